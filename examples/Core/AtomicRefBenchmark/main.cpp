@@ -0,0 +1,153 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+
+using namespace slib;
+
+#define DEFAULT_MAX_THREADS 64
+#define DURATION 500
+#define WRITE_INTERVAL 1
+
+/*
+	Measures the reads of shared references from 1 to [maxThreads] threads,
+	while another thread replaces the value every millisecond.
+	"SpinLock" is the previous implementation of AtomicRef, which locked every read.
+	Usage: ExampleAtomicRefBenchmark [maxThreads]
+*/
+
+class SpinLockRef
+{
+public:
+	SpinLockRef(Referable* object): m_object(object)
+	{
+		object->increaseReference();
+	}
+
+	~SpinLockRef()
+	{
+		m_object->decreaseReference();
+	}
+
+public:
+	Ref<Referable> get()
+	{
+		SpinLocker lock(&m_lock);
+		return m_object;
+	}
+
+	void set(Referable* object)
+	{
+		object->increaseReference();
+		Referable* before;
+		{
+			SpinLocker lock(&m_lock);
+			before = m_object;
+			m_object = object;
+		}
+		before->decreaseReference();
+	}
+
+private:
+	Referable* m_object;
+	SpinLock m_lock;
+
+};
+
+static sl_uint64 Run(sl_uint32 nThreads, const Function<sl_bool()>& read, const Function<void()>& write)
+{
+	volatile sl_int32 flagStop = 0;
+	sl_int64 nTotal = 0;
+	List< Ref<Thread> > threads;
+	for (sl_uint32 i = 0; i < nThreads; i++) {
+		threads.add(Thread::start([&]() {
+			sl_int64 n = 0;
+			while (!flagStop) {
+				for (sl_uint32 k = 0; k < 256; k++) {
+					if (read()) {
+						n++;
+					}
+				}
+			}
+			Base::interlockedAdd64(&nTotal, n);
+		}));
+	}
+	Ref<Thread> writer = Thread::start([&]() {
+		while (!flagStop) {
+			write();
+			System::sleep(WRITE_INTERVAL);
+		}
+	});
+	System::sleep(DURATION);
+	flagStop = 1;
+	for (auto& thread : threads) {
+		thread->join();
+	}
+	writer->join();
+	return (sl_uint64)nTotal * 1000 / DURATION;
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nMaxThreads = DEFAULT_MAX_THREADS;
+	if (argc > 1) {
+		nMaxThreads = String(argv[1]).parseUint32();
+		if (!nMaxThreads) {
+			nMaxThreads = DEFAULT_MAX_THREADS;
+		}
+	}
+
+	SpinLockRef spinRef(new Referable);
+	AtomicRef<Referable> atomicRef = new Referable;
+	AtomicString atomicString = String("shared string value");
+	AtomicList<sl_int32> atomicList = List<sl_int32>::create(16);
+
+	Console::println("Reads per second (%d ms each)", DURATION);
+	Console::println("%8s %14s %14s %14s %14s", "Threads", "SpinLock", "AtomicRef", "AtomicString", "AtomicList");
+	for (sl_uint32 nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2) {
+		sl_uint64 nSpin = Run(nThreads, [&]() {
+			return spinRef.get().isNotNull();
+		}, [&]() {
+			spinRef.set(new Referable);
+		});
+		sl_uint64 nRef = Run(nThreads, [&]() {
+			Ref<Referable> ref = atomicRef;
+			return ref.isNotNull();
+		}, [&]() {
+			atomicRef = new Referable;
+		});
+		sl_uint64 nString = Run(nThreads, [&]() {
+			String s = atomicString;
+			return s.isNotNull();
+		}, [&]() {
+			atomicString = String("shared string value");
+		});
+		sl_uint64 nList = Run(nThreads, [&]() {
+			List<sl_int32> list = atomicList;
+			return list.isNotNull();
+		}, [&]() {
+			atomicList = List<sl_int32>::create(16);
+		});
+		Console::println("%8d %14d %14d %14d %14d", nThreads, nSpin, nRef, nString, nList);
+	}
+	return 0;
+}
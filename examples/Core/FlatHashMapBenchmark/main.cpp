@@ -0,0 +1,233 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+#include <unordered_map>
+
+using namespace slib;
+
+#define OPERATIONS_PER_PHASE 1000000
+#define HEADER_REQUESTS 200000
+
+/*
+	Compares `FlatHashMap` with `HashMap` (unsynchronized functions) and `std::unordered_map`,
+	using the same `Hash`/`Compare` functors for all the maps.
+	Each phase runs about 1M operations over the maps of the given size, and prints nanoseconds per operation.
+	"Headers" builds the header map of a request (12 headers, case-insensitive), looks up 6 of them and clears the map.
+	Usage: ExampleFlatHashMapBenchmark
+*/
+
+template <class KT, class HASH = Hash<KT> >
+class StdHash
+{
+public:
+	size_t operator()(const KT& key) const
+	{
+		return HASH()(key);
+	}
+};
+
+template <class KT, class KEY_COMPARE = Compare<KT> >
+class StdEquals
+{
+public:
+	bool operator()(const KT& a, const KT& b) const
+	{
+		return KEY_COMPARE()(a, b) == 0;
+	}
+};
+
+template < class KT, class HASH = Hash<KT>, class KEY_COMPARE = Compare<KT> >
+class HashMapBench
+{
+public:
+	HashMap<KT, String, HASH, KEY_COMPARE> map;
+
+public:
+	void put(const KT& key, const String& value) { map.put_NoLock(key, value); }
+	void add(const KT& key, const String& value) { map.add_NoLock(key, value); }
+	sl_bool find(const KT& key) { return map.find_NoLock(key) != sl_null; }
+	void remove(const KT& key) { map.remove_NoLock(key); }
+	void clear() { map.removeAll_NoLock(); }
+};
+
+template < class KT, class HASH = Hash<KT>, class KEY_COMPARE = Compare<KT> >
+class FlatHashMapBench
+{
+public:
+	FlatHashMap<KT, String, HASH, KEY_COMPARE> map;
+
+public:
+	void put(const KT& key, const String& value) { map.put(key, value); }
+	void add(const KT& key, const String& value) { map.add(key, value); }
+	sl_bool find(const KT& key) { return map.find(key) != sl_null; }
+	void remove(const KT& key) { map.remove(key); }
+	void clear() { map.removeAll(); }
+};
+
+template < class KT, class HASH = Hash<KT>, class KEY_COMPARE = Compare<KT> >
+class StdBench
+{
+public:
+	std::unordered_multimap< KT, String, StdHash<KT, HASH>, StdEquals<KT, KEY_COMPARE> > map;
+
+public:
+	void put(const KT& key, const String& value) { auto it = map.find(key); if (it != map.end()) { it->second = value; } else { map.emplace(key, value); } }
+	void add(const KT& key, const String& value) { map.emplace(key, value); }
+	sl_bool find(const KT& key) { return map.find(key) != map.end(); }
+	void remove(const KT& key) { auto it = map.find(key); if (it != map.end()) { map.erase(it); } }
+	void clear() { map.clear(); }
+};
+
+static double GetNanoseconds(const TimeCounter& t, sl_size nOperations)
+{
+	return (double)(t.getElapsedMilliseconds()) * 1000000.0 / (double)nOperations;
+}
+
+// result: insert, hit, miss, remove
+template <class MAP, class KT>
+static void Measure(const List<KT>& keys, const List<KT>& keysMissing, double* result)
+{
+	sl_size n = keys.getCount();
+	sl_size nMaps = OPERATIONS_PER_PHASE / n;
+	if (!nMaps) {
+		nMaps = 1;
+	}
+	sl_size nOperations = nMaps * n;
+	KT* k = keys.getData();
+	KT* m = keysMissing.getData();
+	String value = "value";
+	MAP* maps = new MAP[nMaps];
+	sl_size nFound = 0;
+	{
+		TimeCounter t;
+		for (sl_size i = 0; i < nMaps; i++) {
+			for (sl_size j = 0; j < n; j++) {
+				maps[i].put(k[j], value);
+			}
+		}
+		result[0] = GetNanoseconds(t, nOperations);
+	}
+	{
+		TimeCounter t;
+		for (sl_size i = 0; i < nMaps; i++) {
+			for (sl_size j = 0; j < n; j++) {
+				nFound += maps[i].find(k[j]);
+			}
+		}
+		result[1] = GetNanoseconds(t, nOperations);
+	}
+	{
+		TimeCounter t;
+		for (sl_size i = 0; i < nMaps; i++) {
+			for (sl_size j = 0; j < n; j++) {
+				nFound += maps[i].find(m[j]);
+			}
+		}
+		result[2] = GetNanoseconds(t, nOperations);
+	}
+	{
+		TimeCounter t;
+		for (sl_size i = 0; i < nMaps; i++) {
+			for (sl_size j = 0; j < n; j++) {
+				maps[i].remove(k[j]);
+			}
+		}
+		result[3] = GetNanoseconds(t, nOperations);
+	}
+	delete[] maps;
+	if (nFound != nOperations) {
+		Console::println("Unexpected result: %d/%d", nFound, nOperations);
+	}
+}
+
+template <class KT>
+static void RunKeys(const char* name, const List<KT>& keys, const List<KT>& keysMissing)
+{
+	double results[3][4];
+	Measure< HashMapBench<KT> >(keys, keysMissing, results[0]);
+	Measure< FlatHashMapBench<KT> >(keys, keysMissing, results[1]);
+	Measure< StdBench<KT> >(keys, keysMissing, results[2]);
+	static const char* operations[] = {"Insert", "Find (hit)", "Find (miss)", "Remove"};
+	for (sl_uint32 i = 0; i < 4; i++) {
+		Console::println("%-10s %8d %-12s %12.1f %12.1f %12.1f", name, keys.getCount(), operations[i], results[0][i], results[1][i], results[2][i]);
+	}
+}
+
+template <class MAP>
+static double MeasureHeaders(const List<String>& names, const List<String>& lookups)
+{
+	MAP map;
+	sl_size nFound = 0;
+	String value = "value";
+	TimeCounter t;
+	for (sl_uint32 i = 0; i < HEADER_REQUESTS; i++) {
+		for (auto& name : names) {
+			map.add(name, value);
+		}
+		for (auto& name : lookups) {
+			nFound += map.find(name);
+		}
+		map.clear();
+	}
+	if (nFound != HEADER_REQUESTS * lookups.getCount()) {
+		Console::println("Unexpected result: %d", nFound);
+	}
+	return GetNanoseconds(t, HEADER_REQUESTS);
+}
+
+int main(int argc, const char * argv[])
+{
+	Console::println("Nanoseconds per operation");
+	Console::println("%-10s %8s %-12s %12s %12s %12s", "Keys", "Size", "Operation", "HashMap", "FlatHashMap", "std");
+	sl_uint32 sizes[] = {16, 1024, 65536};
+	for (sl_uint32 size : sizes) {
+		List<sl_uint64> intKeys, intKeysMissing;
+		List<String> stringKeys, stringKeysMissing;
+		List<void*> pointerKeys, pointerKeysMissing;
+		for (sl_uint32 i = 0; i < size; i++) {
+			intKeys.add_NoLock((sl_uint64)i * 7919);
+			intKeysMissing.add_NoLock((sl_uint64)i * 7919 + 1);
+			stringKeys.add_NoLock(String::format("key-%d", i));
+			stringKeysMissing.add_NoLock(String::format("missing-%d", i));
+			// aligned addresses, as the connections in `HttpService`
+			pointerKeys.add_NoLock((void*)((sl_size)(i + 1) * 256));
+			pointerKeysMissing.add_NoLock((void*)((sl_size)(i + 1 + size) * 256));
+		}
+		RunKeys("Integer", intKeys, intKeysMissing);
+		RunKeys("String", stringKeys, stringKeysMissing);
+		RunKeys("Pointer", pointerKeys, pointerKeysMissing);
+	}
+
+	List<String> names = {"Host", "User-Agent", "Accept", "Accept-Encoding", "Accept-Language", "Connection", "Cookie", "Referer", "Cache-Control", "Content-Type", "Content-Length", "Upgrade-Insecure-Requests"};
+	List<String> lookups = {"host", "connection", "content-length", "content-type", "accept-encoding", "cookie"};
+	double tHashMap = MeasureHeaders< HashMapBench<String, HashIgnoreCaseString, CompareIgnoreCaseString> >(names, lookups);
+	double tFlatHashMap = MeasureHeaders< FlatHashMapBench<String, HashIgnoreCaseString, CompareIgnoreCaseString> >(names, lookups);
+	double tStd = MeasureHeaders< StdBench<String, HashIgnoreCaseString, CompareIgnoreCaseString> >(names, lookups);
+	Console::println("");
+	Console::println("Nanoseconds per request");
+	Console::println("%-23s %12s %12s %12s", "Workload", "HashMap", "FlatHashMap", "std");
+	Console::println("%-23s %12.1f %12.1f %12.1f", "Headers", tHashMap, tFlatHashMap, tStd);
+	return 0;
+}
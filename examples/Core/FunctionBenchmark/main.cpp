@@ -0,0 +1,167 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+
+#include <stdlib.h>
+#include <new>
+
+using namespace slib;
+
+#define DEFAULT_TASKS_COUNT 100000
+
+/*
+	Counts the heap allocations and the time per task posted to the loops,
+	comparing `dispatch` (allocating a `Function`) with `addTask` (storing the callable inline).
+	Usage: ExampleFunctionBenchmark [tasksCount]
+*/
+
+static volatile sl_int64 g_nAllocations = 0;
+
+void* operator new(size_t size)
+{
+	Base::interlockedIncrement64((sl_int64*)&g_nAllocations);
+	void* p = malloc(size);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	Base::interlockedIncrement64((sl_int64*)&g_nAllocations);
+	void* p = malloc(size);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+#if defined(__GLIBC__)
+// the memory of the queues and the lists is allocated by `Base::createMemory`
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+	Base::interlockedIncrement64((sl_int64*)&g_nAllocations);
+	return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+	Base::interlockedIncrement64((sl_int64*)&g_nAllocations);
+	return __libc_realloc(p, size);
+}
+#endif
+
+static void Measure(const char* name, sl_uint32 nTasks, const Function<void(sl_int64*)>& post)
+{
+	sl_int64 nDone = 0;
+	// the first pass grows the queues
+	for (sl_uint32 k = 0; k < 2; k++) {
+		nDone = 0;
+		sl_int64 nAllocationsBefore = g_nAllocations;
+		TimeCounter t;
+		for (sl_uint32 i = 0; i < nTasks; i++) {
+			post(&nDone);
+		}
+		while (Base::interlockedAdd64(&nDone, 0) < nTasks) {
+			System::yield();
+		}
+		if (k) {
+			sl_uint64 dt = t.getElapsedMilliseconds();
+			sl_int64 nAllocations = g_nAllocations - nAllocationsBefore;
+			Console::println("%-24s %12.2f %12.1f", name, (double)nAllocations / nTasks, (double)dt * 1000000 / nTasks);
+		}
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nTasks = DEFAULT_TASKS_COUNT;
+	if (argc > 1) {
+		nTasks = String(argv[1]).parseUint32();
+		if (!nTasks) {
+			nTasks = DEFAULT_TASKS_COUNT;
+		}
+	}
+
+	Ref<DispatchLoop> dispatchLoop = DispatchLoop::create();
+	Ref<ThreadPool> threadPool = ThreadPool::create(1, 1);
+	Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create();
+	if (dispatchLoop.isNull() || threadPool.isNull() || ioLoop.isNull()) {
+		Console::println("Failed to create the loops");
+		return -1;
+	}
+
+	sl_int64 value = 1;
+
+	Console::println("%d tasks", nTasks);
+	Console::println("%-24s %12s %12s", "", "Allocs/task", "ns/task");
+	Measure("DispatchLoop::dispatch", nTasks, [&](sl_int64* pDone) {
+		dispatchLoop->dispatch([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		});
+	});
+	Measure("DispatchLoop::addTask", nTasks, [&](sl_int64* pDone) {
+		dispatchLoop->addTask([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		});
+	});
+	Measure("ThreadPool::dispatch", nTasks, [&](sl_int64* pDone) {
+		threadPool->dispatch([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		});
+	});
+	Measure("ThreadPool::addTask", nTasks, [&](sl_int64* pDone) {
+		threadPool->addTask([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		});
+	});
+	Measure("AsyncIoLoop::dispatch", nTasks, [&](sl_int64* pDone) {
+		ioLoop->dispatch([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		}, 0);
+	});
+	Measure("AsyncIoLoop::addTask", nTasks, [&](sl_int64* pDone) {
+		ioLoop->addTask([pDone, value]() {
+			Base::interlockedAdd64(pDone, value);
+		});
+	});
+
+	ioLoop->release();
+	threadPool->release();
+	dispatchLoop->release();
+	return 0;
+}
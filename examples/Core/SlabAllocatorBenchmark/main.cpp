@@ -0,0 +1,178 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+
+using namespace slib;
+
+#define DEFAULT_MAX_THREADS 8
+#define DURATION 500
+
+/*
+	Measures the string-heavy and the map-heavy workloads from 1 to [maxThreads] threads,
+	allocating by `malloc` and by the slab allocator.
+	The "Queue" workload frees the strings on another thread than the one allocating them.
+	Usage: ExampleSlabAllocatorBenchmark [maxThreads]
+*/
+
+static void RunStrings(sl_uint32 index, sl_uint64& n)
+{
+	List<String> list;
+	for (sl_uint32 i = 0; i < 64; i++) {
+		String s = String::format("item-%d-%d", index, i);
+		list.add_NoLock(s + ":" + String::fromUint32(i * 7919));
+	}
+	n += 64;
+}
+
+static void RunMaps(sl_uint32 index, sl_uint64& n)
+{
+	HashMap<String, sl_uint32> map;
+	Map<sl_uint32, String> tree;
+	for (sl_uint32 i = 0; i < 64; i++) {
+		String key = String::format("key-%d-%d", index, i);
+		map.put_NoLock(key, i);
+		tree.put_NoLock(i, key);
+	}
+	for (sl_uint32 i = 0; i < 64; i += 2) {
+		map.remove_NoLock(tree.getValue_NoLock(i));
+	}
+	n += 64;
+}
+
+static sl_uint64 Run(sl_uint32 nThreads, void (*work)(sl_uint32 index, sl_uint64& n))
+{
+	volatile sl_int32 flagStop = 0;
+	sl_int64 nTotal = 0;
+	List< Ref<Thread> > threads;
+	for (sl_uint32 i = 0; i < nThreads; i++) {
+		threads.add(Thread::start([&, i]() {
+			sl_uint64 n = 0;
+			while (!flagStop) {
+				work(i, n);
+			}
+			Base::interlockedAdd64(&nTotal, (sl_int64)n);
+		}));
+	}
+	System::sleep(DURATION);
+	flagStop = 1;
+	for (auto& thread : threads) {
+		thread->join();
+	}
+	return (sl_uint64)nTotal * 1000 / DURATION;
+}
+
+static sl_uint64 RunQueue(sl_uint32 nThreads)
+{
+	volatile sl_int32 flagStop = 0;
+	sl_int64 nTotal = 0;
+	List< Ref<Thread> > threads;
+	// half of the threads produce the strings, and the others free them
+	sl_uint32 nProducers = (nThreads + 1) / 2;
+	LinkedQueue<String> queue;
+	for (sl_uint32 i = 0; i < nThreads; i++) {
+		if (i < nProducers) {
+			threads.add(Thread::start([&, i]() {
+				sl_uint32 k = 0;
+				while (!flagStop) {
+					if (queue.getCount() < 10000) {
+						queue.push(String::format("message-%d-%d", i, k++));
+					} else {
+						System::yield();
+					}
+				}
+			}));
+		} else {
+			threads.add(Thread::start([&]() {
+				sl_int64 n = 0;
+				while (!flagStop) {
+					String s;
+					if (queue.pop(&s)) {
+						n++;
+					} else {
+						System::yield();
+					}
+				}
+				Base::interlockedAdd64(&nTotal, n);
+			}));
+		}
+	}
+	if (nThreads == 1) {
+		// the main thread consumes
+		sl_int64 n = 0;
+		TimeCounter t;
+		while (t.getElapsedMilliseconds() < DURATION) {
+			String s;
+			if (queue.pop(&s)) {
+				n++;
+			} else {
+				System::yield();
+			}
+		}
+		nTotal = n;
+	} else {
+		System::sleep(DURATION);
+	}
+	flagStop = 1;
+	for (auto& thread : threads) {
+		thread->join();
+	}
+	return (sl_uint64)nTotal * 1000 / DURATION;
+}
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nMaxThreads = DEFAULT_MAX_THREADS;
+	if (argc > 1) {
+		nMaxThreads = String(argv[1]).parseUint32();
+		if (!nMaxThreads) {
+			nMaxThreads = DEFAULT_MAX_THREADS;
+		}
+	}
+
+	Console::println("Operations per second (%d ms each)", DURATION);
+	Console::println("%8s %12s %12s %12s %12s %12s %12s", "Threads", "Strings", "Strings/Slab", "Maps", "Maps/Slab", "Queue", "Queue/Slab");
+	for (sl_uint32 nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2) {
+		sl_uint64 result[6];
+		for (sl_uint32 k = 0; k < 2; k++) {
+			if (!(SlabAllocator::setEnabled(k != 0))) {
+				Console::println("Failed to enable the slab allocator");
+				return -1;
+			}
+			result[k] = Run(nThreads, RunStrings);
+			result[2 + k] = Run(nThreads, RunMaps);
+			result[4 + k] = RunQueue(nThreads);
+		}
+		SlabAllocator::setEnabled(sl_false);
+		Console::println("%8d %12d %12d %12d %12d %12d %12d", nThreads, result[0], result[1], result[2], result[3], result[4], result[5]);
+	}
+
+	Console::println("");
+	Console::println("%8s %14s %14s %14s %8s", "Block", "Allocated", "Freed", "Live bytes", "Spans");
+	for (sl_uint32 i = 0; i < SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT; i++) {
+		SlabAllocatorStatistics stats;
+		if (SlabAllocator::getStatistics(i, stats)) {
+			Console::println("%8d %14d %14d %14d %8d", stats.blockSize, stats.allocatedCount, stats.freedCount, stats.liveBytes, stats.spansCount);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+
+using namespace slib;
+
+#define PORT 8081
+#define DEFAULT_REQUEST_COUNT 10000
+
+/*
+	Fires the requests concurrently at a local HttpService through CurlRequest,
+	which runs all of them on the shared curl multi handle.
+	Usage: ExampleCurlBenchmark [count]
+*/
+
+int main(int argc, const char * argv[])
+{
+	sl_uint32 nRequests = DEFAULT_REQUEST_COUNT;
+	if (argc > 1) {
+		nRequests = String(argv[1]).parseUint32();
+		if (!nRequests) {
+			nRequests = DEFAULT_REQUEST_COUNT;
+		}
+	}
+	
+	HttpServiceParam param;
+	param.port = PORT;
+	param.onRequest = [](HttpService* service, HttpServiceContext* context) {
+		context->write("Welcome");
+		return sl_true;
+	};
+	Ref<HttpService> service = HttpService::create(param);
+	if (service.isNull()) {
+		return -1;
+	}
+	
+	Ref<Event> ev = Event::create();
+	sl_int32 nRemaining = (sl_int32)nRequests;
+	sl_int32 nErrors = 0;
+	String url = String::format("http://127.0.0.1:%d/bench", PORT);
+	
+	Console::println("Sending %d requests to %s", nRequests, url);
+	sl_uint32 tStart = System::getTickCount();
+	for (sl_uint32 i = 0; i < nRequests; i++) {
+		CurlRequest::send(url, [&](UrlRequest* request) {
+			if (request->isError()) {
+				Base::interlockedIncrement32(&nErrors);
+			}
+			if (!(Base::interlockedDecrement32(&nRemaining))) {
+				ev->set();
+			}
+		});
+	}
+	ev->wait();
+	sl_uint32 tEnd = System::getTickCount();
+	
+	sl_uint32 elapsed = tEnd - tStart;
+	Console::println("Completed: %d requests, %d errors, %d ms", nRequests, nErrors, elapsed);
+	if (elapsed) {
+		Console::println("Throughput: %d requests/s", (sl_uint64)nRequests * 1000 / elapsed);
+	}
+	return 0;
+}
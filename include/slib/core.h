@@ -49,10 +49,13 @@
 #include "core/singleton.h"
 
 #include "core/spin_lock.h"
+#include "core/hazard_pointer.h"
+#include "core/slab_allocator.h"
 #include "core/mutex.h"
 #include "core/string.h"
 #include "core/string_buffer.h"
 #include "core/memory.h"
+#include "core/memory_arena.h"
 #include "core/time.h"
 #include "core/variant.h"
 
@@ -67,6 +70,7 @@
 #include "core/map.h"
 #include "core/hash_map.h"
 #include "core/hash_table.h"
+#include "core/flat_hash_map.h"
 #include "core/linked_list.h"
 #include "core/queue.h"
 #include "core/queue_channel.h"
@@ -83,6 +87,7 @@
 #include "core/console.h"
 #include "core/event.h"
 #include "core/thread.h"
+#include "core/task_queue.h"
 #include "core/thread_pool.h"
 #include "core/rw_lock.h"
 #include "core/log.h"
@@ -48,6 +48,9 @@ namespace slib
 	class AsyncStream;
 	class AsyncStreamRequest;
 	
+	class _priv_IoUringFileInstance;
+	class _priv_Unix_AsyncTcpSocketInstance;
+	
 	class SLIB_EXPORT AsyncIoLoop : public Dispatcher
 	{
 		SLIB_DECLARE_OBJECT
@@ -70,9 +73,19 @@ namespace slib
 		void start();
 
 		sl_bool isRunning();
+		
+		// returns true when called on the thread running this loop
+		sl_bool isCurrentThread();
+
 
+		// the callables fitting in `UniqueFunction` are queued without allocation
+		sl_bool addTask(UniqueFunction<void()>&& task);
 
-		sl_bool addTask(const Function<void()>& task);
+		template <class FUNC>
+		sl_bool addTask(FUNC&& task)
+		{
+			return addTask(UniqueFunction<void()>(Forward<FUNC>(task)));
+		}
 	
 		void wake();
 
@@ -84,6 +97,20 @@ namespace slib
 		void requestOrder(AsyncIoInstance* instance);
 
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms) override;
+		
+		TimerHandle addTimeout(const Function<void()>& task, sl_uint64 delay_ms);
+
+		/*
+			Registers the memory to the kernel as the fixed buffer of this loop (io_uring), so that the sockets receiving
+			into it don't map the user pages on every read. The memory is kept by the loop until the loop is released.
+			Only one buffer is registered per loop. Returns false when the loop doesn't support it, or another buffer is registered.
+		*/
+		sl_bool registerBuffer(const Memory& mem);
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// returns true when the loop is running on io_uring: the sockets submit their reads and writes to the ring, instead of waiting for the readiness
+		sl_bool isIoUring();
+#endif
 
 	protected:
 		sl_bool m_flagInit;
@@ -92,11 +119,17 @@ namespace slib
 
 		Ref<Thread> m_thread;
 
-		LinkedQueue< Function<void()> > m_queueTasks;
+		TaskQueue m_queueTasks;
+		// used only by the loop thread, keeping its buffer between the runs
+		TaskQueue m_queueTasksRunning;
 	
 		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesOrder;
 		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesClosing;
 		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesClosed;
+		
+		TimerWheel m_timers;
+		
+		Memory m_bufferRegistered;
 
 	protected:
 		static void* _native_createHandle();
@@ -105,10 +138,28 @@ namespace slib
 		sl_bool _native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode);
 		void _native_detachInstance(AsyncIoInstance* instance);
 		void _native_wake();
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// returns the io_uring object (`_priv_IoUring`) when the loop is running on io_uring, otherwise null
+		void* _native_getIoUring();
+		void _submitIoUring();
+		/*
+			Queue the requests of the socket to the io_uring, submitted together by the next waiting of the loop thread.
+			`onEvent` of the instance is called on the loop thread with `completionResult`, and with `flagIn` for the receiving or the poll-in,
+			or `flagOut` for the sending or the poll-out. Each request keeps a reference of the instance until its completion.
+			The receiving into the registered buffer reads into the fixed buffer.
+		*/
+		sl_bool _submitIoUringReceive(AsyncIoInstance* instance, void* data, sl_uint32 size);
+		sl_bool _submitIoUringSend(AsyncIoInstance* instance, const void* data, sl_uint32 size);
+		sl_bool _submitIoUringPoll(AsyncIoInstance* instance, sl_bool flagOut);
+#endif
 
 	protected:
-		void _stepBegin();
+		// returns the timeout (milliseconds) for waiting the next events (-1: infinite)
+		sl_int32 _stepBegin();
 		void _stepEnd();
+		
+		friend class _priv_IoUringFileInstance;
+		friend class _priv_Unix_AsyncTcpSocketInstance;
 	
 	};
 	
@@ -167,6 +218,9 @@ namespace slib
 			sl_bool flagIn;
 			sl_bool flagOut;
 			sl_bool flagError;
+#endif
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_int32 completionResult; // result of the completed read/write request on io_uring
 #endif
 		};
 		virtual void onEvent(EventDesc* pev) = 0;
@@ -242,6 +296,10 @@ namespace slib
 		Function<void(AsyncStreamResult*)> callback;
 		sl_bool flagRead;
 
+		// file region to be sent (`data` is null)
+		Ref<File> file;
+		sl_uint64 offsetFile;
+
 	protected:
 		AsyncStreamRequest(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback, sl_bool flagRead);
 	
@@ -250,6 +308,8 @@ namespace slib
 
 		static Ref<AsyncStreamRequest> createWrite(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
 
+		static Ref<AsyncStreamRequest> createSendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
+
 	public:
 		void runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError);
 
@@ -270,6 +330,10 @@ namespace slib
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
 
+		virtual sl_bool isSendFileSupported();
+
+		virtual sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -321,6 +385,11 @@ namespace slib
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) = 0;
 
+		// returns true when the stream can send file regions directly (zero-copy), without reading them into the user-space buffers
+		virtual sl_bool isSendFileSupported();
+
+		virtual sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -351,6 +420,10 @@ namespace slib
 
 		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
 
+		sl_bool isSendFileSupported() override;
+
+		sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
+
 		sl_bool isSeekable() override;
 
 		sl_bool seek(sl_uint64 pos) override;
@@ -509,6 +582,17 @@ namespace slib
 
 		static Ref<AsyncStream> openIOCP(const String& path, FileMode mode);
 #endif
+		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		/*
+			Reads and writes are submitted to the io_uring of the loop, and completed on the loop thread.
+			Returns the file on the dispatcher thread (same as `open`) when the loop is not running on io_uring.
+			The loops run on io_uring when the kernel supports it, unless the library is built with `SLIB_NOT_USE_IO_URING`.
+		*/
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop);
+		
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode);
+#endif
 	
 	public:
 		void close() override;
@@ -559,7 +643,7 @@ namespace slib
 		Ref<AsyncStream> target;
 	
 		// optional
-		sl_uint64 size; // default: Maximum
+		sl_uint64 size; // default: Maximum (copies until the source completes a read with no data)
 		sl_uint32 bufferSize; // default: 0x10000
 		sl_uint32 bufferCount; // default: 8
 		sl_bool flagAutoStart; // default: true
@@ -659,6 +743,8 @@ namespace slib
 
 		AsyncOutputBufferElement(AsyncStream* stream, sl_uint64 size);
 
+		AsyncOutputBufferElement(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
+
 		~AsyncOutputBufferElement();
 	
 	public:
@@ -670,17 +756,25 @@ namespace slib
 		sl_bool addHeader(const Memory& header);
 
 		void setBody(AsyncStream* stream, sl_uint64 size);
+
+		void setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
 	
 		MemoryQueue& getHeader();
 	
 		Ref<AsyncStream> getBody();
 	
 		sl_uint64 getBodySize();
+
+		Ref<File> getBodyFile();
+
+		sl_uint64 getBodyFileOffset();
 	
 	protected:
 		MemoryQueue m_header;
 		sl_uint64 m_sizeBody;
 		AtomicRef<AsyncStream> m_body;
+		AtomicRef<File> m_bodyFile;
+		sl_uint64 m_offsetBodyFile;
 
 	};
 	
@@ -704,7 +798,15 @@ namespace slib
 
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
+		// the region is sent by `sendfile` when the output stream supports it, otherwise it is copied via `AsyncFile`
+		sl_bool copyFromFileRegion(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
+
+		sl_bool copyFromFileRegion(const String& path, sl_uint64 offset, sl_uint64 size);
+
 		sl_uint64 getOutputLength() const;
+
+		// merges the whole output into `_out`, returns false when the output contains stream or file bodies
+		sl_bool getMemoryOutput(Memory& _out);
 	
 	protected:
 		sl_uint64 m_lengthOutput;
@@ -766,6 +868,9 @@ namespace slib
 
 		void startWriting();
 
+		// returns true until all the merged output is written to the stream
+		sl_bool isWriting();
+
 		void close();
 
 	protected:
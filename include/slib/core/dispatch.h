@@ -42,6 +42,11 @@ namespace slib
 		static sl_bool setTimeout(const Ref<DispatchLoop>& loop, const Function<void()>& task, sl_uint64 delay_ms);
 
 		static sl_bool setTimeout(const Function<void()>& task, sl_uint64 delay_ms);
+
+		// same as `setTimeout`, but the returned handle can cancel or reschedule the pending task
+		static TimerHandle addTimeout(const Ref<DispatchLoop>& loop, const Function<void()>& task, sl_uint64 delay_ms);
+
+		static TimerHandle addTimeout(const Function<void()>& task, sl_uint64 delay_ms);
 	
 		static Ref<Timer> setInterval(const Ref<DispatchLoop>& loop, const Function<void(Timer*)>& task, sl_uint64 interval_ms);
 
@@ -29,6 +29,7 @@
 #include "thread.h"
 #include "time.h"
 #include "map.h"
+#include "task_queue.h"
 
 namespace slib
 {
@@ -58,6 +59,17 @@ namespace slib
 
 		sl_bool dispatch(const Function<void()>& task, sl_uint64 delay_ms = 0) override;
 
+		// the callables fitting in `UniqueFunction` are queued without allocation
+		sl_bool addTask(UniqueFunction<void()>&& task);
+
+		template <class FUNC>
+		sl_bool addTask(FUNC&& task)
+		{
+			return addTask(UniqueFunction<void()>(Forward<FUNC>(task)));
+		}
+		
+		TimerHandle addTimeout(const Function<void()>& task, sl_uint64 delay_ms);
+
 		sl_bool addTimer(const Ref<Timer>& timer);
 		
 		void removeTimer(const Ref<Timer>& timer);
@@ -71,32 +83,16 @@ namespace slib
 
 		TimeCounter m_timeCounter;
 
-		LinkedQueue< Function<void()> > m_queueTasks;
-
-		struct TimeTask
-		{
-			sl_uint64 time;
-			Function<void()> task;
-		};
-		CMap<sl_uint64, TimeTask> m_timeTasks;
-		Mutex m_lockTimeTasks;
-
-		class TimerTask
-		{
-		public:
-			WeakRef<Timer> timer;
+		TaskQueue m_queueTasks;
+		// used only by the loop thread, keeping its buffer between the runs
+		TaskQueue m_queueTasksRunning;
 
-		public:
-			sl_bool operator==(const TimerTask& other) const;
-		};
-		LinkedQueue<TimerTask> m_queueTimers;
-		Mutex m_lockTimer;
+		TimerWheel m_timers;
 
 	protected:
 		void _wake();
 		sl_int32 _getTimeout();
-		sl_int32 _getTimeout_TimeTasks();
-		sl_int32 _getTimeout_Timer();
+		void _runTimer(const WeakRef<Timer>& timer);
 		void _runLoop();
 
 	};
@@ -0,0 +1,201 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_CORE_FLAT_HASH_MAP
+#define CHECKHEADER_SLIB_CORE_FLAT_HASH_MAP
+
+#include "definition.h"
+
+#include "map_common.h"
+#include "hash.h"
+#include "compare.h"
+#include "list.h"
+
+namespace slib
+{
+	
+	template <class KT, class VT>
+	class FlatHashMapNode
+	{
+	public:
+		KT key;
+		VT value;
+		sl_size hash;
+		
+	public:
+		template <class KEY, class... VALUE_ARGS>
+		FlatHashMapNode(KEY&& _key, VALUE_ARGS&&... value_args) noexcept;
+		
+	};
+	
+	template <class KT, class VT>
+	class SLIB_EXPORT FlatHashMapPosition
+	{
+	public:
+		typedef FlatHashMapNode<KT, VT> NODE;
+		
+	public:
+		FlatHashMapPosition(const sl_int8* ctrl, NODE* node, NODE* end) noexcept;
+		
+		FlatHashMapPosition(const FlatHashMapPosition& other) noexcept = default;
+		
+	public:
+		FlatHashMapPosition& operator=(const FlatHashMapPosition& other) noexcept = default;
+		
+		NODE& operator*() const noexcept;
+		
+		sl_bool operator==(const FlatHashMapPosition& other) const noexcept;
+		
+		sl_bool operator!=(const FlatHashMapPosition& other) const noexcept;
+		
+		FlatHashMapPosition& operator++() noexcept;
+		
+	public:
+		const sl_int8* ctrl;
+		NODE* node;
+		NODE* end;
+		
+	};
+	
+	/*
+		Unsynchronized hash map using open addressing (Swiss table).
+
+		The items are stored in a single array, and a control byte per item (empty, deleted or 7 bits of the hash)
+		is kept in a separated array, which is probed by groups of 16 bytes (SSE2) or 8 bytes (NEON or portable code).
+		The full hash is stored in each node, so the keys are only compared when the hashes are same,
+		and the table is rehashed without calling `HASH` (`String` keys cache the hash in their containers).
+	 
+		The nodes are moved when the table grows, so the pointers to the nodes are invalidated by the insertions.
+		Duplicated keys are allowed by `add`, same as `HashTable`.
+	*/
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT FlatHashMap
+	{
+	public:
+		typedef FlatHashMapNode<KT, VT> NODE;
+		
+	public:
+		FlatHashMap(sl_size capacityMinimum = 0, const HASH& hash = HASH(), const KEY_COMPARE& compare = KEY_COMPARE()) noexcept;
+		
+		FlatHashMap(const FlatHashMap& other) = delete;
+		
+		FlatHashMap(FlatHashMap&& other) noexcept;
+		
+		~FlatHashMap() noexcept;
+		
+	public:
+		FlatHashMap& operator=(const FlatHashMap& other) = delete;
+		
+		FlatHashMap& operator=(FlatHashMap&& other) noexcept;
+		
+	public:
+		sl_size getCount() const noexcept;
+		
+		sl_bool isEmpty() const noexcept;
+		
+		sl_bool isNotEmpty() const noexcept;
+		
+		sl_size getCapacity() const noexcept;
+		
+		// prepares the table for `count` items without rehashing
+		sl_bool reserve(sl_size count) noexcept;
+		
+		NODE* find(const KT& key) const noexcept;
+		
+		template < class VALUE, class VALUE_EQUALS = Equals<VT, VALUE> >
+		NODE* findKeyAndValue(const KT& key, const VALUE& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const noexcept;
+		
+		VT* getItemPointer(const KT& key) const noexcept;
+		
+		sl_bool get(const KT& key, VT* outValue = sl_null) const noexcept;
+		
+		VT getValue(const KT& key) const noexcept;
+		
+		VT getValue(const KT& key, const VT& def) const noexcept;
+		
+		List<VT> getValues(const KT& key) const noexcept;
+		
+		template <class KEY, class VALUE>
+		NODE* put(KEY&& key, VALUE&& value, sl_bool* isInsertion = sl_null) noexcept;
+		
+		template <class KEY, class VALUE>
+		NODE* replace(const KEY& key, VALUE&& value) noexcept;
+		
+		template <class KEY, class... VALUE_ARGS>
+		NODE* add(KEY&& key, VALUE_ARGS&&... value_args) noexcept;
+		
+		template <class KEY, class... VALUE_ARGS>
+		MapEmplaceReturn<NODE> emplace(KEY&& key, VALUE_ARGS&&... value_args) noexcept;
+		
+		sl_bool removeAt(const NODE* node) noexcept;
+		
+		sl_bool remove(const KT& key, VT* outValue = sl_null) noexcept;
+		
+		sl_size removeItems(const KT& key) noexcept;
+		
+		template < class VALUE, class VALUE_EQUALS = Equals<VT, VALUE> >
+		sl_bool removeKeyAndValue(const KT& key, const VALUE& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) noexcept;
+		
+		// the capacity is kept for the next items
+		sl_size removeAll() noexcept;
+		
+		void shrink() noexcept;
+		
+		sl_bool copyFrom(const FlatHashMap& other) noexcept;
+		
+		List<KT> getAllKeys() const noexcept;
+		
+		List<VT> getAllValues() const noexcept;
+		
+		// range-based for loop
+		FlatHashMapPosition<KT, VT> begin() const noexcept;
+		
+		FlatHashMapPosition<KT, VT> end() const noexcept;
+		
+	private:
+		NODE* _find(const KT& key, sl_size hash) const noexcept;
+		
+		sl_size _prepareInsert(sl_size hash) noexcept;
+		
+		void _eraseAt(sl_size index) noexcept;
+		
+		sl_bool _rehash(sl_size capacity) noexcept;
+		
+		void _free() noexcept;
+		
+	private:
+		NODE* m_nodes;
+		sl_int8* m_ctrl;
+		sl_size m_capacity;
+		sl_size m_count;
+		sl_size m_growthLeft;
+		HASH m_hash;
+		KEY_COMPARE m_compare;
+		
+	};
+
+}
+
+#include "detail/flat_hash_map.inc"
+
+#endif
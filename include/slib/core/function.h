@@ -28,6 +28,7 @@
 #include "object.h"
 #include "tuple.h"
 #include "null_value.h"
+#include "new_helper.h"
 
 namespace slib
 {
@@ -38,6 +39,9 @@ namespace slib
 	template <class T>
 	class Function;
 	
+	template <class T>
+	class UniqueFunction;
+	
 	template <class T>
 	using AtomicFunction = Atomic< Function<T> >;
 	
@@ -117,6 +121,80 @@ namespace slib
 		RET_TYPE operator()(ARGS... args) const;
 
 	};
+	
+#define SLIB_UNIQUE_FUNCTION_INLINE_SIZE 48
+	
+	/*
+		Move-only function storing the small callables (up to `SLIB_UNIQUE_FUNCTION_INLINE_SIZE` bytes, ex: lambdas capturing a few pointers or references) inline,
+		so that it is created and destroyed without the heap allocation and the reference counting of `Function`.
+		The larger callables are allocated on the heap, and a `Function` is stored as it is.
+	*/
+	template <class RET_TYPE, class... ARGS>
+	class SLIB_EXPORT UniqueFunction<RET_TYPE(ARGS...)>
+	{
+	public:
+		UniqueFunction() noexcept;
+
+		UniqueFunction(sl_null_t) noexcept;
+
+		UniqueFunction(UniqueFunction&& other) noexcept;
+
+		template <class FUNC>
+		UniqueFunction(FUNC&& func) noexcept;
+
+		UniqueFunction(const UniqueFunction& other) = delete;
+
+		~UniqueFunction() noexcept;
+
+	public:
+		UniqueFunction& operator=(UniqueFunction&& other) noexcept;
+
+		UniqueFunction& operator=(sl_null_t) noexcept;
+
+		template <class FUNC>
+		UniqueFunction& operator=(FUNC&& func) noexcept;
+
+		UniqueFunction& operator=(const UniqueFunction& other) = delete;
+
+		RET_TYPE operator()(ARGS... args) const;
+
+		explicit operator sl_bool() const noexcept;
+
+	public:
+		sl_bool isNull() const noexcept;
+
+		sl_bool isNotNull() const noexcept;
+
+		void setNull() noexcept;
+
+		// moves the callable into a `Function` (allocated unless a `Function` is stored)
+		Function<RET_TYPE(ARGS...)> release() noexcept;
+
+	public:
+		struct Operations
+		{
+			RET_TYPE (*invoke)(void* storage, ARGS... args);
+			void (*move)(void* dst, void* src);
+			void (*destroy)(void* storage);
+			Function<RET_TYPE(ARGS...)> (*release)(void* storage);
+		};
+
+		union Storage
+		{
+			void* ptr;
+			sl_uint64 align;
+			char data[SLIB_UNIQUE_FUNCTION_INLINE_SIZE];
+		};
+
+	protected:
+		const Operations* m_operations;
+		mutable Storage m_storage;
+
+	protected:
+		template <class FUNC>
+		void _init(FUNC&& func) noexcept;
+
+	};
 
 }
 
@@ -54,6 +54,8 @@ namespace slib
 	template <class KT, class VT>
 	class SLIB_EXPORT HashMapNode
 	{
+		SLIB_DECLARE_BASE_MEMORY_OPERATORS
+
 	public:
 		HashMapNode* parent;
 		HashMapNode* left;
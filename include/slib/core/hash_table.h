@@ -35,6 +35,8 @@ namespace slib
 	template <class KT, class VT>
 	class HashTableNode
 	{
+		SLIB_DECLARE_BASE_MEMORY_OPERATORS
+
 	public:
 		HashTableNode* next;
 		sl_size hash;
@@ -0,0 +1,88 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_HAZARD_POINTER
+#define CHECKHEADER_SLIB_CORE_HAZARD_POINTER
+
+#include "definition.h"
+
+namespace slib
+{
+
+	/*
+		Lock-free access to a shared pointer of a reference-counted object.
+
+		The reader announces the pointer in the hazard slot of its thread before increasing the reference count.
+		The writer doesn't wait for the readers: the replaced pointer is kept in the retire list of the writer thread,
+		and the list is reclaimed in one scan of the slots when it reaches a small threshold (8 pointers), by `reclaimAll` or when the thread exits.
+		So the replaced object is destructed later than the replacement, after at most a few more replacements on the same thread.
+		The I/O loops call `reclaimAll` after each step, and the workers of the thread pools before sleeping.
+		The slot is only held while the reference count is increased, so the pointers announced in a scan are not kept long.
+	*/
+	class SLIB_EXPORT HazardPointer
+	{
+	public:
+		typedef void (*Releaser)(void* ptr);
+
+	public:
+		// returns the pointer stored in `*ptr`, announced by the current thread until `clear` is called (not announced when null is returned)
+		static void* protect(void* const volatile* ptr) noexcept;
+
+		static void clear() noexcept;
+
+		// stores `value`, and calls `release` with the previous pointer after it is not announced by any thread
+		static void replace(void* volatile* ptr, const void* value, Releaser release) noexcept;
+
+		// releases the pointers replaced by the current thread, waiting for the readers still announcing them
+		static void reclaimAll() noexcept;
+
+	public:
+		template <class T>
+		static T* retain(T* const volatile& ptr) noexcept
+		{
+			T* ret = (T*)(protect((void* const volatile*)&ptr));
+			if (ret) {
+				ret->increaseReference();
+				clear();
+			}
+			return ret;
+		}
+
+		// the previous object is released by `decreaseReference`
+		template <class T>
+		static void replace(T* volatile& ptr, T* value) noexcept
+		{
+			replace((void* volatile*)&ptr, value, &_decreaseReference<T>);
+		}
+
+	private:
+		template <class T>
+		static void _decreaseReference(void* ptr) noexcept
+		{
+			((T*)ptr)->decreaseReference();
+		}
+
+	};
+
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "variant.h"
 #include "cast.h"
+#include "memory_arena.h"
 
 #ifdef SLIB_SUPPORT_STD_TYPES
 #include <initializer_list>
@@ -523,6 +524,199 @@ namespace slib
 		
 	};
 	
+	class _priv_JsonNode;
+	
+	/*
+		Read-only value of `JsonDocument`.
+		This is a light handle to the node in the document, and should not be used after the document is freed.
+	*/
+	class SLIB_EXPORT JsonValue
+	{
+	public:
+		JsonValue();
+		
+		JsonValue(const _priv_JsonNode* node);
+		
+	public:
+		sl_bool isNull() const;
+		
+		sl_bool isNotNull() const;
+		
+		sl_bool isBoolean() const;
+		
+		sl_bool getBoolean(sl_bool def = sl_false) const;
+		
+		sl_bool isInteger() const;
+		
+		sl_bool isNumber() const;
+		
+		sl_int32 getInt32(sl_int32 def = 0) const;
+		
+		sl_uint32 getUint32(sl_uint32 def = 0) const;
+		
+		sl_int64 getInt64(sl_int64 def = 0) const;
+		
+		sl_uint64 getUint64(sl_uint64 def = 0) const;
+		
+		float getFloat(float def = 0) const;
+		
+		double getDouble(double def = 0) const;
+		
+		sl_bool isString() const;
+		
+		String getString(const String& def) const;
+		
+		String getString() const;
+		
+		// returns the string content without copying (not null-terminated)
+		const sl_char8* getStringData(sl_size* pLength = sl_null) const;
+		
+		sl_bool isList() const;
+		
+		sl_size getElementsCount() const;
+		
+		JsonValue getElement(sl_size index) const;
+		
+		JsonValue operator[](sl_size index) const;
+		
+		sl_bool isMap() const;
+		
+		// the items are sorted by key
+		sl_size getItemsCount() const;
+		
+		String getItemKey(sl_size index) const;
+		
+		JsonValue getItemValue(sl_size index) const;
+		
+		JsonValue getItem(const sl_char8* key, sl_size lengthKey) const;
+		
+		JsonValue getItem(const String& key) const;
+		
+		JsonValue operator[](const String& key) const;
+		
+		// builds the `Variant` based DOM
+		Json toJson() const;
+		
+		String toJsonString() const;
+		
+	protected:
+		const _priv_JsonNode* m_node;
+		
+	};
+	
+	/*
+		Read-only JSON DOM parsed directly from UTF-8 text.
+		The nodes are allocated in an arena owned by the document, the objects are flat arrays sorted by key,
+		and the strings without escapes point into the retained source memory.
+	*/
+	class SLIB_EXPORT JsonDocument : public Referable
+	{
+	public:
+		JsonDocument();
+		
+		~JsonDocument();
+		
+	public:
+		static Ref<JsonDocument> parse(const Memory& json, JsonParseParam& param);
+		
+		static Ref<JsonDocument> parse(const Memory& json);
+		
+	public:
+		JsonValue getRoot() const;
+		
+		const Memory& getSource() const;
+		
+	protected:
+		Memory m_source;
+		Ref<MemoryArena> m_arena;
+		const _priv_JsonNode* m_root;
+		
+	};
+	
+	class IWriter;
+	
+#define SLIB_JSON_WRITER_CHUNK_SIZE 8192
+	
+	/*
+		Streaming JSON serializer.
+		The text is formatted into a reusable chunk, which is passed to the output when it is full,
+		so the result is never materialized as one String. Call `flush()` when finished.
+	*/
+	class SLIB_EXPORT JsonWriter
+	{
+	public:
+		JsonWriter(IWriter* output, sl_bool flagPretty = sl_false);
+		
+		virtual ~JsonWriter();
+		
+	public:
+		sl_bool write(const Variant& value);
+		
+		sl_bool write(const List<Variant>& list);
+		
+		sl_bool write(const Map<String, Variant>& map);
+		
+		sl_bool write(const HashMap<String, Variant>& map);
+		
+		sl_bool writeNull();
+		
+		sl_bool writeBoolean(sl_bool value);
+		
+		sl_bool writeInt64(sl_int64 value);
+		
+		sl_bool writeUint64(sl_uint64 value);
+		
+		// NaN and infinity are written as `null`
+		sl_bool writeDouble(double value);
+		
+		sl_bool writeString(const sl_char8* str, sl_size length);
+		
+		sl_bool writeString(const String& str);
+		
+		sl_bool beginList();
+		
+		sl_bool endList();
+		
+		sl_bool beginMap();
+		
+		sl_bool endMap();
+		
+		// call before each item value of the map
+		sl_bool writeKey(const sl_char8* key, sl_size length);
+		
+		sl_bool writeKey(const String& key);
+		
+		sl_bool flush();
+		
+		sl_uint64 getWrittenSize() const;
+		
+		sl_bool isError() const;
+		
+	protected:
+		virtual sl_bool writeOutput(const void* data, sl_size size);
+		
+	protected:
+		sl_bool _writeRaw(const void* data, sl_size size);
+		
+		sl_bool _writeChar(sl_char8 ch);
+		
+		sl_bool _writeNewLine();
+		
+		sl_bool _beginValue();
+		
+	protected:
+		IWriter* m_output;
+		sl_bool m_flagPretty;
+		sl_uint32 m_depth;
+		sl_bool m_flagNeedComma;
+		sl_bool m_flagAfterKey;
+		sl_bool m_flagError;
+		sl_uint64 m_sizeWritten;
+		sl_size m_sizeChunk;
+		sl_char8 m_chunk[SLIB_JSON_WRITER_CHUNK_SIZE];
+		
+	};
+	
 	SLIB_INLINE JsonPair operator<<=(const String& str, const Json& v)
 	{
 		return Pair<String, Json>(str, v);
@@ -51,6 +51,8 @@ namespace slib
 	template <class KT, class VT>
 	class SLIB_EXPORT MapNode
 	{
+		SLIB_DECLARE_BASE_MEMORY_OPERATORS
+
 	public:
 		MapNode* parent;
 		MapNode* left;
@@ -0,0 +1,90 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_MEMORY_ARENA
+#define CHECKHEADER_SLIB_CORE_MEMORY_ARENA
+
+#include "definition.h"
+
+#include "ref.h"
+
+#define SLIB_MEMORY_ARENA_DEFAULT_CHUNK_SIZE 8192
+
+namespace slib
+{
+	
+	class Memory;
+	class _priv_MemoryArenaChunk;
+	
+	/*
+		Bump-pointer allocator for the objects sharing a lifetime (ex: the data of a request).
+
+		Every allocation keeps a reference of its chunk, so the memory stays valid while the objects are alive, even after `reset`.
+		`reset` rewinds the current chunk when none of its objects is alive, otherwise the next allocation starts a new chunk,
+		so that an arena reset after each request allocates nothing in the steady state.
+		A block larger than a quarter of the chunk size is not carved from the chunk, and is allocated as its own chunk on the heap.
+		The arena itself is not thread-safe, but the allocated objects can be released on any thread.
+	*/
+	class SLIB_EXPORT MemoryArena : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		MemoryArena();
+
+		~MemoryArena();
+
+	public:
+		static Ref<MemoryArena> create(sl_size chunkSize = SLIB_MEMORY_ARENA_DEFAULT_CHUNK_SIZE);
+
+	public:
+		/*
+			Returns the memory (aligned by the size of pointer) which is valid while the reference of `_outChunk` is kept.
+			The reference count of `_outChunk` is increased by this function, and should be decreased when the memory is not used.
+		*/
+		void* allocate(sl_size size, Referable*& _outChunk);
+
+		/*
+			Returns the memory (aligned by the size of pointer) which is valid until the arena is destroyed.
+			The chunks holding such memory are kept by the arena, so `reset` never reuses them.
+		*/
+		void* allocateRetained(sl_size size);
+
+		Memory createMemory(sl_size size);
+
+		void reset();
+
+		sl_size getChunkSize();
+
+	protected:
+		Ref<Referable> m_chunk;
+		sl_uint8* m_data;
+		sl_size m_capacity;
+		sl_size m_position;
+		sl_size m_chunkSize;
+		_priv_MemoryArenaChunk* m_chunksRetained;
+
+	};
+
+}
+
+#endif
@@ -30,6 +30,14 @@
 
 #include <new>
 
+// allocates the objects of the class by `Base::createMemory`, so that the small objects use the slab allocator when it is enabled
+#define SLIB_DECLARE_BASE_MEMORY_OPERATORS \
+	public: \
+		static void* operator new(std::size_t size) noexcept { return slib::Base::createMemory(size); } \
+		static void operator delete(void* ptr) noexcept { slib::Base::freeMemory(ptr); } \
+		static void* operator new(std::size_t, void* place) noexcept { return place; } \
+		static void operator delete(void*, void*) noexcept {}
+
 namespace slib
 {
 	
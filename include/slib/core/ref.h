@@ -26,7 +26,9 @@
 #include "definition.h"
 
 #include "base.h"
+#include "new_helper.h"
 #include "atomic.h"
+#include "hazard_pointer.h"
 #include "macro.h"
 
 #ifdef SLIB_DEBUG
@@ -42,6 +44,8 @@ namespace slib
 	
 	class SLIB_EXPORT Referable
 	{
+		SLIB_DECLARE_BASE_MEMORY_OPERATORS
+
 	public:
 		Referable() noexcept;
 
@@ -263,6 +267,11 @@ namespace slib
 
 	};
 	
+	/*
+		The object is read without locking, and the replaced object is not released at once:
+		it is retired by the writer thread and destructed after a few more replacements on the thread (see `HazardPointer`).
+		Call `HazardPointer::reclaimAll()` when the destruction should be observed immediately.
+	*/
 	template <class T>
 	class Atomic< Ref<T> >
 	{
@@ -402,9 +411,8 @@ namespace slib
 		void _move_assign(void* other) noexcept;
 
 	public:
+		// read without locking (see `HazardPointer`)
 		T* _ptr;
-	private:
-		SpinLock m_lock;
 	
 	};
 
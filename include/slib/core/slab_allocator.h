@@ -0,0 +1,91 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_SLAB_ALLOCATOR
+#define CHECKHEADER_SLIB_CORE_SLAB_ALLOCATOR
+
+#include "definition.h"
+
+#define SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT 16
+#define SLIB_SLAB_ALLOCATOR_MAX_BLOCK_SIZE 512
+
+namespace slib
+{
+	
+	class SLIB_EXPORT SlabAllocatorStatistics
+	{
+	public:
+		sl_size blockSize;
+		sl_uint64 allocatedCount;
+		sl_uint64 freedCount;
+		// bytes of the blocks not freed yet. The freed blocks are kept in the free lists, so the memory used by the process doesn't drop with this value
+		sl_uint64 liveBytes;
+		// high-water count of the 64KB spans: the spans are never returned to the system, even after all of their blocks are freed
+		sl_uint64 spansCount;
+
+	public:
+		SlabAllocatorStatistics() noexcept;
+
+	};
+	
+	/*
+		Allocator of the small memory blocks (up to `SLIB_SLAB_ALLOCATOR_MAX_BLOCK_SIZE` bytes) used by `Base::createMemory`.
+
+		The blocks are carved from 64KB spans of a reserved address range, and each span holds the blocks of a size class.
+		Every thread allocates from its own heap without locking. The blocks freed by the other threads are pushed to the
+		lock-free remote queue of the owning heap, and returned to its free lists when the owner runs out of blocks.
+		The heaps of the finished threads are reused by the new threads, and the memory of the spans is never returned to the system.
+
+		Disabled by default: enabled by `setEnabled` or by defining `SLIB_USE_SLAB_ALLOCATOR` when building the library.
+		The memory allocated before enabling (or after disabling) is still freed correctly by `Base::freeMemory`.
+	*/
+	class SLIB_EXPORT SlabAllocator
+	{
+	public:
+		static sl_bool isEnabled() noexcept;
+
+		// returns false if the address range can't be reserved
+		static sl_bool setEnabled(sl_bool flag) noexcept;
+
+		// returns null if disabled or `size` is larger than `SLIB_SLAB_ALLOCATOR_MAX_BLOCK_SIZE`
+		static void* allocate(sl_size size) noexcept;
+
+		// `ptr` must be allocated by this allocator
+		static void free(void* ptr) noexcept;
+
+		static sl_bool contains(const void* ptr) noexcept;
+
+		// size of the block containing `ptr`, which must be allocated by this allocator
+		static sl_size getBlockSize(const void* ptr) noexcept;
+
+		/*
+			Statistics of the size class (0 ~ `SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT` - 1), summed over the heaps of all threads.
+			The blocks waiting in the remote queues are counted as live.
+			The memory reserved for the size class is `spansCount` x 64KB, which is the high-water mark of `liveBytes` (rounded up to the spans).
+		*/
+		static sl_bool getStatistics(sl_uint32 sizeClass, SlabAllocatorStatistics& _out) noexcept;
+
+	};
+
+}
+
+#endif
@@ -1221,8 +1221,8 @@ namespace slib
 	class SLIB_EXPORT Atomic<String16>
 	{
 	private:
+		// read without locking (see `HazardPointer`)
 		StringContainer16* volatile m_container;
-		SpinLock m_lock;
 		
 	public:
 		
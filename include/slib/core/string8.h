@@ -48,6 +48,7 @@ namespace slib
 	typedef Atomic<String16> AtomicString16;
 	class StringData;
 	class Variant;
+	class MemoryArena;
 
 	class SLIB_EXPORT StringContainer
 	{
@@ -152,6 +153,12 @@ namespace slib
 		 */
 		static String fromRef(const Ref<Referable>& ref, const sl_char8* str, sl_reg len = -1) noexcept;
 		
+		/**
+		 * Creates a string copying the `str` into the memory of `arena`.
+		 * The chunk of the arena is kept alive while the returned string is being used.
+		 */
+		static String fromArena(MemoryArena* arena, const sl_char8* str, sl_reg len = -1) noexcept;
+		
 		/**
 		 * Creates a string pointing the `mem` as the UTF-8 content, without copying the data.
 		 */
@@ -1234,8 +1241,8 @@ namespace slib
 	class SLIB_EXPORT Atomic<String>
 	{
 	private:
+		// read without locking (see `HazardPointer`)
 		StringContainer* volatile m_container;
-		SpinLock m_lock;
 		
 	public:
 		/**
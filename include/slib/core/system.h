@@ -71,6 +71,8 @@ namespace slib
 		static void yield();
 
 		static void yield(sl_uint32 elapsed);
+		
+		static sl_uint32 getProcessorsCount();
 	
 		
 		// Error Handling
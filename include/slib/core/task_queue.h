@@ -0,0 +1,95 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_TASK_QUEUE
+#define CHECKHEADER_SLIB_CORE_TASK_QUEUE
+
+#include "definition.h"
+
+#include "function.h"
+#include "spin_lock.h"
+
+namespace slib
+{
+	
+	class _priv_TaskQueueBlock;
+
+	/*
+		FIFO queue of the tasks posted to a loop or a pool.
+		The tasks are stored in a list of fixed-size blocks, so the queued tasks are never moved when it grows.
+		The emptied blocks are kept for reuse and never freed until the queue is destroyed,
+		so that a loop swapping its queue with a persistent local queue stops allocating after warming up.
+		`push` allocates a new block out of the lock.
+	*/
+	class SLIB_EXPORT TaskQueue
+	{
+	public:
+		TaskQueue() noexcept;
+
+		TaskQueue(const TaskQueue& other) = delete;
+
+		~TaskQueue() noexcept;
+
+	public:
+		TaskQueue& operator=(const TaskQueue& other) = delete;
+
+	public:
+		sl_size getCount() const noexcept;
+
+		sl_bool isEmpty() const noexcept;
+
+		sl_bool isNotEmpty() const noexcept;
+
+		sl_bool push_NoLock(UniqueFunction<void()>&& task) noexcept;
+
+		sl_bool push(UniqueFunction<void()>&& task) noexcept;
+
+		sl_bool pop_NoLock(UniqueFunction<void()>* _out) noexcept;
+
+		sl_bool pop(UniqueFunction<void()>* _out) noexcept;
+
+		void removeAll_NoLock() noexcept;
+
+		void removeAll() noexcept;
+
+		// swaps the tasks and the buffers, locking this queue only (`other` must not be shared with other threads)
+		void swap(TaskQueue& other) noexcept;
+
+		const SpinLock* getLocker() const noexcept;
+
+	protected:
+		sl_bool _hasRoom() const noexcept;
+
+	protected:
+		_priv_TaskQueueBlock* m_blockFirst;
+		_priv_TaskQueueBlock* m_blockLast;
+		sl_size m_posFirst;
+		sl_size m_posLast;
+		_priv_TaskQueueBlock* m_blocksFree;
+		sl_size m_count;
+		SpinLock m_lock;
+
+	};
+
+}
+
+#endif
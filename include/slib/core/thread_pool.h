@@ -28,10 +28,13 @@
 #include "queue.h"
 #include "thread.h"
 #include "dispatch.h"
+#include "task_queue.h"
 
 namespace slib
 {
 	
+	class _priv_ThreadPool_WorkStealing;
+	
 	class SLIB_EXPORT ThreadPool : public Dispatcher
 	{
 		SLIB_DECLARE_OBJECT
@@ -43,17 +46,36 @@ namespace slib
 
 	public:
 		static Ref<ThreadPool> create(sl_uint32 minThreads = 0, sl_uint32 maxThreads = 30);
+		
+		/*
+			Creates a pool of `nWorkers` fixed workers (0: number of processors), each owning a work-stealing deque.
+			Tasks added from a worker thread are pushed to its own deque, other tasks go to a lock-free shared queue,
+			and idle workers steal tasks from the other workers.
+		*/
+		static Ref<ThreadPool> createWorkStealing(sl_uint32 nWorkers = 0);
 	
 	public:
 		void release();
 
 		sl_bool isRunning();
+		
+		sl_bool isWorkStealing();
 
 		sl_uint32 getThreadsCount();
 	
-		sl_bool addTask(const Function<void()>& task);
+		// the callables fitting in `UniqueFunction` are queued without allocation
+		sl_bool addTask(UniqueFunction<void()>&& task);
+
+		template <class FUNC>
+		sl_bool addTask(FUNC&& task)
+		{
+			return addTask(UniqueFunction<void()>(Forward<FUNC>(task)));
+		}
 
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms = 0) override;
+		
+		// the task is added to this pool after `delay_ms`, unless it is canceled by the returned handle before
+		TimerHandle addTimeout(const Function<void()>& task, sl_uint64 delay_ms);
 	
 	public:
 		SLIB_PROPERTY(sl_uint32, MinimumThreadsCount)
@@ -62,11 +84,17 @@ namespace slib
 	
 	protected:
 		void onRunWorker();
+		
+		void _runWorkStealing(sl_uint32 index);
+		
+		void _addTaskFromTimer(const Function<void()>& task);
 	
 	protected:
 		CList< Ref<Thread> > m_threadWorkers;
 		LinkedQueue< Ref<Thread> > m_threadSleeping;
-		LinkedQueue< Function<void()> > m_tasks;
+		TaskQueue m_tasks;
+		
+		Ref<_priv_ThreadPool_WorkStealing> m_workStealing;
 
 		sl_bool m_flagRunning;
 
@@ -360,6 +360,12 @@ namespace slib
 
 		String format(const sl_char16* fmt) const noexcept;
 	
+		// IMF-fixdate (RFC 7231), always in GMT: "Sun, 06 Nov 1994 08:49:37 GMT"
+		String toHttpDate() const noexcept;
+
+		// IMF-fixdate, and the obsolete RFC 850 and asctime formats (RFC 7231)
+		static sl_bool parseHttpDate(const String& str, Time* _out) noexcept;
+
 
 		static sl_reg parseElements(sl_int32* outArrayYMDHMS, const sl_char8* sz, sl_size posStart = 0, sl_size posEnd = SLIB_SIZE_MAX) noexcept;
 
@@ -27,10 +27,145 @@
 
 #include "object.h"
 #include "function.h"
+#include "mutex.h"
+#include "time.h"
+#include "queue.h"
 
 namespace slib
 {
 	
+	class TimerWheel;
+	
+	class SLIB_EXPORT TimerWheelEntry : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+		
+	public:
+		TimerWheelEntry(const Function<void()>& task);
+		
+		~TimerWheelEntry();
+		
+	public:
+		const Function<void()>& getTask();
+		
+		sl_bool isPending();
+		
+		// returns false if the task is already expired or canceled
+		sl_bool cancel();
+		
+		// returns false if the task is already expired or canceled
+		sl_bool reschedule(sl_uint64 delay_ms);
+		
+	private:
+		Function<void()> m_task;
+		TimerWheel* m_wheel;
+		TimerWheelEntry* m_before;
+		TimerWheelEntry* m_next;
+		sl_uint32 m_slot;
+		sl_uint64 m_timeExpire;
+		
+		friend class TimerWheel;
+		
+	};
+	
+	/*
+		Hashed hierarchical timing wheel (resolution: 1 millisecond).
+		Adding, canceling and rescheduling a timeout is O(1), and expired timeouts are collected by `pollExpired`.
+		All the functions are thread-safe.
+	*/
+	class SLIB_EXPORT TimerWheel
+	{
+	public:
+		TimerWheel();
+		
+		~TimerWheel();
+		
+	public:
+		// milliseconds elapsed since the creation of the wheel
+		sl_uint64 getElapsedMilliseconds();
+		
+		sl_size getCount();
+		
+		// called when a timeout is added earlier than the next polling time returned by the last call of `pollExpired`, so that the polling thread should be woken
+		void setWakeCallback(const Function<void()>& callback);
+		
+		Ref<TimerWheelEntry> add(const Function<void()>& task, sl_uint64 delay_ms);
+		
+		// (re)schedules the entry, even if it is already expired or canceled
+		sl_bool schedule(TimerWheelEntry* entry, sl_uint64 delay_ms);
+		
+		sl_bool cancel(TimerWheelEntry* entry);
+		
+		void cancelAll();
+		
+		// moves the tasks of the expired timeouts into `output`, and returns the milliseconds until the next expiration (-1: no pending timeout)
+		sl_int32 pollExpired(LinkedQueue< Function<void()> >& output);
+		
+	private:
+		sl_bool _reschedule(TimerWheelEntry* entry, sl_uint64 delay_ms);
+		
+		sl_bool _schedule(TimerWheelEntry* entry, sl_uint64 delay_ms, sl_bool flagOnlyPending);
+		
+		void _insert(TimerWheelEntry* entry);
+		
+		void _remove(TimerWheelEntry* entry);
+		
+		void _cascade(sl_uint32 slot);
+		
+		sl_int32 _getTimeout(sl_uint64 now);
+		
+	private:
+		Mutex m_lock;
+		TimeCounter m_timeCounter;
+		sl_uint64 m_timeCurrent;
+		sl_uint64 m_timeNextPoll;
+		sl_size m_count;
+		TimerWheelEntry* m_slots[512];
+		Function<void()> m_callbackWake;
+		
+		friend class TimerWheelEntry;
+		
+	};
+	
+	class SLIB_EXPORT TimerHandle
+	{
+	public:
+		Ref<TimerWheelEntry> entry;
+		
+	public:
+		TimerHandle();
+		
+		TimerHandle(sl_null_t);
+		
+		TimerHandle(const Ref<TimerWheelEntry>& entry);
+		
+		TimerHandle(const TimerHandle& other);
+		
+		~TimerHandle();
+		
+	public:
+		TimerHandle& operator=(const TimerHandle& other);
+		
+		TimerHandle& operator=(sl_null_t);
+		
+	public:
+		sl_bool isNull() const;
+		
+		sl_bool isNotNull() const;
+		
+		void setNull();
+		
+		sl_bool isPending() const;
+		
+		// returns false if the timeout is already expired or canceled
+		sl_bool cancel() const;
+		
+		// pushes back (or forward) the pending timeout. returns false if the timeout is already expired or canceled
+		sl_bool reschedule(sl_uint64 delay_ms) const;
+		
+	};
+	
+	
 	class DispatchLoop;
 	class Dispatcher;
 	
@@ -87,8 +222,11 @@ namespace slib
 
 		Ref<Dispatcher> m_dispatcher;
 		WeakRef<DispatchLoop> m_loop;
+		AtomicRef<TimerWheelEntry> m_entryLoop;
 
 		sl_bool m_flagDispatched;
+		
+		friend class DispatchLoop;
 
 	};
 
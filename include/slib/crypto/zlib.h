@@ -45,6 +45,10 @@ namespace slib
 
 	};
 
+	/*
+		The deflate state is kept after the stream is finished, and it is reset (not initialized again) by the next `start` call using the same format.
+		Call `abort()` to free the state.
+	*/
 	class SLIB_EXPORT ZlibCompress : public Object
 	{
 	public:
@@ -91,6 +95,9 @@ namespace slib
 	
 		void abort();
 	
+	private:
+		sl_bool _start(sl_int32 level, sl_int32 windowBits);
+
 	private:
 		sl_uint8 m_stream[128]; // bigger than sizeof(z_stream)
 
@@ -99,6 +106,9 @@ namespace slib
 		String m_gzipComment;
 	
 		sl_bool m_flagStarted;
+		sl_bool m_flagInitialized;
+		sl_int32 m_level;
+		sl_int32 m_windowBits;
 
 	};
 	
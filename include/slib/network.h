@@ -46,7 +46,9 @@
 #include "network/url.h"
 #include "network/url_request.h"
 #include "network/curl.h"
+#include "network/http_client.h"
 #include "network/http.h"
+#include "network/websocket.h"
 #include "network/stun.h"
 
 #endif
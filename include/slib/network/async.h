@@ -71,6 +71,10 @@ namespace slib
 		
 	};
 	
+	/*
+		A read request of zero size is completed (with no data) when the socket becomes readable,
+		so that the reader can wait for the data without holding a buffer.
+	*/
 	class SLIB_EXPORT AsyncTcpSocket : public AsyncStreamBase
 	{
 		SLIB_DECLARE_OBJECT
@@ -147,6 +151,7 @@ namespace slib
 		sl_bool flagIPv6; // default: false
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
+		sl_bool flagReusingPort; // default: false, allows several servers to listen on the same port (SO_REUSEPORT)
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncTcpServerListener> listener;
@@ -179,6 +184,9 @@ namespace slib
 		
 		void start();
 		
+		// stops accepting the connections until `start` is called again. The pending connections are kept in the backlog of the listening socket
+		void stop();
+		
 		sl_bool isRunning();
 		
 		Ref<Socket> getSocket();
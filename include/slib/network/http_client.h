@@ -0,0 +1,214 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_NETWORK_HTTP_CLIENT
+#define CHECKHEADER_SLIB_NETWORK_HTTP_CLIENT
+
+#include "definition.h"
+
+#include "url_request.h"
+#include "ip_address.h"
+
+#include "../core/async.h"
+#include "../core/thread_pool.h"
+
+/*
+	Asynchronous HTTP/1.1 client running on `AsyncIoLoop`
+
+	- connections are pooled per host (host:port) and kept alive between the requests. A host is removed when its last connection is closed
+	- idempotent requests (GET, HEAD, PUT, DELETE, OPTIONS, TRACE) can be pipelined on a connection
+	- resolved host names are cached for `HttpClientParam::dnsCacheTime`
+	- only `http` urls are handled. `https` urls are sent by the default `UrlRequest` implementation
+	- redirections are not followed
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT HttpClientParam
+	{
+	public:
+		Ref<AsyncIoLoop> ioLoop; // default: AsyncIoLoop::getDefault()
+		
+		sl_uint32 maxConnectionsPerHost; // default: 6
+		sl_uint32 maxPipelinedRequests; // requests sent on a connection before receiving their responses, default: 1 (no pipelining)
+		sl_uint32 keepAliveTimeout; // milliseconds to keep an idle connection in the pool, default: 30000
+		sl_uint32 dnsCacheTime; // milliseconds to keep a resolved address, default: 60000
+		
+	public:
+		HttpClientParam();
+		
+		HttpClientParam(const HttpClientParam& other);
+		
+		~HttpClientParam();
+		
+	};
+	
+	class _priv_HttpClientHost;
+	class _priv_HttpClientRequest;
+	
+	class SLIB_EXPORT HttpClient : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		HttpClient();
+		
+		~HttpClient();
+		
+	public:
+		static Ref<HttpClient> create(const HttpClientParam& param);
+		
+		static Ref<HttpClient> create();
+		
+		// shared by `HttpClientRequest`
+		static Ref<HttpClient> getDefault();
+		
+	public:
+		void release();
+		
+		const HttpClientParam& getParam();
+		
+		Ref<AsyncIoLoop> getAsyncIoLoop();
+		
+		Ref<UrlRequest> send(const UrlRequestParam& param);
+		
+		// open connections, including the connecting and the idle ones
+		sl_uint32 getConnectionsCount();
+		
+		void closeIdleConnections();
+		
+		void clearDnsCache();
+		
+	protected:
+		Ref<UrlRequest> _createRequest(const UrlRequestParam& param, const String& url);
+		
+		void _sendRequest(_priv_HttpClientRequest* request);
+		
+		sl_bool _getCachedAddress(const String& hostName, IPAddress& _out);
+		
+		void _resolveAddress(const String& hostName, const Function<void(const IPAddress&)>& callback);
+		
+		void _runResolveAddress(const String& hostName, const Function<void(const IPAddress&)>& callback);
+		
+	protected:
+		HttpClientParam m_param;
+		Ref<AsyncIoLoop> m_ioLoop;
+		sl_bool m_flagReleased;
+		
+		CHashMap< String, Ref<_priv_HttpClientHost> > m_hosts;
+		
+		struct DnsEntry
+		{
+			IPAddress address;
+			sl_uint32 tickResolved;
+		};
+		CHashMap<String, DnsEntry> m_dnsCache;
+		AtomicRef<ThreadPool> m_threadPoolDns;
+		
+		friend class _priv_HttpClientHost;
+		friend class _priv_HttpClientRequest;
+		friend class HttpClientRequest;
+		
+	};
+	
+	// `UrlRequest` API on the connections of `HttpClient::getDefault()`
+	class SLIB_EXPORT HttpClientRequest
+	{
+	public:
+		static Ref<UrlRequest> send(const UrlRequestParam& param);
+		
+		static Ref<UrlRequest> send(const String& url, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> send(const String& url, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> send(const String& url, const HttpHeaderMap& headers, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> send(const String& url, const HttpHeaderMap& headers, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const Variant& body, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const Variant& body, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Variant& body, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> send(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Variant& body, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> sendJson(HttpMethod method, const String& url, const Json& json, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> sendJson(HttpMethod method, const String& url, const Json& json, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> sendJson(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Json& json, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> sendJson(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Json& json, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> post(const String& url, const Variant& body, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> post(const String& url, const Variant& body, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> post(const String& url, const HttpHeaderMap& headers, const Variant& body, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> post(const String& url, const HttpHeaderMap& headers, const Variant& body, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> postJson(const String& url, const Json& json, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> postJson(const String& url, const Json& json, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		static Ref<UrlRequest> postJson(const String& url, const HttpHeaderMap& headers, const Json& json, const Function<void(UrlRequest*)>& onComplete);
+		
+		static Ref<UrlRequest> postJson(const String& url, const HttpHeaderMap& headers, const Json& json, const Function<void(UrlRequest*)>& onComplete, const Ref<Dispatcher>& dispatcher);
+		
+		// must not be called on the I/O loop of the client
+		static Ref<UrlRequest> sendSynchronous(const String& url);
+		
+		static Ref<UrlRequest> sendSynchronous(const String& url, const HttpHeaderMap& headers);
+		
+		static Ref<UrlRequest> sendSynchronous(HttpMethod method, const String& url);
+		
+		static Ref<UrlRequest> sendSynchronous(HttpMethod method, const String& url, const Variant& body);
+		
+		static Ref<UrlRequest> sendSynchronous(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Variant& body);
+		
+		static Ref<UrlRequest> sendJsonSynchronous(HttpMethod method, const String& url, const Json& json);
+		
+		static Ref<UrlRequest> sendJsonSynchronous(HttpMethod method, const String& url, const HttpHeaderMap& headers, const Json& json);
+		
+		static Ref<UrlRequest> postSynchronous(const String& url, const Variant& body);
+		
+		static Ref<UrlRequest> postSynchronous(const String& url, const HttpHeaderMap& headers, const Variant& body);
+		
+		static Ref<UrlRequest> postJsonSynchronous(const String& url, const Json& json);
+		
+		static Ref<UrlRequest> postJsonSynchronous(const String& url, const HttpHeaderMap& headers, const Json& json);
+		
+	protected:
+		static Ref<UrlRequest> _create(const UrlRequestParam& param, const String& url);
+		
+	};
+
+}
+
+#endif
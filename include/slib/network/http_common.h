@@ -53,6 +53,7 @@
 #include "../core/string.h"
 #include "../core/content_type.h"
 #include "../core/hash_map.h"
+#include "../core/memory_arena.h"
 
 namespace slib
 {
@@ -167,6 +168,19 @@ namespace slib
 		static const String& Origin;
 		static const String& AccessControlAllowOrigin;
 		
+		static const String& ETag;
+		static const String& LastModified;
+		static const String& IfNoneMatch;
+		static const String& IfModifiedSince;
+		static const String& Vary;
+		
+		static const String& Connection;
+		static const String& Upgrade;
+		static const String& SecWebSocketKey;
+		static const String& SecWebSocketAccept;
+		static const String& SecWebSocketVersion;
+		static const String& SecWebSocketProtocol;
+		
 	public:
 		
 		/*
@@ -180,6 +194,17 @@ namespace slib
 	};
 	
 	
+	// a header line in the retained header section, used by the in-place parser
+	struct SLIB_EXPORT HttpHeaderSlice
+	{
+		sl_uint32 posName;
+		sl_uint32 lengthName;
+		sl_uint32 posValue;
+		sl_uint32 lengthValue;
+	};
+	
+#define SLIB_HTTP_MAX_HEADER_SLICES 32
+	
 	class SLIB_EXPORT HttpRequest
 	{
 	public:
@@ -210,6 +235,16 @@ namespace slib
 		
 		void setRequestVersion(const String& version);
 		
+		Ref<MemoryArena> getRequestArena() const;
+		
+		/*
+			The strings parsed from the request (method, path, query, headers, parameters) are allocated in `arena`.
+			The header and parameter maps still allocate their nodes by `Base::createMemory`,
+			so the parsing makes no heap allocation only when `SlabAllocator` is enabled,
+			and a header section larger than a quarter of the arena chunk (2KB by default) is allocated on the heap.
+		*/
+		void setRequestArena(const Ref<MemoryArena>& arena);
+		
 		
 		const HttpHeaderMap& getRequestHeaders() const;
 		
@@ -313,12 +348,32 @@ namespace slib
 		 */
 		sl_reg parseRequestPacket(const void* packet, sl_size size);
 		
+		/*
+		 In-place parsing: `packet` is retained, and the header lines are recorded as slices
+		 into it. The header strings are created on demand, so no allocation is made per header.
+		 Returns same as above
+		 */
+		sl_reg parseRequestPacket(const Memory& packet);
+		
 		template <class KT, class VT, class KEY_COMPARE>
 		static String buildFormUrlEncodedFromMap(const Map<KT, VT, KEY_COMPARE>& map);
 		
 		template <class KT, class VT, class HASH, class KEY_COMPARE>
 		static String buildFormUrlEncodedFromHashMap(const HashMap<KT, VT, HASH, KEY_COMPARE>& map);
 		
+	protected:
+		void _buildRequestHeaders() const;
+		
+		void _clearRequestHeaderSlices();
+		
+		const HttpHeaderSlice* _findRequestHeaderSlice(const String& name, sl_uint32 start) const;
+		
+		String _getRequestHeaderSliceValue(const HttpHeaderSlice& slice) const;
+		
+		String _createRequestString(const sl_char8* data, sl_size len) const;
+		
+		void _applyParameters(HashMap<String, String>& map, const void* data, sl_size size);
+		
 	protected:
 		HttpMethod m_method;
 		String m_methodText;
@@ -327,7 +382,14 @@ namespace slib
 		String m_query;
 		String m_requestVersion;
 		
-		HttpHeaderMap m_requestHeaders;
+		mutable HttpHeaderMap m_requestHeaders;
+		// valid while `m_flagRequestHeaderSlices` is set (before the headers are modified or enumerated)
+		Memory m_requestHeaderPacket;
+		HttpHeaderSlice m_requestHeaderSlices[SLIB_HTTP_MAX_HEADER_SLICES];
+		sl_uint32 m_countRequestHeaderSlices;
+		mutable sl_bool m_flagRequestHeaderSlices;
+		Ref<MemoryArena> m_requestArena;
+		
 		HashMap<String, String> m_parameters;
 		HashMap<String, String> m_queryParameters;
 		HashMap<String, String> m_postParameters;
@@ -26,6 +26,8 @@
 #include "definition.h"
 
 #include "../core/string.h"
+#include "../core/variant.h"
+#include "../core/memory_arena.h"
 #include "../crypto/zlib.h"
 
 #include "async.h"
@@ -49,12 +51,19 @@ namespace slib
 		
 		void write(const Memory& mem);
 		
+		// serializes the value with `JsonWriter`, without building the whole text first
+		sl_bool writeJson(const Variant& value, sl_bool flagPretty = sl_false);
+		
 		void copyFrom(AsyncStream* stream, sl_uint64 size);
 		
 		void copyFromFile(const String& path);
 		
 		void copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 		
+		sl_bool copyFromFileRegion(const Ref<File>& file, sl_uint64 offset, sl_uint64 size);
+		
+		sl_bool copyFromFileRegion(const String& path, sl_uint64 offset, sl_uint64 size);
+		
 		sl_uint64 getOutputLength() const;
 		
 	protected:
@@ -79,9 +88,16 @@ namespace slib
 		
 		void clear();
 		
+		// the header data is copied into `arena` when it is set
+		void setMemoryArena(const Ref<MemoryArena>& arena);
+		
+	protected:
+		Memory _createMemory(const void* buf, sl_size size);
+		
 	protected:
 		sl_char16 m_last[3];
 		MemoryQueue m_buffer;
+		Ref<MemoryArena> m_arena;
 		
 	};
 	
@@ -123,6 +139,10 @@ namespace slib
 	public:
 		sl_bool isDecompressing();
 		
+		// decodes the content received by the caller, for the readers created without a source stream (`io` is null).
+		// chunked content is decoded in place. The data following the content is passed to `onCompleteReadHttpContent`, before the last decoded part is returned
+		Memory feed(void* data, sl_uint32 size, Referable* refData = sl_null);
+		
 	protected:
 		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* ref) override;
 		
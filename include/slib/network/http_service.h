@@ -28,14 +28,27 @@
 #include "http_common.h"
 #include "http_io.h"
 #include "socket_address.h"
+#include "websocket.h"
 
 #include "../core/thread_pool.h"
+#include "../core/flat_hash_map.h"
 
 namespace slib
 {
 
 	class HttpService;
 	class HttpServiceConnection;
+	class JsonDocument;
+	
+#define SLIB_HTTP_MAX_PATH_PARAMETERS 8
+	
+	// path parameter captured by a router: the value is the slice [pos, pos+length) of the request path
+	struct SLIB_EXPORT HttpPathParameter
+	{
+		String name;
+		sl_uint32 pos;
+		sl_uint32 length;
+	};
 	
 	class SLIB_EXPORT HttpServiceContext : public Object, public HttpRequest, public HttpResponse, public HttpOutputBuffer
 	{
@@ -58,6 +71,9 @@ namespace slib
 		
 		Variant getRequestBodyAsJson() const;
 		
+		// read-only DOM referencing the retained body
+		Ref<JsonDocument> getRequestBodyAsJsonDocument() const;
+		
 		sl_uint64 getResponseContentLength() const;
 		
 		Ref<HttpService> getService();
@@ -78,6 +94,35 @@ namespace slib
 		
 		void completeResponse();
 		
+		/*
+			Streaming request body: call from `HttpService::preprocessRequest` to receive the body chunks
+			on the I/O thread instead of buffering the whole body. `processRequest` is called after the
+			last chunk, and `getRequestBody()` returns null in this mode.
+			`data` is valid until the callback returns, or until `resumeRequestBody()` if suspended.
+		*/
+		void setRequestBodyCallback(const Function<void(HttpServiceContext*, const void* data, sl_size size)>& callback);
+		
+		sl_uint64 getRequestBodyReceivedSize() const;
+		
+		// stops reading the connection (backpressure), can be called in the body callback
+		void suspendRequestBody();
+		
+		// can be called from any thread, the reading is restarted on the I/O thread
+		void resumeRequestBody();
+		
+		sl_uint32 getPathParameterCount() const;
+		
+		String getPathParameterName(sl_uint32 index) const;
+		
+		String getPathParameterValue(sl_uint32 index) const;
+		
+		String getPathParameter(const String& name) const;
+		
+		sl_bool containsPathParameter(const String& name) const;
+		
+		// called by the router, at most `SLIB_HTTP_MAX_PATH_PARAMETERS` parameters are kept
+		void setPathParameters(const HttpPathParameter* params, sl_uint32 count);
+		
 	public:
 		SLIB_BOOLEAN_PROPERTY(ClosingConnection);
 		SLIB_BOOLEAN_PROPERTY(ProcessingByThread);
@@ -90,6 +135,16 @@ namespace slib
 		AtomicMemory m_requestBody;
 		sl_bool m_flagAsynchronousResponse;
 		
+		Memory m_responseHeader;
+		sl_bool m_flagResponseCompleted;
+		
+		Function<void(HttpServiceContext*, const void*, sl_size)> m_callbackRequestBody;
+		sl_uint64 m_sizeRequestBodyReceived;
+		sl_bool m_flagRequestBodySuspended;
+		
+		HttpPathParameter m_pathParameters[SLIB_HTTP_MAX_PATH_PARAMETERS];
+		sl_uint32 m_countPathParameters;
+		
 	private:
 		WeakRef<HttpServiceConnection> m_connection;
 		
@@ -97,6 +152,8 @@ namespace slib
 		
 	};
 	
+	class _priv_HttpBufferPool;
+	
 	class SLIB_EXPORT HttpServiceConnection : public Object, public IAsyncOutputListener, public IClosable
 	{
 	protected:
@@ -146,23 +203,67 @@ namespace slib
 		Ref<AsyncOutput> m_output;
 		
 		AtomicRef<HttpServiceContext> m_contextCurrent;
+		// requests waiting for their responses, in the order of arrival (HTTP/1.1 pipelining)
+		LinkedQueue< Ref<HttpServiceContext> > m_queueContexts;
 		
 		sl_bool m_flagClosed;
+		// borrowed from the pool only while a request is being received
 		Memory m_bufRead;
+		Ref<_priv_HttpBufferPool> m_poolRead;
+		Ref<MemoryArena> m_arena; // reset for each request
+		sl_bool m_flagLazyReadBuffer; // waits for the data before borrowing the buffer
 		sl_bool m_flagReading;
+		sl_bool m_flagProcessingInput;
+		sl_bool m_flagReadRequested; // requested by other threads while the input is processed
+		Memory m_bufPending;
+		sl_bool m_flagPipelineFull; // the input is kept in `m_bufPending` until the queued responses are flushed
+		Ref<WebSocket> m_webSocket;
+		
+		TimerHandle m_timer;
+		sl_uint32 m_stateTimeout;
+		sl_uint32 m_timeStateStarted;
+		sl_bool m_flagRequestServed;
 		
 	protected:
 		void _read();
 		
+		void _releaseReadBuffer();
+		
+		sl_uint32 _getTimeoutState();
+		
+		void _updateTimeout();
+		
+		void _cancelTimeout();
+		
+		void _setTimeout(sl_uint32 timeout);
+		
+		void _onTimeout();
+		
 		void _processInput(const void* data, sl_uint32 size);
 		
+		void _resumeInput();
+		
+		void _resumeRequestBody(const Ref<HttpServiceContext>& context);
+		
 		void _processContext(const Ref<HttpServiceContext>& context);
 		
 		void _completeResponse(HttpServiceContext* context);
 		
+		void _compressResponse(HttpServiceContext* context);
+		
+		sl_bool _upgradeWebSocket(HttpServiceContext* context, const void* data, sl_uint32 size);
+		
+		void _dispatchContext(HttpServiceContext* context);
+		
+		void _sendErrorResponse(HttpServiceContext* context, const Memory& response);
+		
+		void _flushResponses();
+		
 	protected:
 		void onReadStream(AsyncStreamResult* result);
 		
+		void onReadable(AsyncStreamResult* result);
+		
 		void onAsyncOutputComplete(AsyncOutput* output) override;
 		
 		void onAsyncOutputError(AsyncOutput* output) override;
@@ -182,6 +283,11 @@ namespace slib
 	public:
 		virtual void release() = 0;
 		
+		// called by the service while the number of the connections is reaching `HttpServiceParam::maxConnections`
+		virtual void pauseAccepting();
+		
+		virtual void resumeAccepting();
+		
 	public:
 		Ref<HttpService> getService();
 		
@@ -210,15 +316,37 @@ namespace slib
 		IPAddress addressBind;
 		sl_uint16 port;
 		
+		sl_uint32 ioLoopCount; // default: number of processors. Connections are distributed across the I/O loops
+		
 		sl_uint32 maxThreadsCount;
 		sl_bool flagProcessByThreads;
 		
 		sl_bool flagUseAsset;
 		String prefixAsset;
 		
+		// in-memory cache for the static files served by `processFile` (LRU within `staticCacheSize` bytes)
+		sl_bool flagUseStaticCache; // default: false
+		sl_uint64 staticCacheSize; // default: 64MB
+		sl_uint64 staticCacheMaxFileSize; // default: 1MB, larger files are always served from the file system
+		sl_uint32 staticCacheCheckInterval; // milliseconds between the modification checks of a cached file, default: 1000
+		sl_bool flagStaticCacheGzip; // precompress the text contents, default: true
+		
+		// compresses the text contents (gzip or deflate, by `Accept-Encoding`), the stream and file bodies are compressed while sending in the chunked transfer coding
+		sl_bool flagCompressResponse; // default: false
+		sl_uint32 compressionMinSize; // default: 1024, smaller responses are sent as they are
+		sl_int32 compressionLevel; // 0 ~ 9, default: 6
+		
 		sl_uint64 maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize;
 		
+		// the listening sockets stop accepting while this number of connections are opened (0: unlimited)
+		sl_uint32 maxConnections; // default: 0
+		// timeouts in milliseconds (0: no timeout). The WebSocket connections are not limited by these timeouts
+		sl_uint32 requestHeaderTimeout; // default: 30000, from the first byte of a request (or the connection) to the end of its header
+		sl_uint32 keepAliveTimeout; // default: 60000, idle time after a response is sent
+		sl_uint32 requestBodyTimeout; // default: 30000, idle time while receiving the request body
+		sl_uint32 requestBodyMinRate; // bytes per second, default: 0 (not checked). The body should be received at this average rate after `requestBodyTimeout`
+		
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
@@ -226,6 +354,10 @@ namespace slib
 		
 		Ptr<IHttpServiceProcessor> processor;
 		Function<sl_bool(HttpService*, HttpServiceContext* context)> onRequest;
+		// called before receiving the body (see `HttpService::preprocessRequest`)
+		Function<sl_bool(HttpService*, HttpServiceContext* context)> onPreprocessRequest;
+		// called on the WebSocket upgrade requests, returns true to accept the connection with the callbacks set in `param`
+		Function<sl_bool(HttpService*, HttpServiceContext* context, WebSocketParam& param)> onWebSocket;
 		
 	public:
 		HttpServiceParam();
@@ -236,6 +368,10 @@ namespace slib
 		
 	};
 	
+	class _priv_HttpStaticCache;
+	class _priv_HttpStaticCacheEntry;
+	class _priv_HttpCompressPool;
+	
 	class SLIB_EXPORT HttpService : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -255,6 +391,8 @@ namespace slib
 		
 		Ref<AsyncIoLoop> getAsyncIoLoop();
 		
+		List< Ref<AsyncIoLoop> > getAsyncIoLoops();
+		
 		Ref<ThreadPool> getThreadPool();
 		
 		const HttpServiceParam& getParam();
@@ -266,6 +404,9 @@ namespace slib
 		// called after inputing body
 		virtual void processRequest(const Ref<HttpServiceContext>& context);
 		
+		// called on the WebSocket upgrade requests, returns true to accept the connection
+		virtual sl_bool acceptWebSocket(const Ref<HttpServiceContext>& context, WebSocketParam& param);
+		
 		virtual sl_bool processAsset(const Ref<HttpServiceContext>& context, const String& path);
 		
 		sl_bool processFile(const Ref<HttpServiceContext>& context, const String& path);
@@ -302,12 +443,25 @@ namespace slib
 	protected:
 		sl_bool _init(const HttpServiceParam& param);
 		
+		void _updateAccepting();
+		
+		sl_size _getConnectionsCount();
+		
+		Ref<_priv_HttpBufferPool> _getReadBufferPool(AsyncStream* io);
+		
+		sl_bool _processCachedFile(const Ref<HttpServiceContext>& context, _priv_HttpStaticCacheEntry* entry);
+		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
+		CList< Ref<AsyncIoLoop> > m_ioLoops;
 		AtomicRef<ThreadPool> m_threadPool;
 		sl_bool m_flagRunning;
 		
-		CHashMap< HttpServiceConnection*, Ref<HttpServiceConnection> > m_connections;
+		FlatHashMap< HttpServiceConnection*, Ref<HttpServiceConnection> > m_connections;
+		// not a spin lock: the insertion can rehash the table
+		Mutex m_lockConnections;
+		Mutex m_lockAccepting;
+		sl_bool m_flagAcceptingPaused;
 		
 		CList< Ptr<IHttpServiceProcessor> > m_processors;
 		AtomicList< Ptr<IHttpServiceProcessor> > m_processorsCached;
@@ -315,6 +469,15 @@ namespace slib
 		
 		HttpServiceParam m_param;
 		
+		Ref<_priv_HttpStaticCache> m_staticCache;
+		
+		Ref<_priv_HttpCompressPool> m_compressPool;
+		
+		// read buffers of the connections, per I/O loop
+		CHashMap< AsyncIoLoop*, Ref<_priv_HttpBufferPool> > m_readBufferPools;
+		
+		friend class HttpServiceConnection;
+		
 	};
 
 }
@@ -31,7 +31,7 @@
 #include "socket_address.h"
 
 #include "../core/object.h"
-#include "../core/hash_map.h"
+#include "../core/flat_hash_map.h"
 
 /*
 	If you are usiing kernel-mode NAT on linux (for example on port range 40000~60000), following configuration will avoid to conflict with kernel-networking.
@@ -72,7 +72,7 @@ namespace slib
 		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
 		
 	protected:
-		CHashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		FlatHashMap< SocketAddress, sl_uint16 > m_mapPorts;
 		
 		_priv_NatTablePort* m_ports;
 		sl_uint16 m_nPorts;
@@ -137,8 +137,8 @@ namespace slib
 			sl_uint16 sequenceNumberTarget;
 		};
 		
-		CHashMap<IcmpEchoAddress, IcmpEchoElement> m_mapIcmpEchoOutgoing;
-		CHashMap<sl_uint32, IcmpEchoElement> m_mapIcmpEchoIncoming;
+		FlatHashMap<IcmpEchoAddress, IcmpEchoElement> m_mapIcmpEchoOutgoing;
+		FlatHashMap<sl_uint32, IcmpEchoElement> m_mapIcmpEchoIncoming;
 		
 	};
 
@@ -29,6 +29,8 @@
 #include "socket_address.h"
 #include "mac_address.h"
 
+#include "../core/file.h"
+
 typedef int sl_socket;
 #define SLIB_SOCKET_INVALID_HANDLE (-1)
 
@@ -129,6 +131,7 @@ namespace slib
 		SendPacketIsNotSupported = 113,
 		SendPacketInvalidAddress = 114,
 		ReceivePacketIsNotSupported = 115,
+		SendFileIsNotSupported = 116,
 		
 		Unknown = 10000
 		
@@ -210,14 +213,23 @@ namespace slib
 		
 		sl_bool accept(Ref<Socket>& socket, SocketAddress& address);
 		
+		// accepted socket is in non-blocking mode (uses `accept4` where available, saving the additional system calls)
+		sl_bool acceptNonBlocking(Ref<Socket>& socket, SocketAddress& address);
+		
 		sl_bool connect(const SocketAddress& address);
 		
 		sl_bool connectAndWait(const SocketAddress& address, sl_int32 timeout = -1);
 		
 		sl_int32 send(const void* buf, sl_uint32 size);
 		
+		// sends the file region directly from the kernel (`sendfile`), without copying it into the user space. returns 0 when the operation would block
+		sl_int32 sendFile(sl_file file, sl_uint64 offset, sl_uint32 size);
+		
 		sl_int32 receive(void* buf, sl_uint32 size);
 		
+		// receives without removing the data from the queue (MSG_PEEK). returns 0 when the operation would block
+		sl_int32 peek(void* buf, sl_uint32 size);
+		
 		sl_int32 sendTo(const SocketAddress& address, const void* buf, sl_uint32 size);
 		
 		sl_int32 receiveFrom(SocketAddress& address, void* buf, sl_uint32 size);
@@ -312,10 +324,13 @@ namespace slib
 		sl_bool setOption(int level, int option, sl_uint32 value);
 		sl_uint32 getOption(int level, int option) const;
 		
+		sl_bool _accept(Ref<Socket>& socket, SocketAddress& address, sl_bool flagNonBlocking);
+		
 	protected:
 		SocketType m_type;
 		sl_socket m_socket;
 		SocketError m_lastError;
+		sl_bool m_flagNonBlocking;
 		
 	};
 
@@ -333,6 +333,8 @@ namespace slib
 		Ref<Event> m_eventSync;
 		
 		friend class CurlRequest;
+		friend class HttpClient;
+		friend class HttpClientRequest;
 	};
 
 }
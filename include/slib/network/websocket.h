@@ -0,0 +1,263 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_NETWORK_WEBSOCKET
+#define CHECKHEADER_SLIB_NETWORK_WEBSOCKET
+
+#include "definition.h"
+
+#include "../core/async.h"
+#include "../core/list.h"
+#include "../core/hash_map.h"
+
+/*
+	WebSocket Protocol (server side)
+
+	https://tools.ietf.org/html/rfc6455
+
+	- the connections are upgraded by `HttpService` (see `HttpServiceParam::onWebSocket`)
+	- the frames are parsed and unmasked in the reading buffer, and the unfragmented messages are passed to `onMessage` without copying
+	- the fragmented messages are assembled up to `WebSocketParam::maxMessageSize`
+	- the pings are answered automatically
+	- `WebSocketGroup` encodes a broadcasted frame once and shares its memory across the connections
+*/
+
+namespace slib
+{
+	
+	enum class WebSocketOpcode
+	{
+		Continuation = 0,
+		Text = 1,
+		Binary = 2,
+		Close = 8,
+		Ping = 9,
+		Pong = 10
+	};
+	
+	class SLIB_EXPORT WebSocketCloseCode
+	{
+	public:
+		enum
+		{
+			Normal = 1000,
+			GoingAway = 1001,
+			ProtocolError = 1002,
+			UnsupportedData = 1003,
+			NoStatus = 1005,
+			Abnormal = 1006,
+			InvalidData = 1007,
+			PolicyViolation = 1008,
+			MessageTooBig = 1009,
+			InternalError = 1011
+		};
+	};
+	
+	class WebSocket;
+	class HttpServiceConnection;
+	
+	class SLIB_EXPORT WebSocketMessage
+	{
+	public:
+		WebSocketOpcode opcode; // Text or Binary
+		// valid only in the callback
+		const void* data;
+		sl_size size;
+		
+	public:
+		WebSocketMessage();
+		
+		~WebSocketMessage();
+		
+	public:
+		sl_bool isText() const;
+		
+		String getText() const;
+		
+		// copies the data
+		Memory getData() const;
+		
+	};
+	
+	class SLIB_EXPORT WebSocketParam
+	{
+	public:
+		String protocol; // selected subprotocol responded by `Sec-WebSocket-Protocol`
+		
+		sl_uint64 maxMessageSize; // default: 16MB
+		sl_uint64 maxPendingWriteSize; // the connection is closed when the data waiting to be sent is larger than this size, default: 16MB
+		
+		// all the callbacks are invoked on the I/O loop of the connection
+		Function<void(WebSocket*)> onOpen;
+		Function<void(WebSocket*, WebSocketMessage*)> onMessage;
+		Function<void(WebSocket*, const void* data, sl_size size)> onPong;
+		Function<void(WebSocket*, sl_uint16 code, const String& reason)> onClose;
+		
+	public:
+		WebSocketParam();
+		
+		WebSocketParam(const WebSocketParam& other);
+		
+		~WebSocketParam();
+		
+	};
+	
+	class SLIB_EXPORT WebSocket : public Object, public IClosable
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		WebSocket();
+		
+		~WebSocket();
+		
+	public:
+		// `input`: the data received after the upgrade request
+		static Ref<WebSocket> create(const Ref<AsyncStream>& io, const WebSocketParam& param, const void* input = sl_null, sl_size sizeInput = 0);
+		
+	public:
+		void start();
+		
+		// closes the connection without the closing handshake
+		void close() override;
+		
+		// starts the closing handshake, and the connection is closed after the frame is sent
+		void close(sl_uint16 code, const String& reason = sl_null);
+		
+		sl_bool isOpened();
+		
+		Ref<AsyncStream> getIO();
+		
+		const WebSocketParam& getParam();
+		
+		sl_bool sendText(const String& text);
+		
+		sl_bool sendBinary(const void* data, sl_size size);
+		
+		sl_bool sendBinary(const Memory& data);
+		
+		sl_bool ping(const void* data = sl_null, sl_size size = 0);
+		
+		// sends a frame built by `buildFrame`
+		sl_bool sendFrame(const Memory& frame);
+		
+		sl_uint64 getPendingWriteSize();
+		
+	public:
+		// unmasked frame (server to client)
+		static Memory buildFrame(WebSocketOpcode opcode, const void* data, sl_size size, sl_bool flagFin = sl_true);
+		
+		// builds the header, returns the size of the header (2 ~ 14 bytes). `mask` is optional
+		static sl_uint32 buildFrameHeader(void* header, WebSocketOpcode opcode, sl_uint64 sizePayload, sl_bool flagFin = sl_true, const sl_uint8* mask = sl_null);
+		
+		// XORs `data` with the masking key. `offset` is the position of `data` in the payload
+		static void applyMask(void* data, sl_size size, const sl_uint8* mask, sl_size offset = 0);
+		
+		// value of `Sec-WebSocket-Accept` for `Sec-WebSocket-Key`
+		static String getAcceptKey(const String& key);
+		
+		// checks that `data` is well-formed UTF-8 (RFC 3629), as required for the text messages
+		static sl_bool isValidUtf8(const void* data, sl_size size);
+		
+	public:
+		SLIB_PROPERTY(AtomicRef<Referable>, UserObject)
+		
+	protected:
+		sl_bool _send(WebSocketOpcode opcode, const void* data, sl_size size, const Memory& payload);
+		
+		sl_bool _write(const Memory& frame, const Memory& payload, sl_bool flagClose);
+		
+		void _read();
+		
+		void _processInput();
+		
+		sl_bool _processFrame(WebSocketOpcode opcode, sl_bool flagFin, sl_uint8* payload, sl_size size);
+		
+		void _closeWithError(sl_uint16 code);
+		
+		void _onClosed(sl_uint16 code, const String& reason);
+		
+		void _closeIO();
+		
+	protected:
+		void onReadStream(AsyncStreamResult* result);
+		
+		void onWriteStream(AsyncStreamResult* result);
+		
+		void onWriteStreamAndClose(AsyncStreamResult* result);
+		
+		friend class HttpServiceConnection;
+		
+	protected:
+		Ref<AsyncStream> m_io;
+		WebSocketParam m_param;
+		WeakRef<HttpServiceConnection> m_connection;
+		
+		sl_bool m_flagOpened;
+		sl_bool m_flagReading;
+		sl_bool m_flagCloseSent;
+		
+		Memory m_bufRead;
+		sl_size m_sizeRead;
+		
+		MemoryBuffer m_fragments;
+		WebSocketOpcode m_opcodeFragments;
+		sl_bool m_flagFragmented;
+		
+		Mutex m_lockWrite;
+		sl_uint64 m_sizePendingWrite;
+		
+	};
+	
+	class SLIB_EXPORT WebSocketGroup : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	public:
+		WebSocketGroup();
+		
+		~WebSocketGroup();
+		
+	public:
+		void add(const Ref<WebSocket>& socket);
+		
+		void remove(WebSocket* socket);
+		
+		sl_size getCount();
+		
+		List< Ref<WebSocket> > getSockets();
+		
+		// returns the count of the connections which the frame is sent to
+		sl_size broadcastFrame(const Memory& frame);
+		
+		sl_size broadcastText(const String& text);
+		
+		sl_size broadcastBinary(const void* data, sl_size size);
+		
+	protected:
+		CHashMap< WebSocket*, Ref<WebSocket> > m_sockets;
+		
+	};
+	
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "../core/function.h"
 #include "../core/variant.h"
+#include "../core/rw_lock.h"
 #include "../network/http_service.h"
 
 #define SWEB_HANDLER_PARAMS_LIST const slib::Ref<slib::HttpServiceContext>& context, HttpMethod method, const slib::String& path
@@ -35,6 +36,40 @@ namespace slib
 {
 
 	typedef Function<Variant(SWEB_HANDLER_PARAMS_LIST)> WebHandler;
+	
+	class _priv_WebRouteNode;
+	
+	// Radix-tree router with one tree per HTTP method.
+	//
+	// Pattern syntax (`:` and `*` are special only at the beginning of a segment):
+	//	/users/list			static path
+	//	/users/:id/orders	`:id` matches one non-empty segment
+	//	/files/*rest		`*rest` matches the remainder of the path (can be empty), must be last
+	//
+	// Static segments take precedence over parameters, and parameters over wildcards.
+	// The names are given by the matched pattern: `/users/:id` and `/users/:name/orders` capture `id` and `name`.
+	// Matching is O(path length) and makes no allocation; the captured values are slices of the path.
+	class SLIB_EXPORT WebRouter
+	{
+	public:
+		WebRouter();
+		
+		~WebRouter();
+		
+	public:
+		void add(HttpMethod method, const String& pattern, const WebHandler& handler);
+		
+		/*
+			`params` should have room for `SLIB_HTTP_MAX_PATH_PARAMETERS` items.
+			Returns null if no route matches.
+		*/
+		WebHandler match(HttpMethod method, const String& path, HttpPathParameter* params, sl_uint32* pCountParams) const;
+		
+	protected:
+		Ref<_priv_WebRouteNode> m_roots[(int)(HttpMethod::TRACE) + 1];
+		ReadWriteLock m_lock;
+		
+	};
 
 	class WebController : public Object, public IHttpServiceProcessor
 	{
@@ -47,16 +82,16 @@ namespace slib
 		static Ref<WebController> create();
 		
 	public:
+		// `path` can be a pattern (see `WebRouter`), the captured values are set on the `HttpServiceContext`
 		void registerHandler(HttpMethod method, const String& path, const WebHandler& handler);
 		
-	protected:
-		sl_bool onHttpRequest(const Ref<HttpServiceContext>& context) override;
+		WebRouter& getRouter();
 		
 	protected:
-		static String _getHandlerSignature(HttpMethod method, const String& path);
+		sl_bool onHttpRequest(const Ref<HttpServiceContext>& context) override;
 		
 	protected:
-		CMap<String, WebHandler> m_handlers;
+		WebRouter m_router;
 		
 		friend class WebModule;
 		
@@ -107,4 +142,8 @@ namespace SWEB_MODULE_##NAME { \
 #define SWEB_FLOAT_PARAM(NAME, ...) float NAME = context->getParameter(#NAME).parseFloat(##__VA_ARGS__);
 #define SWEB_DOUBLE_PARAM(NAME, ...) double NAME = context->getParameter(#NAME).parseDouble(##__VA_ARGS__);
 
+#define SWEB_STRING_PATH_PARAM(NAME) slib::String NAME = context->getPathParameter(#NAME);
+#define SWEB_INT_PATH_PARAM(NAME, ...) sl_int32 NAME = context->getPathParameter(#NAME).parseInt32(10, ##__VA_ARGS__);
+#define SWEB_INT64_PATH_PARAM(NAME, ...) sl_int64 NAME = context->getPathParameter(#NAME).parseInt64(10, ##__VA_ARGS__);
+
 #endif
@@ -22,6 +22,7 @@
 
 #include "slib/core/async.h"
 
+#include "slib/core/hazard_pointer.h"
 #include "slib/core/safe_static.h"
 
 namespace slib
@@ -38,6 +39,7 @@ namespace slib
 		m_flagInit = sl_false;
 		m_flagRunning = sl_false;
 		m_handle = sl_null;
+		m_timers.setWakeCallback(SLIB_FUNCTION_CLASS(AsyncIoLoop, wake, this));
 	}
 
 	AsyncIoLoop::~AsyncIoLoop()
@@ -105,6 +107,11 @@ namespace slib
 		m_queueInstancesClosing.removeAll();
 		m_queueInstancesClosed.removeAll();
 		
+		m_queueTasks.removeAll();
+		m_timers.cancelAll();
+		
+		m_bufferRegistered.setNull();
+		
 	}
 
 	void AsyncIoLoop::start()
@@ -127,12 +134,20 @@ namespace slib
 		return m_flagRunning;
 	}
 
-	sl_bool AsyncIoLoop::addTask(const Function<void()>& task)
+	sl_bool AsyncIoLoop::isCurrentThread()
+	{
+		if (m_thread.isNotNull()) {
+			return m_thread->isCurrentThread();
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::addTask(UniqueFunction<void()>&& task)
 	{
 		if (task.isNull()) {
 			return sl_false;
 		}
-		if (m_queueTasks.push(task)) {
+		if (m_queueTasks.push(Move(task))) {
 			wake();
 			return sl_true;
 		}
@@ -141,7 +156,18 @@ namespace slib
 
 	sl_bool AsyncIoLoop::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
 	{
-		return addTask(callback);
+		if (delay_ms > 0) {
+			return addTimeout(callback, delay_ms).isNotNull();
+		}
+		return addTask(UniqueFunction<void()>(callback));
+	}
+
+	TimerHandle AsyncIoLoop::addTimeout(const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		if (!m_flagInit) {
+			return sl_null;
+		}
+		return m_timers.add(task, delay_ms);
 	}
 
 	void AsyncIoLoop::wake()
@@ -158,6 +184,7 @@ namespace slib
 		if (m_handle) {
 			if (instance && instance->isOpened()) {
 				ObjectLocker lock(this);
+				instance->setMode(mode);
 				return _native_attachInstance(instance, mode);
 			}
 		}
@@ -187,14 +214,25 @@ namespace slib
 		}
 	}
 
-	void AsyncIoLoop::_stepBegin()
+	sl_int32 AsyncIoLoop::_stepBegin()
 	{
 		// Async Tasks
+		{
+			TaskQueue& tasks = m_queueTasksRunning;
+			m_queueTasks.swap(tasks);
+			UniqueFunction<void()> task;
+			while (tasks.pop_NoLock(&task)) {
+				task();
+			}
+		}
+		
+		// Timers
+		sl_int32 timeout;
 		{
 			LinkedQueue< Function<void()> > tasks;
-			tasks.merge(&m_queueTasks);
+			timeout = m_timers.pollExpired(tasks);
 			Function<void()> task;
-			while (m_queueTasks.pop(&task)) {
+			while (tasks.pop_NoLock(&task)) {
 				task();
 			}
 		}
@@ -210,6 +248,11 @@ namespace slib
 				}
 			}
 		}
+		
+		if (m_queueTasks.isNotEmpty()) {
+			return 0;
+		}
+		return timeout;
 	}
 
 	void AsyncIoLoop::_stepEnd()
@@ -222,6 +265,8 @@ namespace slib
 				m_queueInstancesClosed.push(instance);
 			}
 		}
+		// the objects replaced on this thread (ex: the sockets of the closed instances) are not kept until the following replacements
+		HazardPointer::reclaimAll();
 	}
 
 /*************************************
@@ -396,7 +441,7 @@ namespace slib
 		Referable* _userObject,
 		const Function<void(AsyncStreamResult*)>& _callback,
 		sl_bool _flagRead)
-	 : data((void*)_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead)
+	 : data((void*)_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead), offsetFile(0)
 	{
 	}
 
@@ -418,6 +463,21 @@ namespace slib
 		return new AsyncStreamRequest(data, size, userObject, callback, sl_false);
 	}
 
+	Ref<AsyncStreamRequest> AsyncStreamRequest::createSendFile(
+		const Ref<File>& file,
+		sl_uint64 offset,
+		sl_uint32 size,
+		Referable* userObject,
+		const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Ref<AsyncStreamRequest> ret = new AsyncStreamRequest(sl_null, size, userObject, callback, sl_false);
+		if (ret.isNotNull()) {
+			ret->file = file;
+			ret->offsetFile = offset;
+		}
+		return ret;
+	}
+
 	void AsyncStreamRequest::runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError)
 	{
 		if (callback.isNotNull()) {
@@ -463,6 +523,24 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamInstance::isSendFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		if (file.isNull() || !(isSendFileSupported())) {
+			return sl_false;
+		}
+		Ref<AsyncStreamRequest> req = AsyncStreamRequest::createSendFile(file, offset, size, userObject, callback);
+		if (req.isNotNull()) {
+			m_requestsWrite.push(req);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamInstance::isSeekable()
 	{
 		return sl_false;
@@ -557,6 +635,16 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool AsyncStream::isSendFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStream::isSeekable()
 	{
 		return sl_false;
@@ -670,6 +758,31 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::isSendFileSupported()
+	{
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			return instance->isSendFileSupported();
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->sendFile(file, offset, size, callback, userObject)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamBase::isSeekable()
 	{
 		Ref<AsyncStreamInstance> instance = getIoInstance();
@@ -1322,6 +1435,13 @@ namespace slib
 		m_bufferReading.setNull();
 
 		if (bufferReading.isNotNull()) {
+			if (!(result->flagError) && result->size == 0 && m_sizeTotal == SLIB_UINT64_MAX) {
+				// the source of unknown size has reached the end
+				m_sizeTotal = m_sizeRead;
+				m_buffersRead.pushBack(bufferReading);
+				enqueue();
+				return;
+			}
 			m_sizeRead += result->size;
 			Memory memWrite = bufferReading->mem.sub(0, result->size);
 			if (memWrite.isNull()) {
@@ -1456,18 +1576,28 @@ namespace slib
 	AsyncOutputBufferElement::AsyncOutputBufferElement()
 	{
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(const Memory& header)
 	{
 		m_header.add(header);
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(AsyncStream* stream, sl_uint64 size)
 	{
 		m_body = stream;
 		m_sizeBody = size;
+		m_offsetBodyFile = 0;
+	}
+
+	AsyncOutputBufferElement::AsyncOutputBufferElement(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		m_bodyFile = file;
+		m_offsetBodyFile = offset;
+		m_sizeBody = size;
 	}
 
 	AsyncOutputBufferElement::~AsyncOutputBufferElement()
@@ -1476,7 +1606,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmpty() const
 	{
-		if (m_header.getSize() == 0 && (m_sizeBody == 0 || m_body.isNull())) {
+		if (m_header.getSize() == 0 && isEmptyBody()) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1484,7 +1614,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmptyBody() const
 	{
-		if (m_sizeBody == 0 || m_body.isNull()) {
+		if (m_sizeBody == 0 || (m_body.isNull() && m_bodyFile.isNull())) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1498,6 +1628,15 @@ namespace slib
 	void AsyncOutputBufferElement::setBody(AsyncStream* stream, sl_uint64 size)
 	{
 		m_body = stream;
+		m_bodyFile.setNull();
+		m_sizeBody = size;
+	}
+
+	void AsyncOutputBufferElement::setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		m_body.setNull();
+		m_bodyFile = file;
+		m_offsetBodyFile = offset;
 		m_sizeBody = size;
 	}
 
@@ -1516,6 +1655,16 @@ namespace slib
 		return m_sizeBody;
 	}
 
+	Ref<File> AsyncOutputBufferElement::getBodyFile()
+	{
+		return m_bodyFile;
+	}
+
+	sl_uint64 AsyncOutputBufferElement::getBodyFileOffset()
+	{
+		return m_offsetBodyFile;
+	}
+
 
 /**********************************************
 		AsyncOutputBuffer
@@ -1629,11 +1778,71 @@ namespace slib
 		return sl_true;
 	}
 
+	sl_bool AsyncOutputBuffer::copyFromFileRegion(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		if (size == 0) {
+			return sl_true;
+		}
+		if (file.isNull()) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getBack();
+		if (link && link->value->isEmptyBody()) {
+			link->value->setBodyFile(file, offset, size);
+			m_lengthOutput += size;
+		} else {
+			Ref<AsyncOutputBufferElement> data = new AsyncOutputBufferElement(file, offset, size);
+			if (data.isNotNull()) {
+				if (m_queueOutput.push(data)) {
+					m_lengthOutput += size;
+				} else {
+					return sl_false;
+				}
+			} else {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool AsyncOutputBuffer::copyFromFileRegion(const String& path, sl_uint64 offset, sl_uint64 size)
+	{
+		if (size == 0) {
+			return sl_true;
+		}
+		Ref<File> file = File::openForRead(path);
+		if (file.isNotNull()) {
+			return copyFromFileRegion(file, offset, size);
+		}
+		return sl_false;
+	}
+
 	sl_uint64 AsyncOutputBuffer::getOutputLength() const
 	{
 		return m_lengthOutput;
 	}
 
+	sl_bool AsyncOutputBuffer::getMemoryOutput(Memory& _out)
+	{
+		ObjectLocker lock(this);
+		MemoryBuffer buf;
+		Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getFront();
+		while (link) {
+			AsyncOutputBufferElement* element = link->value.get();
+			if (!(element->isEmptyBody())) {
+				return sl_false;
+			}
+			MemoryQueue& header = element->getHeader();
+			if (header.getSize() > 0) {
+				buf.add(header.merge());
+			}
+			link = link->next;
+		}
+		_out = buf.merge();
+		return sl_true;
+	}
+
 /**********************************************
 				AsyncOutput
 **********************************************/
@@ -1663,6 +1872,8 @@ namespace slib
 	{
 	}
 
+#define PRIV_ASYNC_OUTPUT_SEND_FILE_CHUNK 0x1000000
+
 	SLIB_DEFINE_OBJECT(AsyncOutput, AsyncOutputBuffer)
 
 	AsyncOutput::AsyncOutput()
@@ -1699,8 +1910,7 @@ namespace slib
 		if (param.stream.isNull()) {
 			return sl_null;
 		}
-		Memory buffer = Memory::create(param.bufferSize);
-		if (buffer.isNull()) {
+		if (!(param.bufferSize)) {
 			return sl_null;
 		}
 		Ref<AsyncOutput> ret = new AsyncOutput;
@@ -1710,7 +1920,6 @@ namespace slib
 			ret->m_bufferCount = param.bufferCount;
 			ret->m_listener = param.listener;
 			ret->m_callback = param.callback;
-			ret->m_bufWrite = buffer;
 			return ret;
 		}
 		return sl_null;
@@ -1728,6 +1937,12 @@ namespace slib
 		_write(sl_false);
 	}
 
+	sl_bool AsyncOutput::isWriting()
+	{
+		ObjectLocker lock(this);
+		return m_flagWriting || m_elementWriting.isNotNull() || m_queueOutput.isNotEmpty();
+	}
+
 	void AsyncOutput::_write(sl_bool flagCompleted)
 	{
 		ObjectLocker lock(this);
@@ -1746,7 +1961,11 @@ namespace slib
 				}
 			}
 			if (!(m_queueOutput.pop(&m_elementWriting))) {
+				// the buffer is not kept while idle (ex: keep-alive connections)
+				m_bufWrite.setNull();
 				if (flagCompleted) {
+					// the listener may lock its own objects, which are also locked while writing to this output
+					lock.unlock();
 					_onComplete();
 				}
 				return;
@@ -1754,16 +1973,62 @@ namespace slib
 		}
 		MemoryQueue& header = m_elementWriting->getHeader();
 		if (header.getSize() > 0) {
-			sl_uint32 size = (sl_uint32)(header.pop(m_bufWrite.getData(), m_bufWrite.getSize()));
+			if (m_bufWrite.isNull()) {
+				m_bufWrite = Memory::create(m_bufferSize);
+				if (m_bufWrite.isNull()) {
+					lock.unlock();
+					_onError();
+					return;
+				}
+			}
+			sl_uint8* buf = (sl_uint8*)(m_bufWrite.getData());
+			sl_uint32 sizeBuf = (sl_uint32)(m_bufWrite.getSize());
+			sl_uint32 size = (sl_uint32)(header.pop(buf, sizeBuf));
+			// gather the following in-memory elements (ex: pipelined responses) into the same write
+			while (size < sizeBuf && m_elementWriting->isEmpty()) {
+				Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getFront();
+				if (!link || link->value->getHeader().getSize() == 0) {
+					break;
+				}
+				m_queueOutput.pop(&m_elementWriting);
+				size += (sl_uint32)(m_elementWriting->getHeader().pop(buf + size, sizeBuf - size));
+			}
 			if (size > 0) {
 				m_flagWriting = sl_true;
 				if (!(m_streamOutput->write(m_bufWrite.getData(), size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
 					m_flagWriting = sl_false;
+					lock.unlock();
 					_onError();
 				}
 			}
 		} else {
 			sl_uint64 sizeBody = m_elementWriting->getBodySize();
+			Ref<File> file = m_elementWriting->getBodyFile();
+			if (sizeBody != 0 && file.isNotNull()) {
+				sl_uint64 offset = m_elementWriting->getBodyFileOffset();
+				if (m_streamOutput->isSendFileSupported()) {
+					sl_uint32 size = PRIV_ASYNC_OUTPUT_SEND_FILE_CHUNK;
+					if (sizeBody < size) {
+						size = (sl_uint32)sizeBody;
+					}
+					m_elementWriting->setBodyFile(file, offset + size, sizeBody - size);
+					m_flagWriting = sl_true;
+					if (!(m_streamOutput->sendFile(file, offset, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this)))) {
+						m_flagWriting = sl_false;
+						lock.unlock();
+						_onError();
+					}
+					return;
+				}
+				// fallback: copy the region through the regular buffered path
+				Ref<AsyncFile> fileAsync = AsyncFile::create(file);
+				if (fileAsync.isNull() || !(file->seek(offset, SeekPosition::Begin))) {
+					lock.unlock();
+					_onError();
+					return;
+				}
+				m_elementWriting->setBody(fileAsync.get(), sizeBody);
+			}
 			Ref<AsyncStream> body = m_elementWriting->getBody();
 			if (sizeBody != 0 && body.isNotNull()) {
 				m_flagWriting = sl_true;
@@ -1780,6 +2045,7 @@ namespace slib
 					m_copy = copy;
 				} else {
 					m_flagWriting = sl_false;
+					lock.unlock();
 					_onError();
 				}
 			}
@@ -31,6 +31,16 @@
 #define ASYNC_USE_KQUEUE
 #elif defined(SLIB_PLATFORM_IS_LINUX)
 #define ASYNC_USE_EPOLL
+// define `SLIB_NOT_USE_IO_URING` when building the library to use epoll only
+#	if !defined(SLIB_NOT_USE_IO_URING) && !defined(SLIB_PLATFORM_IS_ANDROID) && defined(__has_include)
+#		if __has_include(<linux/io_uring.h>)
+#			include <linux/io_uring.h>
+#			if defined(IORING_POLL_ADD_MULTI) && defined(IORING_FEAT_EXT_ARG)
+// io_uring is used when it is supported by the running kernel, otherwise epoll is used
+#				define ASYNC_USE_IO_URING
+#			endif
+#		endif
+#	endif
 #elif defined(SLIB_PLATFORM_IS_FREEBSD)
 #define ASYNC_USE_KEVENT
 #endif
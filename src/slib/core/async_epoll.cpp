@@ -25,10 +25,15 @@
 #if defined(ASYNC_USE_EPOLL)
 
 #include "slib/core/async.h"
-#include "slib/core/pipe.h"
+#include "slib/core/base.h"
+
+#if defined(ASYNC_USE_IO_URING)
+#include "async_uring.h"
+#endif
 
 #include <unistd.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/errno.h>
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
@@ -41,44 +46,80 @@ namespace slib
 	struct _priv_AsyncIoLoopHandle
 	{
 		int fdEpoll;
-		Ref<PipeEvent> eventWake;
+		int fdWake; // eventfd
+		// non-zero while a wake is signaled and not yet consumed by the loop, so that the repeated wakes don't write to the eventfd
+		sl_int32 flagWakePending;
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring; // null: using epoll
+#endif
 	};
 
 	void* AsyncIoLoop::_native_createHandle()
 	{
-		Ref<PipeEvent> pipe = PipeEvent::create();
-		if (pipe.isNull()) {
+		int fdWake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (fdWake < 0) {
 			return 0;
 		}
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = _priv_IoUring::create(ASYNC_MAX_WAIT_EVENT * 4);
+		if (ring) {
+			_priv_AsyncIoLoopHandle* handle = new _priv_AsyncIoLoopHandle;
+			if (handle) {
+				handle->fdEpoll = -1;
+				handle->fdWake = fdWake;
+				handle->flagWakePending = 0;
+				handle->ring = ring;
+				// register wake event
+				if (ring->addPoll(fdWake, EPOLLIN, 0) && ring->submit(0) == 1) {
+					return handle;
+				}
+				delete handle;
+			}
+			delete ring;
+		}
+#endif
 		int fdEpoll;
 #if defined(EPOLL_LOW)
 		fdEpoll = ::epoll_create(1024);
 #else
-		fdEpoll = ::epoll_create1(0);
+		fdEpoll = ::epoll_create1(EPOLL_CLOEXEC);
 #endif
 		if (fdEpoll >= 0) {
 			_priv_AsyncIoLoopHandle* handle = new _priv_AsyncIoLoopHandle;
 			if (handle) {
 				handle->fdEpoll = fdEpoll;
-				handle->eventWake = pipe;
+				handle->fdWake = fdWake;
+				handle->flagWakePending = 0;
+#if defined(ASYNC_USE_IO_URING)
+				handle->ring = sl_null;
+#endif
 				// register wake event
 				epoll_event ev;
 				ev.data.ptr = sl_null;
-				ev.events = EPOLLIN | EPOLLPRI | EPOLLET;
-				if (0 == epoll_ctl(fdEpoll, EPOLL_CTL_ADD, (int)(pipe->getReadPipeHandle()), &ev)) {
+				ev.events = EPOLLIN;
+				if (0 == epoll_ctl(fdEpoll, EPOLL_CTL_ADD, fdWake, &ev)) {
 					return handle;
 				}
 				delete handle;
 			}
 			::close(fdEpoll);
 		}
+		::close(fdWake);
 		return 0;
 	}
 
 	void AsyncIoLoop::_native_closeHandle(void* _handle)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)_handle;
-		::close(handle->fdEpoll);
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			delete handle->ring;
+		}
+#endif
+		if (handle->fdEpoll >= 0) {
+			::close(handle->fdEpoll);
+		}
+		::close(handle->fdWake);
 		delete handle;
 	}
 
@@ -86,13 +127,94 @@ namespace slib
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
 
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = handle->ring;
+		if (ring) {
+			while (m_flagRunning) {
+				
+				sl_int32 timeout = _stepBegin();
+				
+				// submits the entries queued by the previous step, and waits the completions in one system call
+				ring->submit(timeout);
+				
+				sl_uint32 nEvents = 0;
+				io_uring_cqe cqe;
+				while (ring->popCqe(cqe)) {
+					nEvents++;
+					sl_uint32 tag = (sl_uint32)(cqe.user_data & PRIV_IO_URING_TAG_MASK);
+					AsyncIoInstance* instance = (AsyncIoInstance*)(sl_size)(cqe.user_data & ~((sl_uint64)PRIV_IO_URING_TAG_MASK));
+					if (tag == PRIV_IO_URING_TAG_IGNORE) {
+						continue;
+					}
+					if (!instance) {
+						eventfd_t value;
+						::eventfd_read(handle->fdWake, &value);
+						Base::interlockedCompareExchange32(&(handle->flagWakePending), 0, 1);
+						if (!(cqe.flags & IORING_CQE_F_MORE)) {
+							ring->addPoll(handle->fdWake, EPOLLIN, 0);
+						}
+						continue;
+					}
+					if (tag == PRIV_IO_URING_TAG_POLL) {
+						if (cqe.res == -ECANCELED) {
+							continue;
+						}
+						if (!(instance->isClosing())) {
+							if (m_flagRunning && cqe.res >= 0) {
+								AsyncIoInstance::EventDesc desc;
+								desc.flagIn = sl_false;
+								desc.flagOut = sl_false;
+								desc.flagError = sl_false;
+								desc.completionResult = 0;
+								int re = cqe.res;
+								if (re & (EPOLLIN | EPOLLPRI)) {
+									desc.flagIn = sl_true;
+								}
+								if (re & (EPOLLOUT)) {
+									desc.flagOut = sl_true;
+								}
+								if (re & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+									desc.flagError = sl_true;
+								}
+								instance->onEvent(&desc);
+							}
+							if (!(cqe.flags & IORING_CQE_F_MORE) && !(instance->isClosing())) {
+								// multi-shot poll is terminated by the kernel (for example, on overflow)
+								_native_attachInstance(instance, instance->getMode());
+							}
+						}
+					} else {
+						// completion of read/write, the reference is taken on submission
+						if (m_flagRunning && !(instance->isClosing())) {
+							AsyncIoInstance::EventDesc desc;
+							desc.flagIn = tag == PRIV_IO_URING_TAG_READ;
+							desc.flagOut = tag == PRIV_IO_URING_TAG_WRITE;
+							desc.flagError = cqe.res < 0;
+							desc.completionResult = cqe.res;
+							instance->onEvent(&desc);
+						}
+						instance->decreaseReference();
+					}
+				}
+				if (!nEvents) {
+					m_queueInstancesClosed.removeAll();
+				}
+				
+				if (m_flagRunning) {
+					_stepEnd();
+				}
+			}
+			return;
+		}
+#endif
+
 		epoll_event waitEvents[ASYNC_MAX_WAIT_EVENT];
 
 		while (m_flagRunning) {
 
-			_stepBegin();
+			sl_int32 timeout = _stepBegin();
 
-			int nEvents = ::epoll_wait(handle->fdEpoll, waitEvents, ASYNC_MAX_WAIT_EVENT, -1);
+			int nEvents = ::epoll_wait(handle->fdEpoll, waitEvents, ASYNC_MAX_WAIT_EVENT, timeout);
 			if (nEvents == 0) {
 				m_queueInstancesClosed.removeAll();
 			}
@@ -126,10 +248,16 @@ namespace slib
 #endif
 							desc.flagError = sl_true;
 						}
+#if defined(ASYNC_USE_IO_URING)
+						desc.completionResult = 0;
+#endif
 						instance->onEvent(&desc);
 					}
 				} else {
-					handle->eventWake->reset();
+					eventfd_t value;
+					::eventfd_read(handle->fdWake, &value);
+					// the tasks dispatched after this point will be processed in the next `_stepBegin`, or wake the loop again
+					Base::interlockedCompareExchange32(&(handle->flagWakePending), 0, 1);
 				}
 			}
 
@@ -140,16 +268,147 @@ namespace slib
 
 	}
 
+#if defined(ASYNC_USE_IO_URING)
+	void* AsyncIoLoop::_native_getIoUring()
+	{
+		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
+		if (handle) {
+			return handle->ring;
+		}
+		return sl_null;
+	}
+
+	void AsyncIoLoop::_submitIoUring()
+	{
+		// the entries are submitted together by the next waiting of the loop thread.
+		// other threads only wake the loop: the requests submitted by a thread are canceled by the kernel when the thread exits
+		if (!(m_thread->isCurrentThread())) {
+			_native_wake();
+		}
+	}
+#endif
+
+	sl_bool AsyncIoLoop::isIoUring()
+	{
+#if defined(ASYNC_USE_IO_URING)
+		return _native_getIoUring() != sl_null;
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool AsyncIoLoop::registerBuffer(const Memory& mem)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		if (!m_flagInit) {
+			return sl_false;
+		}
+		_priv_IoUring* ring = (_priv_IoUring*)(_native_getIoUring());
+		if (ring && m_bufferRegistered.isNull()) {
+			if (ring->registerBuffer(mem.getData(), mem.getSize())) {
+				m_bufferRegistered = mem;
+				return sl_true;
+			}
+		}
+#endif
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::_submitIoUringReceive(AsyncIoInstance* instance, void* data, sl_uint32 size)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = (_priv_IoUring*)(_native_getIoUring());
+		if (ring) {
+			// released on the completion
+			instance->increaseReference();
+			if (ring->addReceive((int)(instance->getHandle()), data, size, (sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_READ)) {
+				_submitIoUring();
+				return sl_true;
+			}
+			instance->decreaseReference();
+		}
+#endif
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::_submitIoUringSend(AsyncIoInstance* instance, const void* data, sl_uint32 size)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = (_priv_IoUring*)(_native_getIoUring());
+		if (ring) {
+			instance->increaseReference();
+			if (ring->addSend((int)(instance->getHandle()), data, size, (sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_WRITE)) {
+				_submitIoUring();
+				return sl_true;
+			}
+			instance->decreaseReference();
+		}
+#endif
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::_submitIoUringPoll(AsyncIoInstance* instance, sl_bool flagOut)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = (_priv_IoUring*)(_native_getIoUring());
+		if (ring) {
+			instance->increaseReference();
+			sl_bool bRet;
+			if (flagOut) {
+				bRet = ring->addPollOnce((int)(instance->getHandle()), EPOLLOUT, (sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_WRITE);
+			} else {
+				bRet = ring->addPollOnce((int)(instance->getHandle()), EPOLLIN | EPOLLRDHUP, (sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_READ);
+			}
+			if (bRet) {
+				_submitIoUring();
+				return sl_true;
+			}
+			instance->decreaseReference();
+		}
+#endif
+		return sl_false;
+	}
+
 	void AsyncIoLoop::_native_wake()
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
-		handle->eventWake->set();
+		if (Base::interlockedCompareExchange32(&(handle->flagWakePending), 1, 0)) {
+			::eventfd_write(handle->fdWake, 1);
+		}
 	}
 
 	sl_bool AsyncIoLoop::_native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
 		int hObject = (int)(instance->getHandle());
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = handle->ring;
+		if (ring) {
+			sl_uint32 events = EPOLLRDHUP;
+			switch (mode) {
+				case AsyncIoMode::In:
+					events |= EPOLLIN | EPOLLPRI;
+					break;
+				case AsyncIoMode::Out:
+					events |= EPOLLOUT;
+					break;
+				case AsyncIoMode::InOut:
+					events |= EPOLLIN | EPOLLPRI | EPOLLOUT;
+					break;
+				default:
+					return sl_true;
+			}
+			if (ring->addPoll(hObject, events, (sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_POLL)) {
+				_submitIoUring();
+				return sl_true;
+			}
+			return sl_false;
+		}
+#endif
 		epoll_event ev;
 		ev.data.ptr = (void*)instance;
 		
@@ -183,6 +442,22 @@ namespace slib
 	void AsyncIoLoop::_native_detachInstance(AsyncIoInstance* instance)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		_priv_IoUring* ring = handle->ring;
+		if (ring) {
+			if (instance->getMode() != AsyncIoMode::None) {
+				ring->removePoll((sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_POLL);
+				_submitIoUring();
+			} else {
+				// the pending reads and writes hold the file (socket) open, until they are completed.
+				// submitted here (loop thread) before the instance closes the descriptor, so that the queued entries can't refer to a reused descriptor
+				ring->addCancel((sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_READ);
+				ring->addCancel((sl_uint64)(sl_size)instance | PRIV_IO_URING_TAG_WRITE);
+				ring->submit(0);
+			}
+			return;
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		int ret = ::epoll_ctl(handle->fdEpoll, EPOLL_CTL_DEL, hObject, &ev);
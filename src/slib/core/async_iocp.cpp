@@ -93,11 +93,11 @@ namespace slib
 
 		while (m_flagRunning) {
 
-			_stepBegin();
+			sl_int32 timeout = _stepBegin();
 
 			DWORD nCount = 0;
 			
-			if (!fGetQueuedCompletionStatusEx(handle->hCompletionPort, entries, ASYNC_MAX_WAIT_EVENT, &nCount, INFINITE, FALSE)) {
+			if (!fGetQueuedCompletionStatusEx(handle->hCompletionPort, entries, ASYNC_MAX_WAIT_EVENT, &nCount, timeout >= 0 ? (DWORD)timeout : INFINITE, FALSE)) {
 				nCount = 0;
 			}
 			if (nCount == 0) {
@@ -128,6 +128,11 @@ namespace slib
 		::PostQueuedCompletionStatus(handle->hCompletionPort, 0, 0, &(handle->overlappedWake));
 	}
 
+	sl_bool AsyncIoLoop::registerBuffer(const Memory& mem)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncIoLoop::_native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
@@ -82,9 +82,17 @@ namespace slib
 
 		while (m_flagRunning) {
 
-			_stepBegin();
+			sl_int32 timeout = _stepBegin();
+			
+			struct timespec ts;
+			struct timespec* pts = sl_null;
+			if (timeout >= 0) {
+				ts.tv_sec = timeout / 1000;
+				ts.tv_nsec = (timeout % 1000) * 1000000;
+				pts = &ts;
+			}
 
-			int nEvents = ::kevent(handle->kq, sl_null, 0, waitEvents, ASYNC_MAX_WAIT_EVENT, NULL);
+			int nEvents = ::kevent(handle->kq, sl_null, 0, waitEvents, ASYNC_MAX_WAIT_EVENT, pts);
 			if (nEvents == 0) {
 				m_queueInstancesClosed.removeAll();
 			}
@@ -129,6 +137,11 @@ namespace slib
 		handle->eventWake->set();
 	}
 
+	sl_bool AsyncIoLoop::registerBuffer(const Memory& mem)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncIoLoop::_native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
@@ -0,0 +1,525 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "async_uring.h"
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+
+#include "slib/core/async.h"
+#include "slib/core/file.h"
+#include "slib/core/base.h"
+
+#if defined(ASYNC_USE_IO_URING)
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace slib
+{
+
+#if defined(ASYNC_USE_IO_URING)
+
+	_priv_IoUring::_priv_IoUring()
+	{
+		fd = -1;
+		ptrSqRing = MAP_FAILED;
+		ptrCqRing = MAP_FAILED;
+		sqes = (io_uring_sqe*)MAP_FAILED;
+		sizeSqRing = 0;
+		sizeCqRing = 0;
+		sizeSqes = 0;
+		nPending = 0;
+		flagSupportRegisterBuffer = sl_false;
+		bufferRegistered = sl_null;
+		sizeBufferRegistered = 0;
+	}
+
+	_priv_IoUring::~_priv_IoUring()
+	{
+		if (sqes != MAP_FAILED) {
+			::munmap(sqes, sizeSqes);
+		}
+		if (ptrCqRing != MAP_FAILED && ptrCqRing != ptrSqRing) {
+			::munmap(ptrCqRing, sizeCqRing);
+		}
+		if (ptrSqRing != MAP_FAILED) {
+			::munmap(ptrSqRing, sizeSqRing);
+		}
+		if (fd >= 0) {
+			::close(fd);
+		}
+	}
+
+	_priv_IoUring* _priv_IoUring::create(sl_uint32 nEntries)
+	{
+		io_uring_params params;
+		Base::zeroMemory(&params, sizeof(params));
+		params.flags = IORING_SETUP_CLAMP;
+		int fd = (int)(::syscall(__NR_io_uring_setup, nEntries, &params));
+		if (fd < 0) {
+			return sl_null;
+		}
+		sl_uint32 featuresRequired = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+		if ((params.features & featuresRequired) != featuresRequired) {
+			::close(fd);
+			return sl_null;
+		}
+		_priv_IoUring* ring = new _priv_IoUring;
+		if (!ring) {
+			::close(fd);
+			return sl_null;
+		}
+		ring->fd = fd;
+#if defined(IORING_FEAT_RSRC_TAGS)
+		// on the older kernels, registering waits until all the pending requests (including the polls) are completed
+		ring->flagSupportRegisterBuffer = (params.features & IORING_FEAT_RSRC_TAGS) != 0;
+#endif
+		sl_size sizeSq = params.sq_off.array + params.sq_entries * sizeof(sl_uint32);
+		sl_size sizeCq = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		ring->sizeSqRing = SLIB_MAX(sizeSq, sizeCq);
+		ring->ptrSqRing = ::mmap(sl_null, ring->sizeSqRing, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (ring->ptrSqRing == MAP_FAILED) {
+			delete ring;
+			return sl_null;
+		}
+		ring->ptrCqRing = ring->ptrSqRing;
+		ring->sizeCqRing = ring->sizeSqRing;
+		ring->sizeSqes = params.sq_entries * sizeof(io_uring_sqe);
+		ring->sqes = (io_uring_sqe*)(::mmap(sl_null, ring->sizeSqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+		if (ring->sqes == MAP_FAILED) {
+			delete ring;
+			return sl_null;
+		}
+		sl_uint8* sq = (sl_uint8*)(ring->ptrSqRing);
+		ring->sqHead = (sl_uint32*)(sq + params.sq_off.head);
+		ring->sqTail = (sl_uint32*)(sq + params.sq_off.tail);
+		ring->sqMask = *((sl_uint32*)(sq + params.sq_off.ring_mask));
+		ring->sqEntries = params.sq_entries;
+		sl_uint32* sqArray = (sl_uint32*)(sq + params.sq_off.array);
+		for (sl_uint32 i = 0; i < params.sq_entries; i++) {
+			sqArray[i] = i;
+		}
+		sl_uint8* cq = (sl_uint8*)(ring->ptrCqRing);
+		ring->cqHead = (sl_uint32*)(cq + params.cq_off.head);
+		ring->cqTail = (sl_uint32*)(cq + params.cq_off.tail);
+		ring->cqMask = *((sl_uint32*)(cq + params.cq_off.ring_mask));
+		ring->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+		return ring;
+	}
+
+	io_uring_sqe* _priv_IoUring::getSqe()
+	{
+		sl_uint32 tail = *sqTail;
+		if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+			// ring is full
+			if (nPending) {
+				int n = (int)(::syscall(__NR_io_uring_enter, fd, nPending, 0, 0, sl_null, 0));
+				if (n > 0) {
+					nPending -= (sl_uint32)n;
+				}
+			}
+			if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+				return sl_null;
+			}
+		}
+		io_uring_sqe* sqe = sqes + (tail & sqMask);
+		Base::zeroMemory(sqe, sizeof(io_uring_sqe));
+		return sqe;
+	}
+
+	void _priv_IoUring::pushSqe()
+	{
+		__atomic_store_n(sqTail, *sqTail + 1, __ATOMIC_RELEASE);
+		nPending++;
+	}
+
+	sl_int32 _priv_IoUring::submit(sl_int32 timeout)
+	{
+		sl_uint32 nSubmit;
+		{
+			MutexLocker locker(&lock);
+			nSubmit = nPending;
+			nPending = 0;
+		}
+		if (!timeout) {
+			if (!nSubmit) {
+				return 0;
+			}
+			int n = (int)(::syscall(__NR_io_uring_enter, fd, nSubmit, 0, 0, sl_null, 0));
+			if (n >= 0 && (sl_uint32)n < nSubmit) {
+				MutexLocker locker(&lock);
+				nPending += nSubmit - (sl_uint32)n;
+			}
+			return n;
+		}
+		io_uring_getevents_arg arg;
+		Base::zeroMemory(&arg, sizeof(arg));
+		__kernel_timespec ts;
+		if (timeout > 0) {
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = (timeout % 1000) * 1000000;
+			arg.ts = (sl_uint64)(sl_size)&ts;
+		}
+		int n = (int)(::syscall(__NR_io_uring_enter, fd, nSubmit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)));
+		if (n < 0) {
+			if (nSubmit) {
+				MutexLocker locker(&lock);
+				nPending += nSubmit;
+			}
+		} else if ((sl_uint32)n < nSubmit) {
+			MutexLocker locker(&lock);
+			nPending += nSubmit - (sl_uint32)n;
+		}
+		return n;
+	}
+
+	sl_bool _priv_IoUring::popCqe(io_uring_cqe& cqe)
+	{
+		sl_uint32 head = *cqHead;
+		if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+			return sl_false;
+		}
+		cqe = cqes[head & cqMask];
+		__atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addPoll(int fdTarget, sl_uint32 events, sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = fdTarget;
+		sqe->len = IORING_POLL_ADD_MULTI;
+#if defined(SLIB_ARCH_IS_BIG_ENDIAN)
+		events = (events << 16) | (events >> 16);
+#endif
+		sqe->poll32_events = events;
+		sqe->user_data = userData;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::removePoll(sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = IORING_OP_POLL_REMOVE;
+		sqe->fd = -1;
+		sqe->addr = userData;
+		sqe->user_data = PRIV_IO_URING_TAG_IGNORE;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addReadWrite(sl_bool flagRead, int fdTarget, const void* buf, sl_uint32 size, sl_uint64 offset, sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = flagRead ? IORING_OP_READ : IORING_OP_WRITE;
+		sqe->fd = fdTarget;
+		sqe->addr = (sl_uint64)(sl_size)buf;
+		sqe->len = size;
+		sqe->off = offset;
+		sqe->user_data = userData;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addReceive(int fdTarget, void* buf, sl_uint32 size, sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sl_uint8* p = (sl_uint8*)buf;
+		if (bufferRegistered && p >= bufferRegistered && p + size <= bufferRegistered + sizeBufferRegistered) {
+			// `read` on the socket, with the offset of the stream (zero)
+			sqe->opcode = IORING_OP_READ_FIXED;
+			sqe->buf_index = 0;
+		} else {
+			sqe->opcode = IORING_OP_RECV;
+		}
+		sqe->fd = fdTarget;
+		sqe->addr = (sl_uint64)(sl_size)buf;
+		sqe->len = size;
+		sqe->user_data = userData;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addSend(int fdTarget, const void* buf, sl_uint32 size, sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		// not `IORING_OP_WRITE_FIXED`: `write` on the socket raises SIGPIPE when the peer is closed
+		sqe->opcode = IORING_OP_SEND;
+		sqe->fd = fdTarget;
+		sqe->addr = (sl_uint64)(sl_size)buf;
+		sqe->len = size;
+		sqe->msg_flags = MSG_NOSIGNAL;
+		sqe->user_data = userData;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addPollOnce(int fdTarget, sl_uint32 events, sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = fdTarget;
+#if defined(SLIB_ARCH_IS_BIG_ENDIAN)
+		events = (events << 16) | (events >> 16);
+#endif
+		sqe->poll32_events = events;
+		sqe->user_data = userData;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::addCancel(sl_uint64 userData)
+	{
+		MutexLocker locker(&lock);
+		io_uring_sqe* sqe = getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = userData;
+		sqe->user_data = PRIV_IO_URING_TAG_IGNORE;
+		pushSqe();
+		return sl_true;
+	}
+
+	sl_bool _priv_IoUring::registerBuffer(const void* buf, sl_size size)
+	{
+		if (!flagSupportRegisterBuffer) {
+			return sl_false;
+		}
+		MutexLocker locker(&lock);
+		if (bufferRegistered) {
+			return sl_false;
+		}
+		iovec iov;
+		iov.iov_base = (void*)buf;
+		iov.iov_len = size;
+		// fails when the size exceeds RLIMIT_MEMLOCK
+		if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+			return sl_false;
+		}
+		bufferRegistered = (const sl_uint8*)buf;
+		sizeBufferRegistered = size;
+		return sl_true;
+	}
+
+
+	class _priv_IoUringFileInstance : public AsyncStreamInstance
+	{
+	public:
+		Ref<File> m_file;
+		Ref<AsyncStreamRequest> m_requestOperating;
+		sl_uint64 m_offset;
+
+	public:
+		_priv_IoUringFileInstance()
+		{
+			m_offset = 0;
+		}
+
+		~_priv_IoUringFileInstance()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_priv_IoUringFileInstance> open(const String& path, FileMode mode)
+		{
+			Ref<File> file = File::open(path, mode);
+			if (file.isNotNull()) {
+				Ref<_priv_IoUringFileInstance> ret = new _priv_IoUringFileInstance;
+				if (ret.isNotNull()) {
+					ret->m_file = file;
+					ret->setHandle(file->getHandle());
+					if (mode & FileMode::SeekToEnd) {
+						ret->m_offset = file->getSize();
+					}
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+		static sl_bool isSupported(AsyncIoLoop* loop)
+		{
+			return loop->_native_getIoUring() != sl_null;
+		}
+
+		void close() override
+		{
+			Ref<File> file = m_file;
+			if (file.isNotNull()) {
+				file->close();
+			}
+			setHandle(SLIB_FILE_INVALID_HANDLE);
+		}
+
+		void onOrder() override
+		{
+			sl_file handle = getHandle();
+			if (handle == SLIB_FILE_INVALID_HANDLE) {
+				return;
+			}
+			if (m_requestOperating.isNotNull()) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req;
+			if (popReadRequest(req)) {
+				if (req.isNotNull()) {
+					if (req->data && req->size) {
+						_submit(req, sl_true);
+					} else {
+						_runCallback(req.get(), 0, sl_false);
+					}
+				}
+			} else if (popWriteRequest(req)) {
+				if (req.isNotNull()) {
+					if (req->data && req->size) {
+						_submit(req, sl_false);
+					} else {
+						_runCallback(req.get(), 0, sl_false);
+					}
+				}
+			}
+		}
+
+		void onEvent(EventDesc* pev) override
+		{
+			Ref<AsyncStreamRequest> req = m_requestOperating;
+			m_requestOperating.setNull();
+			sl_int32 result = pev->completionResult;
+			if (req.isNotNull()) {
+				if (result > 0) {
+					m_offset += result;
+					_runCallback(req.get(), (sl_uint32)result, sl_false);
+				} else {
+					_runCallback(req.get(), 0, sl_true);
+				}
+			}
+			requestOrder();
+		}
+
+		sl_bool isSeekable() override
+		{
+			return sl_true;
+		}
+
+		sl_bool seek(sl_uint64 pos) override
+		{
+			m_offset = pos;
+			return sl_true;
+		}
+
+		sl_uint64 getSize() override
+		{
+			return File::getSize(getHandle());
+		}
+
+	private:
+		void _submit(const Ref<AsyncStreamRequest>& req, sl_bool flagRead)
+		{
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNotNull()) {
+				_priv_IoUring* ring = (_priv_IoUring*)(loop->_native_getIoUring());
+				if (ring) {
+					m_requestOperating = req;
+					// released on the completion
+					increaseReference();
+					if (ring->addReadWrite(flagRead, (int)(getHandle()), req->data, req->size, m_offset, (sl_uint64)(sl_size)this | (flagRead ? PRIV_IO_URING_TAG_READ : PRIV_IO_URING_TAG_WRITE))) {
+						loop->_submitIoUring();
+						return;
+					}
+					decreaseReference();
+					m_requestOperating.setNull();
+				}
+			}
+			_runCallback(req.get(), 0, sl_true);
+		}
+
+		void _runCallback(AsyncStreamRequest* req, sl_uint32 size, sl_bool flagError)
+		{
+			Ref<AsyncIoObject> object = getObject();
+			if (object.isNotNull()) {
+				req->runCallback(static_cast<AsyncStream*>(object.get()), size, flagError);
+			}
+		}
+
+	};
+
+#endif
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+		if (loop.isNull()) {
+			return sl_null;
+		}
+#if defined(ASYNC_USE_IO_URING)
+		if (_priv_IoUringFileInstance::isSupported(loop.get())) {
+			Ref<_priv_IoUringFileInstance> instance = _priv_IoUringFileInstance::open(path, mode);
+			if (instance.isNotNull()) {
+				return AsyncStream::create(instance.get(), AsyncIoMode::None, loop);
+			}
+			return sl_null;
+		}
+#endif
+		return AsyncFile::open(path, mode);
+	}
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode)
+	{
+		return AsyncFile::openIoUring(path, mode, AsyncIoLoop::getDefault());
+	}
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_ASYNC_URING
+#define CHECKHEADER_SLIB_CORE_ASYNC_URING
+
+#include "async_config.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "slib/core/mutex.h"
+
+/*
+	Tags stored in the low bits of `user_data` of the submission entries
+	(the pointers of the instances are aligned at least by 8 bytes)
+*/
+#define PRIV_IO_URING_TAG_POLL 0
+#define PRIV_IO_URING_TAG_READ 1
+#define PRIV_IO_URING_TAG_WRITE 2
+#define PRIV_IO_URING_TAG_IGNORE 3
+#define PRIV_IO_URING_TAG_MASK 7
+
+namespace slib
+{
+
+	// Minimal io_uring ring on the raw system calls
+	class _priv_IoUring
+	{
+	public:
+		int fd;
+
+		sl_uint32* sqHead;
+		sl_uint32* sqTail;
+		sl_uint32 sqMask;
+		sl_uint32 sqEntries;
+		io_uring_sqe* sqes;
+
+		sl_uint32* cqHead;
+		sl_uint32* cqTail;
+		sl_uint32 cqMask;
+		io_uring_cqe* cqes;
+
+		void* ptrSqRing;
+		sl_size sizeSqRing;
+		void* ptrCqRing;
+		sl_size sizeCqRing;
+		sl_size sizeSqes;
+
+		Mutex lock;
+		sl_uint32 nPending; // entries queued to the ring, but not submitted to the kernel
+
+		sl_bool flagSupportRegisterBuffer; // registering does not wait for the pending requests (IORING_FEAT_RSRC_TAGS)
+		const sl_uint8* bufferRegistered; // protected by `lock`
+		sl_size sizeBufferRegistered;
+
+	public:
+		_priv_IoUring();
+
+		~_priv_IoUring();
+
+	public:
+		// returns null when io_uring (or a required feature: multi-shot poll, extended wait arguments) is not supported by the kernel
+		static _priv_IoUring* create(sl_uint32 nEntries);
+
+	public:
+		// call with `lock` locked. fills zeros, and returns null only when the kernel fails to consume the ring
+		io_uring_sqe* getSqe();
+
+		// call with `lock` locked
+		void pushSqe();
+
+		// submits the pending entries, and waits for at least one completion when `timeout` is not zero (-1: infinite)
+		sl_int32 submit(sl_int32 timeout);
+
+		// called from the loop thread only
+		sl_bool popCqe(io_uring_cqe& cqe);
+
+		// queues the entries
+		sl_bool addPoll(int fd, sl_uint32 events, sl_uint64 userData);
+
+		sl_bool removePoll(sl_uint64 userData);
+
+		sl_bool addReadWrite(sl_bool flagRead, int fd, const void* buf, sl_uint32 size, sl_uint64 offset, sl_uint64 userData);
+
+		// receives into the registered buffer by `IORING_OP_READ_FIXED`, otherwise by `IORING_OP_RECV`
+		sl_bool addReceive(int fd, void* buf, sl_uint32 size, sl_uint64 userData);
+
+		sl_bool addSend(int fd, const void* buf, sl_uint32 size, sl_uint64 userData);
+
+		// single-shot poll
+		sl_bool addPollOnce(int fd, sl_uint32 events, sl_uint64 userData);
+
+		// cancels the request having `userData`
+		sl_bool addCancel(sl_uint64 userData);
+
+		// one buffer per ring, kept until the ring is closed
+		sl_bool registerBuffer(const void* buf, sl_size size);
+
+	};
+
+}
+
+#endif
+
+#endif
@@ -24,6 +24,7 @@
 
 #include "slib/core/system.h"
 #include "slib/core/math.h"
+#include "slib/core/slab_allocator.h"
 
 #if !defined(SLIB_PLATFORM_IS_APPLE)
 #include <malloc.h>
@@ -61,16 +62,36 @@ namespace slib
 
 	void* Base::createMemory(sl_size size) noexcept
 	{
+		void* ptr = SlabAllocator::allocate(size);
+		if (ptr) {
+			return ptr;
+		}
 		return ::malloc(size);
 	}
 
 	void Base::freeMemory(void* ptr) noexcept
 	{
-		::free(ptr);
+		if (SlabAllocator::contains(ptr)) {
+			SlabAllocator::free(ptr);
+		} else {
+			::free(ptr);
+		}
 	}
 
 	void* Base::reallocMemory(void* ptr, sl_size sizeNew) noexcept
 	{
+		if (SlabAllocator::contains(ptr)) {
+			sl_size size = SlabAllocator::getBlockSize(ptr);
+			if (sizeNew && sizeNew <= size) {
+				return ptr;
+			}
+			void* ptrNew = createMemory(sizeNew ? sizeNew : 1);
+			if (ptrNew) {
+				::memcpy(ptrNew, ptr, sizeNew < size ? sizeNew : size);
+				SlabAllocator::free(ptr);
+			}
+			return ptrNew;
+		}
 		if (sizeNew == 0) {
 			::free(ptr);
 			return ::malloc(1);
@@ -81,7 +102,7 @@ namespace slib
 
 	void* Base::createZeroMemory(sl_size size) noexcept
 	{
-		void* ptr = ::malloc(size);
+		void* ptr = createMemory(size);
 		if (ptr) {
 			::memset(ptr, 0, size);
 		}
@@ -46,16 +46,26 @@ namespace slib
 	}
 
 	sl_bool Dispatch::setTimeout(const Ref<DispatchLoop>& loop, const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		return Dispatch::addTimeout(loop, task, delay_ms).isNotNull();
+	}
+
+	sl_bool Dispatch::setTimeout(const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		return Dispatch::addTimeout(DispatchLoop::getDefault(), task, delay_ms).isNotNull();
+	}
+
+	TimerHandle Dispatch::addTimeout(const Ref<DispatchLoop>& loop, const Function<void()>& task, sl_uint64 delay_ms)
 	{
 		if (loop.isNotNull()) {
-			return loop->dispatch(task, delay_ms);
+			return loop->addTimeout(task, delay_ms);
 		}
-		return sl_false;
+		return sl_null;
 	}
 
-	sl_bool Dispatch::setTimeout(const Function<void()>& task, sl_uint64 delay_ms)
+	TimerHandle Dispatch::addTimeout(const Function<void()>& task, sl_uint64 delay_ms)
 	{
-		return Dispatch::setTimeout(DispatchLoop::getDefault(), task, delay_ms);
+		return Dispatch::addTimeout(DispatchLoop::getDefault(), task, delay_ms);
 	}
 
 	Ref<Timer> Dispatch::setInterval(const Ref<DispatchLoop>& loop, const Function<void(Timer*)>& task, sl_uint64 interval_ms)
@@ -96,6 +106,7 @@ namespace slib
 	{
 		m_flagInit = sl_false;
 		m_flagRunning = sl_false;
+		m_timers.setWakeCallback(SLIB_FUNCTION_CLASS(DispatchLoop, _wake, this));
 	}
 
 	DispatchLoop::~DispatchLoop()
@@ -151,9 +162,7 @@ namespace slib
 		}
 
 		m_queueTasks.removeAll();
-		
-		MutexLocker lockTime(&m_lockTimeTasks);
-		m_timeTasks.removeAll();
+		m_timers.cancelAll();
 	}
 
 	void DispatchLoop::start()
@@ -188,20 +197,16 @@ namespace slib
 	sl_int32 DispatchLoop::_getTimeout()
 	{
 		m_timeCounter.update();
-		sl_int32 t1 = _getTimeout_TimeTasks();
-		sl_int32 t2 = _getTimeout_Timer();
+		LinkedQueue< Function<void()> > tasks;
+		sl_int32 timeout = m_timers.pollExpired(tasks);
+		Function<void()> task;
+		while (tasks.pop_NoLock(&task)) {
+			task();
+		}
 		if (m_queueTasks.isNotEmpty()) {
 			return 0;
 		}
-		if (t1 < 0) {
-			return t2;
-		} else {
-			if (t2 < 0) {
-				return t1;
-			} else {
-				return SLIB_MIN(t1, t2);
-			}
-		}
+		return timeout;
 	}
 
 	sl_bool DispatchLoop::dispatch(const Function<void()>& task, sl_uint64 delay_ms)
@@ -210,97 +215,29 @@ namespace slib
 			return sl_false;
 		}
 		if (delay_ms == 0) {
-			if (m_queueTasks.push(task)) {
-				_wake();
-				return sl_true;
-			}
-		} else {
-			MutexLocker lock(&m_lockTimeTasks);
-			TimeTask tt;
-			tt.time = getElapsedMilliseconds() + delay_ms;
-			tt.task = task;
-			if (m_timeTasks.add(tt.time, tt)) {
-				_wake();
-				return sl_true;
-			}
+			return addTask(UniqueFunction<void()>(task));
 		}
-		return sl_false;
+		return addTimeout(task, delay_ms).isNotNull();
 	}
 
-	sl_int32 DispatchLoop::_getTimeout_TimeTasks()
+	sl_bool DispatchLoop::addTask(UniqueFunction<void()>&& task)
 	{
-		MutexLocker lock(&m_lockTimeTasks);
-		sl_uint64 rel = getElapsedMilliseconds();
-		if (m_timeTasks.getCount() == 0) {
-			return -1;
-		}
-		sl_int32 timeout = -1;
-		LinkedQueue< Function<void()> > tasks;
-		while (MapNode<sl_uint64, TimeTask>* node = m_timeTasks.getFirstNode()) {
-			if (rel >= node->key) {
-				tasks.push(node->value.task);
-				m_timeTasks.removeAt(node);
-			} else {
-				timeout = (sl_int32)(node->key - rel);
-				break;
-			}
+		if (task.isNull()) {
+			return sl_false;
 		}
-		lock.unlock();
-
-		Function<void()> task;
-		while (tasks.pop(&task)) {
-			task();
+		if (m_queueTasks.push(Move(task))) {
+			_wake();
+			return sl_true;
 		}
-		return timeout;
+		return sl_false;
 	}
 
-	sl_int32 DispatchLoop::_getTimeout_Timer()
+	TimerHandle DispatchLoop::addTimeout(const Function<void()>& task, sl_uint64 delay_ms)
 	{
-		MutexLocker lock(&m_lockTimer);
-
-		sl_int32 timeout = -1;
-		LinkedQueue< Ref<Timer> > tasks;
-
-		sl_uint64 rel = getElapsedMilliseconds();
-		Link<TimerTask>* link = m_queueTimers.getFront();
-		while (link) {
-			Ref<Timer> timer(link->value.timer);
-			if (timer.isNotNull()) {
-				if (timer->isStarted()) {
-					sl_uint64 t = rel - timer->getLastRunTime();
-					if (t >= timer->getInterval()) {
-						tasks.push(timer);
-						timer->setLastRunTime(rel);
-						t = timer->getInterval();
-					} else {
-						t = timer->getInterval() - t;
-					}
-					if (timeout < 0 || t < (sl_uint64)timeout) {
-						timeout = (sl_uint32)t;
-					}
-				}
-				link = link->next;
-			} else {
-				Link<TimerTask>* linkRemove = link;
-				link = link->next;
-				m_queueTimers.removeAt(linkRemove);
-			}
-		}
-
-		lock.unlock();
-
-		Ref<Timer> task;
-		while (tasks.pop(&task)) {
-			if (task.isNotNull()) {
-				task->run();
-			}
+		if (!m_flagInit) {
+			return sl_null;
 		}
-		return timeout;
-	}
-
-	sl_bool DispatchLoop::TimerTask::operator==(const DispatchLoop::TimerTask& other) const
-	{
-		return timer == other.timer;
+		return m_timers.add(task, delay_ms);
 	}
 
 	sl_bool DispatchLoop::addTimer(const Ref<Timer>& timer)
@@ -308,23 +245,57 @@ namespace slib
 		if (timer.isNull()) {
 			return sl_false;
 		}
-		TimerTask t;
-		t.timer = timer;
-		MutexLocker lock(&m_lockTimer);
-		if (m_queueTimers.push(t)) {
-			_wake();
-			return sl_true;
-		} else {
+		ObjectLocker lock(this);
+		Ref<TimerWheelEntry> entry = m_timers.add(SLIB_BIND_WEAKREF(void(), DispatchLoop, _runTimer, this, WeakRef<Timer>(timer)), timer->getInterval());
+		if (entry.isNull()) {
 			return sl_false;
 		}
+		Ref<TimerWheelEntry> old = timer->m_entryLoop;
+		timer->m_entryLoop = entry;
+		if (old.isNotNull()) {
+			m_timers.cancel(old.get());
+		}
+		return sl_true;
 	}
 
 	void DispatchLoop::removeTimer(const Ref<Timer>& timer)
 	{
-		MutexLocker lock(&m_lockTimer);
-		TimerTask t;
-		t.timer = timer;
-		m_queueTimers.remove(t);
+		if (timer.isNull()) {
+			return;
+		}
+		ObjectLocker lock(this);
+		Ref<TimerWheelEntry> entry = timer->m_entryLoop;
+		if (entry.isNotNull()) {
+			timer->m_entryLoop.setNull();
+			m_timers.cancel(entry.get());
+		}
+	}
+
+	void DispatchLoop::_runTimer(const WeakRef<Timer>& _timer)
+	{
+		Ref<Timer> timer(_timer);
+		if (timer.isNull()) {
+			return;
+		}
+		{
+			// checked under the lock of `removeTimer`, because the expired entry would be revived by `schedule` after it is removed
+			ObjectLocker lock(this);
+			if (!(timer->isStarted())) {
+				return;
+			}
+			Ref<TimerWheelEntry> entry = timer->m_entryLoop;
+			if (entry.isNull()) {
+				return;
+			}
+			if (entry->isPending()) {
+				// expired entry of the timer which was restarted after removed
+				return;
+			}
+			// the next run is scheduled before running the task, to keep the interval regardless of the running time
+			m_timers.schedule(entry.get(), timer->getInterval());
+		}
+		timer->setLastRunTime(getElapsedMilliseconds());
+		timer->run();
 	}
 
 	sl_uint64 DispatchLoop::getElapsedMilliseconds()
@@ -338,9 +309,9 @@ namespace slib
 
 			// Async Tasks
 			{
-				LinkedQueue< Function<void()> > tasks;
-				tasks.merge(&m_queueTasks);
-				Function<void()> task;
+				TaskQueue& tasks = m_queueTasksRunning;
+				m_queueTasks.swap(tasks);
+				UniqueFunction<void()> task;
 				while (tasks.pop_NoLock(&task)) {
 					task();
 				}
@@ -0,0 +1,367 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/core/hazard_pointer.h"
+
+#include "slib/core/spin_lock.h"
+#include "slib/core/system.h"
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#define USE_CPP_ATOMIC
+#endif
+
+#if defined(USE_CPP_ATOMIC)
+#include <atomic>
+#endif
+
+#define HAZARD_SLOT_COUNT 256
+#define HAZARD_RETIRE_COUNT 32
+// number of the retired pointers which triggers a scan of the slots
+#define HAZARD_RECLAIM_THRESHOLD 8
+
+namespace slib
+{
+
+	SLIB_INLINE static void* _priv_HazardPointer_load(void* const volatile* ptr)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<void*>*)(ptr))->load();
+#else
+		return __atomic_load_n((void**)ptr, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _priv_HazardPointer_store(void* volatile* ptr, void* value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<void*>*)(ptr))->store(value);
+#else
+		__atomic_store_n((void**)ptr, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _priv_HazardPointer_release(void* volatile* ptr)
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<void*>*)(ptr))->store(sl_null, std::memory_order_release);
+#else
+		__atomic_store_n((void**)ptr, sl_null, __ATOMIC_RELEASE);
+#endif
+	}
+
+	SLIB_INLINE static void* _priv_HazardPointer_exchange(void* volatile* ptr, void* value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<void*>*)(ptr))->exchange(value);
+#else
+		return __atomic_exchange_n((void**)ptr, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _priv_HazardPointer_loadCount(sl_uint32 volatile* count)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<sl_uint32>*)(count))->load();
+#else
+		return __atomic_load_n((sl_uint32*)count, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static sl_bool _priv_HazardPointer_compareExchangeCount(sl_uint32 volatile* count, sl_uint32 expected, sl_uint32 value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<sl_uint32>*)(count))->compare_exchange_strong(expected, value);
+#else
+		return __atomic_compare_exchange_n((sl_uint32*)count, &expected, value, sl_false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	// a cache line for each slot, so that the readers don't invalidate the slots of other threads
+	struct _priv_HazardSlot
+	{
+		void* volatile ptr;
+		sl_uint32 volatile flagUsed;
+		char padding[64 - sizeof(void*) - sizeof(sl_uint32)];
+	};
+
+	static _priv_HazardSlot _g_hazardSlots[HAZARD_SLOT_COUNT];
+	// number of the slots scanned by the writers
+	static sl_uint32 volatile _g_hazardSlotsCount = 0;
+
+	// the threads without slots hold this lock while increasing the reference count
+	static SpinLock _g_hazardLockOverflow;
+	static sl_uint32 volatile _g_hazardFlagOverflow = 0;
+
+	SLIB_INLINE static void _priv_HazardPointer_setOverflow()
+	{
+		if (!(_priv_HazardPointer_loadCount(&_g_hazardFlagOverflow))) {
+			_priv_HazardPointer_compareExchangeCount(&_g_hazardFlagOverflow, 0, 1);
+		}
+	}
+
+	struct _priv_HazardRetired
+	{
+		void* ptr;
+		HazardPointer::Releaser release;
+	};
+
+	// collects the pointers announced by the slots, returns the number of the pointers
+	static sl_uint32 _priv_HazardPointer_collectAnnounced(void** announced)
+	{
+		sl_uint32 nAnnounced = 0;
+		sl_uint32 n = _priv_HazardPointer_loadCount(&_g_hazardSlotsCount);
+		for (sl_uint32 i = 0; i < n; i++) {
+			void* ptr = _priv_HazardPointer_load(&(_g_hazardSlots[i].ptr));
+			if (ptr) {
+				announced[nAnnounced++] = ptr;
+			}
+		}
+		return nAnnounced;
+	}
+
+	static sl_bool _priv_HazardPointer_isAnnounced(void** announced, sl_uint32 nAnnounced, void* ptr)
+	{
+		for (sl_uint32 i = 0; i < nAnnounced; i++) {
+			if (announced[i] == ptr) {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	SLIB_INLINE static void _priv_HazardPointer_waitOverflow()
+	{
+		// the threads without slots increase the reference count while holding the lock
+		if (_priv_HazardPointer_loadCount(&_g_hazardFlagOverflow)) {
+			_g_hazardLockOverflow.lock();
+			_g_hazardLockOverflow.unlock();
+		}
+	}
+
+	// used when the retire list is not available: waits until `ptr` is not announced
+	static void _priv_HazardPointer_waitAndRelease(void* ptr, HazardPointer::Releaser release)
+	{
+		sl_uint32 n = _priv_HazardPointer_loadCount(&_g_hazardSlotsCount);
+		for (sl_uint32 i = 0; i < n; i++) {
+			_priv_HazardSlot* slot = _g_hazardSlots + i;
+			sl_uint32 nYield = 0;
+			while (_priv_HazardPointer_load(&(slot->ptr)) == ptr) {
+				System::yield(nYield);
+				nYield++;
+			}
+		}
+		_priv_HazardPointer_waitOverflow();
+		release(ptr);
+	}
+
+	class _priv_HazardSlotHolder
+	{
+	public:
+		_priv_HazardSlot* slot;
+		sl_bool flagNoSlot;
+		sl_bool flagExited;
+		_priv_HazardRetired retired[HAZARD_RETIRE_COUNT];
+		sl_uint32 countRetired;
+		// the slots are scanned when `countRetired` reaches this count
+		sl_uint32 countReclaim;
+
+	public:
+		constexpr _priv_HazardSlotHolder(): slot(sl_null), flagNoSlot(sl_false), flagExited(sl_false), retired(), countRetired(0), countReclaim(HAZARD_RECLAIM_THRESHOLD) {}
+
+		~_priv_HazardSlotHolder()
+		{
+			if (slot) {
+				_priv_HazardPointer_release(&(slot->ptr));
+				_priv_HazardPointer_compareExchangeCount(&(slot->flagUsed), 1, 0);
+				slot = sl_null;
+			}
+			// the objects destructed later on this thread use the overflow lock, and release the replaced pointers by waiting
+			flagNoSlot = sl_true;
+			flagExited = sl_true;
+			while (countRetired) {
+				countRetired--;
+				_priv_HazardRetired& item = retired[countRetired];
+				_priv_HazardPointer_waitAndRelease(item.ptr, item.release);
+			}
+		}
+
+	public:
+		_priv_HazardSlot* get()
+		{
+			if (slot) {
+				return slot;
+			}
+			if (flagNoSlot) {
+				_priv_HazardPointer_setOverflow();
+				return sl_null;
+			}
+			for (sl_uint32 i = 0; i < HAZARD_SLOT_COUNT; i++) {
+				_priv_HazardSlot* p = _g_hazardSlots + i;
+				if (_priv_HazardPointer_compareExchangeCount(&(p->flagUsed), 0, 1)) {
+					// the slot is visible to the writers before it is used
+					sl_uint32 n = _priv_HazardPointer_loadCount(&_g_hazardSlotsCount);
+					while (n <= i && !(_priv_HazardPointer_compareExchangeCount(&_g_hazardSlotsCount, n, i + 1))) {
+						n = _priv_HazardPointer_loadCount(&_g_hazardSlotsCount);
+					}
+					slot = p;
+					return p;
+				}
+			}
+			flagNoSlot = sl_true;
+			_priv_HazardPointer_setOverflow();
+			return sl_null;
+		}
+
+		void retire(void* ptr, HazardPointer::Releaser release)
+		{
+			if (countRetired >= HAZARD_RETIRE_COUNT) {
+				// all the retired pointers are announced: the oldest one is released by waiting
+				_priv_HazardRetired item = retired[0];
+				countRetired--;
+				Base::moveMemory(retired, retired + 1, sizeof(_priv_HazardRetired) * countRetired);
+				_priv_HazardPointer_waitAndRelease(item.ptr, item.release);
+				if (countRetired >= HAZARD_RETIRE_COUNT) {
+					// retired again by the releaser
+					_priv_HazardPointer_waitAndRelease(ptr, release);
+					return;
+				}
+			}
+			retired[countRetired].ptr = ptr;
+			retired[countRetired].release = release;
+			countRetired++;
+		}
+
+		// releases the retired pointers which are not announced, in one scan of the slots
+		void reclaim()
+		{
+			void* announced[HAZARD_SLOT_COUNT];
+			sl_uint32 nAnnounced = _priv_HazardPointer_collectAnnounced(announced);
+			_priv_HazardPointer_waitOverflow();
+			_priv_HazardRetired items[HAZARD_RETIRE_COUNT];
+			sl_uint32 nItems = 0;
+			sl_uint32 nKept = 0;
+			for (sl_uint32 i = 0; i < countRetired; i++) {
+				if (_priv_HazardPointer_isAnnounced(announced, nAnnounced, retired[i].ptr)) {
+					retired[nKept++] = retired[i];
+				} else {
+					items[nItems++] = retired[i];
+				}
+			}
+			countRetired = nKept;
+			// the pointers still announced don't trigger the next scan
+			countReclaim = nKept + HAZARD_RECLAIM_THRESHOLD;
+			if (countReclaim > HAZARD_RETIRE_COUNT) {
+				countReclaim = HAZARD_RETIRE_COUNT;
+			}
+			// the releasers can replace other pointers on this thread
+			for (sl_uint32 i = 0; i < nItems; i++) {
+				items[i].release(items[i].ptr);
+			}
+		}
+
+		// releases all the retired pointers, waiting for the readers still announcing them
+		void reclaimAll()
+		{
+			reclaim();
+			while (countRetired) {
+				countRetired--;
+				_priv_HazardRetired item = retired[countRetired];
+				_priv_HazardPointer_waitAndRelease(item.ptr, item.release);
+			}
+			countReclaim = HAZARD_RECLAIM_THRESHOLD;
+		}
+
+	};
+
+	SLIB_THREAD _priv_HazardSlotHolder _gt_hazardSlotHolder;
+
+	void* HazardPointer::protect(void* const volatile* ptr) noexcept
+	{
+		void* value = _priv_HazardPointer_load(ptr);
+		if (!value) {
+			return sl_null;
+		}
+		_priv_HazardSlot* slot = _gt_hazardSlotHolder.get();
+		if (slot) {
+			for (;;) {
+				_priv_HazardPointer_store(&(slot->ptr), value);
+				// the pointer is still stored after it is announced, so the writer will see the announcement before releasing it
+				void* current = _priv_HazardPointer_load(ptr);
+				if (current == value) {
+					return value;
+				}
+				if (!current) {
+					_priv_HazardPointer_release(&(slot->ptr));
+					return sl_null;
+				}
+				value = current;
+			}
+		} else {
+			_g_hazardLockOverflow.lock();
+			value = _priv_HazardPointer_load(ptr);
+			if (!value) {
+				_g_hazardLockOverflow.unlock();
+			}
+			return value;
+		}
+	}
+
+	void HazardPointer::clear() noexcept
+	{
+		_priv_HazardSlot* slot = _gt_hazardSlotHolder.slot;
+		if (slot) {
+			_priv_HazardPointer_release(&(slot->ptr));
+		} else {
+			_g_hazardLockOverflow.unlock();
+		}
+	}
+
+	void HazardPointer::replace(void* volatile* ptr, const void* value, Releaser release) noexcept
+	{
+		void* before = _priv_HazardPointer_exchange(ptr, (void*)value);
+		_priv_HazardSlotHolder& holder = _gt_hazardSlotHolder;
+		if (holder.flagExited) {
+			if (before) {
+				_priv_HazardPointer_waitAndRelease(before, release);
+			}
+			return;
+		}
+		if (before) {
+			holder.retire(before, release);
+			if (holder.countRetired >= holder.countReclaim) {
+				holder.reclaim();
+			}
+		}
+	}
+
+	void HazardPointer::reclaimAll() noexcept
+	{
+		_priv_HazardSlotHolder& holder = _gt_hazardSlotHolder;
+		if (holder.flagExited) {
+			return;
+		}
+		if (holder.countRetired) {
+			holder.reclaimAll();
+		}
+	}
+
+}
@@ -29,6 +29,19 @@
 
 #include "slib/core/file.h"
 #include "slib/core/log.h"
+#include "slib/core/math.h"
+#include "slib/core/sort.h"
+#include "slib/core/io.h"
+
+#include <stdio.h>
+
+#if defined(SLIB_ARCH_IS_X64) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define PRIV_JSON_USE_SSE2
+#elif defined(SLIB_ARCH_IS_ARM64) && defined(__ARM_NEON)
+#	include <arm_neon.h>
+#	define PRIV_JSON_USE_NEON
+#endif
 
 namespace slib
 {
@@ -329,6 +342,8 @@ namespace slib
 		void escapeSpaceAndComments();
 		
 		Json parseJson();
+		
+		static ST parseString(const CT* buf, sl_size len, sl_size* lengthParsed, sl_bool* flagError);
 
 		static Json parseJson(const CT* buf, sl_size len, JsonParseParam& param);
 		
@@ -356,6 +371,254 @@ namespace slib
 		strFalse = _false;
 	}
 
+	// returns the first quote or backslash in [p, end), or `end` if not found
+	static const sl_char8* _priv_Json_findQuoteOrBackslash(const sl_char8* p, const sl_char8* end, sl_char8 quote)
+	{
+#if defined(PRIV_JSON_USE_SSE2)
+		__m128i vQuote = _mm_set1_epi8(quote);
+		__m128i vBackslash = _mm_set1_epi8('\\');
+		while (p + 16 <= end) {
+			__m128i v = _mm_loadu_si128((const __m128i*)p);
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vQuote), _mm_cmpeq_epi8(v, vBackslash))));
+			if (mask) {
+				return p + Math::getLeastSignificantBits(mask);
+			}
+			p += 16;
+		}
+#elif defined(PRIV_JSON_USE_NEON)
+		uint8x16_t vQuote = vdupq_n_u8((sl_uint8)quote);
+		uint8x16_t vBackslash = vdupq_n_u8('\\');
+		while (p + 16 <= end) {
+			uint8x16_t v = vld1q_u8((const sl_uint8*)p);
+			if (vmaxvq_u8(vorrq_u8(vceqq_u8(v, vQuote), vceqq_u8(v, vBackslash)))) {
+				break;
+			}
+			p += 16;
+		}
+#endif
+		while (p < end) {
+			sl_char8 ch = *p;
+			if (ch == quote || ch == '\\') {
+				return p;
+			}
+			p++;
+		}
+		return end;
+	}
+	
+	/*
+		`str` starts with the opening quote.
+		Returns the length of the string literal including the quotes, or 0 if the closing quote is missing.
+	*/
+	static sl_size _priv_Json_scanString(const sl_char8* str, sl_size len, sl_bool& flagEscapes)
+	{
+		flagEscapes = sl_false;
+		sl_char8 quote = str[0];
+		const sl_char8* end = str + len;
+		const sl_char8* p = str + 1;
+		for (;;) {
+			p = _priv_Json_findQuoteOrBackslash(p, end, quote);
+			if (p == end) {
+				return 0;
+			}
+			if (*p == quote) {
+				return p + 1 - str;
+			}
+			flagEscapes = sl_true;
+			if (end - p <= 2) {
+				return 0;
+			}
+			p += 2;
+		}
+	}
+	
+	static sl_bool _priv_Json_parseHex4(const sl_char8* p, const sl_char8* end, sl_uint32& value)
+	{
+		if (end - p < 4) {
+			return sl_false;
+		}
+		sl_uint32 t = 0;
+		for (int k = 0; k < 4; k++) {
+			sl_uint32 h = SLIB_CHAR_HEX_TO_INT(p[k]);
+			if (h >= 16) {
+				return sl_false;
+			}
+			t = (t << 4) | h;
+		}
+		value = t;
+		return sl_true;
+	}
+	
+	/*
+		Decodes the escapes of the string literal `str` (`n` bytes including the quotes) into `out`,
+		which should have room for `n - 2` bytes.
+		A surrogate pair is written as one 4-byte UTF-8 sequence, and an unpaired surrogate as U+FFFD.
+		Besides the JSON escapes, `\a`, `\v`, the octal/`\x` byte escapes and `\UXXXXXXXX` are accepted like the other string parsers of SLib.
+		Returns the decoded length, or -1 if an escape is invalid.
+	*/
+	static sl_reg _priv_Json_unescapeString(const sl_char8* str, sl_size n, sl_char8* out)
+	{
+		const sl_char8* p = str + 1;
+		const sl_char8* end = str + n - 1;
+		sl_char8* q = out;
+		for (;;) {
+			const sl_char8* s = (const sl_char8*)(Base::findMemory(p, '\\', end - p));
+			if (!s) {
+				s = end;
+			}
+			if (s > p) {
+				Base::copyMemory(q, p, s - p);
+				q += s - p;
+				p = s;
+			}
+			if (p + 1 >= end) {
+				break;
+			}
+			sl_char8 ch = p[1];
+			p += 2;
+			switch (ch) {
+				case '"':
+				case '\'':
+				case '\\':
+				case '/':
+					*(q++) = ch;
+					break;
+				case 'b':
+					*(q++) = '\b';
+					break;
+				case 'f':
+					*(q++) = '\f';
+					break;
+				case 'n':
+					*(q++) = '\n';
+					break;
+				case 'r':
+					*(q++) = '\r';
+					break;
+				case 't':
+					*(q++) = '\t';
+					break;
+				case 'a':
+					*(q++) = '\a';
+					break;
+				case 'v':
+					*(q++) = '\v';
+					break;
+				case '0': case '1': case '2': case '3':
+				case '4': case '5': case '6': case '7':
+				{
+					// octal escape of one byte, as accepted by `ParseUtil::parseBackslashEscapes`
+					sl_uint32 t = ch - '0';
+					for (int k = 0; k < 2 && p < end && *p >= '0' && *p < '8'; k++) {
+						t = (t << 3) | (*p - '0');
+						p++;
+					}
+					*(q++) = (sl_char8)t;
+					break;
+				}
+				case 'x':
+				{
+					sl_uint32 t = 0;
+					int k = 0;
+					for (; k < 2 && p < end; k++) {
+						sl_uint32 h = SLIB_CHAR_HEX_TO_INT(*p);
+						if (h >= 16) {
+							break;
+						}
+						t = (t << 4) | h;
+						p++;
+					}
+					if (!k) {
+						return -1;
+					}
+					*(q++) = (sl_char8)t;
+					break;
+				}
+				case 'U':
+				{
+					sl_uint32 high, low;
+					if (!(_priv_Json_parseHex4(p, end, high) && _priv_Json_parseHex4(p + 4, end, low))) {
+						return -1;
+					}
+					p += 8;
+					sl_char32 c = (sl_char32)((high << 16) | low);
+					if (c > 0x10FFFF) {
+						return -1;
+					}
+					q += Charsets::utf32ToUtf8(&c, 1, q, 4);
+					break;
+				}
+				case 'u':
+				{
+					sl_uint32 code;
+					if (!(_priv_Json_parseHex4(p, end, code))) {
+						return -1;
+					}
+					p += 4;
+					if (code >= 0xD800 && code < 0xDC00) {
+						sl_uint32 low;
+						if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && _priv_Json_parseHex4(p + 2, end, low) && low >= 0xDC00 && low < 0xE000) {
+							code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+							p += 6;
+						} else {
+							code = 0xFFFD;
+						}
+					} else if (code >= 0xDC00 && code < 0xE000) {
+						code = 0xFFFD;
+					}
+					sl_char32 c = (sl_char32)code;
+					q += Charsets::utf32ToUtf8(&c, 1, q, 4);
+					break;
+				}
+				default:
+					return -1;
+			}
+		}
+		return q - out;
+	}
+	
+	template <class ST, class CT>
+	ST _priv_Json_Parser<ST, CT>::parseString(const CT* buf, sl_size len, sl_size* lengthParsed, sl_bool* flagError)
+	{
+		return ParseUtil::parseBackslashEscapes(buf, len, lengthParsed, flagError);
+	}
+	
+	template <>
+	String _priv_Json_Parser<String, sl_char8>::parseString(const sl_char8* buf, sl_size len, sl_size* lengthParsed, sl_bool* flagError)
+	{
+		sl_bool flagEscapes;
+		sl_size n = _priv_Json_scanString(buf, len, flagEscapes);
+		if (!n) {
+			*lengthParsed = 0;
+			*flagError = sl_true;
+			return sl_null;
+		}
+		if (flagEscapes) {
+			// the decoded string is never longer than the literal
+			String ret = String::allocate(n - 2);
+			if (ret.isNull()) {
+				*lengthParsed = 0;
+				*flagError = sl_true;
+				return sl_null;
+			}
+			sl_char8* data = ret.getData();
+			sl_reg m = _priv_Json_unescapeString(buf, n, data);
+			if (m < 0) {
+				*lengthParsed = 0;
+				*flagError = sl_true;
+				return sl_null;
+			}
+			data[m] = 0;
+			ret.setLength(m);
+			*lengthParsed = n;
+			*flagError = sl_false;
+			return ret;
+		}
+		*lengthParsed = n;
+		*flagError = sl_false;
+		return String(buf + 1, n - 2);
+	}
+
 	template <class ST, class CT>
 	void _priv_Json_Parser<ST, CT>::escapeSpaceAndComments()
 	{
@@ -412,7 +675,7 @@ namespace slib
 		if (first == '"' || first == '\'') {
 			sl_size m = 0;
 			sl_bool f = sl_false;
-			ST str = ParseUtil::parseBackslashEscapes(buf + pos, len - pos, &m, &f);
+			ST str = parseString(buf + pos, len - pos, &m, &f);
 			pos += m;
 			if (f) {
 				flagError = sl_true;
@@ -521,7 +784,7 @@ namespace slib
 				} else if (ch == '"' || ch == '\'') {
 					sl_size m = 0;
 					sl_bool f = sl_false;
-					key = ParseUtil::parseBackslashEscapes(buf + pos, len - pos, &m, &f);
+					key = parseString(buf + pos, len - pos, &m, &f);
 					pos += m;
 					if (f) {
 						flagError = sl_true;
@@ -719,14 +982,26 @@ namespace slib
 		return parseJsonFromTextFile(filePath, param);
 	}
 
+	static void _priv_Json_skipUtf8Bom(const sl_char8*& data, sl_size& size)
+	{
+		if (size >= 3 && (sl_uint8)(data[0]) == 0xEF && (sl_uint8)(data[1]) == 0xBB && (sl_uint8)(data[2]) == 0xBF) {
+			data += 3;
+			size -= 3;
+		}
+	}
+
 	Json Json::parseJsonUtf8(const Memory& mem, JsonParseParam& param)
 	{
-		return parseJson((sl_char8*)(mem.getData()), mem.getSize(), param);
+		const sl_char8* data = (const sl_char8*)(mem.getData());
+		sl_size size = mem.getSize();
+		_priv_Json_skipUtf8Bom(data, size);
+		return parseJson(data, size, param);
 	}
 
 	Json Json::parseJsonUtf8(const Memory& mem)
 	{
-		return parseJson((sl_char8*)(mem.getData()), mem.getSize());
+		JsonParseParam param;
+		return parseJsonUtf8(mem, param);
 	}
 
 	Json Json::parseJson16Utf8(const Memory& mem, JsonParseParam& param)
@@ -1297,5 +1572,1264 @@ namespace slib
 	{
 		setJsonMapList(_in);
 	}
+
+
+#define PRIV_JSON_DOCUMENT_ARENA_MIN_CHUNK_SIZE 1024
+#define PRIV_JSON_DOCUMENT_ARENA_MAX_CHUNK_SIZE 0x100000
+
+	enum class _priv_JsonNodeType
+	{
+		Null = 0,
+		Boolean,
+		Int64,
+		Uint64,
+		Double,
+		String,
+		List,
+		Map
+	};
+	
+	class _priv_JsonMember;
+	
+	class _priv_JsonNode
+	{
+	public:
+		_priv_JsonNodeType type;
+		sl_size length; // length of the string, count of the elements or the members
+		union {
+			sl_bool valueBoolean;
+			sl_int64 valueInt64;
+			sl_uint64 valueUint64;
+			double valueDouble;
+			const sl_char8* str;
+			_priv_JsonNode* elements;
+			_priv_JsonMember* members;
+		};
+	};
+	
+	class _priv_JsonMember
+	{
+	public:
+		const sl_char8* key;
+		sl_size lengthKey;
+		_priv_JsonNode value;
+	};
+	
+	static sl_int32 _priv_JsonMember_compareKey(const sl_char8* key1, sl_size len1, const sl_char8* key2, sl_size len2)
+	{
+		sl_int32 c = Base::compareMemory((const sl_uint8*)key1, (const sl_uint8*)key2, len1 < len2 ? len1 : len2);
+		if (c) {
+			return c;
+		}
+		if (len1 < len2) {
+			return -1;
+		}
+		if (len1 > len2) {
+			return 1;
+		}
+		return 0;
+	}
+	
+	class _priv_JsonDocument_MemberItem
+	{
+	public:
+		_priv_JsonMember member;
+		sl_size order;
+	};
+	
+	class _priv_JsonDocument_CompareMemberItem
+	{
+	public:
+		int operator()(const _priv_JsonDocument_MemberItem& a, const _priv_JsonDocument_MemberItem& b) const
+		{
+			sl_int32 c = _priv_JsonMember_compareKey(a.member.key, a.member.lengthKey, b.member.key, b.member.lengthKey);
+			if (c) {
+				return c;
+			}
+			return a.order < b.order ? -1 : (a.order > b.order ? 1 : 0);
+		}
+	};
+	
+	class _priv_JsonDocument_Parser : public _priv_Json_Parser<String, sl_char8>
+	{
+	public:
+		MemoryArena* arena;
+		List<_priv_JsonNode> stackElements;
+		List<_priv_JsonDocument_MemberItem> stackMembers;
+		
+	public:
+		void setOutOfMemory()
+		{
+			flagError = sl_true;
+			errorMessage = "Out of memory";
+		}
+		
+		void parseStringSlice(const sl_char8*& str, sl_size& length)
+		{
+			sl_bool flagEscapes;
+			sl_size n = _priv_Json_scanString(buf + pos, len - pos, flagEscapes);
+			if (!n) {
+				flagError = sl_true;
+				errorMessage = "String: Missing character  \" or ' ";
+				return;
+			}
+			if (!flagEscapes) {
+				str = buf + pos + 1;
+				length = n - 2;
+				pos += n;
+				return;
+			}
+			// decoded directly into the arena, the decoded string is never longer than the literal
+			sl_char8* p = (sl_char8*)(arena->allocateRetained(n - 1));
+			if (!p) {
+				setOutOfMemory();
+				return;
+			}
+			sl_reg m = _priv_Json_unescapeString(buf + pos, n, p);
+			if (m < 0) {
+				flagError = sl_true;
+				errorMessage = "String: Invalid escape sequence";
+				return;
+			}
+			p[m] = 0;
+			str = p;
+			length = m;
+			pos += n;
+		}
+		
+		void finishList(_priv_JsonNode& node, sl_size base)
+		{
+			sl_size n = stackElements.getCount() - base;
+			node.type = _priv_JsonNodeType::List;
+			node.length = n;
+			node.elements = (_priv_JsonNode*)(arena->allocateRetained(sizeof(_priv_JsonNode) * n));
+			if (!(node.elements)) {
+				setOutOfMemory();
+				return;
+			}
+			Base::copyMemory(node.elements, stackElements.getData() + base, sizeof(_priv_JsonNode) * n);
+			stackElements.setCount_NoLock(base);
+		}
+		
+		void finishMap(_priv_JsonNode& node, sl_size base)
+		{
+			sl_size n = stackMembers.getCount() - base;
+			_priv_JsonDocument_MemberItem* items = stackMembers.getData() + base;
+			QuickSort::sortAsc(items, n, _priv_JsonDocument_CompareMemberItem());
+			node.type = _priv_JsonNodeType::Map;
+			node.members = (_priv_JsonMember*)(arena->allocateRetained(sizeof(_priv_JsonMember) * n));
+			if (!(node.members)) {
+				setOutOfMemory();
+				return;
+			}
+			// the duplicated keys are resolved to the last value, same as `JsonMap`
+			sl_size k = 0;
+			for (sl_size i = 0; i < n; i++) {
+				if (i + 1 < n && !(_priv_JsonMember_compareKey(items[i].member.key, items[i].member.lengthKey, items[i + 1].member.key, items[i + 1].member.lengthKey))) {
+					continue;
+				}
+				node.members[k] = items[i].member;
+				k++;
+			}
+			node.length = k;
+			stackMembers.setCount_NoLock(base);
+		}
+		
+		void parseNode(_priv_JsonNode& node)
+		{
+			node.type = _priv_JsonNodeType::Null;
+			node.length = 0;
+			node.valueUint64 = 0;
+			
+			escapeSpaceAndComments();
+			if (pos == len) {
+				return;
+			}
+			
+			sl_char8 first = buf[pos];
+			
+			// string
+			if (first == '"' || first == '\'') {
+				node.type = _priv_JsonNodeType::String;
+				parseStringSlice(node.str, node.length);
+				return;
+			}
+			
+			// array
+			if (first == '[') {
+				pos++;
+				escapeSpaceAndComments();
+				if (pos == len) {
+					flagError = sl_true;
+					errorMessage = "Array: Missing character ] ";
+					return;
+				}
+				sl_size base = stackElements.getCount();
+				if (buf[pos] == ']') {
+					pos++;
+					finishList(node, base);
+					return;
+				}
+				while (pos < len) {
+					sl_char8 ch = buf[pos];
+					_priv_JsonNode item;
+					if (ch == ']' || ch == ',') {
+						item.type = _priv_JsonNodeType::Null;
+						item.length = 0;
+						item.valueUint64 = 0;
+					} else {
+						parseNode(item);
+						if (flagError) {
+							return;
+						}
+						escapeSpaceAndComments();
+						if (pos == len) {
+							break;
+						}
+						ch = buf[pos];
+					}
+					if (!(stackElements.add_NoLock(item))) {
+						setOutOfMemory();
+						return;
+					}
+					if (ch == ']') {
+						pos++;
+						finishList(node, base);
+						return;
+					} else if (ch == ',') {
+						pos++;
+					} else {
+						break;
+					}
+					escapeSpaceAndComments();
+				}
+				flagError = sl_true;
+				errorMessage = "Array: Missing character ] ";
+				return;
+			}
+			
+			// object
+			if (first == '{') {
+				pos++;
+				sl_size base = stackMembers.getCount();
+				sl_size order = 0;
+				while (pos < len) {
+					escapeSpaceAndComments();
+					if (pos == len) {
+						break;
+					}
+					sl_char8 ch = buf[pos];
+					if (ch == '}') {
+						pos++;
+						finishMap(node, base);
+						return;
+					}
+					if (order) {
+						if (ch == ',') {
+							pos++;
+						} else {
+							flagError = sl_true;
+							errorMessage = "Object: Missing character , ";
+							return;
+						}
+					}
+					escapeSpaceAndComments();
+					if (pos == len) {
+						break;
+					}
+					_priv_JsonDocument_MemberItem item;
+					item.order = order;
+					ch = buf[pos];
+					if (ch == '}') {
+						pos++;
+						finishMap(node, base);
+						return;
+					} else if (ch == '"' || ch == '\'') {
+						parseStringSlice(item.member.key, item.member.lengthKey);
+						if (flagError) {
+							errorMessage = "Object Item Name: Missing terminating character \" or ' ";
+							return;
+						}
+					} else {
+						sl_size s = pos;
+						while (pos < len) {
+							ch = buf[pos];
+							if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_' || (pos != s && ch >= '0' && ch <= '9')) {
+								pos++;
+							} else {
+								break;
+							}
+						}
+						if (pos == len) {
+							flagError = sl_true;
+							errorMessage = "Object: Missing character : ";
+							return;
+						}
+						item.member.key = buf + s;
+						item.member.lengthKey = pos - s;
+					}
+					escapeSpaceAndComments();
+					if (pos == len || buf[pos] != ':') {
+						flagError = sl_true;
+						errorMessage = "Object: Missing character : ";
+						return;
+					}
+					pos++;
+					escapeSpaceAndComments();
+					if (pos == len) {
+						flagError = sl_true;
+						errorMessage = "Object: Missing Item value";
+						return;
+					}
+					if (buf[pos] == '}' || buf[pos] == ',') {
+						item.member.value.type = _priv_JsonNodeType::Null;
+						item.member.value.length = 0;
+						item.member.value.valueUint64 = 0;
+					} else {
+						parseNode(item.member.value);
+						if (flagError) {
+							return;
+						}
+					}
+					if (!(stackMembers.add_NoLock(item))) {
+						setOutOfMemory();
+						return;
+					}
+					order++;
+				}
+				flagError = sl_true;
+				errorMessage = "Object: Missing character } ";
+				return;
+			}
+			
+			sl_size s = pos;
+			while (pos < len) {
+				sl_char8 ch = buf[pos];
+				if (ch == '\r' || ch == '\n' || ch == ' ' || ch == '\t' || ch == '/' || ch == ']' || ch == '}' || ch == ',') {
+					break;
+				} else {
+					pos++;
+				}
+			}
+			sl_size n = pos - s;
+			const sl_char8* t = buf + s;
+			if (n == 4 && Base::equalsMemory(t, "null", 4)) {
+				return;
+			}
+			if (n == 4 && Base::equalsMemory(t, "true", 4)) {
+				node.type = _priv_JsonNodeType::Boolean;
+				node.valueBoolean = sl_true;
+				return;
+			}
+			if (n == 5 && Base::equalsMemory(t, "false", 5)) {
+				node.type = _priv_JsonNodeType::Boolean;
+				node.valueBoolean = sl_false;
+				return;
+			}
+			if (n) {
+				if (String::parseInt64(10, &(node.valueInt64), buf, s, pos) == (sl_reg)pos) {
+					node.type = _priv_JsonNodeType::Int64;
+					return;
+				}
+				if (String::parseUint64(10, &(node.valueUint64), buf, s, pos) == (sl_reg)pos) {
+					node.type = _priv_JsonNodeType::Uint64;
+					return;
+				}
+				if (String::parseDouble(&(node.valueDouble), buf, s, pos) == (sl_reg)pos) {
+					node.type = _priv_JsonNodeType::Double;
+					return;
+				}
+			}
+			flagError = sl_true;
+			errorMessage = "Invalid token";
+		}
+		
+	};
+	
+	
+	JsonValue::JsonValue(): m_node(sl_null)
+	{
+	}
+	
+	JsonValue::JsonValue(const _priv_JsonNode* node): m_node(node)
+	{
+	}
+	
+	sl_bool JsonValue::isNull() const
+	{
+		return !m_node || m_node->type == _priv_JsonNodeType::Null;
+	}
+	
+	sl_bool JsonValue::isNotNull() const
+	{
+		return m_node && m_node->type != _priv_JsonNodeType::Null;
+	}
+	
+	sl_bool JsonValue::isBoolean() const
+	{
+		return m_node && m_node->type == _priv_JsonNodeType::Boolean;
+	}
+	
+	sl_bool JsonValue::getBoolean(sl_bool def) const
+	{
+		if (m_node) {
+			switch (m_node->type) {
+				case _priv_JsonNodeType::Boolean:
+					return m_node->valueBoolean;
+				case _priv_JsonNodeType::Int64:
+				case _priv_JsonNodeType::Uint64:
+					return m_node->valueUint64 != 0;
+				case _priv_JsonNodeType::String:
+					{
+						sl_bool f;
+						if (String::parseBoolean(&f, m_node->str, 0, m_node->length) == (sl_reg)(m_node->length)) {
+							return f;
+						}
+						break;
+					}
+				default:
+					break;
+			}
+		}
+		return def;
+	}
+	
+	sl_bool JsonValue::isInteger() const
+	{
+		return m_node && (m_node->type == _priv_JsonNodeType::Int64 || m_node->type == _priv_JsonNodeType::Uint64);
+	}
+	
+	sl_bool JsonValue::isNumber() const
+	{
+		return isInteger() || (m_node && m_node->type == _priv_JsonNodeType::Double);
+	}
+	
+	template <class T>
+	static T _priv_JsonValue_getNumber(const _priv_JsonNode* node, T def)
+	{
+		if (node) {
+			switch (node->type) {
+				case _priv_JsonNodeType::Boolean:
+					return node->valueBoolean ? (T)1 : (T)0;
+				case _priv_JsonNodeType::Int64:
+					return (T)(node->valueInt64);
+				case _priv_JsonNodeType::Uint64:
+					return (T)(node->valueUint64);
+				case _priv_JsonNodeType::Double:
+					return (T)(node->valueDouble);
+				case _priv_JsonNodeType::String:
+					{
+						sl_int64 n;
+						if (String::parseInt64(10, &n, node->str, 0, node->length) == (sl_reg)(node->length)) {
+							return (T)n;
+						}
+						double f;
+						if (String::parseDouble(&f, node->str, 0, node->length) == (sl_reg)(node->length)) {
+							return (T)f;
+						}
+						break;
+					}
+				default:
+					break;
+			}
+		}
+		return def;
+	}
+	
+	sl_int32 JsonValue::getInt32(sl_int32 def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	sl_uint32 JsonValue::getUint32(sl_uint32 def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	sl_int64 JsonValue::getInt64(sl_int64 def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	sl_uint64 JsonValue::getUint64(sl_uint64 def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	float JsonValue::getFloat(float def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	double JsonValue::getDouble(double def) const
+	{
+		return _priv_JsonValue_getNumber(m_node, def);
+	}
+	
+	sl_bool JsonValue::isString() const
+	{
+		return m_node && m_node->type == _priv_JsonNodeType::String;
+	}
+	
+	String JsonValue::getString(const String& def) const
+	{
+		if (m_node) {
+			switch (m_node->type) {
+				case _priv_JsonNodeType::String:
+					return String(m_node->str, m_node->length);
+				case _priv_JsonNodeType::Boolean:
+					if (m_node->valueBoolean) {
+						SLIB_STATIC_STRING(s, "true")
+						return s;
+					} else {
+						SLIB_STATIC_STRING(s, "false")
+						return s;
+					}
+				case _priv_JsonNodeType::Int64:
+					return String::fromInt64(m_node->valueInt64);
+				case _priv_JsonNodeType::Uint64:
+					return String::fromUint64(m_node->valueUint64);
+				case _priv_JsonNodeType::Double:
+					return String::fromDouble(m_node->valueDouble);
+				default:
+					break;
+			}
+		}
+		return def;
+	}
+	
+	String JsonValue::getString() const
+	{
+		return getString(String::null());
+	}
+	
+	const sl_char8* JsonValue::getStringData(sl_size* pLength) const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::String) {
+			if (pLength) {
+				*pLength = m_node->length;
+			}
+			return m_node->str;
+		}
+		if (pLength) {
+			*pLength = 0;
+		}
+		return sl_null;
+	}
+	
+	sl_bool JsonValue::isList() const
+	{
+		return m_node && m_node->type == _priv_JsonNodeType::List;
+	}
+	
+	sl_size JsonValue::getElementsCount() const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::List) {
+			return m_node->length;
+		}
+		return 0;
+	}
+	
+	JsonValue JsonValue::getElement(sl_size index) const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::List && index < m_node->length) {
+			return m_node->elements + index;
+		}
+		return sl_null;
+	}
+	
+	JsonValue JsonValue::operator[](sl_size index) const
+	{
+		return getElement(index);
+	}
+	
+	sl_bool JsonValue::isMap() const
+	{
+		return m_node && m_node->type == _priv_JsonNodeType::Map;
+	}
+	
+	sl_size JsonValue::getItemsCount() const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::Map) {
+			return m_node->length;
+		}
+		return 0;
+	}
+	
+	String JsonValue::getItemKey(sl_size index) const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::Map && index < m_node->length) {
+			_priv_JsonMember& member = m_node->members[index];
+			return String(member.key, member.lengthKey);
+		}
+		return sl_null;
+	}
+	
+	JsonValue JsonValue::getItemValue(sl_size index) const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::Map && index < m_node->length) {
+			return &(m_node->members[index].value);
+		}
+		return sl_null;
+	}
+	
+	JsonValue JsonValue::getItem(const sl_char8* key, sl_size lengthKey) const
+	{
+		if (m_node && m_node->type == _priv_JsonNodeType::Map) {
+			_priv_JsonMember* members = m_node->members;
+			sl_size start = 0;
+			sl_size end = m_node->length;
+			while (start < end) {
+				sl_size mid = (start + end) >> 1;
+				sl_int32 c = _priv_JsonMember_compareKey(key, lengthKey, members[mid].key, members[mid].lengthKey);
+				if (!c) {
+					return &(members[mid].value);
+				}
+				if (c < 0) {
+					end = mid;
+				} else {
+					start = mid + 1;
+				}
+			}
+		}
+		return sl_null;
+	}
+	
+	JsonValue JsonValue::getItem(const String& key) const
+	{
+		return getItem(key.getData(), key.getLength());
+	}
+	
+	JsonValue JsonValue::operator[](const String& key) const
+	{
+		return getItem(key.getData(), key.getLength());
+	}
+	
+	Json JsonValue::toJson() const
+	{
+		if (m_node) {
+			switch (m_node->type) {
+				case _priv_JsonNodeType::Boolean:
+					return Json::fromBoolean(m_node->valueBoolean);
+				case _priv_JsonNodeType::Int64:
+					{
+						sl_int64 n = m_node->valueInt64;
+						if (n >= SLIB_INT64(-0x80000000) && n < SLIB_INT64(0x7fffffff)) {
+							return (sl_int32)n;
+						}
+						return n;
+					}
+				case _priv_JsonNodeType::Uint64:
+					return m_node->valueUint64;
+				case _priv_JsonNodeType::Double:
+					return m_node->valueDouble;
+				case _priv_JsonNodeType::String:
+					return String(m_node->str, m_node->length);
+				case _priv_JsonNodeType::List:
+					{
+						JsonList list = JsonList::create();
+						for (sl_size i = 0; i < m_node->length; i++) {
+							list.add_NoLock(JsonValue(m_node->elements + i).toJson());
+						}
+						return list;
+					}
+				case _priv_JsonNodeType::Map:
+					{
+						JsonMap map = JsonMap::create();
+						for (sl_size i = 0; i < m_node->length; i++) {
+							_priv_JsonMember& member = m_node->members[i];
+							map.put_NoLock(String(member.key, member.lengthKey), JsonValue(&(member.value)).toJson());
+						}
+						return map;
+					}
+				default:
+					break;
+			}
+		}
+		return sl_null;
+	}
+	
+	String JsonValue::toJsonString() const
+	{
+		return toJson().toJsonString();
+	}
+	
+	
+	JsonDocument::JsonDocument()
+	{
+		m_root = sl_null;
+	}
+	
+	JsonDocument::~JsonDocument()
+	{
+	}
+	
+	Ref<JsonDocument> JsonDocument::parse(const Memory& json, JsonParseParam& param)
+	{
+		param.flagError = sl_false;
+		
+		const sl_char8* data = (const sl_char8*)(json.getData());
+		sl_size size = json.getSize();
+		_priv_Json_skipUtf8Bom(data, size);
+		
+		Ref<JsonDocument> doc = new JsonDocument;
+		if (doc.isNull()) {
+			return sl_null;
+		}
+		sl_size sizeChunk = size;
+		if (sizeChunk < PRIV_JSON_DOCUMENT_ARENA_MIN_CHUNK_SIZE) {
+			sizeChunk = PRIV_JSON_DOCUMENT_ARENA_MIN_CHUNK_SIZE;
+		} else if (sizeChunk > PRIV_JSON_DOCUMENT_ARENA_MAX_CHUNK_SIZE) {
+			sizeChunk = PRIV_JSON_DOCUMENT_ARENA_MAX_CHUNK_SIZE;
+		}
+		Ref<MemoryArena> arena = MemoryArena::create(sizeChunk);
+		if (arena.isNull()) {
+			return sl_null;
+		}
+		doc->m_arena = arena;
+		
+		_priv_JsonDocument_Parser parser;
+		parser.buf = data;
+		parser.len = size;
+		parser.flagSupportComments = param.flagSupportComments;
+		parser.arena = arena.get();
+		
+		_priv_JsonNode* root = (_priv_JsonNode*)(arena->allocateRetained(sizeof(_priv_JsonNode)));
+		if (root) {
+			parser.parseNode(*root);
+		} else {
+			parser.setOutOfMemory();
+		}
+		if (!(parser.flagError)) {
+			parser.escapeSpaceAndComments();
+			if (parser.pos != size) {
+				parser.flagError = sl_true;
+				parser.errorMessage = "Invalid token";
+			}
+			if (!(parser.flagError)) {
+				doc->m_source = json;
+				doc->m_root = root;
+				return doc;
+			}
+		}
+		
+		param.flagError = sl_true;
+		param.errorPosition = parser.pos;
+		param.errorMessage = parser.errorMessage;
+		param.errorLine = ParseUtil::countLineNumber(data, parser.pos, &(param.errorColumn));
+		
+		if (param.flagLogError) {
+			LogError("Json", param.getErrorText());
+		}
+		
+		return sl_null;
+	}
+	
+	Ref<JsonDocument> JsonDocument::parse(const Memory& json)
+	{
+		JsonParseParam param;
+		return parse(json, param);
+	}
+	
+	JsonValue JsonDocument::getRoot() const
+	{
+		return m_root;
+	}
+	
+	const Memory& JsonDocument::getSource() const
+	{
+		return m_source;
+	}
+
+	
+	JsonWriter::JsonWriter(IWriter* output, sl_bool flagPretty)
+	{
+		m_output = output;
+		m_flagPretty = flagPretty;
+		m_depth = 0;
+		m_flagNeedComma = sl_false;
+		m_flagAfterKey = sl_false;
+		m_flagError = sl_false;
+		m_sizeWritten = 0;
+		m_sizeChunk = 0;
+	}
+	
+	JsonWriter::~JsonWriter()
+	{
+	}
+	
+	sl_bool JsonWriter::writeOutput(const void* data, sl_size size)
+	{
+		if (m_output) {
+			return m_output->writeFully(data, size) == (sl_reg)size;
+		}
+		return sl_false;
+	}
+	
+	sl_bool JsonWriter::flush()
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (m_sizeChunk) {
+			if (!(writeOutput(m_chunk, m_sizeChunk))) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			m_sizeWritten += m_sizeChunk;
+			m_sizeChunk = 0;
+		}
+		return sl_true;
+	}
+	
+	sl_uint64 JsonWriter::getWrittenSize() const
+	{
+		return m_sizeWritten + m_sizeChunk;
+	}
+	
+	sl_bool JsonWriter::isError() const
+	{
+		return m_flagError;
+	}
+	
+	sl_bool JsonWriter::_writeRaw(const void* _data, sl_size size)
+	{
+		const sl_char8* data = (const sl_char8*)_data;
+		while (size) {
+			sl_size n = SLIB_JSON_WRITER_CHUNK_SIZE - m_sizeChunk;
+			if (!n) {
+				if (!(flush())) {
+					return sl_false;
+				}
+				n = SLIB_JSON_WRITER_CHUNK_SIZE;
+			}
+			if (n > size) {
+				n = size;
+			}
+			Base::copyMemory(m_chunk + m_sizeChunk, data, n);
+			m_sizeChunk += n;
+			data += n;
+			size -= n;
+		}
+		return !m_flagError;
+	}
+	
+	SLIB_INLINE sl_bool JsonWriter::_writeChar(sl_char8 ch)
+	{
+		if (m_sizeChunk == SLIB_JSON_WRITER_CHUNK_SIZE) {
+			if (!(flush())) {
+				return sl_false;
+			}
+		}
+		m_chunk[m_sizeChunk++] = ch;
+		return sl_true;
+	}
+	
+	sl_bool JsonWriter::_writeNewLine()
+	{
+		if (!(_writeChar('\n'))) {
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < m_depth; i++) {
+			if (!(_writeChar('\t'))) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+	
+	sl_bool JsonWriter::_beginValue()
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (m_flagAfterKey) {
+			m_flagAfterKey = sl_false;
+			return sl_true;
+		}
+		if (m_flagNeedComma) {
+			if (!(_writeChar(','))) {
+				return sl_false;
+			}
+		}
+		if (m_flagPretty && m_depth) {
+			return _writeNewLine();
+		}
+		return sl_true;
+	}
+	
+	sl_bool JsonWriter::writeNull()
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		return _writeRaw("null", 4);
+	}
+	
+	sl_bool JsonWriter::writeBoolean(sl_bool value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		if (value) {
+			return _writeRaw("true", 4);
+		} else {
+			return _writeRaw("false", 5);
+		}
+	}
+	
+	static const char _priv_JsonWriter_digits[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+	
+	// writes the digits backward from `end`, returns the beginning
+	static sl_char8* _priv_JsonWriter_formatUint64(sl_char8* end, sl_uint64 value)
+	{
+		sl_char8* p = end;
+		while (value >= 100) {
+			sl_uint32 r = (sl_uint32)(value % 100) << 1;
+			value /= 100;
+			*(--p) = _priv_JsonWriter_digits[r + 1];
+			*(--p) = _priv_JsonWriter_digits[r];
+		}
+		if (value >= 10) {
+			sl_uint32 r = (sl_uint32)value << 1;
+			*(--p) = _priv_JsonWriter_digits[r + 1];
+			*(--p) = _priv_JsonWriter_digits[r];
+		} else {
+			*(--p) = (sl_char8)('0' + value);
+		}
+		return p;
+	}
+	
+	sl_bool JsonWriter::writeInt64(sl_int64 value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		sl_char8 buf[24];
+		sl_char8* end = buf + sizeof(buf);
+		sl_char8* p;
+		if (value < 0) {
+			p = _priv_JsonWriter_formatUint64(end, (sl_uint64)0 - (sl_uint64)value);
+			*(--p) = '-';
+		} else {
+			p = _priv_JsonWriter_formatUint64(end, (sl_uint64)value);
+		}
+		return _writeRaw(p, end - p);
+	}
+	
+	sl_bool JsonWriter::writeUint64(sl_uint64 value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		sl_char8 buf[24];
+		sl_char8* end = buf + sizeof(buf);
+		sl_char8* p = _priv_JsonWriter_formatUint64(end, value);
+		return _writeRaw(p, end - p);
+	}
+	
+	sl_bool JsonWriter::writeDouble(double value)
+	{
+		if (Math::isNaN(value) || Math::isInfinite(value)) {
+			return writeNull();
+		}
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		sl_char8 buf[40];
+		if (value > -1e15 && value < 1e15) {
+			sl_int64 n = (sl_int64)value;
+			if ((double)n == value) {
+				// integral value: keep the fraction so that it is parsed back as a double
+				sl_char8* end = buf + sizeof(buf);
+				*(--end) = '0';
+				*(--end) = '.';
+				sl_char8* p;
+				if (n < 0) {
+					p = _priv_JsonWriter_formatUint64(end, (sl_uint64)(-n));
+					*(--p) = '-';
+				} else {
+					p = _priv_JsonWriter_formatUint64(end, (sl_uint64)n);
+				}
+				return _writeRaw(p, buf + sizeof(buf) - p);
+			}
+		}
+		// shortest of 15 or 17 significant digits which is parsed back to the same value
+		int n = snprintf(buf, sizeof(buf), "%.15g", value);
+		double check;
+		if (n <= 0 || String::parseDouble(&check, buf, 0, n) != n || check != value) {
+			n = snprintf(buf, sizeof(buf), "%.17g", value);
+			if (n <= 0) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+		}
+		return _writeRaw(buf, n);
+	}
+	
+	sl_bool JsonWriter::writeString(const sl_char8* str, sl_size length)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_true;
+		if (!(_writeChar('"'))) {
+			return sl_false;
+		}
+		sl_size start = 0;
+		for (sl_size i = 0; i < length; i++) {
+			sl_uint8 ch = (sl_uint8)(str[i]);
+			if (ch >= 0x20 && ch != '"' && ch != '\\') {
+				continue;
+			}
+			if (i > start) {
+				if (!(_writeRaw(str + start, i - start))) {
+					return sl_false;
+				}
+			}
+			start = i + 1;
+			sl_char8 esc[6] = {'\\', 0, 0, 0, 0, 0};
+			sl_size n = 2;
+			switch (ch) {
+				case '"':
+				case '\\':
+					esc[1] = ch;
+					break;
+				case '\n':
+					esc[1] = 'n';
+					break;
+				case '\r':
+					esc[1] = 'r';
+					break;
+				case '\t':
+					esc[1] = 't';
+					break;
+				case '\b':
+					esc[1] = 'b';
+					break;
+				case '\f':
+					esc[1] = 'f';
+					break;
+				default:
+					esc[1] = 'u';
+					esc[2] = '0';
+					esc[3] = '0';
+					esc[4] = "0123456789abcdef"[ch >> 4];
+					esc[5] = "0123456789abcdef"[ch & 15];
+					n = 6;
+					break;
+			}
+			if (!(_writeRaw(esc, n))) {
+				return sl_false;
+			}
+		}
+		if (length > start) {
+			if (!(_writeRaw(str + start, length - start))) {
+				return sl_false;
+			}
+		}
+		return _writeChar('"');
+	}
+	
+	sl_bool JsonWriter::writeString(const String& str)
+	{
+		return writeString(str.getData(), str.getLength());
+	}
+	
+	sl_bool JsonWriter::beginList()
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_depth++;
+		m_flagNeedComma = sl_false;
+		return _writeChar('[');
+	}
+	
+	sl_bool JsonWriter::endList()
+	{
+		if (m_depth) {
+			m_depth--;
+		}
+		if (m_flagPretty && m_flagNeedComma) {
+			if (!(_writeNewLine())) {
+				return sl_false;
+			}
+		}
+		m_flagNeedComma = sl_true;
+		return _writeChar(']');
+	}
+	
+	sl_bool JsonWriter::beginMap()
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		m_depth++;
+		m_flagNeedComma = sl_false;
+		return _writeChar('{');
+	}
+	
+	sl_bool JsonWriter::endMap()
+	{
+		if (m_depth) {
+			m_depth--;
+		}
+		if (m_flagPretty && m_flagNeedComma) {
+			if (!(_writeNewLine())) {
+				return sl_false;
+			}
+		}
+		m_flagNeedComma = sl_true;
+		return _writeChar('}');
+	}
+	
+	sl_bool JsonWriter::writeKey(const sl_char8* key, sl_size length)
+	{
+		if (!(writeString(key, length))) {
+			return sl_false;
+		}
+		m_flagNeedComma = sl_false;
+		m_flagAfterKey = sl_true;
+		if (m_flagPretty) {
+			return _writeRaw(": ", 2);
+		} else {
+			return _writeChar(':');
+		}
+	}
+	
+	sl_bool JsonWriter::writeKey(const String& key)
+	{
+		return writeKey(key.getData(), key.getLength());
+	}
+	
+	sl_bool JsonWriter::write(const List<Variant>& list)
+	{
+		ListLocker<Variant> l(list);
+		if (!(beginList())) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < l.count; i++) {
+			if (!(write(l[i]))) {
+				return sl_false;
+			}
+		}
+		return endList();
+	}
+	
+	sl_bool JsonWriter::write(const Map<String, Variant>& map)
+	{
+		MutexLocker lock(map.getLocker());
+		if (!(beginMap())) {
+			return sl_false;
+		}
+		for (auto& pair : map) {
+			if (!(writeKey(pair.key))) {
+				return sl_false;
+			}
+			if (!(write(pair.value))) {
+				return sl_false;
+			}
+		}
+		return endMap();
+	}
+	
+	sl_bool JsonWriter::write(const HashMap<String, Variant>& map)
+	{
+		MutexLocker lock(map.getLocker());
+		if (!(beginMap())) {
+			return sl_false;
+		}
+		for (auto& pair : map) {
+			if (!(writeKey(pair.key))) {
+				return sl_false;
+			}
+			if (!(write(pair.value))) {
+				return sl_false;
+			}
+		}
+		return endMap();
+	}
+	
+	sl_bool JsonWriter::write(const Variant& v)
+	{
+		switch (v.getType()) {
+			case VariantType::Int32:
+			case VariantType::Int64:
+				return writeInt64(v.getInt64());
+			case VariantType::Uint32:
+			case VariantType::Uint64:
+				return writeUint64(v.getUint64());
+			case VariantType::Float:
+			case VariantType::Double:
+				return writeDouble(v.getDouble());
+			case VariantType::Boolean:
+				return writeBoolean(v.getBoolean());
+			case VariantType::Sz8:
+				{
+					const sl_char8* sz = v.getSz8();
+					return writeString(sz, Base::getStringLength(sz));
+				}
+			case VariantType::String8:
+			case VariantType::String16:
+			case VariantType::Sz16:
+			case VariantType::Time:
+				return writeString(v.getString());
+			case VariantType::Object:
+			case VariantType::Weak:
+				{
+					Ref<Referable> obj(v.getObject());
+					if (obj.isNotNull()) {
+						if (CList<Variant>* p1 = CastInstance< CList<Variant> >(obj._ptr)) {
+							return write(List<Variant>(p1));
+						} else if (CMap<String, Variant>* p2 = CastInstance< CMap<String, Variant> >(obj._ptr)) {
+							return write(Map<String, Variant>(p2));
+						} else if (CHashMap<String, Variant>* p3 = CastInstance< CHashMap<String, Variant> >(obj._ptr)) {
+							return write(HashMap<String, Variant>(p3));
+						} else if (CList< Map<String, Variant> >* p4 = CastInstance< CList< Map<String, Variant> > >(obj._ptr)) {
+							ListLocker< Map<String, Variant> > l(*p4);
+							if (!(beginList())) {
+								return sl_false;
+							}
+							for (sl_size i = 0; i < l.count; i++) {
+								if (!(write(l[i]))) {
+									return sl_false;
+								}
+							}
+							return endList();
+						} else if (CList< HashMap<String, Variant> >* p5 = CastInstance< CList< HashMap<String, Variant> > >(obj._ptr)) {
+							ListLocker< HashMap<String, Variant> > l(*p5);
+							if (!(beginList())) {
+								return sl_false;
+							}
+							for (sl_size i = 0; i < l.count; i++) {
+								if (!(write(l[i]))) {
+									return sl_false;
+								}
+							}
+							return endList();
+						}
+					}
+					return writeNull();
+				}
+			default:
+				return writeNull();
+		}
+	}
 	
 }
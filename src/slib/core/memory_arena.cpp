@@ -0,0 +1,180 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/core/memory_arena.h"
+
+#include "slib/core/memory.h"
+
+namespace slib
+{
+
+	class _priv_MemoryArenaChunk : public Referable
+	{
+	public:
+		sl_size size;
+		_priv_MemoryArenaChunk* nextRetained;
+		sl_bool flagRetained;
+
+	public:
+		static _priv_MemoryArenaChunk* create(sl_size size) noexcept
+		{
+			// the data follows the header in the same block, which is freed by the `operator delete` of `Referable`
+			void* mem = Base::createMemory(sizeof(_priv_MemoryArenaChunk) + size);
+			if (mem) {
+				_priv_MemoryArenaChunk* chunk = new (mem) _priv_MemoryArenaChunk;
+				chunk->size = size;
+				chunk->nextRetained = sl_null;
+				chunk->flagRetained = sl_false;
+				return chunk;
+			}
+			return sl_null;
+		}
+
+		sl_uint8* getData() noexcept
+		{
+			return (sl_uint8*)(this + 1);
+		}
+
+	};
+
+	SLIB_DEFINE_ROOT_OBJECT(MemoryArena)
+
+	MemoryArena::MemoryArena()
+	{
+		m_data = sl_null;
+		m_capacity = 0;
+		m_position = 0;
+		m_chunkSize = SLIB_MEMORY_ARENA_DEFAULT_CHUNK_SIZE;
+		m_chunksRetained = sl_null;
+	}
+
+	MemoryArena::~MemoryArena()
+	{
+		_priv_MemoryArenaChunk* chunk = m_chunksRetained;
+		while (chunk) {
+			_priv_MemoryArenaChunk* next = chunk->nextRetained;
+			chunk->decreaseReference();
+			chunk = next;
+		}
+	}
+
+	Ref<MemoryArena> MemoryArena::create(sl_size chunkSize)
+	{
+		Ref<MemoryArena> ret = new MemoryArena;
+		if (ret.isNotNull()) {
+			if (chunkSize) {
+				ret->m_chunkSize = chunkSize;
+			}
+		}
+		return ret;
+	}
+
+	void* MemoryArena::allocate(sl_size size, Referable*& _outChunk)
+	{
+		size = (size + sizeof(void*) - 1) & ~((sl_size)(sizeof(void*) - 1));
+		if (m_position + size > m_capacity || m_chunk.isNull()) {
+			if (size > (m_chunkSize >> 2)) {
+				// large block: a dedicated chunk not replacing the current one
+				_priv_MemoryArenaChunk* chunk = _priv_MemoryArenaChunk::create(size);
+				if (!chunk) {
+					return sl_null;
+				}
+				chunk->increaseReference();
+				_outChunk = chunk;
+				return chunk->getData();
+			}
+			if (m_chunk.isNotNull() && m_chunk->getReferenceCount() == 1) {
+				// no object in the chunk is alive
+				m_position = 0;
+			} else {
+				_priv_MemoryArenaChunk* chunk = _priv_MemoryArenaChunk::create(m_chunkSize);
+				if (!chunk) {
+					return sl_null;
+				}
+				m_chunk = chunk;
+				m_data = chunk->getData();
+				m_capacity = m_chunkSize;
+				m_position = 0;
+			}
+		}
+		void* ret = m_data + m_position;
+		m_position += size;
+		Referable* chunk = m_chunk.get();
+		chunk->increaseReference();
+		_outChunk = chunk;
+		return ret;
+	}
+
+	void* MemoryArena::allocateRetained(sl_size size)
+	{
+		Referable* ref;
+		void* ret = allocate(size, ref);
+		if (ret) {
+			_priv_MemoryArenaChunk* chunk = (_priv_MemoryArenaChunk*)ref;
+			if (chunk->flagRetained) {
+				chunk->decreaseReference();
+			} else {
+				// the reference taken by `allocate` is kept until the arena is destroyed
+				chunk->flagRetained = sl_true;
+				chunk->nextRetained = m_chunksRetained;
+				m_chunksRetained = chunk;
+			}
+		}
+		return ret;
+	}
+
+	Memory MemoryArena::createMemory(sl_size size)
+	{
+		if (!size) {
+			return sl_null;
+		}
+		Referable* chunk;
+		void* data = allocate(size, chunk);
+		if (data) {
+			Memory ret = Memory::createStatic(data, size, chunk);
+			chunk->decreaseReference();
+			return ret;
+		}
+		return sl_null;
+	}
+
+	void MemoryArena::reset()
+	{
+		if (m_chunk.isNotNull()) {
+			if (m_chunk->getReferenceCount() == 1) {
+				m_position = 0;
+			} else {
+				// the chunk is released by the last object
+				m_chunk.setNull();
+				m_data = sl_null;
+				m_capacity = 0;
+				m_position = 0;
+			}
+		}
+	}
+
+	sl_size MemoryArena::getChunkSize()
+	{
+		return m_chunkSize;
+	}
+
+}
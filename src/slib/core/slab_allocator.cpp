@@ -0,0 +1,402 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/core/slab_allocator.h"
+
+#include "slib/core/base.h"
+#include "slib/core/spin_lock.h"
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#	include "slib/core/platform_windows.h"
+#	define USE_CPP_ATOMIC
+#else
+#	include <sys/mman.h>
+#endif
+
+#if defined(USE_CPP_ATOMIC)
+#include <atomic>
+#endif
+
+#include <stdlib.h>
+
+#define SPAN_SIZE 0x10000
+#define SPAN_HEADER_SIZE 64
+#if defined(SLIB_ARCH_IS_64BIT)
+#	define REGION_SIZE 0x100000000ULL
+#else
+#	define REGION_SIZE 0x8000000
+#endif
+#define SIZE_CLASSES_COUNT SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT
+
+namespace slib
+{
+
+	struct _priv_SlabBlock
+	{
+		_priv_SlabBlock* next;
+	};
+
+	struct _priv_SlabHeap
+	{
+		// used only by the owner thread
+		_priv_SlabBlock* freeList[SIZE_CLASSES_COUNT];
+		sl_uint8* bump[SIZE_CLASSES_COUNT];
+		sl_uint8* bumpEnd[SIZE_CLASSES_COUNT];
+		sl_uint64 nAllocated[SIZE_CLASSES_COUNT];
+		sl_uint64 nFreed[SIZE_CLASSES_COUNT];
+		sl_uint64 nSpans[SIZE_CLASSES_COUNT];
+
+		_priv_SlabHeap* nextHeap;
+		_priv_SlabHeap* nextAbandoned;
+
+		// the blocks freed by the other threads, on its own cache line
+		char padding1[64];
+		_priv_SlabBlock* volatile remoteFree;
+		char padding2[64 - sizeof(void*)];
+	};
+
+	struct _priv_SlabSpan
+	{
+		_priv_SlabHeap* heap;
+		sl_uint32 sizeClass;
+		sl_uint32 blockSize;
+	};
+
+	static const sl_uint32 _g_slabBlockSizes[SIZE_CLASSES_COUNT] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+
+	static volatile sl_bool _g_slabFlagEnabled =
+#if defined(SLIB_USE_SLAB_ALLOCATOR)
+		sl_true;
+#else
+		sl_false;
+#endif
+
+	static sl_uint8* volatile _g_slabRegionBegin = sl_null;
+	static sl_uint8* volatile _g_slabRegionEnd = sl_null;
+	static sl_bool _g_slabFlagReserveFailed = sl_false;
+	static sl_size volatile _g_slabSpansCount = 0;
+
+	// protects the region reservation and the lists of the heaps
+	static SpinLock _g_slabLock;
+	static _priv_SlabHeap* _g_slabHeaps = sl_null;
+	static _priv_SlabHeap* _g_slabHeapsAbandoned = sl_null;
+
+	SLIB_INLINE static _priv_SlabBlock* _priv_SlabAllocator_load(_priv_SlabBlock* volatile* ptr)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<_priv_SlabBlock*>*)(ptr))->load(std::memory_order_relaxed);
+#else
+		return __atomic_load_n((_priv_SlabBlock**)ptr, __ATOMIC_RELAXED);
+#endif
+	}
+
+	SLIB_INLINE static sl_bool _priv_SlabAllocator_compareExchange(_priv_SlabBlock* volatile* ptr, _priv_SlabBlock* expected, _priv_SlabBlock* value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<_priv_SlabBlock*>*)(ptr))->compare_exchange_weak(expected, value, std::memory_order_release, std::memory_order_relaxed);
+#else
+		return __atomic_compare_exchange_n((_priv_SlabBlock**)ptr, &expected, value, sl_true, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+#endif
+	}
+
+	SLIB_INLINE static _priv_SlabBlock* _priv_SlabAllocator_exchange(_priv_SlabBlock* volatile* ptr, _priv_SlabBlock* value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<_priv_SlabBlock*>*)(ptr))->exchange(value, std::memory_order_acquire);
+#else
+		return __atomic_exchange_n((_priv_SlabBlock**)ptr, value, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	SLIB_INLINE static sl_size _priv_SlabAllocator_addSpansCount()
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<sl_size>*)(&_g_slabSpansCount))->fetch_add(1);
+#else
+		return __atomic_fetch_add((sl_size*)&_g_slabSpansCount, 1, __ATOMIC_RELAXED);
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _priv_SlabAllocator_getSizeClass(sl_size size)
+	{
+		if (size <= 128) {
+			return size ? (sl_uint32)((size - 1) >> 4) : 0;
+		} else if (size <= 256) {
+			return 8 + (sl_uint32)((size - 129) >> 5);
+		} else {
+			return 12 + (sl_uint32)((size - 257) >> 6);
+		}
+	}
+
+	SLIB_INLINE static _priv_SlabSpan* _priv_SlabAllocator_getSpan(const void* ptr)
+	{
+		sl_uint8* begin = _g_slabRegionBegin;
+		return (_priv_SlabSpan*)(begin + ((((sl_uint8*)ptr) - begin) & ~((sl_size)(SPAN_SIZE - 1))));
+	}
+
+	static sl_bool _priv_SlabAllocator_reserve()
+	{
+		SpinLocker lock(&_g_slabLock);
+		if (_g_slabRegionBegin) {
+			return sl_true;
+		}
+		if (_g_slabFlagReserveFailed) {
+			return sl_false;
+		}
+		// reserves one more span to align the spans
+		sl_size size = (sl_size)(REGION_SIZE) + SPAN_SIZE;
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		void* region = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+		if (!region) {
+			_g_slabFlagReserveFailed = sl_true;
+			return sl_false;
+		}
+#else
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#	if defined(MAP_NORESERVE)
+		flags |= MAP_NORESERVE;
+#	endif
+		void* region = mmap(sl_null, size, PROT_NONE, flags, -1, 0);
+		if (region == MAP_FAILED) {
+			_g_slabFlagReserveFailed = sl_true;
+			return sl_false;
+		}
+#endif
+		sl_uint8* begin = (sl_uint8*)((((sl_size)region) + SPAN_SIZE - 1) & ~((sl_size)(SPAN_SIZE - 1)));
+		_g_slabRegionEnd = begin + (sl_size)(REGION_SIZE);
+		_g_slabRegionBegin = begin;
+		return sl_true;
+	}
+
+	static _priv_SlabSpan* _priv_SlabAllocator_createSpan()
+	{
+		sl_size index = _priv_SlabAllocator_addSpansCount();
+		if (index >= (sl_size)(REGION_SIZE / SPAN_SIZE)) {
+			return sl_null;
+		}
+		sl_uint8* span = _g_slabRegionBegin + index * SPAN_SIZE;
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		if (!(VirtualAlloc(span, SPAN_SIZE, MEM_COMMIT, PAGE_READWRITE))) {
+			return sl_null;
+		}
+#else
+		if (mprotect(span, SPAN_SIZE, PROT_READ | PROT_WRITE)) {
+			return sl_null;
+		}
+#endif
+		return (_priv_SlabSpan*)span;
+	}
+
+	class _priv_SlabHeapHolder
+	{
+	public:
+		_priv_SlabHeap* heap;
+		sl_bool flagFinished;
+
+	public:
+		constexpr _priv_SlabHeapHolder(): heap(sl_null), flagFinished(sl_false) {}
+
+		~_priv_SlabHeapHolder()
+		{
+			if (heap) {
+				SpinLocker lock(&_g_slabLock);
+				heap->nextAbandoned = _g_slabHeapsAbandoned;
+				_g_slabHeapsAbandoned = heap;
+				heap = sl_null;
+			}
+			// the blocks allocated later on this thread are allocated by `malloc`
+			flagFinished = sl_true;
+		}
+
+	public:
+		_priv_SlabHeap* get()
+		{
+			if (heap) {
+				return heap;
+			}
+			if (flagFinished) {
+				return sl_null;
+			}
+			SpinLocker lock(&_g_slabLock);
+			_priv_SlabHeap* ret = _g_slabHeapsAbandoned;
+			if (ret) {
+				_g_slabHeapsAbandoned = ret->nextAbandoned;
+				ret->nextAbandoned = sl_null;
+			} else {
+				ret = (_priv_SlabHeap*)(::malloc(sizeof(_priv_SlabHeap)));
+				if (!ret) {
+					return sl_null;
+				}
+				Base::zeroMemory(ret, sizeof(_priv_SlabHeap));
+				ret->nextHeap = _g_slabHeaps;
+				_g_slabHeaps = ret;
+			}
+			heap = ret;
+			return ret;
+		}
+
+	};
+
+	SLIB_THREAD _priv_SlabHeapHolder _gt_slabHeapHolder;
+
+	// moves the blocks freed by the other threads to the free lists
+	static void _priv_SlabAllocator_collectRemote(_priv_SlabHeap* heap)
+	{
+		_priv_SlabBlock* block = _priv_SlabAllocator_exchange(&(heap->remoteFree), sl_null);
+		while (block) {
+			_priv_SlabBlock* next = block->next;
+			sl_uint32 sizeClass = _priv_SlabAllocator_getSpan(block)->sizeClass;
+			block->next = heap->freeList[sizeClass];
+			heap->freeList[sizeClass] = block;
+			heap->nFreed[sizeClass]++;
+			block = next;
+		}
+	}
+
+	SlabAllocatorStatistics::SlabAllocatorStatistics() noexcept
+	{
+		blockSize = 0;
+		allocatedCount = 0;
+		freedCount = 0;
+		liveBytes = 0;
+		spansCount = 0;
+	}
+
+	sl_bool SlabAllocator::isEnabled() noexcept
+	{
+		return _g_slabFlagEnabled;
+	}
+
+	sl_bool SlabAllocator::setEnabled(sl_bool flag) noexcept
+	{
+		if (flag) {
+			if (!(_priv_SlabAllocator_reserve())) {
+				return sl_false;
+			}
+		}
+		_g_slabFlagEnabled = flag;
+		return sl_true;
+	}
+
+	void* SlabAllocator::allocate(sl_size size) noexcept
+	{
+		if (size > SLIB_SLAB_ALLOCATOR_MAX_BLOCK_SIZE || !_g_slabFlagEnabled) {
+			return sl_null;
+		}
+		if (!_g_slabRegionBegin) {
+			if (!(_priv_SlabAllocator_reserve())) {
+				return sl_null;
+			}
+		}
+		_priv_SlabHeap* heap = _gt_slabHeapHolder.get();
+		if (!heap) {
+			return sl_null;
+		}
+		sl_uint32 sizeClass = _priv_SlabAllocator_getSizeClass(size);
+		_priv_SlabBlock* block = heap->freeList[sizeClass];
+		if (!block) {
+			if (_priv_SlabAllocator_load(&(heap->remoteFree))) {
+				_priv_SlabAllocator_collectRemote(heap);
+				block = heap->freeList[sizeClass];
+			}
+		}
+		if (block) {
+			heap->freeList[sizeClass] = block->next;
+		} else {
+			sl_uint32 blockSize = _g_slabBlockSizes[sizeClass];
+			sl_uint8* p = heap->bump[sizeClass];
+			if (!p || p + blockSize > heap->bumpEnd[sizeClass]) {
+				_priv_SlabSpan* span = _priv_SlabAllocator_createSpan();
+				if (!span) {
+					return sl_null;
+				}
+				span->heap = heap;
+				span->sizeClass = sizeClass;
+				span->blockSize = blockSize;
+				heap->nSpans[sizeClass]++;
+				p = ((sl_uint8*)span) + SPAN_HEADER_SIZE;
+				heap->bumpEnd[sizeClass] = ((sl_uint8*)span) + SPAN_SIZE;
+			}
+			heap->bump[sizeClass] = p + blockSize;
+			block = (_priv_SlabBlock*)p;
+		}
+		heap->nAllocated[sizeClass]++;
+		return block;
+	}
+
+	void SlabAllocator::free(void* ptr) noexcept
+	{
+		_priv_SlabSpan* span = _priv_SlabAllocator_getSpan(ptr);
+		_priv_SlabHeap* heap = span->heap;
+		_priv_SlabBlock* block = (_priv_SlabBlock*)ptr;
+		if (heap == _gt_slabHeapHolder.heap) {
+			sl_uint32 sizeClass = span->sizeClass;
+			block->next = heap->freeList[sizeClass];
+			heap->freeList[sizeClass] = block;
+			heap->nFreed[sizeClass]++;
+		} else {
+			_priv_SlabBlock* head;
+			do {
+				head = _priv_SlabAllocator_load(&(heap->remoteFree));
+				block->next = head;
+			} while (!(_priv_SlabAllocator_compareExchange(&(heap->remoteFree), head, block)));
+		}
+	}
+
+	sl_bool SlabAllocator::contains(const void* ptr) noexcept
+	{
+		return (sl_uint8*)ptr >= _g_slabRegionBegin && (sl_uint8*)ptr < _g_slabRegionEnd;
+	}
+
+	sl_size SlabAllocator::getBlockSize(const void* ptr) noexcept
+	{
+		return _priv_SlabAllocator_getSpan(ptr)->blockSize;
+	}
+
+	sl_bool SlabAllocator::getStatistics(sl_uint32 sizeClass, SlabAllocatorStatistics& _out) noexcept
+	{
+		if (sizeClass >= SIZE_CLASSES_COUNT) {
+			return sl_false;
+		}
+		sl_uint64 nAllocated = 0;
+		sl_uint64 nFreed = 0;
+		sl_uint64 nSpans = 0;
+		{
+			SpinLocker lock(&_g_slabLock);
+			_priv_SlabHeap* heap = _g_slabHeaps;
+			while (heap) {
+				// the counters of the other threads are read without synchronization
+				nAllocated += ((volatile sl_uint64*)(heap->nAllocated))[sizeClass];
+				nFreed += ((volatile sl_uint64*)(heap->nFreed))[sizeClass];
+				nSpans += ((volatile sl_uint64*)(heap->nSpans))[sizeClass];
+				heap = heap->nextHeap;
+			}
+		}
+		_out.blockSize = _g_slabBlockSizes[sizeClass];
+		_out.allocatedCount = nAllocated;
+		_out.freedCount = nFreed;
+		_out.liveBytes = nAllocated > nFreed ? (nAllocated - nFreed) * _out.blockSize : 0;
+		_out.spansCount = nSpans;
+		return sl_true;
+	}
+
+}
@@ -33,6 +33,7 @@
 #include "slib/core/json.h"
 #include "slib/core/cast.h"
 #include "slib/core/math.h"
+#include "slib/core/memory_arena.h"
 
 namespace slib
 {
@@ -88,7 +89,8 @@ namespace slib
 	enum STRING_CONTAINER_TYPES {
 		STRING_CONTAINER_TYPE_NORMAL = 0,
 		STRING_CONTAINER_TYPE_STD = 10,
-		STRING_CONTAINER_TYPE_REF = 11
+		STRING_CONTAINER_TYPE_REF = 11,
+		STRING_CONTAINER_TYPE_ARENA = 12
 	};
 
 	const _priv_String_Const _priv_String_Null = {sl_null, 0};
@@ -143,6 +145,14 @@ namespace slib
 		}
 		
 	};
+	
+	// allocated in the chunk of `MemoryArena`, followed by the characters
+	class _priv_StringContainer_arena : public StringContainer
+	{
+	public:
+		Referable* chunk;
+		
+	};
 
 	SLIB_INLINE sl_reg StringContainer::decreaseReference() noexcept
 	{
@@ -155,6 +165,10 @@ namespace slib
 				} else if (type == STRING_CONTAINER_TYPE_REF) {
 					_priv_StringContainer_ref* container = static_cast<_priv_StringContainer_ref*>(this);
 					container->_priv_StringContainer_ref::~_priv_StringContainer_ref();
+				} else if (type == STRING_CONTAINER_TYPE_ARENA) {
+					// the memory is owned by the chunk
+					static_cast<_priv_StringContainer_arena*>(this)->chunk->decreaseReference();
+					return 0;
 				}
 				Base::freeMemory(this);
 			}
@@ -350,6 +364,32 @@ namespace slib
 		return sl_null;
 	}
 	
+	SLIB_INLINE static StringContainer* _priv_String_alloc_arena(MemoryArena* arena, const sl_char8* sz, sl_size len) noexcept
+	{
+		if (len == 0) {
+			return _priv_String_Empty.container;
+		}
+		Referable* chunk;
+		sl_char8* buf = (sl_char8*)(arena->allocate(sizeof(_priv_StringContainer_arena) + len + 1, chunk));
+		if (buf) {
+			_priv_StringContainer_arena* container = reinterpret_cast<_priv_StringContainer_arena*>(buf);
+			container->sz = buf + sizeof(_priv_StringContainer_arena);
+			container->len = len;
+			container->hash = 0;
+			container->type = STRING_CONTAINER_TYPE_ARENA;
+			container->ref = 1;
+			container->chunk = chunk;
+			Base::copyMemory(container->sz, sz, len);
+			container->sz[len] = 0;
+			return container;
+		}
+		StringContainer* container = _priv_String_alloc(len);
+		if (container) {
+			Base::copyMemory(container->sz, sz, len);
+		}
+		return container;
+	}
+	
 	SLIB_INLINE static StringContainer16* _priv_String16_alloc_ref(const Ref<Referable>& obj, const sl_char16* sz, sl_size len) noexcept
 	{
 		if (len == 0) {
@@ -913,12 +953,7 @@ namespace slib
 	SLIB_INLINE StringContainer* Atomic<String>::_retainContainer() const noexcept
 	{
 		if (m_container) {
-			SpinLocker lock(&m_lock);
-			StringContainer* container = m_container;
-			if (container) {
-				container->increaseReference();
-			}
-			return container;
+			return HazardPointer::retain(m_container);
 		}
 		return sl_null;
 	}
@@ -926,12 +961,7 @@ namespace slib
 	SLIB_INLINE StringContainer16* Atomic<String16>::_retainContainer() const noexcept
 	{
 		if (m_container) {
-			SpinLocker lock(&m_lock);
-			StringContainer16* container = m_container;
-			if (container) {
-				container->increaseReference();
-			}
-			return container;
+			return HazardPointer::retain(m_container);
 		}
 		return sl_null;
 	}
@@ -955,28 +985,12 @@ namespace slib
 
 	SLIB_INLINE void Atomic<String>::_replaceContainer(StringContainer* container) noexcept
 	{
-		StringContainer* before;
-		{
-			SpinLocker lock(&m_lock);
-			before = m_container;
-			m_container = container;
-		}
-		if (before) {
-			before->decreaseReference();
-		}
+		HazardPointer::replace(m_container, container);
 	}
 
 	SLIB_INLINE void Atomic<String16>::_replaceContainer(StringContainer16* container) noexcept
 	{
-		StringContainer16* before;
-		{
-			SpinLocker lock(&m_lock);
-			before = m_container;
-			m_container = container;
-		}
-		if (before) {
-			before->decreaseReference();
-		}
+		HazardPointer::replace(m_container, container);
 	}
 
 	String::String(const String& src) noexcept
@@ -1470,6 +1484,20 @@ namespace slib
 		return sl_null;
 	}
 	
+	String String::fromArena(MemoryArena* arena, const sl_char8* str, sl_reg len) noexcept
+	{
+		if (str) {
+			if (len < 0) {
+				len = Base::getStringLength(str);
+			}
+			if (arena) {
+				return _priv_String_alloc_arena(arena, str, len);
+			}
+			return String(str, len);
+		}
+		return sl_null;
+	}
+	
 	String16 String16::fromRef(const Ref<Referable>& ref, const sl_char16* str, sl_reg len) noexcept
 	{
 		if (str) {
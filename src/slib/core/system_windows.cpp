@@ -188,6 +188,16 @@ namespace slib
 #endif
 	}
 
+	sl_uint32 System::getProcessorsCount()
+	{
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		if (si.dwNumberOfProcessors > 0) {
+			return (sl_uint32)(si.dwNumberOfProcessors);
+		}
+		return 1;
+	}
+
 	sl_uint32 System::getLastError()
 	{
 		return (sl_uint32)(::GetLastError());
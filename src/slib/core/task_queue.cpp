@@ -0,0 +1,226 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/core/task_queue.h"
+
+#include "slib/core/base.h"
+
+#define TASK_QUEUE_BLOCK_SIZE 32
+
+namespace slib
+{
+
+	class _priv_TaskQueueBlock
+	{
+	public:
+		_priv_TaskQueueBlock* next;
+		// constructed and destructed by the queue
+		UniqueFunction<void()> tasks[1];
+
+	public:
+		static _priv_TaskQueueBlock* create() noexcept
+		{
+			_priv_TaskQueueBlock* block = (_priv_TaskQueueBlock*)(Base::createMemory(sizeof(_priv_TaskQueueBlock) + sizeof(UniqueFunction<void()>) * (TASK_QUEUE_BLOCK_SIZE - 1)));
+			if (block) {
+				block->next = sl_null;
+			}
+			return block;
+		}
+
+		static void freeList(_priv_TaskQueueBlock* block) noexcept
+		{
+			while (block) {
+				_priv_TaskQueueBlock* next = block->next;
+				Base::freeMemory(block);
+				block = next;
+			}
+		}
+
+	};
+
+	TaskQueue::TaskQueue() noexcept
+	{
+		m_blockFirst = sl_null;
+		m_blockLast = sl_null;
+		m_posFirst = 0;
+		m_posLast = 0;
+		m_blocksFree = sl_null;
+		m_count = 0;
+	}
+
+	TaskQueue::~TaskQueue() noexcept
+	{
+		removeAll_NoLock();
+		_priv_TaskQueueBlock::freeList(m_blocksFree);
+	}
+
+	sl_size TaskQueue::getCount() const noexcept
+	{
+		return m_count;
+	}
+
+	sl_bool TaskQueue::isEmpty() const noexcept
+	{
+		return m_count == 0;
+	}
+
+	sl_bool TaskQueue::isNotEmpty() const noexcept
+	{
+		return m_count != 0;
+	}
+
+	sl_bool TaskQueue::_hasRoom() const noexcept
+	{
+		return (m_blockLast && m_posLast < TASK_QUEUE_BLOCK_SIZE) || m_blocksFree;
+	}
+
+	sl_bool TaskQueue::push_NoLock(UniqueFunction<void()>&& task) noexcept
+	{
+		if (task.isNull()) {
+			return sl_false;
+		}
+		if (!m_blockLast || m_posLast >= TASK_QUEUE_BLOCK_SIZE) {
+			_priv_TaskQueueBlock* block = m_blocksFree;
+			if (block) {
+				m_blocksFree = block->next;
+				block->next = sl_null;
+			} else {
+				block = _priv_TaskQueueBlock::create();
+				if (!block) {
+					return sl_false;
+				}
+			}
+			if (m_blockLast) {
+				m_blockLast->next = block;
+			} else {
+				m_blockFirst = block;
+				m_posFirst = 0;
+			}
+			m_blockLast = block;
+			m_posLast = 0;
+		}
+		new (m_blockLast->tasks + m_posLast) UniqueFunction<void()>(Move(task));
+		m_posLast++;
+		m_count++;
+		return sl_true;
+	}
+
+	sl_bool TaskQueue::push(UniqueFunction<void()>&& task) noexcept
+	{
+		if (task.isNull()) {
+			return sl_false;
+		}
+		_priv_TaskQueueBlock* block = sl_null;
+		for (;;) {
+			{
+				SpinLocker lock(&m_lock);
+				if (block) {
+					block->next = m_blocksFree;
+					m_blocksFree = block;
+				}
+				if (_hasRoom()) {
+					// no allocation is made in the lock
+					return push_NoLock(Move(task));
+				}
+			}
+			block = _priv_TaskQueueBlock::create();
+			if (!block) {
+				return sl_false;
+			}
+		}
+	}
+
+	sl_bool TaskQueue::pop_NoLock(UniqueFunction<void()>* _out) noexcept
+	{
+		if (!m_count) {
+			return sl_false;
+		}
+		UniqueFunction<void()>& item = m_blockFirst->tasks[m_posFirst];
+		if (_out) {
+			*_out = Move(item);
+		}
+		item.~UniqueFunction();
+		m_posFirst++;
+		m_count--;
+		if (m_posFirst >= TASK_QUEUE_BLOCK_SIZE) {
+			// the emptied block is kept for reuse
+			_priv_TaskQueueBlock* block = m_blockFirst;
+			m_blockFirst = block->next;
+			m_posFirst = 0;
+			if (!m_blockFirst) {
+				m_blockLast = sl_null;
+				m_posLast = 0;
+			}
+			block->next = m_blocksFree;
+			m_blocksFree = block;
+		} else if (!m_count) {
+			m_posFirst = 0;
+			m_posLast = 0;
+		}
+		return sl_true;
+	}
+
+	sl_bool TaskQueue::pop(UniqueFunction<void()>* _out) noexcept
+	{
+		UniqueFunction<void()> task;
+		{
+			SpinLocker lock(&m_lock);
+			if (!(pop_NoLock(&task))) {
+				return sl_false;
+			}
+		}
+		// the captures of the previous task in `_out` are released out of the lock
+		if (_out) {
+			*_out = Move(task);
+		}
+		return sl_true;
+	}
+
+	void TaskQueue::removeAll_NoLock() noexcept
+	{
+		while (pop_NoLock(sl_null)) {
+		}
+	}
+
+	void TaskQueue::removeAll() noexcept
+	{
+		TaskQueue tasks;
+		swap(tasks);
+	}
+
+	void TaskQueue::swap(TaskQueue& other) noexcept
+	{
+		SpinLocker lock(&m_lock);
+		Swap(m_blockFirst, other.m_blockFirst);
+		Swap(m_blockLast, other.m_blockLast);
+		Swap(m_posFirst, other.m_posFirst);
+		Swap(m_posLast, other.m_posLast);
+		Swap(m_blocksFree, other.m_blocksFree);
+		Swap(m_count, other.m_count);
+	}
+
+	const SpinLock* TaskQueue::getLocker() const noexcept
+	{
+		return &m_lock;
+	}
+
+}
@@ -22,9 +22,549 @@
 
 #include "slib/core/thread_pool.h"
 
+#include "slib/core/system.h"
+#include "slib/core/timer.h"
+#include "slib/core/hazard_pointer.h"
+#include "slib/core/safe_static.h"
+
+#define PRIV_WORK_STEALING_DEQUE_INITIAL_SIZE 256
+#define PRIV_WORK_STEALING_INJECT_QUEUE_SIZE 8192
+
 namespace slib
 {
 
+	typedef Callable<void()> _priv_ThreadPool_Task;
+
+	/*
+		Chase-Lev work-stealing deque.
+		Only the owner calls `push` and `pop`, other workers call `steal`.
+		The deque holds a reference of each task.
+		The indices are read as volatile words, and every write ordered against the other threads is done
+		by a compare-exchange of `Base`, which is a full memory barrier.
+	*/
+	class _priv_ThreadPool_Deque
+	{
+	private:
+		struct Buffer
+		{
+			sl_reg size;
+			_priv_ThreadPool_Task* volatile* items;
+			Buffer* retired;
+		};
+
+		sl_reg m_top;
+		sl_reg m_bottom;
+		Buffer* m_buffer;
+
+	public:
+		_priv_ThreadPool_Deque()
+		{
+			m_top = 0;
+			m_bottom = 0;
+			m_buffer = _createBuffer(PRIV_WORK_STEALING_DEQUE_INITIAL_SIZE, sl_null);
+		}
+
+		~_priv_ThreadPool_Deque()
+		{
+			for (;;) {
+				_priv_ThreadPool_Task* task = pop();
+				if (!task) {
+					break;
+				}
+				task->decreaseReference();
+			}
+			Buffer* buffer = m_buffer;
+			while (buffer) {
+				Buffer* retired = buffer->retired;
+				delete[] buffer->items;
+				delete buffer;
+				buffer = retired;
+			}
+		}
+
+	public:
+		sl_bool isEmpty()
+		{
+			sl_reg t = _load(&m_top);
+			sl_reg b = _load(&m_bottom);
+			return b <= t;
+		}
+
+		sl_bool push(_priv_ThreadPool_Task* task)
+		{
+			sl_reg b = m_bottom;
+			sl_reg t = _load(&m_top);
+			Buffer* buffer = m_buffer;
+			if (b - t > buffer->size - 1) {
+				Buffer* bufferNew = _createBuffer(buffer->size << 1, buffer);
+				if (!bufferNew) {
+					return sl_false;
+				}
+				for (sl_reg i = t; i < b; i++) {
+					_put(bufferNew, i, _get(buffer, i));
+				}
+				// the old buffer is kept until the destruction because thieves may still read it
+				Base::interlockedCompareExchangePtr((void**)&m_buffer, bufferNew, buffer);
+				buffer = bufferNew;
+			}
+			_put(buffer, b, task);
+			// publishes the task; only the owner writes `m_bottom`, so the exchange always succeeds
+			Base::interlockedCompareExchange(&m_bottom, b + 1, b);
+			return sl_true;
+		}
+
+		_priv_ThreadPool_Task* pop()
+		{
+			sl_reg b = m_bottom - 1;
+			Buffer* buffer = m_buffer;
+			// the barrier orders the write of `m_bottom` before the read of `m_top`
+			Base::interlockedCompareExchange(&m_bottom, b, b + 1);
+			sl_reg t = _load(&m_top);
+			if (t <= b) {
+				_priv_ThreadPool_Task* task = _get(buffer, b);
+				if (t == b) {
+					// last item: race against thieves
+					if (!(Base::interlockedCompareExchange(&m_top, t + 1, t))) {
+						task = sl_null;
+					}
+					Base::interlockedCompareExchange(&m_bottom, b + 1, b);
+				}
+				return task;
+			} else {
+				Base::interlockedCompareExchange(&m_bottom, b + 1, b);
+				return sl_null;
+			}
+		}
+
+		_priv_ThreadPool_Task* steal()
+		{
+			sl_reg t = _load(&m_top);
+			// the barrier orders the read of `m_top` before the read of `m_bottom`. Fails when another thief took the item
+			if (!(Base::interlockedCompareExchange(&m_top, t, t))) {
+				return sl_null;
+			}
+			sl_reg b = _load(&m_bottom);
+			if (t < b) {
+				Buffer* buffer = (Buffer*)(_loadPtr((void**)&m_buffer));
+				_priv_ThreadPool_Task* task = _get(buffer, t);
+				if (!(Base::interlockedCompareExchange(&m_top, t + 1, t))) {
+					return sl_null;
+				}
+				return task;
+			}
+			return sl_null;
+		}
+
+	private:
+		static Buffer* _createBuffer(sl_reg size, Buffer* retired)
+		{
+			Buffer* buffer = new Buffer;
+			if (buffer) {
+				buffer->items = new _priv_ThreadPool_Task*[(sl_size)size];
+				if (buffer->items) {
+					buffer->size = size;
+					buffer->retired = retired;
+					return buffer;
+				}
+				delete buffer;
+			}
+			return sl_null;
+		}
+
+		static _priv_ThreadPool_Task* _get(Buffer* buffer, sl_reg index)
+		{
+			return buffer->items[index & (buffer->size - 1)];
+		}
+
+		static void _put(Buffer* buffer, sl_reg index, _priv_ThreadPool_Task* task)
+		{
+			buffer->items[index & (buffer->size - 1)] = task;
+		}
+
+		SLIB_INLINE static sl_reg _load(sl_reg* p)
+		{
+			return *((volatile sl_reg*)p);
+		}
+
+		SLIB_INLINE static void* _loadPtr(void** p)
+		{
+			return *((void* volatile*)p);
+		}
+
+	};
+
+	/*
+		Bounded lock-free MPMC queue (D. Vyukov) receiving the tasks added from outside of the workers.
+		The queue holds a reference of each task.
+		The thread claiming a cell is the only writer of its sequence until it is released,
+		so the sequences are written by compare-exchanges that always succeed and act as barriers.
+	*/
+	class _priv_ThreadPool_InjectQueue
+	{
+	private:
+		struct Cell
+		{
+			sl_reg sequence;
+			_priv_ThreadPool_Task* task;
+		};
+
+		Cell m_cells[PRIV_WORK_STEALING_INJECT_QUEUE_SIZE];
+		char m_padding1[64];
+		sl_reg m_posPush;
+		char m_padding2[64];
+		sl_reg m_posPop;
+
+	public:
+		_priv_ThreadPool_InjectQueue()
+		{
+			for (sl_size i = 0; i < PRIV_WORK_STEALING_INJECT_QUEUE_SIZE; i++) {
+				m_cells[i].sequence = (sl_reg)i;
+				m_cells[i].task = sl_null;
+			}
+			m_posPush = 0;
+			m_posPop = 0;
+		}
+
+		~_priv_ThreadPool_InjectQueue()
+		{
+			for (;;) {
+				_priv_ThreadPool_Task* task = pop();
+				if (!task) {
+					break;
+				}
+				task->decreaseReference();
+			}
+		}
+
+	public:
+		sl_bool isEmpty()
+		{
+			return _load(&m_posPop) >= _load(&m_posPush);
+		}
+
+		// returns false when the queue is full
+		sl_bool push(_priv_ThreadPool_Task* task)
+		{
+			sl_reg pos = _load(&m_posPush);
+			Cell* cell;
+			for (;;) {
+				cell = m_cells + (pos & (PRIV_WORK_STEALING_INJECT_QUEUE_SIZE - 1));
+				sl_reg seq = _load(&(cell->sequence));
+				sl_reg dif = seq - pos;
+				if (dif == 0) {
+					if (Base::interlockedCompareExchange(&m_posPush, pos + 1, pos)) {
+						break;
+					}
+				} else if (dif < 0) {
+					return sl_false;
+				}
+				pos = _load(&m_posPush);
+			}
+			cell->task = task;
+			Base::interlockedCompareExchange(&(cell->sequence), pos + 1, pos);
+			return sl_true;
+		}
+
+		_priv_ThreadPool_Task* pop()
+		{
+			sl_reg pos = _load(&m_posPop);
+			Cell* cell;
+			for (;;) {
+				cell = m_cells + (pos & (PRIV_WORK_STEALING_INJECT_QUEUE_SIZE - 1));
+				sl_reg seq = _load(&(cell->sequence));
+				sl_reg dif = seq - (pos + 1);
+				if (dif == 0) {
+					if (Base::interlockedCompareExchange(&m_posPop, pos + 1, pos)) {
+						break;
+					}
+				} else if (dif < 0) {
+					return sl_null;
+				}
+				pos = _load(&m_posPop);
+			}
+			_priv_ThreadPool_Task* task = cell->task;
+			Base::interlockedCompareExchange(&(cell->sequence), pos + PRIV_WORK_STEALING_INJECT_QUEUE_SIZE, pos + 1);
+			return task;
+		}
+
+	private:
+		SLIB_INLINE static sl_reg _load(sl_reg* p)
+		{
+			return *((volatile sl_reg*)p);
+		}
+
+	};
+
+	class _priv_ThreadPool_WorkStealing;
+
+	class _priv_ThreadPool_Worker : public Referable
+	{
+	public:
+		_priv_ThreadPool_WorkStealing* scheduler;
+		sl_uint32 index;
+		_priv_ThreadPool_Deque deque;
+		Ref<Thread> thread;
+		sl_bool flagSleeping; // protected by `_priv_ThreadPool_WorkStealing::lockSleeping`
+		sl_uint32 seed;
+
+	public:
+		_priv_ThreadPool_Worker()
+		{
+			scheduler = sl_null;
+			index = 0;
+			flagSleeping = sl_false;
+			seed = 0;
+		}
+
+	public:
+		sl_uint32 random()
+		{
+			// xorshift32
+			sl_uint32 x = seed;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			seed = x;
+			return x;
+		}
+
+	};
+
+	SLIB_THREAD _priv_ThreadPool_Worker* _gt_threadPoolWorkerCurrent = sl_null;
+
+	class _priv_ThreadPool_WorkStealing : public Referable
+	{
+	public:
+		Array< Ref<_priv_ThreadPool_Worker> > workers;
+		_priv_ThreadPool_InjectQueue inject;
+		LinkedQueue< Function<void()> > overflow;
+
+		Mutex lockSleeping;
+		List<_priv_ThreadPool_Worker*> sleepers;
+		sl_int32 nSleeping; // written under `lockSleeping`
+
+	public:
+		_priv_ThreadPool_WorkStealing()
+		{
+			nSleeping = 0;
+		}
+
+	public:
+		sl_bool addTask(const Function<void()>& task)
+		{
+			_priv_ThreadPool_Task* callable = task.ref.get();
+			_priv_ThreadPool_Worker* worker = _gt_threadPoolWorkerCurrent;
+			callable->increaseReference();
+			if (worker && worker->scheduler == this) {
+				if (!(worker->deque.push(callable))) {
+					callable->decreaseReference();
+					return sl_false;
+				}
+			} else {
+				if (!(inject.push(callable))) {
+					callable->decreaseReference();
+					if (!(overflow.push(task))) {
+						return sl_false;
+					}
+				}
+			}
+			// the compare-exchange is a barrier pairing with the one in `run` before checking the queues again, so that a sleeping worker never misses the task.
+			// It fails when any worker is sleeping
+			if (!(Base::interlockedCompareExchange32(&nSleeping, 0, 0))) {
+				wakeOne();
+			}
+			return sl_true;
+		}
+
+		void wakeOne()
+		{
+			_priv_ThreadPool_Worker* worker = sl_null;
+			{
+				MutexLocker lock(&lockSleeping);
+				if (sleepers.popBack_NoLock(&worker)) {
+					worker->flagSleeping = sl_false;
+					Base::interlockedDecrement32(&nSleeping);
+				}
+			}
+			if (worker) {
+				worker->thread->wakeSelfEvent();
+			}
+		}
+
+		sl_bool hasTask()
+		{
+			if (!(inject.isEmpty())) {
+				return sl_true;
+			}
+			if (overflow.getCount() > 0) {
+				return sl_true;
+			}
+			Ref<_priv_ThreadPool_Worker>* list = workers.getData();
+			sl_size n = workers.getCount();
+			for (sl_size i = 0; i < n; i++) {
+				if (!(list[i]->deque.isEmpty())) {
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+
+		_priv_ThreadPool_Task* findTask(_priv_ThreadPool_Worker* worker)
+		{
+			_priv_ThreadPool_Task* task = worker->deque.pop();
+			if (task) {
+				return task;
+			}
+			task = inject.pop();
+			if (task) {
+				return task;
+			}
+			if (overflow.getCount() > 0) {
+				Function<void()> f;
+				if (overflow.pop(&f)) {
+					task = f.ref.get();
+					task->increaseReference();
+					return task;
+				}
+			}
+			Ref<_priv_ThreadPool_Worker>* list = workers.getData();
+			sl_size n = workers.getCount();
+			if (n > 1) {
+				sl_size start = (sl_size)(worker->random() % n);
+				for (sl_size k = 0; k < n; k++) {
+					_priv_ThreadPool_Worker* victim = list[(start + k) % n].get();
+					if (victim != worker) {
+						task = victim->deque.steal();
+						if (task) {
+							return task;
+						}
+					}
+				}
+			}
+			return sl_null;
+		}
+
+		void cancelSleeping(_priv_ThreadPool_Worker* worker)
+		{
+			MutexLocker lock(&lockSleeping);
+			if (worker->flagSleeping) {
+				worker->flagSleeping = sl_false;
+				sleepers.remove_NoLock(worker);
+				Base::interlockedDecrement32(&nSleeping);
+			}
+		}
+
+		void run(ThreadPool* pool, _priv_ThreadPool_Worker* worker)
+		{
+			Ref<Thread> thread = worker->thread;
+			_gt_threadPoolWorkerCurrent = worker;
+			while (pool->isRunning() && Thread::isNotStoppingCurrent()) {
+				_priv_ThreadPool_Task* task = findTask(worker);
+				if (task) {
+					task->invoke();
+					task->decreaseReference();
+					continue;
+				}
+				{
+					MutexLocker lock(&lockSleeping);
+					if (!(worker->flagSleeping)) {
+						worker->flagSleeping = sl_true;
+						sleepers.add_NoLock(worker);
+						Base::interlockedIncrement32(&nSleeping);
+					}
+					// barrier between announcing the sleep and checking the queues
+					Base::interlockedCompareExchange32(&nSleeping, 0, 0);
+				}
+				if (hasTask()) {
+					cancelSleeping(worker);
+					continue;
+				}
+				// the objects replaced by the tasks are not kept while sleeping
+				HazardPointer::reclaimAll();
+				thread->wait();
+				cancelSleeping(worker);
+			}
+			cancelSleeping(worker);
+			_gt_threadPoolWorkerCurrent = sl_null;
+		}
+
+	};
+
+	// shared by all the thread pools, to dispatch the delayed tasks
+	class _priv_ThreadPool_Timer : public Referable
+	{
+	public:
+		TimerWheel wheel;
+		Ref<Thread> thread;
+		Mutex lockThread;
+		
+	public:
+		_priv_ThreadPool_Timer()
+		{
+			wheel.setWakeCallback(SLIB_FUNCTION_CLASS(_priv_ThreadPool_Timer, wake, this));
+		}
+		
+		~_priv_ThreadPool_Timer()
+		{
+			Ref<Thread> _thread = thread;
+			if (_thread.isNotNull()) {
+				_thread->finishAndWait();
+			}
+		}
+		
+	public:
+		Ref<TimerWheelEntry> addTask(const Function<void()>& task, sl_uint64 delay_ms)
+		{
+			Ref<Thread> _thread = thread;
+			if (_thread.isNull()) {
+				MutexLocker lock(&lockThread);
+				_thread = thread;
+				if (_thread.isNull()) {
+					_thread = Thread::start(SLIB_FUNCTION_CLASS(_priv_ThreadPool_Timer, run, this));
+					if (_thread.isNull()) {
+						return sl_null;
+					}
+					thread = _thread;
+				}
+			}
+			return wheel.add(task, delay_ms);
+		}
+		
+		void wake()
+		{
+			Ref<Thread> _thread = thread;
+			if (_thread.isNotNull()) {
+				_thread->wakeSelfEvent();
+			}
+		}
+		
+		void run()
+		{
+			Ref<Thread> thread = Thread::getCurrent();
+			if (thread.isNull()) {
+				return;
+			}
+			LinkedQueue< Function<void()> > tasks;
+			while (thread->isNotStopping()) {
+				sl_int32 t = wheel.pollExpired(tasks);
+				Function<void()> task;
+				while (tasks.pop_NoLock(&task)) {
+					task();
+				}
+				if (t < 0 || t > 10000) {
+					t = 10000;
+				}
+				if (t > 0) {
+					thread->wait(t);
+				}
+			}
+		}
+		
+	};
+	
+	SLIB_SAFE_STATIC_GETTER(Ref<_priv_ThreadPool_Timer>, _priv_ThreadPool_getTimer, new _priv_ThreadPool_Timer)
+	
+
 	SLIB_DEFINE_OBJECT(ThreadPool, Dispatcher)
 
 	ThreadPool::ThreadPool()
@@ -48,6 +588,54 @@ namespace slib
 		return ret;
 	}
 
+	Ref<ThreadPool> ThreadPool::createWorkStealing(sl_uint32 nWorkers)
+	{
+		if (!nWorkers) {
+			nWorkers = System::getProcessorsCount();
+		}
+		Ref<ThreadPool> ret = new ThreadPool();
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->setMinimumThreadsCount(nWorkers);
+		ret->setMaximumThreadsCount(nWorkers);
+		Ref<_priv_ThreadPool_WorkStealing> ws = new _priv_ThreadPool_WorkStealing;
+		if (ws.isNull()) {
+			return sl_null;
+		}
+		ws->workers = Array< Ref<_priv_ThreadPool_Worker> >::create(nWorkers);
+		if (ws->workers.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_ThreadPool_Worker>* workers = ws->workers.getData();
+		sl_uint32 i;
+		for (i = 0; i < nWorkers; i++) {
+			Ref<_priv_ThreadPool_Worker> worker = new _priv_ThreadPool_Worker;
+			if (worker.isNull()) {
+				return sl_null;
+			}
+			worker->scheduler = ws.get();
+			worker->index = i;
+			worker->seed = 0x9E3779B9 ^ (i * 0x85EBCA6B + 1);
+			Ref<Thread> thread = Thread::create(SLIB_BIND_CLASS(void(), ThreadPool, _runWorkStealing, ret.get(), i));
+			if (thread.isNull()) {
+				return sl_null;
+			}
+			worker->thread = thread;
+			workers[i] = worker;
+		}
+		ret->m_workStealing = ws;
+		for (i = 0; i < nWorkers; i++) {
+			Ref<Thread>& thread = workers[i]->thread;
+			if (!(thread->start(ret->getThreadStackSize()))) {
+				ret->release();
+				return sl_null;
+			}
+			ret->m_threadWorkers.add(thread);
+		}
+		return ret;
+	}
+
 	void ThreadPool::release()
 	{
 		ObjectLocker lock(this);
@@ -71,22 +659,34 @@ namespace slib
 		return m_flagRunning;
 	}
 
+	sl_bool ThreadPool::isWorkStealing()
+	{
+		return m_workStealing.isNotNull();
+	}
+
 	sl_uint32 ThreadPool::getThreadsCount()
 	{
 		return (sl_uint32)(m_threadWorkers.getCount());
 	}
 
-	sl_bool ThreadPool::addTask(const Function<void()>& task)
+	sl_bool ThreadPool::addTask(UniqueFunction<void()>&& task)
 	{
 		if (task.isNull()) {
 			return sl_false;
 		}
+		if (m_workStealing.isNotNull()) {
+			if (!m_flagRunning) {
+				return sl_false;
+			}
+			// the deques hold reference-counted callables
+			return m_workStealing->addTask(task.release());
+		}
 		ObjectLocker lock(this);
 		if (!m_flagRunning) {
 			return sl_false;
 		}
 		// add task
-		if (!(m_tasks.push(task))) {
+		if (!(m_tasks.push(Move(task)))) {
 			return sl_false;
 		}
 
@@ -114,7 +714,31 @@ namespace slib
 
 	sl_bool ThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
 	{
-		return addTask(callback);
+		if (delay_ms > 0) {
+			return addTimeout(callback, delay_ms).isNotNull();
+		}
+		return addTask(UniqueFunction<void()>(callback));
+	}
+
+	TimerHandle ThreadPool::addTimeout(const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		if (task.isNull() || !m_flagRunning) {
+			return sl_null;
+		}
+		Ref<_priv_ThreadPool_Timer>* pTimer = _priv_ThreadPool_getTimer();
+		if (!pTimer) {
+			return sl_null;
+		}
+		Ref<_priv_ThreadPool_Timer>& timer = *pTimer;
+		if (timer.isNull()) {
+			return sl_null;
+		}
+		return timer->addTask(SLIB_BIND_WEAKREF(void(), ThreadPool, _addTaskFromTimer, this, task), delay_ms);
+	}
+
+	void ThreadPool::_addTaskFromTimer(const Function<void()>& task)
+	{
+		addTask(UniqueFunction<void()>(task));
 	}
 
 	void ThreadPool::onRunWorker()
@@ -124,11 +748,15 @@ namespace slib
 			return;
 		}
 		while (m_flagRunning && Thread::isNotStoppingCurrent()) {
-			Function<void()> task;
+			UniqueFunction<void()> task;
 			if (m_tasks.pop(&task)) {
 				task();
 			} else {
 				ObjectLocker lock(this);
+				// the tasks are added while locking this pool, so the task added after the failed `pop` is found here instead of being left without a worker
+				if (m_tasks.isNotEmpty()) {
+					continue;
+				}
 				sl_size nThreads = m_threadWorkers.getCount();
 				if (nThreads > getMinimumThreadsCount()) {
 					m_threadWorkers.remove_NoLock(thread);
@@ -136,10 +764,24 @@ namespace slib
 				} else {
 					m_threadSleeping.push_NoLock(thread);
 					lock.unlock();
+					// the objects replaced by the tasks are not kept while sleeping
+					HazardPointer::reclaimAll();
 					thread->wait();
 				}
 			}
 		}
 	}
 
+	void ThreadPool::_runWorkStealing(sl_uint32 index)
+	{
+		Ref<_priv_ThreadPool_WorkStealing> ws = m_workStealing;
+		if (ws.isNull()) {
+			return;
+		}
+		Ref<_priv_ThreadPool_Worker> worker = ws->workers.getValueAt(index);
+		if (worker.isNotNull()) {
+			ws->run(this, worker.get());
+		}
+	}
+
 }
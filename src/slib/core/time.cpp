@@ -857,6 +857,146 @@ namespace slib
 		return String16::format(fmt, *this);
 	}
 
+	// days since 1970-01-01 from the civil date (proleptic Gregorian calendar)
+	static sl_int64 _priv_Time_getDaysFromCivil(sl_int64 year, sl_int32 month, sl_int32 day) noexcept
+	{
+		sl_int64 y = month <= 2 ? year - 1 : year;
+		sl_int64 era = (y >= 0 ? y : y - 399) / 400;
+		sl_int64 yoe = y - era * 400;
+		sl_int64 doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+		sl_int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + doe - 719468;
+	}
+
+	static void _priv_Time_getCivilFromDays(sl_int64 days, sl_int64& year, sl_int32& month, sl_int32& day) noexcept
+	{
+		sl_int64 z = days + 719468;
+		sl_int64 era = (z >= 0 ? z : z - 146096) / 146097;
+		sl_int64 doe = z - era * 146097;
+		sl_int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+		sl_int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+		sl_int64 mp = (5 * doy + 2) / 153;
+		day = (sl_int32)(doy - (153 * mp + 2) / 5 + 1);
+		month = (sl_int32)(mp < 10 ? mp + 3 : mp - 9);
+		year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+	}
+
+	String Time::toHttpDate() const noexcept
+	{
+		static const char* weekdays[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+		static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+		sl_int64 seconds = getSecondsCount();
+		sl_int64 days = seconds / 86400;
+		sl_int64 secondsOfDay = seconds % 86400;
+		if (secondsOfDay < 0) {
+			secondsOfDay += 86400;
+			days--;
+		}
+		sl_int64 weekday = days % 7;
+		if (weekday < 0) {
+			weekday += 7;
+		}
+		sl_int64 year;
+		sl_int32 month, day;
+		_priv_Time_getCivilFromDays(days, year, month, day);
+		return String::format("%s, %02d %s %04d %02d:%02d:%02d GMT", weekdays[weekday], day, months[month - 1], (sl_int32)year, (sl_int32)(secondsOfDay / 3600), (sl_int32)(secondsOfDay / 60 % 60), (sl_int32)(secondsOfDay % 60));
+	}
+
+	static sl_bool _priv_Time_parseHttpDateNumber(const sl_char8* sz, sl_size len, sl_int32& _out) noexcept
+	{
+		if (!len || len > 4) {
+			return sl_false;
+		}
+		sl_int32 n = 0;
+		for (sl_size i = 0; i < len; i++) {
+			if (!(SLIB_CHAR_IS_DIGIT(sz[i]))) {
+				return sl_false;
+			}
+			n = n * 10 + (sz[i] - '0');
+		}
+		_out = n;
+		return sl_true;
+	}
+
+	// hh:mm:ss
+	static sl_bool _priv_Time_parseHttpDateClock(const sl_char8* sz, sl_size len, sl_int32& hour, sl_int32& minute, sl_int32& second) noexcept
+	{
+		if (len != 8 || sz[2] != ':' || sz[5] != ':') {
+			return sl_false;
+		}
+		if (!(_priv_Time_parseHttpDateNumber(sz, 2, hour)) || !(_priv_Time_parseHttpDateNumber(sz + 3, 2, minute)) || !(_priv_Time_parseHttpDateNumber(sz + 6, 2, second))) {
+			return sl_false;
+		}
+		return hour < 24 && minute < 60 && second <= 60;
+	}
+
+	sl_bool Time::parseHttpDate(const String& str, Time* _out) noexcept
+	{
+		static const char* months[] = {"jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"};
+		sl_int32 year = -1;
+		sl_int32 month = -1;
+		sl_int32 day = -1;
+		sl_int32 hour = -1;
+		sl_int32 minute = 0;
+		sl_int32 second = 0;
+		const sl_char8* sz = str.getData();
+		sl_size len = str.getLength();
+		sl_size pos = 0;
+		// the tokens are separated by spaces, commas (after the weekday) and hyphens (RFC 850 date)
+		while (pos < len) {
+			sl_char8 ch = sz[pos];
+			if (ch == ' ' || ch == ',' || ch == '-') {
+				pos++;
+				continue;
+			}
+			const sl_char8* token = sz + pos;
+			sl_size start = pos;
+			while (pos < len && sz[pos] != ' ' && sz[pos] != ',' && sz[pos] != '-') {
+				pos++;
+			}
+			sl_size lenToken = pos - start;
+			if (lenToken > 2 && token[2] == ':') {
+				if (hour >= 0 || !(_priv_Time_parseHttpDateClock(token, lenToken, hour, minute, second))) {
+					return sl_false;
+				}
+			} else if (SLIB_CHAR_IS_DIGIT(ch)) {
+				sl_int32 n;
+				if (!(_priv_Time_parseHttpDateNumber(token, lenToken, n))) {
+					return sl_false;
+				}
+				if (day < 0 && lenToken <= 2) {
+					day = n;
+				} else if (year < 0) {
+					if (lenToken == 2) {
+						// RFC 850: two-digit year
+						n += n < 70 ? 2000 : 1900;
+					}
+					year = n;
+				} else {
+					return sl_false;
+				}
+			} else if (lenToken == 3 && month < 0) {
+				sl_char8 c0 = SLIB_CHAR_UPPER_TO_LOWER(token[0]);
+				sl_char8 c1 = SLIB_CHAR_UPPER_TO_LOWER(token[1]);
+				sl_char8 c2 = SLIB_CHAR_UPPER_TO_LOWER(token[2]);
+				for (sl_int32 i = 0; i < 12; i++) {
+					if (months[i][0] == c0 && months[i][1] == c1 && months[i][2] == c2) {
+						month = i + 1;
+						break;
+					}
+				}
+			}
+		}
+		if (year < 1970 || month < 0 || day < 1 || day > 31 || hour < 0) {
+			return sl_false;
+		}
+		if (_out) {
+			sl_int64 days = _priv_Time_getDaysFromCivil(year, month, day);
+			_out->setSecondsCount(days * 86400 + hour * 3600 + minute * 60 + second);
+		}
+		return sl_true;
+	}
+
 
 	template <class CT>
 	static sl_reg _priv_Time_parseElements(sl_int32* outYMDHMS, const CT* sz, sl_size i, sl_size n) noexcept
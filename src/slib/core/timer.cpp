@@ -204,4 +204,403 @@ namespace slib
 		}
 	}
 
+
+/******************************************************
+					TimerWheel
+******************************************************/
+
+/*
+	Slots: root level of 256 slots (1ms per slot), followed by 4 levels of 64 slots
+	(256ms, 16.384s, 17.48min, 18.64h per slot). Timeouts further than 2^32 ms are
+	placed in the last level, and are re-cascaded until they are due.
+*/
+#define PRIV_TIMER_WHEEL_ROOT_BITS 8
+#define PRIV_TIMER_WHEEL_ROOT_SIZE (1 << PRIV_TIMER_WHEEL_ROOT_BITS)
+#define PRIV_TIMER_WHEEL_ROOT_MASK (PRIV_TIMER_WHEEL_ROOT_SIZE - 1)
+#define PRIV_TIMER_WHEEL_LEVEL_BITS 6
+#define PRIV_TIMER_WHEEL_LEVEL_SIZE (1 << PRIV_TIMER_WHEEL_LEVEL_BITS)
+#define PRIV_TIMER_WHEEL_LEVEL_MASK (PRIV_TIMER_WHEEL_LEVEL_SIZE - 1)
+#define PRIV_TIMER_WHEEL_LEVEL_COUNT 4
+#define PRIV_TIMER_WHEEL_SLOT_COUNT (PRIV_TIMER_WHEEL_ROOT_SIZE + PRIV_TIMER_WHEEL_LEVEL_SIZE * PRIV_TIMER_WHEEL_LEVEL_COUNT)
+#define PRIV_TIMER_WHEEL_LEVEL_SHIFT(LEVEL) (PRIV_TIMER_WHEEL_ROOT_BITS + PRIV_TIMER_WHEEL_LEVEL_BITS * (LEVEL))
+#define PRIV_TIMER_WHEEL_LEVEL_SLOT(LEVEL, INDEX) (PRIV_TIMER_WHEEL_ROOT_SIZE + PRIV_TIMER_WHEEL_LEVEL_SIZE * (LEVEL) + (INDEX))
+#define PRIV_TIMER_WHEEL_MAX_INTERVAL SLIB_UINT64(0xFFFFFFFF)
+
+	SLIB_DEFINE_OBJECT(TimerWheelEntry, Referable)
+
+	TimerWheelEntry::TimerWheelEntry(const Function<void()>& task): m_task(task)
+	{
+		m_wheel = sl_null;
+		m_before = sl_null;
+		m_next = sl_null;
+		m_slot = 0;
+		m_timeExpire = 0;
+	}
+
+	TimerWheelEntry::~TimerWheelEntry()
+	{
+	}
+
+	const Function<void()>& TimerWheelEntry::getTask()
+	{
+		return m_task;
+	}
+
+	sl_bool TimerWheelEntry::isPending()
+	{
+		return m_wheel != sl_null;
+	}
+
+	sl_bool TimerWheelEntry::cancel()
+	{
+		TimerWheel* wheel = m_wheel;
+		if (wheel) {
+			return wheel->cancel(this);
+		}
+		return sl_false;
+	}
+
+	sl_bool TimerWheelEntry::reschedule(sl_uint64 delay_ms)
+	{
+		TimerWheel* wheel = m_wheel;
+		if (wheel) {
+			return wheel->_reschedule(this, delay_ms);
+		}
+		return sl_false;
+	}
+
+
+	TimerHandle::TimerHandle()
+	{
+	}
+
+	TimerHandle::TimerHandle(sl_null_t)
+	{
+	}
+
+	TimerHandle::TimerHandle(const Ref<TimerWheelEntry>& _entry): entry(_entry)
+	{
+	}
+
+	TimerHandle::TimerHandle(const TimerHandle& other): entry(other.entry)
+	{
+	}
+
+	TimerHandle::~TimerHandle()
+	{
+	}
+
+	TimerHandle& TimerHandle::operator=(const TimerHandle& other)
+	{
+		entry = other.entry;
+		return *this;
+	}
+
+	TimerHandle& TimerHandle::operator=(sl_null_t)
+	{
+		entry.setNull();
+		return *this;
+	}
+
+	sl_bool TimerHandle::isNull() const
+	{
+		return entry.isNull();
+	}
+
+	sl_bool TimerHandle::isNotNull() const
+	{
+		return entry.isNotNull();
+	}
+
+	void TimerHandle::setNull()
+	{
+		entry.setNull();
+	}
+
+	sl_bool TimerHandle::isPending() const
+	{
+		if (entry.isNotNull()) {
+			return entry->isPending();
+		}
+		return sl_false;
+	}
+
+	sl_bool TimerHandle::cancel() const
+	{
+		if (entry.isNotNull()) {
+			return entry->cancel();
+		}
+		return sl_false;
+	}
+
+	sl_bool TimerHandle::reschedule(sl_uint64 delay_ms) const
+	{
+		if (entry.isNotNull()) {
+			return entry->reschedule(delay_ms);
+		}
+		return sl_false;
+	}
+
+
+	TimerWheel::TimerWheel()
+	{
+		m_timeCurrent = 0;
+		m_timeNextPoll = SLIB_UINT64_MAX;
+		m_count = 0;
+		Base::zeroMemory(m_slots, sizeof(m_slots));
+	}
+
+	TimerWheel::~TimerWheel()
+	{
+		cancelAll();
+	}
+
+	sl_uint64 TimerWheel::getElapsedMilliseconds()
+	{
+		return m_timeCounter.getElapsedMilliseconds();
+	}
+
+	sl_size TimerWheel::getCount()
+	{
+		return m_count;
+	}
+
+	void TimerWheel::setWakeCallback(const Function<void()>& callback)
+	{
+		MutexLocker lock(&m_lock);
+		m_callbackWake = callback;
+	}
+
+	Ref<TimerWheelEntry> TimerWheel::add(const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		if (task.isNull()) {
+			return sl_null;
+		}
+		Ref<TimerWheelEntry> entry = new TimerWheelEntry(task);
+		if (entry.isNotNull()) {
+			if (schedule(entry.get(), delay_ms)) {
+				return entry;
+			}
+		}
+		return sl_null;
+	}
+
+	sl_bool TimerWheel::schedule(TimerWheelEntry* entry, sl_uint64 delay_ms)
+	{
+		return _schedule(entry, delay_ms, sl_false);
+	}
+
+	sl_bool TimerWheel::_reschedule(TimerWheelEntry* entry, sl_uint64 delay_ms)
+	{
+		return _schedule(entry, delay_ms, sl_true);
+	}
+
+	sl_bool TimerWheel::_schedule(TimerWheelEntry* entry, sl_uint64 delay_ms, sl_bool flagOnlyPending)
+	{
+		if (!entry) {
+			return sl_false;
+		}
+		sl_uint64 now = getElapsedMilliseconds();
+		MutexLocker lock(&m_lock);
+		if (entry->m_wheel) {
+			if (entry->m_wheel != this) {
+				return sl_false;
+			}
+			_remove(entry);
+		} else {
+			if (flagOnlyPending) {
+				return sl_false;
+			}
+			if (!m_count) {
+				m_timeCurrent = now;
+			}
+			entry->increaseReference();
+			m_count++;
+		}
+		entry->m_wheel = this;
+		entry->m_timeExpire = now + delay_ms;
+		_insert(entry);
+		if (entry->m_timeExpire < m_timeNextPoll) {
+			m_timeNextPoll = entry->m_timeExpire;
+			Function<void()> callback = m_callbackWake;
+			lock.unlock();
+			callback();
+		}
+		return sl_true;
+	}
+
+	sl_bool TimerWheel::cancel(TimerWheelEntry* entry)
+	{
+		if (!entry) {
+			return sl_false;
+		}
+		MutexLocker lock(&m_lock);
+		if (entry->m_wheel != this) {
+			return sl_false;
+		}
+		_remove(entry);
+		entry->m_wheel = sl_null;
+		m_count--;
+		lock.unlock();
+		entry->decreaseReference();
+		return sl_true;
+	}
+
+	void TimerWheel::cancelAll()
+	{
+		LinkedQueue<TimerWheelEntry*> entries;
+		{
+			MutexLocker lock(&m_lock);
+			for (sl_uint32 i = 0; i < PRIV_TIMER_WHEEL_SLOT_COUNT; i++) {
+				TimerWheelEntry* entry = m_slots[i];
+				while (entry) {
+					TimerWheelEntry* next = entry->m_next;
+					entry->m_wheel = sl_null;
+					entry->m_before = sl_null;
+					entry->m_next = sl_null;
+					entries.push_NoLock(entry);
+					entry = next;
+				}
+				m_slots[i] = sl_null;
+			}
+			m_count = 0;
+		}
+		TimerWheelEntry* entry;
+		while (entries.pop_NoLock(&entry)) {
+			entry->decreaseReference();
+		}
+	}
+
+	sl_int32 TimerWheel::pollExpired(LinkedQueue< Function<void()> >& output)
+	{
+		LinkedQueue<TimerWheelEntry*> expired;
+		sl_int32 timeout;
+		{
+			sl_uint64 now = getElapsedMilliseconds();
+			MutexLocker lock(&m_lock);
+			if (m_count == 0) {
+				m_timeCurrent = now + 1;
+			}
+			while (m_timeCurrent <= now) {
+				sl_uint32 index = (sl_uint32)(m_timeCurrent & PRIV_TIMER_WHEEL_ROOT_MASK);
+				if (!index) {
+					for (sl_uint32 level = 0; level < PRIV_TIMER_WHEEL_LEVEL_COUNT; level++) {
+						sl_uint32 indexLevel = (sl_uint32)((m_timeCurrent >> PRIV_TIMER_WHEEL_LEVEL_SHIFT(level)) & PRIV_TIMER_WHEEL_LEVEL_MASK);
+						_cascade(PRIV_TIMER_WHEEL_LEVEL_SLOT(level, indexLevel));
+						if (indexLevel) {
+							break;
+						}
+					}
+				}
+				TimerWheelEntry* entry = m_slots[index];
+				m_slots[index] = sl_null;
+				while (entry) {
+					TimerWheelEntry* next = entry->m_next;
+					entry->m_wheel = sl_null;
+					entry->m_before = sl_null;
+					entry->m_next = sl_null;
+					m_count--;
+					expired.push_NoLock(entry);
+					entry = next;
+				}
+				m_timeCurrent++;
+			}
+			timeout = _getTimeout(now);
+			if (timeout < 0) {
+				m_timeNextPoll = SLIB_UINT64_MAX;
+			} else {
+				m_timeNextPoll = now + timeout;
+			}
+		}
+		TimerWheelEntry* entry;
+		while (expired.pop_NoLock(&entry)) {
+			output.push_NoLock(entry->m_task);
+			entry->decreaseReference();
+		}
+		return timeout;
+	}
+
+	void TimerWheel::_insert(TimerWheelEntry* entry)
+	{
+		sl_uint64 expire = entry->m_timeExpire;
+		sl_uint32 slot;
+		if (expire < m_timeCurrent) {
+			slot = (sl_uint32)(m_timeCurrent & PRIV_TIMER_WHEEL_ROOT_MASK);
+		} else {
+			sl_uint64 interval = expire - m_timeCurrent;
+			if (interval < PRIV_TIMER_WHEEL_ROOT_SIZE) {
+				slot = (sl_uint32)(expire & PRIV_TIMER_WHEEL_ROOT_MASK);
+			} else {
+				if (interval > PRIV_TIMER_WHEEL_MAX_INTERVAL) {
+					expire = m_timeCurrent + PRIV_TIMER_WHEEL_MAX_INTERVAL;
+				}
+				sl_uint32 level = 0;
+				while (level < PRIV_TIMER_WHEEL_LEVEL_COUNT - 1 && interval >= ((sl_uint64)1 << PRIV_TIMER_WHEEL_LEVEL_SHIFT(level + 1))) {
+					level++;
+				}
+				slot = PRIV_TIMER_WHEEL_LEVEL_SLOT(level, (sl_uint32)((expire >> PRIV_TIMER_WHEEL_LEVEL_SHIFT(level)) & PRIV_TIMER_WHEEL_LEVEL_MASK));
+			}
+		}
+		entry->m_slot = slot;
+		entry->m_before = sl_null;
+		TimerWheelEntry* head = m_slots[slot];
+		entry->m_next = head;
+		if (head) {
+			head->m_before = entry;
+		}
+		m_slots[slot] = entry;
+	}
+
+	void TimerWheel::_remove(TimerWheelEntry* entry)
+	{
+		TimerWheelEntry* before = entry->m_before;
+		TimerWheelEntry* next = entry->m_next;
+		if (before) {
+			before->m_next = next;
+		} else {
+			m_slots[entry->m_slot] = next;
+		}
+		if (next) {
+			next->m_before = before;
+		}
+		entry->m_before = sl_null;
+		entry->m_next = sl_null;
+	}
+
+	void TimerWheel::_cascade(sl_uint32 slot)
+	{
+		TimerWheelEntry* entry = m_slots[slot];
+		m_slots[slot] = sl_null;
+		while (entry) {
+			TimerWheelEntry* next = entry->m_next;
+			_insert(entry);
+			entry = next;
+		}
+	}
+
+	sl_int32 TimerWheel::_getTimeout(sl_uint64 now)
+	{
+		if (!m_count) {
+			return -1;
+		}
+		// `m_timeCurrent` is greater than `now` here
+		sl_uint64 base = m_timeCurrent;
+		if (!(base & PRIV_TIMER_WHEEL_ROOT_MASK)) {
+			// cascading is pending at `base`
+			return (sl_int32)(base - now);
+		}
+		sl_uint32 nRootSlots = PRIV_TIMER_WHEEL_ROOT_SIZE - (sl_uint32)(base & PRIV_TIMER_WHEEL_ROOT_MASK);
+		for (sl_uint32 i = 0; i < nRootSlots; i++) {
+			if (m_slots[(base + i) & PRIV_TIMER_WHEEL_ROOT_MASK]) {
+				return (sl_int32)(base + i - now);
+			}
+		}
+		// next cascading time
+		sl_uint64 t = base + nRootSlots - now;
+		if (t > SLIB_INT32_MAX) {
+			return SLIB_INT32_MAX;
+		}
+		return (sl_int32)t;
+	}
+
 }
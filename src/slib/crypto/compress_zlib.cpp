@@ -42,6 +42,9 @@ namespace slib
 	ZlibCompress::ZlibCompress()
 	{
 		m_flagStarted = sl_false;
+		m_flagInitialized = sl_false;
+		m_level = 0;
+		m_windowBits = 0;
 	}
 
 	ZlibCompress::~ZlibCompress()
@@ -56,58 +59,33 @@ namespace slib
 
 	sl_bool ZlibCompress::start(sl_int32 level)
 	{
-		if (m_flagStarted) {
-			abort();
-		}
-		Base::zeroMemory(STREAM, sizeof(z_stream));
-		int iRet = deflateInit2(STREAM, level, Z_DEFLATED, 15, 8, Z_DEFAULT_STRATEGY);
-		if (iRet == Z_OK) {
-			m_flagStarted = sl_true;
-			return sl_true;
-		}
-		return sl_false;
+		return _start(level, 15);
 	}
 
 	sl_bool ZlibCompress::startRaw(sl_int32 level)
 	{
-		if (m_flagStarted) {
-			abort();
-		}
-		Base::zeroMemory(STREAM, sizeof(z_stream));
-		int iRet = deflateInit2(STREAM, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
-		if (iRet == Z_OK) {
-			m_flagStarted = sl_true;
-			return sl_true;
-		}
-		return sl_false;
+		return _start(level, -15);
 	}
 
 	sl_bool ZlibCompress::startGzip(const GzipParam& param, sl_int32 level)
 	{
-		if (m_flagStarted) {
-			abort();
+		if (!(_start(level, 31))) {
+			return sl_false;
 		}
-		Base::zeroMemory(STREAM, sizeof(z_stream));
-		int iRet = deflateInit2(STREAM, level, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY);
-		if (iRet == Z_OK) {
-			Base::zeroMemory(GZIP_HEADER, sizeof(gz_header));
-			m_gzipFileName = param.fileName;
-			if (m_gzipFileName.isNotEmpty()) {
-				GZIP_HEADER->name = (Bytef*)(m_gzipFileName.getData());
-			}
-			m_gzipComment = param.comment;
-			if (m_gzipComment.isNotEmpty()) {
-				GZIP_HEADER->comment = (Bytef*)(m_gzipComment.getData());
-			}
-			GZIP_HEADER->os = 255;
-			iRet = deflateSetHeader(STREAM, GZIP_HEADER);
-			if (iRet == Z_OK) {
-				m_flagStarted = sl_true;
-				return sl_true;
-			} else {
-				deflateEnd(STREAM);
-			}
+		Base::zeroMemory(GZIP_HEADER, sizeof(gz_header));
+		m_gzipFileName = param.fileName;
+		if (m_gzipFileName.isNotEmpty()) {
+			GZIP_HEADER->name = (Bytef*)(m_gzipFileName.getData());
+		}
+		m_gzipComment = param.comment;
+		if (m_gzipComment.isNotEmpty()) {
+			GZIP_HEADER->comment = (Bytef*)(m_gzipComment.getData());
 		}
+		GZIP_HEADER->os = 255;
+		if (deflateSetHeader(STREAM, GZIP_HEADER) == Z_OK) {
+			return sl_true;
+		}
+		abort();
 		return sl_false;
 	}
 
@@ -140,7 +118,8 @@ namespace slib
 		sizeInputPassed = sizeInputAvailable - stream->avail_in;
 		sizeOutputUsed = sizeOutputAvailable - stream->avail_out;
 		if (iRet == Z_STREAM_END) {
-			abort();
+			// keeps the deflate state to be reset by the next start
+			m_flagStarted = sl_false;
 			return 0;
 		}
 		return 1;
@@ -188,10 +167,38 @@ namespace slib
 
 	void ZlibCompress::abort()
 	{
-		if (m_flagStarted) {
+		if (m_flagInitialized) {
 			deflateEnd(STREAM);
-			m_flagStarted = sl_false;
+			m_flagInitialized = sl_false;
 		}
+		m_flagStarted = sl_false;
+	}
+
+	sl_bool ZlibCompress::_start(sl_int32 level, sl_int32 windowBits)
+	{
+		if (m_flagInitialized) {
+			if (windowBits == m_windowBits) {
+				// reuses the allocated state instead of initializing again
+				if (deflateReset(STREAM) == Z_OK) {
+					if (level == m_level || deflateParams(STREAM, level, Z_DEFAULT_STRATEGY) == Z_OK) {
+						m_level = level;
+						m_flagStarted = sl_true;
+						return sl_true;
+					}
+				}
+			}
+			abort();
+		}
+		Base::zeroMemory(STREAM, sizeof(z_stream));
+		int iRet = deflateInit2(STREAM, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+		if (iRet == Z_OK) {
+			m_level = level;
+			m_windowBits = windowBits;
+			m_flagInitialized = sl_true;
+			m_flagStarted = sl_true;
+			return sl_true;
+		}
+		return sl_false;
 	}
 
 	ZlibDecompress::ZlibDecompress()
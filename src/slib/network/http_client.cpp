@@ -0,0 +1,1278 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/network/http_client.h"
+
+#include "slib/network/http_common.h"
+#include "slib/network/http_io.h"
+#include "slib/network/async.h"
+#include "slib/network/url.h"
+#include "slib/network/os.h"
+#include "slib/core/file.h"
+#include "slib/core/system.h"
+#include "slib/core/safe_static.h"
+
+#if defined(DELETE)
+#	undef DELETE
+#endif
+
+#define PRIV_HTTP_CLIENT_READ_BUFFER_SIZE 16384
+#define PRIV_HTTP_CLIENT_MAX_HEADERS_SIZE 0x100000
+// a request failed by a stale keep-alive connection is sent again on another connection
+#define PRIV_HTTP_CLIENT_MAX_RETRIES 1
+
+namespace slib
+{
+
+	class _priv_HttpClientConnection;
+
+	class _priv_HttpClientRequest : public UrlRequest
+	{
+	public:
+		Ref<HttpClient> m_client;
+		String m_hostName;
+		sl_uint16 m_port;
+		Memory m_packetHeader;
+		sl_bool m_flagIdempotent;
+		sl_uint32 m_countRetries;
+		Ref<File> m_fileDownload;
+		
+	public:
+		_priv_HttpClientRequest()
+		{
+			m_port = 80;
+			m_flagIdempotent = sl_false;
+			m_countRetries = 0;
+		}
+		
+		~_priv_HttpClientRequest()
+		{
+		}
+		
+	public:
+		static Ref<_priv_HttpClientRequest> create(HttpClient* client, const UrlRequestParam& param, const String& url)
+		{
+			Ref<_priv_HttpClientRequest> ret = new _priv_HttpClientRequest;
+			if (ret.isNotNull()) {
+				ret->_init(param, url);
+				if (ret->_prepare()) {
+					ret->m_client = client;
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+		
+		static sl_bool parseHostAddress(const String& url, String* pScheme, String* pHostName, sl_uint16* pPort, Url* pUrl)
+		{
+			pUrl->parse(url);
+			String scheme = pUrl->scheme;
+			if (pScheme) {
+				*pScheme = scheme;
+			}
+			if (!(scheme.equalsIgnoreCase("http"))) {
+				return sl_false;
+			}
+			String host = pUrl->host;
+			sl_reg indexPort;
+			if (host.startsWith('[')) {
+				// IPv6 literal
+				sl_reg indexEnd = host.indexOf(']');
+				if (indexEnd < 0) {
+					return sl_false;
+				}
+				*pHostName = host.substring(1, indexEnd);
+				indexPort = indexEnd + 1;
+				if (indexPort < (sl_reg)(host.getLength()) && host.getAt(indexPort) != ':') {
+					return sl_false;
+				}
+			} else {
+				indexPort = host.indexOf(':');
+				if (indexPort < 0) {
+					indexPort = host.getLength();
+				}
+				*pHostName = host.substring(0, indexPort);
+			}
+			if (pHostName->isEmpty()) {
+				return sl_false;
+			}
+			*pPort = 80;
+			if (indexPort + 1 < (sl_reg)(host.getLength())) {
+				sl_uint32 port;
+				if (!(host.substring(indexPort + 1).parseUint32(10, &port)) || !port || port > 0xFFFF) {
+					return sl_false;
+				}
+				*pPort = (sl_uint16)port;
+			}
+			return sl_true;
+		}
+		
+		sl_bool _prepare()
+		{
+			Url url;
+			if (!(parseHostAddress(m_url, sl_null, &m_hostName, &m_port, &url))) {
+				return sl_false;
+			}
+			switch (m_method) {
+				case HttpMethod::GET:
+				case HttpMethod::HEAD:
+				case HttpMethod::PUT:
+				case HttpMethod::DELETE:
+				case HttpMethod::OPTIONS:
+				case HttpMethod::TRACE:
+					m_flagIdempotent = sl_true;
+					break;
+				default:
+					break;
+			}
+			HttpRequest request;
+			request.setMethod(m_method);
+			request.setPath(url.path);
+			request.setQuery(url.query);
+			for (auto& pair : m_requestHeaders) {
+				request.addRequestHeader(pair.key, pair.value);
+			}
+			for (auto& pair : m_additionalRequestHeaders) {
+				request.addRequestHeader(pair.key, pair.value);
+			}
+			if (!(request.containsRequestHeader(HttpHeaders::Host))) {
+				String host = url.host;
+				request.setHost(host);
+			}
+			sl_size sizeBody = m_requestBody.getSize();
+			if (sizeBody || m_method == HttpMethod::POST || m_method == HttpMethod::PUT) {
+				if (!(request.containsRequestHeader(HttpHeaders::ContentLength))) {
+					request.setRequestContentLengthHeader(sizeBody);
+				}
+			}
+			m_packetHeader = request.makeRequestPacket();
+			return m_packetHeader.isNotNull();
+		}
+		
+		void _sendAsync() override
+		{
+			m_client->_sendRequest(this);
+		}
+		
+	public:
+		sl_uint32 getTimeout()
+		{
+			return m_timeout;
+		}
+		
+		void processResponse(HttpResponse& response, sl_uint64 sizeContent)
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			m_responseStatus = response.getResponseCode();
+			m_responseMessage = response.getResponseMessage();
+			m_responseHeaders = response.getResponseHeaders();
+			m_sizeContentTotal = sizeContent;
+			if (m_downloadFilePath.isNotEmpty()) {
+				m_fileDownload = File::openForWrite(m_downloadFilePath);
+			}
+			onResponse();
+		}
+		
+		void processContent(const void* data, sl_size size, const Memory& mem)
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			if (m_downloadFilePath.isNotEmpty()) {
+				if (m_fileDownload.isNotNull()) {
+					sl_reg n = m_fileDownload->write(data, size);
+					if (n > 0) {
+						onDownloadContent(n);
+					}
+				}
+			} else {
+				onReceiveContent(data, size, mem);
+			}
+		}
+		
+		void processUpload()
+		{
+			sl_size size = m_requestBody.getSize();
+			if (size) {
+				m_sizeBodySent = size;
+				onUploadBody(size);
+			}
+		}
+		
+		void processComplete()
+		{
+			m_fileDownload.setNull();
+			onComplete();
+		}
+		
+		void processError(const String& message)
+		{
+			m_fileDownload.setNull();
+			m_lastErrorMessage = message;
+			onError();
+		}
+		
+	};
+	
+	class _priv_HttpClientHost : public Referable
+	{
+	public:
+		WeakRef<HttpClient> m_client;
+		String m_key;
+		String m_name;
+		sl_uint16 m_port;
+		
+		Mutex m_lock;
+		// requests waiting for a connection
+		List< Ref<_priv_HttpClientRequest> > m_queueRequests;
+		List< Ref<_priv_HttpClientConnection> > m_connections;
+		sl_bool m_flagResolving;
+		sl_bool m_flagRemoved;
+		
+	public:
+		_priv_HttpClientHost(HttpClient* client, const String& key, const String& name, sl_uint16 port)
+		 : m_client(client), m_key(key), m_name(name), m_port(port)
+		{
+			m_flagResolving = sl_false;
+			m_flagRemoved = sl_false;
+		}
+		
+	public:
+		// returns sl_false when the host is removed from the client
+		sl_bool sendRequest(_priv_HttpClientRequest* request);
+		
+		void closeIdleConnections();
+		
+		void close();
+		
+		sl_uint32 getConnectionsCount()
+		{
+			MutexLocker lock(&m_lock);
+			return (sl_uint32)(m_connections.getCount());
+		}
+		
+		// requests which could not be sent are added to `failed`
+		void _dispatch_NoLock(List< Ref<_priv_HttpClientRequest> >& failed, const IPAddress* addressResolved = sl_null);
+		
+		_priv_HttpClientConnection* _findConnection_NoLock(_priv_HttpClientRequest* request, sl_uint32 maxPipelinedRequests);
+		
+		// marks the host to be removed when it has neither connection nor request
+		sl_bool _checkRemove_NoLock();
+		
+		void _remove();
+		
+		void _resolve();
+		
+		void _onResolved(const IPAddress& address);
+		
+		static void _processFailedRequests(const List< Ref<_priv_HttpClientRequest> >& failed, const String& message);
+		
+	};
+	
+	class _priv_HttpClientConnection : public Referable, public IHttpContentReaderListener
+	{
+	public:
+		WeakRef<_priv_HttpClientHost> m_host;
+		Ref<AsyncIoLoop> m_ioLoop;
+		Ref<AsyncTcpSocket> m_socket;
+		
+		// guarded by the lock of the host
+		sl_bool m_flagConnected;
+		sl_bool m_flagClosed;
+		sl_bool m_flagKeepAlive;
+		sl_bool m_flagPipelining;
+		List< Ref<_priv_HttpClientRequest> > m_requests; // in the order of the responses
+		sl_uint32 m_countSent;
+		sl_uint32 m_countResponses;
+		TimerHandle m_timerIdle;
+		TimerHandle m_timerRequest;
+		
+		// accessed only on the I/O loop
+		Memory m_bufRead;
+		HttpHeaderReader m_headerReader;
+		Ref<_priv_HttpClientRequest> m_requestCurrent;
+		Ref<HttpContentReader> m_contentReader;
+		sl_bool m_flagReadToEnd;
+		sl_bool m_flagReceivedResponse;
+		sl_bool m_flagContentCompleted;
+		sl_bool m_flagContentError;
+		void* m_dataRemained;
+		sl_uint32 m_sizeRemained;
+		
+	public:
+		_priv_HttpClientConnection()
+		{
+			m_flagConnected = sl_false;
+			m_flagClosed = sl_false;
+			m_flagKeepAlive = sl_true;
+			m_flagPipelining = sl_false;
+			m_countSent = 0;
+			m_countResponses = 0;
+			
+			m_flagReadToEnd = sl_false;
+			m_flagReceivedResponse = sl_false;
+			m_flagContentCompleted = sl_false;
+			m_flagContentError = sl_false;
+			m_dataRemained = sl_null;
+			m_sizeRemained = 0;
+		}
+		
+		~_priv_HttpClientConnection()
+		{
+		}
+		
+	public:
+		static Ref<_priv_HttpClientConnection> create(_priv_HttpClientHost* host, const Ref<AsyncIoLoop>& loop, const SocketAddress& address)
+		{
+			Memory buf = Memory::create(PRIV_HTTP_CLIENT_READ_BUFFER_SIZE);
+			if (buf.isNull()) {
+				return sl_null;
+			}
+			Ref<_priv_HttpClientConnection> ret = new _priv_HttpClientConnection;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->m_host = host;
+			ret->m_ioLoop = loop;
+			ret->m_bufRead = buf;
+			Ref<Socket> socket = address.ip.isIPv6() ? Socket::openTcp_IPv6() : Socket::openTcp();
+			if (socket.isNull()) {
+				return sl_null;
+			}
+			socket->setOption_TcpNoDelay(sl_true);
+			AsyncTcpSocketParam param;
+			param.socket = socket;
+			param.ioLoop = loop;
+			param.flagLogError = sl_false;
+			param.onConnect = SLIB_FUNCTION_WEAKREF(_priv_HttpClientConnection, onConnect, ret.get());
+			Ref<AsyncTcpSocket> tcp = AsyncTcpSocket::create(param);
+			if (tcp.isNull()) {
+				return sl_null;
+			}
+			ret->m_socket = tcp;
+			if (!(tcp->connect(address))) {
+				return sl_null;
+			}
+			return ret;
+		}
+		
+	public:
+		sl_bool isIdle_NoLock()
+		{
+			return !m_flagClosed && m_flagKeepAlive && m_requests.getCount() == 0;
+		}
+		
+		sl_bool canPipeline_NoLock(sl_uint32 maxPipelinedRequests)
+		{
+			// pipelining only after a persistent HTTP/1.1 response is received on the connection
+			return !m_flagClosed && m_flagKeepAlive && m_flagPipelining && m_flagConnected && m_countResponses > 0 && m_requests.getCount() < maxPipelinedRequests;
+		}
+		
+		void addRequest_NoLock(_priv_HttpClientRequest* request)
+		{
+			m_timerIdle.cancel();
+			m_timerIdle.setNull();
+			if (!(request->m_flagIdempotent)) {
+				m_flagPipelining = sl_false;
+			}
+			m_requests.add_NoLock(request);
+			if (m_flagConnected) {
+				_sendRequests_NoLock();
+			}
+		}
+		
+		void _sendRequests_NoLock()
+		{
+			sl_uint32 n = (sl_uint32)(m_requests.getCount());
+			Ref<_priv_HttpClientRequest>* requests = m_requests.getData();
+			while (m_countSent < n) {
+				_priv_HttpClientRequest* request = requests[m_countSent].get();
+				Memory body = request->getRequestBody();
+				sl_bool flagSuccess;
+				if (body.isNotNull()) {
+					flagSuccess = m_socket->send(request->m_packetHeader, sl_null) && m_socket->send(body, SLIB_BIND_WEAKREF(void(AsyncStreamResult*), _priv_HttpClientConnection, onSend, this, Ref<_priv_HttpClientRequest>(request)));
+				} else {
+					flagSuccess = m_socket->send(request->m_packetHeader, SLIB_BIND_WEAKREF(void(AsyncStreamResult*), _priv_HttpClientConnection, onSend, this, Ref<_priv_HttpClientRequest>(request)));
+				}
+				if (!flagSuccess) {
+					m_ioLoop->addTask(SLIB_BIND_WEAKREF(void(), _priv_HttpClientConnection, closeWithError, this, String("Failed to send the request")));
+					return;
+				}
+				if (!m_countSent) {
+					_startRequestTimer_NoLock(request);
+				}
+				m_countSent++;
+			}
+		}
+		
+		void _startRequestTimer_NoLock(_priv_HttpClientRequest* request)
+		{
+			m_timerRequest.cancel();
+			m_timerRequest.setNull();
+			sl_uint32 timeout = request->getTimeout();
+			if (timeout) {
+				m_timerRequest = m_ioLoop->addTimeout(SLIB_BIND_WEAKREF(void(), _priv_HttpClientConnection, onRequestTimeout, this, request), timeout);
+			}
+		}
+		
+		void _startIdleTimer_NoLock(sl_uint32 timeout)
+		{
+			m_timerIdle.cancel();
+			m_timerIdle = m_ioLoop->addTimeout(SLIB_FUNCTION_WEAKREF(_priv_HttpClientConnection, onIdleTimeout, this), timeout);
+		}
+		
+		void _read()
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			if (!(m_socket->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(_priv_HttpClientConnection, onRead, this)))) {
+				closeWithError("Failed to receive the response");
+			}
+		}
+		
+		Ref<_priv_HttpClientRequest> _getFrontRequest()
+		{
+			Ref<_priv_HttpClientHost> host = m_host;
+			if (host.isNull()) {
+				return sl_null;
+			}
+			MutexLocker lock(&(host->m_lock));
+			if (m_countSent) {
+				return m_requests.getValueAt_NoLock(0);
+			}
+			return sl_null;
+		}
+		
+		// returns sl_false when the connection is closed
+		sl_bool _processInput(char* data, sl_uint32 size)
+		{
+			for (;;) {
+				if (m_requestCurrent.isNull()) {
+					if (!size) {
+						return sl_true;
+					}
+					Ref<_priv_HttpClientRequest> request = _getFrontRequest();
+					if (request.isNull()) {
+						closeWithError("Unexpected data is received");
+						return sl_false;
+					}
+					m_flagReceivedResponse = sl_true;
+					sl_size posBody;
+					if (!(m_headerReader.add(data, size, posBody))) {
+						if (m_headerReader.getHeaderSize() > PRIV_HTTP_CLIENT_MAX_HEADERS_SIZE) {
+							closeWithError("Response header is too large");
+							return sl_false;
+						}
+						return sl_true;
+					}
+					Memory header = m_headerReader.mergeHeader();
+					m_headerReader.clear();
+					if (posBody > size) {
+						closeWithError("Invalid response");
+						return sl_false;
+					}
+					data += posBody;
+					size -= (sl_uint32)posBody;
+					HttpResponse response;
+					if (response.parseResponsePacket(header.getData(), header.getSize()) != (sl_reg)(header.getSize())) {
+						closeWithError("Invalid response");
+						return sl_false;
+					}
+					HttpStatus status = response.getResponseCode();
+					if ((int)status >= 100 && (int)status < 200) {
+						// informational (100 Continue)
+						continue;
+					}
+					if (!(_startResponse(request.get(), response))) {
+						return sl_false;
+					}
+					if (m_contentReader.isNull()) {
+						if (!(_completeResponse())) {
+							return sl_false;
+						}
+						continue;
+					}
+				}
+				if (!size) {
+					return sl_true;
+				}
+				m_flagContentCompleted = sl_false;
+				Memory content = m_contentReader->feed(data, size);
+				if (content.isNotNull()) {
+					// non-decompressed content refers the reading buffer, so it should be copied when stored
+					m_requestCurrent->processContent(content.getData(), content.getSize(), m_contentReader->isDecompressing() ? content : Memory::null());
+				}
+				if (m_flagContentError) {
+					closeWithError("Invalid response content");
+					return sl_false;
+				}
+				if (!m_flagContentCompleted) {
+					return sl_true;
+				}
+				data = (char*)m_dataRemained;
+				size = m_sizeRemained;
+				if (!(_completeResponse())) {
+					return sl_false;
+				}
+			}
+		}
+		
+		sl_bool _startResponse(_priv_HttpClientRequest* request, HttpResponse& response)
+		{
+			HttpStatus status = response.getResponseCode();
+			
+			sl_bool flagKeepAlive = sl_true;
+			SLIB_STATIC_STRING(strConnection, "Connection")
+			String connection = response.getResponseHeader(strConnection);
+			if (response.getResponseVersion().equalsIgnoreCase("HTTP/1.0")) {
+				flagKeepAlive = connection.equalsIgnoreCase("keep-alive");
+			} else if (connection.equalsIgnoreCase("close")) {
+				flagKeepAlive = sl_false;
+			}
+			
+			sl_bool flagDecompress = sl_false;
+			String encoding = response.getResponseContentEncoding();
+			if (encoding.isNotEmpty()) {
+				if (encoding.equalsIgnoreCase("gzip") || encoding.equalsIgnoreCase("deflate")) {
+					flagDecompress = sl_true;
+				}
+			}
+			
+			Ptr<IHttpContentReaderListener> listener(WeakRef<_priv_HttpClientConnection>(this));
+			sl_uint64 sizeContent = 0;
+			m_contentReader.setNull();
+			m_flagReadToEnd = sl_false;
+			m_flagContentError = sl_false;
+			if (request->getMethod() == HttpMethod::HEAD || status == HttpStatus::NoContent || status == HttpStatus::NotModified) {
+				// no content
+			} else if (response.isChunkedResponse()) {
+				m_contentReader = HttpContentReader::createChunked(sl_null, listener, 0, flagDecompress);
+				if (m_contentReader.isNull()) {
+					closeWithError("Failed to read the response content");
+					return sl_false;
+				}
+			} else if (response.containsResponseHeader(HttpHeaders::ContentLength)) {
+				sizeContent = response.getResponseContentLengthHeader();
+				if (sizeContent) {
+					m_contentReader = HttpContentReader::createPersistent(sl_null, listener, sizeContent, 0, flagDecompress);
+					if (m_contentReader.isNull()) {
+						closeWithError("Failed to read the response content");
+						return sl_false;
+					}
+				}
+			} else {
+				// content is terminated by closing the connection
+				m_contentReader = HttpContentReader::createTearDown(sl_null, listener, 0, flagDecompress);
+				if (m_contentReader.isNull()) {
+					closeWithError("Failed to read the response content");
+					return sl_false;
+				}
+				m_flagReadToEnd = sl_true;
+				flagKeepAlive = sl_false;
+			}
+			if (flagDecompress) {
+				sizeContent = 0;
+			}
+			
+			Ref<_priv_HttpClientHost> host = m_host;
+			if (host.isNotNull()) {
+				MutexLocker lock(&(host->m_lock));
+				if (!flagKeepAlive) {
+					m_flagKeepAlive = sl_false;
+				}
+				if (!m_countResponses && flagKeepAlive && !(response.getResponseVersion().equalsIgnoreCase("HTTP/1.0"))) {
+					m_flagPipelining = sl_true;
+					for (auto& item : m_requests) {
+						if (!(item->m_flagIdempotent)) {
+							m_flagPipelining = sl_false;
+						}
+					}
+				}
+			}
+			
+			m_requestCurrent = request;
+			request->processResponse(response, sizeContent);
+			return sl_true;
+		}
+		
+		sl_bool _completeResponse()
+		{
+			Ref<_priv_HttpClientRequest> request = m_requestCurrent;
+			m_requestCurrent.setNull();
+			m_contentReader.setNull();
+			m_flagReceivedResponse = sl_false;
+			Ref<_priv_HttpClientHost> host = m_host;
+			if (host.isNull()) {
+				return sl_false;
+			}
+			Ref<HttpClient> client = host->m_client;
+			if (client.isNull()) {
+				return sl_false;
+			}
+			sl_bool flagKeepAlive;
+			List< Ref<_priv_HttpClientRequest> > failed;
+			{
+				MutexLocker lock(&(host->m_lock));
+				if (m_flagClosed) {
+					return sl_false;
+				}
+				m_requests.popFront_NoLock();
+				m_countSent--;
+				m_countResponses++;
+				flagKeepAlive = m_flagKeepAlive;
+				if (flagKeepAlive) {
+					if (m_countSent) {
+						_startRequestTimer_NoLock(m_requests.getValueAt_NoLock(0).get());
+					} else {
+						m_timerRequest.cancel();
+						m_timerRequest.setNull();
+						if (!(m_requests.getCount())) {
+							_startIdleTimer_NoLock(client->getParam().keepAliveTimeout);
+						}
+					}
+					host->_dispatch_NoLock(failed);
+				}
+			}
+			request->processComplete();
+			_priv_HttpClientHost::_processFailedRequests(failed, sl_null);
+			if (!flagKeepAlive) {
+				close(sl_null, sl_false);
+				return sl_false;
+			}
+			return sl_true;
+		}
+		
+		void closeWithError(const String& message)
+		{
+			close(message, sl_true);
+		}
+		
+		// `flagFrontFailed`: the response for the first request can not be received. the other requests are sent again on another connection
+		void close(const String& message, sl_bool flagFrontFailed)
+		{
+			Ref<_priv_HttpClientHost> host = m_host;
+			List< Ref<_priv_HttpClientRequest> > failed;
+			sl_bool flagRemoveHost = sl_false;
+			if (host.isNotNull()) {
+				MutexLocker lock(&(host->m_lock));
+				if (m_flagClosed) {
+					return;
+				}
+				_close_NoLock();
+				host->m_connections.remove_NoLock(this);
+				sl_size n = m_requests.getCount();
+				Ref<_priv_HttpClientRequest>* requests = m_requests.getData();
+				List< Ref<_priv_HttpClientRequest> > retries;
+				for (sl_size i = 0; i < n; i++) {
+					_priv_HttpClientRequest* request = requests[i].get();
+					sl_bool flagRetry = sl_false;
+					if (request->m_countRetries < PRIV_HTTP_CLIENT_MAX_RETRIES) {
+						if (!i) {
+							if (!flagFrontFailed && !m_flagReceivedResponse && (m_countResponses || m_flagConnected) && (i >= m_countSent || request->m_flagIdempotent)) {
+								flagRetry = sl_true;
+							}
+						} else {
+							if (i >= m_countSent || request->m_flagIdempotent) {
+								flagRetry = sl_true;
+							}
+						}
+					}
+					if (flagRetry) {
+						request->m_countRetries++;
+						retries.add_NoLock(request);
+					} else {
+						failed.add_NoLock(request);
+					}
+				}
+				m_requests.removeAll_NoLock();
+				m_countSent = 0;
+				host->m_queueRequests.insertElements_NoLock(0, retries.getData(), retries.getCount());
+				host->_dispatch_NoLock(failed);
+				flagRemoveHost = host->_checkRemove_NoLock();
+			} else {
+				if (m_flagClosed) {
+					return;
+				}
+				_close_NoLock();
+			}
+			if (flagRemoveHost) {
+				host->_remove();
+			}
+			m_requestCurrent.setNull();
+			m_contentReader.setNull();
+			if (message.isNotNull()) {
+				_priv_HttpClientHost::_processFailedRequests(failed, message);
+			} else {
+				_priv_HttpClientHost::_processFailedRequests(failed, "Connection is closed");
+			}
+		}
+		
+		void _close_NoLock()
+		{
+			m_flagClosed = sl_true;
+			m_timerIdle.cancel();
+			m_timerIdle.setNull();
+			m_timerRequest.cancel();
+			m_timerRequest.setNull();
+			m_socket->close();
+		}
+		
+	public:
+		void onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+		{
+			if (flagError) {
+				{
+					Ref<_priv_HttpClientHost> host = m_host;
+					if (host.isNotNull()) {
+						MutexLocker lock(&(host->m_lock));
+						// not to retry the requests on an unreachable host
+						for (auto& request : m_requests) {
+							request->m_countRetries = PRIV_HTTP_CLIENT_MAX_RETRIES;
+						}
+					}
+				}
+				closeWithError("Failed to connect to " + address.toString());
+				return;
+			}
+			{
+				Ref<_priv_HttpClientHost> host = m_host;
+				if (host.isNull()) {
+					return;
+				}
+				MutexLocker lock(&(host->m_lock));
+				if (m_flagClosed) {
+					return;
+				}
+				m_flagConnected = sl_true;
+				_sendRequests_NoLock();
+			}
+			_read();
+		}
+		
+		void onSend(const Ref<_priv_HttpClientRequest>& request, AsyncStreamResult* result)
+		{
+			if (result->flagError) {
+				closeWithError("Failed to send the request");
+				return;
+			}
+			request->processUpload();
+		}
+		
+		void onRead(AsyncStreamResult* result)
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			if (result->size) {
+				if (!(_processInput((char*)(result->data), result->size))) {
+					return;
+				}
+			}
+			if (result->flagError) {
+				if (m_flagReadToEnd && m_requestCurrent.isNotNull()) {
+					// the content is terminated by the end of stream
+					_completeResponse();
+					return;
+				}
+				close("Connection is closed by the server", sl_false);
+				return;
+			}
+			_read();
+		}
+		
+		void onCompleteReadHttpContent(void* dataRemained, sl_uint32 sizeRemained, sl_bool flagError) override
+		{
+			m_flagContentCompleted = sl_true;
+			m_flagContentError = flagError;
+			m_dataRemained = dataRemained;
+			m_sizeRemained = sizeRemained;
+		}
+		
+		void onRequestTimeout(_priv_HttpClientRequest* request)
+		{
+			if (_getFrontRequest().get() != request) {
+				return;
+			}
+			closeWithError("Request timeout");
+		}
+		
+		void onIdleTimeout()
+		{
+			Ref<_priv_HttpClientHost> host = m_host;
+			if (host.isNull()) {
+				return;
+			}
+			{
+				MutexLocker lock(&(host->m_lock));
+				if (!(isIdle_NoLock())) {
+					return;
+				}
+			}
+			close(sl_null, sl_false);
+		}
+		
+	};
+	
+	sl_bool _priv_HttpClientHost::sendRequest(_priv_HttpClientRequest* request)
+	{
+		List< Ref<_priv_HttpClientRequest> > failed;
+		sl_bool flagRemove;
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagRemoved) {
+				return sl_false;
+			}
+			m_queueRequests.add_NoLock(request);
+			_dispatch_NoLock(failed);
+			flagRemove = _checkRemove_NoLock();
+		}
+		if (flagRemove) {
+			_remove();
+		}
+		_processFailedRequests(failed, "Failed to connect to " + m_name);
+		return sl_true;
+	}
+	
+	void _priv_HttpClientHost::_dispatch_NoLock(List< Ref<_priv_HttpClientRequest> >& failed, const IPAddress* addressResolved)
+	{
+		if (!(m_queueRequests.getCount())) {
+			return;
+		}
+		Ref<HttpClient> client = m_client;
+		if (client.isNull() || client->m_flagReleased) {
+			failed.addAll_NoLock(m_queueRequests);
+			m_queueRequests.removeAll_NoLock();
+			return;
+		}
+		const HttpClientParam& param = client->m_param;
+		IPAddress address;
+		sl_bool flagAddress = sl_false;
+		Ref<_priv_HttpClientRequest> request;
+		while (m_queueRequests.getAt_NoLock(0, &request)) {
+			if (request->isClosed()) {
+				// canceled
+				m_queueRequests.popFront_NoLock();
+				continue;
+			}
+			_priv_HttpClientConnection* connection = _findConnection_NoLock(request.get(), param.maxPipelinedRequests);
+			Ref<_priv_HttpClientConnection> connectionNew;
+			if (!connection) {
+				if (m_connections.getCount() >= param.maxConnectionsPerHost) {
+					return;
+				}
+				if (!flagAddress) {
+					if (addressResolved) {
+						address = *addressResolved;
+					} else if (!(IPAddress::parse(m_name, &address)) && !(client->_getCachedAddress(m_name, address))) {
+						if (!m_flagResolving) {
+							// resolved out of the lock, because the callback can be invoked before `_resolveAddress` returns
+							if (client->m_ioLoop->addTask(SLIB_FUNCTION_WEAKREF(_priv_HttpClientHost, _resolve, this))) {
+								m_flagResolving = sl_true;
+							} else {
+								failed.addAll_NoLock(m_queueRequests);
+								m_queueRequests.removeAll_NoLock();
+							}
+						}
+						return;
+					}
+					flagAddress = sl_true;
+				}
+				connectionNew = _priv_HttpClientConnection::create(this, client->m_ioLoop, SocketAddress(address, m_port));
+				if (connectionNew.isNull()) {
+					m_queueRequests.popFront_NoLock();
+					failed.add_NoLock(request);
+					continue;
+				}
+				m_connections.add_NoLock(connectionNew);
+				connection = connectionNew.get();
+			}
+			m_queueRequests.popFront_NoLock();
+			connection->addRequest_NoLock(request.get());
+		}
+	}
+	
+	_priv_HttpClientConnection* _priv_HttpClientHost::_findConnection_NoLock(_priv_HttpClientRequest* request, sl_uint32 maxPipelinedRequests)
+	{
+		sl_size n = m_connections.getCount();
+		Ref<_priv_HttpClientConnection>* connections = m_connections.getData();
+		_priv_HttpClientConnection* ret = sl_null;
+		for (sl_size i = 0; i < n; i++) {
+			_priv_HttpClientConnection* connection = connections[i].get();
+			if (connection->isIdle_NoLock()) {
+				return connection;
+			}
+			if (request->m_flagIdempotent && connection->canPipeline_NoLock(maxPipelinedRequests)) {
+				if (!ret || connection->m_requests.getCount() < ret->m_requests.getCount()) {
+					ret = connection;
+				}
+			}
+		}
+		return ret;
+	}
+	
+	sl_bool _priv_HttpClientHost::_checkRemove_NoLock()
+	{
+		if (m_flagRemoved || m_flagResolving || m_connections.getCount() || m_queueRequests.getCount()) {
+			return sl_false;
+		}
+		m_flagRemoved = sl_true;
+		return sl_true;
+	}
+	
+	void _priv_HttpClientHost::_remove()
+	{
+		Ref<HttpClient> client = m_client;
+		if (client.isNotNull()) {
+			client->m_hosts.removeKeyAndValue(m_key, Ref<_priv_HttpClientHost>(this));
+		}
+	}
+	
+	void _priv_HttpClientHost::_resolve()
+	{
+		Ref<HttpClient> client = m_client;
+		if (client.isNotNull()) {
+			client->_resolveAddress(m_name, SLIB_FUNCTION_WEAKREF(_priv_HttpClientHost, _onResolved, this));
+		} else {
+			_onResolved(IPAddress::none());
+		}
+	}
+	
+	void _priv_HttpClientHost::_onResolved(const IPAddress& address)
+	{
+		List< Ref<_priv_HttpClientRequest> > failed;
+		sl_bool flagRemove;
+		{
+			MutexLocker lock(&m_lock);
+			m_flagResolving = sl_false;
+			if (address.isNotNone()) {
+				_dispatch_NoLock(failed, &address);
+			} else {
+				failed.addAll_NoLock(m_queueRequests);
+				m_queueRequests.removeAll_NoLock();
+			}
+			flagRemove = _checkRemove_NoLock();
+		}
+		if (flagRemove) {
+			_remove();
+		}
+		_processFailedRequests(failed, "Failed to resolve " + m_name);
+	}
+	
+	void _priv_HttpClientHost::closeIdleConnections()
+	{
+		List< Ref<_priv_HttpClientConnection> > connections;
+		{
+			MutexLocker lock(&m_lock);
+			for (auto& connection : m_connections) {
+				if (connection->isIdle_NoLock()) {
+					connections.add_NoLock(connection);
+				}
+			}
+		}
+		for (auto& connection : connections) {
+			connection->close(sl_null, sl_false);
+		}
+	}
+	
+	void _priv_HttpClientHost::close()
+	{
+		List< Ref<_priv_HttpClientConnection> > connections;
+		List< Ref<_priv_HttpClientRequest> > failed;
+		{
+			MutexLocker lock(&m_lock);
+			connections = m_connections.duplicate_NoLock();
+			failed.addAll_NoLock(m_queueRequests);
+			m_queueRequests.removeAll_NoLock();
+		}
+		for (auto& connection : connections) {
+			connection->closeWithError("Client is released");
+		}
+		_processFailedRequests(failed, "Client is released");
+	}
+	
+	void _priv_HttpClientHost::_processFailedRequests(const List< Ref<_priv_HttpClientRequest> >& failed, const String& message)
+	{
+		for (auto& request : failed) {
+			request->processError(message);
+		}
+	}
+	
+	
+	HttpClientParam::HttpClientParam()
+	{
+		maxConnectionsPerHost = 6;
+		maxPipelinedRequests = 1;
+		keepAliveTimeout = 30000;
+		dnsCacheTime = 60000;
+	}
+	
+	HttpClientParam::HttpClientParam(const HttpClientParam& other) = default;
+	
+	HttpClientParam::~HttpClientParam()
+	{
+	}
+	
+	
+	SLIB_DEFINE_OBJECT(HttpClient, Object)
+	
+	HttpClient::HttpClient()
+	{
+		m_flagReleased = sl_false;
+	}
+	
+	HttpClient::~HttpClient()
+	{
+		release();
+	}
+	
+	Ref<HttpClient> HttpClient::create(const HttpClientParam& param)
+	{
+		Ref<AsyncIoLoop> loop = param.ioLoop;
+		if (loop.isNull()) {
+			loop = AsyncIoLoop::getDefault();
+			if (loop.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<HttpClient> ret = new HttpClient;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (!(ret->m_param.maxConnectionsPerHost)) {
+				ret->m_param.maxConnectionsPerHost = 1;
+			}
+			if (!(ret->m_param.maxPipelinedRequests)) {
+				ret->m_param.maxPipelinedRequests = 1;
+			}
+			ret->m_ioLoop = loop;
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	Ref<HttpClient> HttpClient::create()
+	{
+		HttpClientParam param;
+		return create(param);
+	}
+	
+	Ref<HttpClient> HttpClient::getDefault()
+	{
+		SLIB_SAFE_STATIC(Ref<HttpClient>, ret, create())
+		if (SLIB_SAFE_STATIC_CHECK_FREED(ret)) {
+			return sl_null;
+		}
+		return ret;
+	}
+	
+	void HttpClient::release()
+	{
+		ObjectLocker lock(this);
+		if (m_flagReleased) {
+			return;
+		}
+		m_flagReleased = sl_true;
+		lock.unlock();
+		
+		List< Ref<_priv_HttpClientHost> > hosts = m_hosts.getAllValues();
+		m_hosts.removeAll();
+		for (auto& host : hosts) {
+			host->close();
+		}
+		Ref<ThreadPool> pool = m_threadPoolDns;
+		if (pool.isNotNull()) {
+			pool->release();
+		}
+	}
+	
+	const HttpClientParam& HttpClient::getParam()
+	{
+		return m_param;
+	}
+	
+	Ref<AsyncIoLoop> HttpClient::getAsyncIoLoop()
+	{
+		return m_ioLoop;
+	}
+	
+	Ref<UrlRequest> HttpClient::send(const UrlRequestParam& param)
+	{
+		String url = param.url;
+		if (url.isNotEmpty()) {
+			if (param.parameters.isNotEmpty()) {
+				if (url.contains('?')) {
+					url += "&";
+				} else {
+					url += "?";
+				}
+			}
+			url += HttpRequest::buildFormUrlEncodedFromHashMap(param.parameters);
+			Ref<UrlRequest> request = _createRequest(param, url);
+			if (request.isNotNull()) {
+				if (param.flagSynchronous) {
+					request->_sendSync();
+				} else {
+					request->_sendAsync();
+				}
+				return request;
+			}
+		}
+		Ref<UrlRequest> request = new UrlRequest;
+		if (request.isNotNull()) {
+			request->_init(param, url);
+			request->m_lastErrorMessage = "Failed to create request";
+			request->onError();
+			return request;
+		}
+		return sl_null;
+	}
+	
+	sl_uint32 HttpClient::getConnectionsCount()
+	{
+		sl_uint32 n = 0;
+		List< Ref<_priv_HttpClientHost> > hosts = m_hosts.getAllValues();
+		for (auto& host : hosts) {
+			n += host->getConnectionsCount();
+		}
+		return n;
+	}
+	
+	void HttpClient::closeIdleConnections()
+	{
+		List< Ref<_priv_HttpClientHost> > hosts = m_hosts.getAllValues();
+		for (auto& host : hosts) {
+			host->closeIdleConnections();
+		}
+	}
+	
+	void HttpClient::clearDnsCache()
+	{
+		m_dnsCache.removeAll();
+	}
+	
+	Ref<UrlRequest> HttpClient::_createRequest(const UrlRequestParam& param, const String& url)
+	{
+		Url _url;
+		String scheme, hostName;
+		sl_uint16 port;
+		if (!(_priv_HttpClientRequest::parseHostAddress(url, &scheme, &hostName, &port, &_url))) {
+			if (scheme.equalsIgnoreCase("https")) {
+				return UrlRequest::_create(param, url);
+			}
+			return sl_null;
+		}
+		return Ref<UrlRequest>::from(_priv_HttpClientRequest::create(this, param, url));
+	}
+	
+	void HttpClient::_sendRequest(_priv_HttpClientRequest* request)
+	{
+		if (m_flagReleased) {
+			request->processError("Client is released");
+			return;
+		}
+		String key = request->m_hostName + ":" + String::fromUint32(request->m_port);
+		for (;;) {
+			Ref<_priv_HttpClientHost> host;
+			{
+				ObjectLocker lock(&m_hosts);
+				if (!(m_hosts.get_NoLock(key, &host))) {
+					host = new _priv_HttpClientHost(this, key, request->m_hostName, request->m_port);
+					if (host.isNull()) {
+						lock.unlock();
+						request->processError("Failed to create request");
+						return;
+					}
+					m_hosts.put_NoLock(key, host);
+				}
+			}
+			if (host->sendRequest(request)) {
+				return;
+			}
+			// the host has lost its last connection after it is found
+			m_hosts.removeKeyAndValue(key, host);
+		}
+	}
+	
+	sl_bool HttpClient::_getCachedAddress(const String& hostName, IPAddress& _out)
+	{
+		ObjectLocker lock(&m_dnsCache);
+		DnsEntry* entry = m_dnsCache.getItemPointer(hostName);
+		if (entry) {
+			if ((sl_uint32)(System::getTickCount() - entry->tickResolved) < m_param.dnsCacheTime) {
+				_out = entry->address;
+				return sl_true;
+			}
+			m_dnsCache.remove_NoLock(hostName);
+		}
+		return sl_false;
+	}
+	
+	void HttpClient::_resolveAddress(const String& hostName, const Function<void(const IPAddress&)>& callback)
+	{
+		Ref<ThreadPool> pool = m_threadPoolDns;
+		if (pool.isNull()) {
+			ObjectLocker lock(this);
+			pool = m_threadPoolDns;
+			if (pool.isNull()) {
+				pool = ThreadPool::create();
+				if (pool.isNull()) {
+					lock.unlock();
+					callback(IPAddress::none());
+					return;
+				}
+				m_threadPoolDns = pool;
+			}
+		}
+		sl_bool flagAdded = pool->addTask(SLIB_BIND_WEAKREF(void(), HttpClient, _runResolveAddress, this, hostName, callback));
+		if (!flagAdded) {
+			callback(IPAddress::none());
+		}
+	}
+	
+	void HttpClient::_runResolveAddress(const String& hostName, const Function<void(const IPAddress&)>& callback)
+	{
+		IPAddress address = Network::getIPAddressFromHostName(hostName);
+		if (address.isNotNone() && m_param.dnsCacheTime) {
+			DnsEntry entry;
+			entry.address = address;
+			entry.tickResolved = System::getTickCount();
+			m_dnsCache.put(hostName, entry);
+		}
+		callback(address);
+	}
+	
+	
+#define URL_REQUEST HttpClientRequest
+#include "url_request_common.inc"
+	
+	Ref<UrlRequest> HttpClientRequest::_create(const UrlRequestParam& param, const String& url)
+	{
+		Ref<HttpClient> client = HttpClient::getDefault();
+		if (client.isNotNull()) {
+			return client->_createRequest(param, url);
+		}
+		return sl_null;
+	}
+	
+}
@@ -169,6 +169,19 @@ namespace slib
 	DEFINE_HTTP_HEADER(Origin, "Origin")
 	DEFINE_HTTP_HEADER(AccessControlAllowOrigin, "Access-Control-Allow-Origin")
 
+	DEFINE_HTTP_HEADER(ETag, "ETag")
+	DEFINE_HTTP_HEADER(LastModified, "Last-Modified")
+	DEFINE_HTTP_HEADER(IfNoneMatch, "If-None-Match")
+	DEFINE_HTTP_HEADER(IfModifiedSince, "If-Modified-Since")
+	DEFINE_HTTP_HEADER(Vary, "Vary")
+
+	DEFINE_HTTP_HEADER(Connection, "Connection")
+	DEFINE_HTTP_HEADER(Upgrade, "Upgrade")
+	DEFINE_HTTP_HEADER(SecWebSocketKey, "Sec-WebSocket-Key")
+	DEFINE_HTTP_HEADER(SecWebSocketAccept, "Sec-WebSocket-Accept")
+	DEFINE_HTTP_HEADER(SecWebSocketVersion, "Sec-WebSocket-Version")
+	DEFINE_HTTP_HEADER(SecWebSocketProtocol, "Sec-WebSocket-Protocol")
+
 	sl_reg HttpHeaders::parseHeaders(HttpHeaderMap& map, const void* _data, sl_size size)
 	{
 		const sl_char8* data = (const sl_char8*)_data;
@@ -243,6 +256,8 @@ namespace slib
 		SLIB_STATIC_STRING(s2, "GET");
 		m_methodText = s2;
 		m_methodTextUpper = s2;
+		m_countRequestHeaderSlices = 0;
+		m_flagRequestHeaderSlices = sl_false;
 	}
 
 	HttpRequest::~HttpRequest()
@@ -308,46 +323,138 @@ namespace slib
 		m_requestVersion = version;
 	}
 
+	Ref<MemoryArena> HttpRequest::getRequestArena() const
+	{
+		return m_requestArena;
+	}
+
+	void HttpRequest::setRequestArena(const Ref<MemoryArena>& arena)
+	{
+		m_requestArena = arena;
+	}
+
+	String HttpRequest::_createRequestString(const sl_char8* data, sl_size len) const
+	{
+		return String::fromArena(m_requestArena.get(), data, len);
+	}
+
 	const HttpHeaderMap& HttpRequest::getRequestHeaders() const
 	{
+		_buildRequestHeaders();
 		return m_requestHeaders;
 	}
 
 	String HttpRequest::getRequestHeader(String name) const
 	{
+		if (m_flagRequestHeaderSlices) {
+			const HttpHeaderSlice* slice = _findRequestHeaderSlice(name, 0);
+			if (slice) {
+				return _getRequestHeaderSliceValue(*slice);
+			}
+			return sl_null;
+		}
 		return m_requestHeaders.getValue_NoLock(name, String::null());
 	}
 
 	List<String> HttpRequest::getRequestHeaderValues(String name) const
 	{
+		if (m_flagRequestHeaderSlices) {
+			List<String> ret;
+			const HttpHeaderSlice* slice = _findRequestHeaderSlice(name, 0);
+			while (slice) {
+				ret.add_NoLock(_getRequestHeaderSliceValue(*slice));
+				slice = _findRequestHeaderSlice(name, (sl_uint32)(slice - m_requestHeaderSlices) + 1);
+			}
+			return ret;
+		}
 		return m_requestHeaders.getValues_NoLock(name);
 	}
 
 	void HttpRequest::setRequestHeader(String name, String value)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.put_NoLock(name, value);
 	}
 
 	void HttpRequest::addRequestHeader(String name, String value)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.add_NoLock(name, value);
 	}
 
 	sl_bool HttpRequest::containsRequestHeader(String name) const
 	{
+		if (m_flagRequestHeaderSlices) {
+			return _findRequestHeaderSlice(name, 0) != sl_null;
+		}
 		return m_requestHeaders.find_NoLock(name) != sl_null;
 	}
 
 	void HttpRequest::removeRequestHeader(String name)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.removeItems_NoLock(name);
 	}
 
 	void HttpRequest::clearRequestHeaders()
 	{
+		_clearRequestHeaderSlices();
 		m_requestHeaders.removeAll_NoLock();
 	}
 
+	void HttpRequest::_clearRequestHeaderSlices()
+	{
+		m_flagRequestHeaderSlices = sl_false;
+		m_countRequestHeaderSlices = 0;
+		m_requestHeaderPacket.setNull();
+	}
+
+	void HttpRequest::_buildRequestHeaders() const
+	{
+		if (!m_flagRequestHeaderSlices) {
+			return;
+		}
+		m_flagRequestHeaderSlices = sl_false;
+		const sl_char8* data = (const sl_char8*)(m_requestHeaderPacket.getData());
+		for (sl_uint32 i = 0; i < m_countRequestHeaderSlices; i++) {
+			const HttpHeaderSlice& slice = m_requestHeaderSlices[i];
+			m_requestHeaders.add_NoLock(_createRequestString(data + slice.posName, slice.lengthName), _getRequestHeaderSliceValue(slice));
+		}
+	}
+
+	const HttpHeaderSlice* HttpRequest::_findRequestHeaderSlice(const String& name, sl_uint32 start) const
+	{
+		const sl_uint8* data = (const sl_uint8*)(m_requestHeaderPacket.getData());
+		const sl_uint8* strName = (const sl_uint8*)(name.getData());
+		sl_uint32 lenName = (sl_uint32)(name.getLength());
+		for (sl_uint32 i = start; i < m_countRequestHeaderSlices; i++) {
+			const HttpHeaderSlice& slice = m_requestHeaderSlices[i];
+			if (slice.lengthName == lenName) {
+				const sl_uint8* p = data + slice.posName;
+				sl_uint32 k = 0;
+				for (; k < lenName; k++) {
+					// ASCII case-insensitive (header names are tokens)
+					if ((p[k] | 0x20) != (strName[k] | 0x20)) {
+						break;
+					}
+				}
+				if (k == lenName) {
+					return &slice;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	String HttpRequest::_getRequestHeaderSliceValue(const HttpHeaderSlice& slice) const
+	{
+		const sl_char8* value = (const sl_char8*)(m_requestHeaderPacket.getData()) + slice.posValue;
+		if (Base::findMemory(value, '%', slice.lengthValue)) {
+			return Url::decodeUriComponentByUTF8(String::fromUtf8(value, slice.lengthValue));
+		}
+		return _createRequestString(value, slice.lengthValue);
+	}
+
 	sl_uint64 HttpRequest::getRequestContentLengthHeader() const
 	{
 		String headerContentLength = getRequestHeader(HttpHeaders::ContentLength);
@@ -523,9 +630,7 @@ namespace slib
 
 	void HttpRequest::applyPostParameters(const void* data, sl_size size)
 	{
-		HashMap<String, String> params = parseParameters(data, size);
-		m_postParameters.putAll_NoLock(params);
-		m_parameters.putAll_NoLock(params);
+		_applyParameters(m_postParameters, data, size);
 	}
 
 	void HttpRequest::applyPostParameters(const String& str)
@@ -535,9 +640,45 @@ namespace slib
 
 	void HttpRequest::applyQueryToParameters()
 	{
-		HashMap<String, String> params = parseParameters(m_query);
-		m_queryParameters.putAll_NoLock(params);
-		m_parameters.putAll_NoLock(params);
+		_applyParameters(m_queryParameters, m_query.getData(), m_query.getLength());
+	}
+
+	void HttpRequest::_applyParameters(HashMap<String, String>& map, const void* data, sl_size len)
+	{
+		// same as `parseParameters`, but puts into the maps directly and decodes only the values containing '%'
+		sl_char8* buf = (sl_char8*)data;
+		sl_size start = 0;
+		sl_size indexSplit = 0;
+		sl_size pos = 0;
+		for (; pos <= len; pos++) {
+			sl_char8 ch;
+			if (pos == len) {
+				ch = '&';
+			} else {
+				ch = buf[pos];
+			}
+			if (ch == '=') {
+				indexSplit = pos;
+			} else if (ch == '&') {
+				String name;
+				String value;
+				if (indexSplit > start) {
+					name = _createRequestString(buf + start, indexSplit - start);
+					indexSplit++;
+					if (Base::findMemory(buf + indexSplit, '%', pos - indexSplit)) {
+						value = Url::decodeUriComponentByUTF8(String::fromUtf8(buf + indexSplit, pos - indexSplit));
+					} else if (pos > indexSplit) {
+						value = _createRequestString(buf + indexSplit, pos - indexSplit);
+					}
+				} else {
+					name = _createRequestString(buf + start, pos - start);
+				}
+				map.put_NoLock(name, value);
+				m_parameters.put_NoLock(name, value);
+				start = pos + 1;
+				indexSplit = start;
+			}
+		}
 	}
 
 	HashMap<String, String> HttpRequest::parseParameters(const String& str)
@@ -602,6 +743,7 @@ namespace slib
 		msg.addStatic(strVersion.getData(), strVersion.getLength());
 		msg.addStatic("\r\n", 2);
 
+		_buildRequestHeaders();
 		for (auto& pair : m_requestHeaders) {
 			String str = pair.key;
 			msg.addStatic(str.getData(), str.getLength());
@@ -614,8 +756,128 @@ namespace slib
 		return msg.merge();
 	}
 
+	sl_reg HttpRequest::parseRequestPacket(const Memory& packet)
+	{
+		// the slices of the previous parse refer to the previous packet, even when this parse stops early
+		_clearRequestHeaderSlices();
+		const sl_char8* data = (const sl_char8*)(packet.getData());
+		sl_size size = packet.getSize();
+		if (size > 0x7fffffff) {
+			return -1;
+		}
+		
+		// request line
+		const sl_char8* endLine = (const sl_char8*)(Base::findMemory(data, '\r', size));
+		if (!endLine || endLine + 1 >= data + size) {
+			return 0;
+		}
+		if (endLine[1] != '\n') {
+			return -1;
+		}
+		sl_size posLineEnd = endLine - data;
+		const sl_char8* p1 = (const sl_char8*)(Base::findMemory(data, ' ', posLineEnd));
+		if (!p1) {
+			return -1;
+		}
+		sl_size posUri = p1 - data + 1;
+		const sl_char8* p2 = (const sl_char8*)(Base::findMemory(data + posUri, ' ', posLineEnd - posUri));
+		if (!p2) {
+			return -1;
+		}
+		sl_size posVersion = p2 - data + 1;
+		
+		sl_size lenMethod = posUri - 1;
+		HttpMethod method = HttpMethod::Unknown;
+		if (lenMethod == 3 && Base::equalsMemory(data, "GET", 3)) {
+			method = HttpMethod::GET;
+		} else if (lenMethod == 4 && Base::equalsMemory(data, "POST", 4)) {
+			method = HttpMethod::POST;
+		}
+		if (method != HttpMethod::Unknown) {
+			setMethod(method);
+		} else {
+			setMethod(_createRequestString(data, lenMethod));
+		}
+		
+		sl_size endUri = posVersion - 1;
+		const sl_char8* q = (const sl_char8*)(Base::findMemory(data + posUri, '?', endUri - posUri));
+		if (q) {
+			sl_size posQuery = q - data;
+			setPath(_createRequestString(data + posUri, posQuery - posUri));
+			setQuery(_createRequestString(data + posQuery + 1, endUri - posQuery - 1));
+		} else {
+			setPath(_createRequestString(data + posUri, endUri - posUri));
+			setQuery(String::null());
+		}
+		
+		sl_size lenVersion = posLineEnd - posVersion;
+		if (lenVersion == 8 && Base::equalsMemory(data + posVersion, "HTTP/1.1", 8)) {
+			SLIB_STATIC_STRING(s, "HTTP/1.1");
+			setRequestVersion(s);
+		} else {
+			setRequestVersion(_createRequestString(data + posVersion, lenVersion));
+		}
+		
+		// headers
+		m_requestHeaders.removeAll_NoLock();
+		sl_size posCurrent = posLineEnd + 2;
+		for (;;) {
+			const sl_char8* end = (const sl_char8*)(Base::findMemory(data + posCurrent, '\r', size - posCurrent));
+			if (!end || end + 1 >= data + size) {
+				return 0;
+			}
+			if (end[1] != '\n') {
+				return -1;
+			}
+			sl_size posEnd = end - data;
+			if (posEnd == posCurrent) {
+				posCurrent += 2;
+				break;
+			}
+			if (m_countRequestHeaderSlices >= SLIB_HTTP_MAX_HEADER_SLICES) {
+				// too many headers for the slices, fall back to the map
+				m_countRequestHeaderSlices = 0;
+				sl_size posHeaders = posLineEnd + 2;
+				sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, data + posHeaders, size - posHeaders);
+				if (iRet > 0) {
+					return posHeaders + iRet;
+				} else {
+					return iRet;
+				}
+			}
+			HttpHeaderSlice& slice = m_requestHeaderSlices[m_countRequestHeaderSlices];
+			const sl_char8* colon = (const sl_char8*)(Base::findMemory(data + posCurrent, ':', posEnd - posCurrent));
+			if (colon && colon != data + posCurrent) {
+				sl_size indexSplit = colon - data;
+				slice.posName = (sl_uint32)posCurrent;
+				slice.lengthName = (sl_uint32)(indexSplit - posCurrent);
+				sl_size startValue = indexSplit + 1;
+				sl_size endValue = posEnd;
+				while (startValue < endValue && (data[startValue] == ' ' || data[startValue] == '\t')) {
+					startValue++;
+				}
+				while (startValue < endValue && (data[endValue - 1] == ' ' || data[endValue - 1] == '\t')) {
+					endValue--;
+				}
+				slice.posValue = (sl_uint32)startValue;
+				slice.lengthValue = (sl_uint32)(endValue - startValue);
+			} else {
+				slice.posName = (sl_uint32)posCurrent;
+				slice.lengthName = (sl_uint32)(posEnd - posCurrent);
+				slice.posValue = (sl_uint32)posEnd;
+				slice.lengthValue = 0;
+			}
+			m_countRequestHeaderSlices++;
+			posCurrent = posEnd + 2;
+		}
+		m_requestHeaderPacket = packet;
+		m_flagRequestHeaderSlices = sl_true;
+		return posCurrent;
+	}
+
 	sl_reg HttpRequest::parseRequestPacket(const void* packet, sl_size size)
 	{
+		_clearRequestHeaderSlices();
 		const sl_char8* data = (const sl_char8*)packet;
 		sl_size posCurrent = 0;
 		sl_size posStart = 0;
@@ -22,6 +22,8 @@
 
 #include "slib/network/http_io.h"
 
+#include "slib/core/json.h"
+
 namespace slib
 {
 
@@ -56,6 +58,33 @@ namespace slib
 		m_bufferOutput.write(mem);
 	}
 
+	class _priv_HttpOutputBuffer_JsonWriter : public JsonWriter
+	{
+	public:
+		AsyncOutputBuffer* m_buffer;
+		
+	public:
+		_priv_HttpOutputBuffer_JsonWriter(AsyncOutputBuffer* buffer, sl_bool flagPretty): JsonWriter(sl_null, flagPretty), m_buffer(buffer)
+		{
+		}
+		
+	protected:
+		sl_bool writeOutput(const void* data, sl_size size) override
+		{
+			return m_buffer->write(data, size);
+		}
+		
+	};
+
+	sl_bool HttpOutputBuffer::writeJson(const Variant& value, sl_bool flagPretty)
+	{
+		_priv_HttpOutputBuffer_JsonWriter writer(&m_bufferOutput, flagPretty);
+		if (writer.write(value)) {
+			return writer.flush();
+		}
+		return sl_false;
+	}
+
 	void HttpOutputBuffer::copyFrom(AsyncStream* stream, sl_uint64 size)
 	{
 		m_bufferOutput.copyFrom(stream, size);
@@ -71,6 +100,16 @@ namespace slib
 		m_bufferOutput.copyFromFile(path, dispatcher);
 	}
 
+	sl_bool HttpOutputBuffer::copyFromFileRegion(const Ref<File>& file, sl_uint64 offset, sl_uint64 size)
+	{
+		return m_bufferOutput.copyFromFileRegion(file, offset, size);
+	}
+
+	sl_bool HttpOutputBuffer::copyFromFileRegion(const String& path, sl_uint64 offset, sl_uint64 size)
+	{
+		return m_bufferOutput.copyFromFileRegion(path, offset, size);
+	}
+
 	sl_uint64 HttpOutputBuffer::getOutputLength() const
 	{
 		return m_bufferOutput.getOutputLength();
@@ -109,22 +148,30 @@ namespace slib
 			posBody = 3;
 			flagFound = sl_true;
 		}
-		if (size > 3) {
-			for (sl_size i = 0; i <= size - 4; i++) {
-				if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
-					posBody = 4 + i;
+		if (!flagFound && size > 3) {
+			// jumps between the line feeds (`memchr`) instead of testing every byte
+			const sl_uint8* p = buf + 1;
+			const sl_uint8* end = buf + size;
+			while (p + 2 < end) {
+				p = Base::findMemory(p, '\n', end - p - 2);
+				if (!p) {
+					break;
+				}
+				if (p[2] == '\n' && p[1] == '\r' && p[-1] == '\r') {
+					posBody = p + 3 - buf;
 					flagFound = sl_true;
 					break;
 				}
+				p++;
 			}
 		}
 		if (flagFound) {
-			m_buffer.add(Memory::create(buf, posBody));
+			m_buffer.add(_createMemory(buf, posBody));
 			m_last[0] = 0;
 			m_last[1] = 0;
 			m_last[2] = 0;
 		} else {
-			m_buffer.add(Memory::create(buf, size));
+			m_buffer.add(_createMemory(buf, size));
 			if (size < 3) {
 				if (size == 1) {
 					m_last[0] = m_last[1];
@@ -162,6 +209,23 @@ namespace slib
 		m_buffer.clear();
 	}
 
+	void HttpHeaderReader::setMemoryArena(const Ref<MemoryArena>& arena)
+	{
+		m_arena = arena;
+	}
+
+	Memory HttpHeaderReader::_createMemory(const void* buf, sl_size size)
+	{
+		if (m_arena.isNotNull()) {
+			Memory mem = m_arena->createMemory(size);
+			if (mem.isNotNull()) {
+				Base::copyMemory(mem.getData(), buf, size);
+				return mem;
+			}
+		}
+		return Memory::create(buf, size);
+	}
+
 /***********************************************************************
 						HttpContentReader
 ***********************************************************************/
@@ -219,17 +283,19 @@ namespace slib
 															   sl_bool flagDecompress)
 	{
 		Ref<_priv_HttpContentReader_Persistent> ret = new _priv_HttpContentReader_Persistent;
-		if (io.isNull()) {
+		if (contentLength == 0) {
 			return ret;
 		}
-		if (contentLength == 0 || bufferSize == 0) {
+		if (io.isNotNull() && bufferSize == 0) {
 			return ret;
 		}
 		if (ret.isNotNull()) {
 			ret->m_sizeTotal = contentLength;
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull()) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -387,16 +453,15 @@ namespace slib
 															sl_bool flagDecompress)
 	{
 		Ref<_priv_HttpContentReader_Chunked> ret = new _priv_HttpContentReader_Chunked;
-		if (io.isNull()) {
-			return ret;
-		}
-		if (bufferSize == 0) {
+		if (io.isNotNull() && bufferSize == 0) {
 			return ret;
 		}
 		if (ret.isNotNull()) {
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull()) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -421,16 +486,15 @@ namespace slib
 															 sl_bool flagDecompress)
 	{
 		Ref<_priv_HttpContentReader_TearDown> ret = new _priv_HttpContentReader_TearDown;
-		if (io.isNull()) {
-			return ret;
-		}
-		if (bufferSize == 0) {
+		if (io.isNotNull() && bufferSize == 0) {
 			return ret;
 		}
 		if (ret.isNotNull()) {
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull()) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -445,6 +509,14 @@ namespace slib
 		return m_flagDecompressing;
 	}
 
+	Memory HttpContentReader::feed(void* data, sl_uint32 size, Referable* refData)
+	{
+		if (size == 0) {
+			return sl_null;
+		}
+		return filterRead(data, size, refData);
+	}
+
 	void HttpContentReader::onReadStream(AsyncStreamResult* result)
 	{
 		if (result->flagError) {
@@ -26,11 +26,16 @@
 #include "slib/core/asset.h"
 #include "slib/core/file.h"
 #include "slib/core/log.h"
+#include "slib/core/system.h"
 #include "slib/core/json.h"
 #include "slib/core/content_type.h"
+#include "slib/core/spin_lock.h"
+#include "slib/crypto/zlib.h"
 
 #define SERVICE_TAG "HTTP SERVICE"
 
+#define PRIV_HTTP_STATIC_CACHE_GZIP_MIN_SIZE 256
+
 namespace slib
 {
 
@@ -44,6 +49,10 @@ namespace slib
 	{
 		m_requestContentLength = 0;
 		m_flagAsynchronousResponse = sl_false;
+		m_flagResponseCompleted = sl_false;
+		m_sizeRequestBodyReceived = 0;
+		m_flagRequestBodySuspended = sl_false;
+		m_countPathParameters = 0;
 
 		setClosingConnection(sl_false);
 		setProcessingByThread(sl_true);
@@ -82,7 +91,12 @@ namespace slib
 
 	Variant HttpServiceContext::getRequestBodyAsJson() const
 	{
-		return Json::parseJson16Utf8(m_requestBody);
+		return Json::parseJsonUtf8(m_requestBody);
+	}
+
+	Ref<JsonDocument> HttpServiceContext::getRequestBodyAsJsonDocument() const
+	{
+		return JsonDocument::parse(m_requestBody);
 	}
 
 	sl_uint64 HttpServiceContext::getResponseContentLength() const
@@ -115,6 +129,13 @@ namespace slib
 
 	Ref<AsyncIoLoop> HttpServiceContext::getAsyncIoLoop()
 	{
+		Ref<AsyncStream> io = getIO();
+		if (io.isNotNull()) {
+			Ref<AsyncIoLoop> loop = io->getIoLoop();
+			if (loop.isNotNull()) {
+				return loop;
+			}
+		}
 		Ref<HttpService> service = getService();
 		if (service.isNotNull()) {
 			return service->getAsyncIoLoop();
@@ -152,271 +173,1473 @@ namespace slib
 		m_flagAsynchronousResponse = flagAsync;
 	}
 
-	void HttpServiceContext::completeResponse()
+	void HttpServiceContext::setRequestBodyCallback(const Function<void(HttpServiceContext*, const void*, sl_size)>& callback)
+	{
+		m_callbackRequestBody = callback;
+	}
+
+	sl_uint64 HttpServiceContext::getRequestBodyReceivedSize() const
+	{
+		return m_sizeRequestBodyReceived;
+	}
+
+	void HttpServiceContext::suspendRequestBody()
 	{
 		Ref<HttpServiceConnection> connection = m_connection;
 		if (connection.isNotNull()) {
-			connection->_completeResponse(this);
-			connection.setNull();
+			ObjectLocker lock(connection.get());
+			m_flagRequestBodySuspended = sl_true;
+		} else {
+			m_flagRequestBodySuspended = sl_true;
 		}
 	}
 
-/******************************************************
-			HttpServiceConnection
-******************************************************/
-#define SIZE_READ_BUF 0x10000
-#define SIZE_COPY_BUF 0x10000
-
-	HttpServiceConnection::HttpServiceConnection()
+	void HttpServiceContext::resumeRequestBody()
 	{
-		m_flagClosed = sl_true;
-		m_flagReading = sl_false;
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNotNull()) {
+			// the flag is cleared on the I/O thread, so no data is read before the kept input is processed
+			connection->m_io->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _resumeRequestBody, connection, Ref<HttpServiceContext>(this)));
+		}
 	}
 
-	HttpServiceConnection::~HttpServiceConnection()
+	sl_uint32 HttpServiceContext::getPathParameterCount() const
 	{
-		close();
+		return m_countPathParameters;
 	}
 
-	Ref<HttpServiceConnection> HttpServiceConnection::create(HttpService* service, AsyncStream* io)
+	String HttpServiceContext::getPathParameterName(sl_uint32 index) const
 	{
-		if (service && io) {
-			Memory bufRead = Memory::create(SIZE_READ_BUF);
-			if (bufRead.isNotNull()) {
-				Ref<HttpServiceConnection> ret = new HttpServiceConnection;
-				if (ret.isNotNull()) {
-					AsyncOutputParam op;
-					op.stream = io;
-					op.listener.setWeak(ret);
-					op.bufferSize = SIZE_COPY_BUF;
-					Ref<AsyncOutput> output = AsyncOutput::create(op);
-					if (output.isNotNull()) {
-						ret->m_service = service;
-						ret->m_io = io;
-						ret->m_output = output;
-						ret->m_bufRead = bufRead;
-						ret->m_flagClosed = sl_false;
-						return ret;
-					}
-				}
-			}
+		if (index < m_countPathParameters) {
+			return m_pathParameters[index].name;
 		}
 		return sl_null;
 	}
 
-	void HttpServiceConnection::close()
+	String HttpServiceContext::getPathParameterValue(sl_uint32 index) const
 	{
-		ObjectLocker lock(this);
-		if (m_flagClosed) {
-			return;
+		if (index < m_countPathParameters) {
+			const HttpPathParameter& param = m_pathParameters[index];
+			return String(m_path.getData() + param.pos, param.length);
 		}
-		m_flagClosed = sl_true;
-		
-		Ref<HttpService> service = m_service;
-		if (service.isNotNull()) {
-			service->closeConnection(this);
+		return sl_null;
+	}
+
+	String HttpServiceContext::getPathParameter(const String& name) const
+	{
+		for (sl_uint32 i = 0; i < m_countPathParameters; i++) {
+			if (m_pathParameters[i].name == name) {
+				return getPathParameterValue(i);
+			}
 		}
-		m_io->close();
-		m_output->close();
+		return sl_null;
 	}
 
-	void HttpServiceConnection::start(const void* data, sl_uint32 size)
+	sl_bool HttpServiceContext::containsPathParameter(const String& name) const
 	{
-		m_contextCurrent.setNull();
-		if (data && size > 0) {
-			_processInput(data, size);
-		} else {
-			_read();
+		for (sl_uint32 i = 0; i < m_countPathParameters; i++) {
+			if (m_pathParameters[i].name == name) {
+				return sl_true;
+			}
 		}
+		return sl_false;
 	}
 
-	Ref<AsyncStream> HttpServiceConnection::getIO()
+	void HttpServiceContext::setPathParameters(const HttpPathParameter* params, sl_uint32 count)
 	{
-		return m_io;
+		if (count > SLIB_HTTP_MAX_PATH_PARAMETERS) {
+			count = SLIB_HTTP_MAX_PATH_PARAMETERS;
+		}
+		sl_size lenPath = m_path.getLength();
+		sl_uint32 n = 0;
+		for (sl_uint32 i = 0; i < count; i++) {
+			if ((sl_size)(params[i].pos) + params[i].length <= lenPath) {
+				m_pathParameters[n] = params[i];
+				n++;
+			}
+		}
+		for (sl_uint32 i = n; i < m_countPathParameters; i++) {
+			m_pathParameters[i].name.setNull();
+		}
+		m_countPathParameters = n;
 	}
 
-	Ref<HttpService> HttpServiceConnection::getService()
+	void HttpServiceContext::completeResponse()
 	{
-		return m_service;
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNotNull()) {
+			connection->_completeResponse(this);
+			connection.setNull();
+		}
 	}
 
-	Ref<HttpServiceContext> HttpServiceConnection::getCurrentContext()
+/******************************************************
+			HttpService Response Compression
+******************************************************/
+#define PRIV_HTTP_COMPRESS_POOL_SIZE 32
+#define PRIV_HTTP_COMPRESS_BUFFER_SIZE 0x4000
+#define PRIV_HTTP_COMPRESS_PENDING_LIMIT 0x10000
+
+	enum class _priv_HttpContentCoding
 	{
-		return m_contextCurrent;
+		Identity,
+		Gzip,
+		Deflate
+	};
+
+	static sl_bool _priv_HttpService_equalsToken(const sl_char8* s, sl_size len, const char* token, sl_size lenToken)
+	{
+		if (len != lenToken) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < len; i++) {
+			sl_char8 c = s[i];
+			if (SLIB_CHAR_UPPER_TO_LOWER(c) != token[i]) {
+				return sl_false;
+			}
+		}
+		return sl_true;
 	}
 
-	void HttpServiceConnection::_read()
+	// returns the quality value in thousandths. an invalid value is regarded as a refusal
+	static sl_int32 _priv_HttpService_parseQuality(const sl_char8* p, const sl_char8* end)
 	{
-		ObjectLocker lock(this);
-		if (m_flagClosed) {
-			return;
+		if (p >= end || *p < '0' || *p > '9') {
+			return 0;
 		}
-		if (m_flagReading) {
-			return;
+		if (*p != '0') {
+			return 1000;
 		}
-		m_flagReading = sl_true;
-		if (!(m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadStream, this)))) {
-			m_flagReading = sl_false;
-			close();
+		p++;
+		if (p >= end || *p != '.') {
+			return 0;
+		}
+		p++;
+		sl_int32 q = 0;
+		sl_int32 unit = 100;
+		for (; p < end && unit && *p >= '0' && *p <= '9'; p++) {
+			q += (*p - '0') * unit;
+			unit /= 10;
 		}
+		return q;
+	}
+
+	/*
+		Chooses the content coding from the value of `Accept-Encoding`, scanning the whole list in place.
+		An explicit coding overrides `*`, `q=0` refuses the coding, and gzip is preferred to deflate at the same quality.
+	*/
+	static _priv_HttpContentCoding _priv_HttpService_getAcceptedCoding(const String& header, sl_bool flagDeflate)
+	{
+		sl_int32 qGzip = -1;
+		sl_int32 qDeflate = -1;
+		sl_int32 qAny = -1;
+		const sl_char8* p = header.getData();
+		const sl_char8* end = p + header.getLength();
+		while (p < end) {
+			while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) {
+				p++;
+			}
+			const sl_char8* name = p;
+			while (p < end && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') {
+				p++;
+			}
+			sl_size lenName = p - name;
+			sl_int32 q = 1000;
+			while (p < end && *p != ',') {
+				if (*p == ';') {
+					p++;
+					while (p < end && (*p == ' ' || *p == '\t')) {
+						p++;
+					}
+					if (end - p >= 2 && (*p == 'q' || *p == 'Q') && p[1] == '=') {
+						p += 2;
+						q = _priv_HttpService_parseQuality(p, end);
+					}
+				} else {
+					p++;
+				}
+			}
+			if (!lenName) {
+				continue;
+			}
+			if (_priv_HttpService_equalsToken(name, lenName, "gzip", 4) || _priv_HttpService_equalsToken(name, lenName, "x-gzip", 6)) {
+				qGzip = q;
+			} else if (_priv_HttpService_equalsToken(name, lenName, "deflate", 7)) {
+				qDeflate = q;
+			} else if (lenName == 1 && *name == '*') {
+				qAny = q;
+			}
+		}
+		if (qGzip < 0) {
+			qGzip = qAny;
+		}
+		if (!flagDeflate) {
+			qDeflate = 0;
+		} else if (qDeflate < 0) {
+			qDeflate = qAny;
+		}
+		if (qGzip > 0 && qGzip >= qDeflate) {
+			return _priv_HttpContentCoding::Gzip;
+		}
+		if (qDeflate > 0) {
+			return _priv_HttpContentCoding::Deflate;
+		}
+		return _priv_HttpContentCoding::Identity;
 	}
 
-	void HttpServiceConnection::_processInput(const void* _data, sl_uint32 size)
+	static sl_bool _priv_HttpService_isCompressibleContentType(const String& type)
 	{
-		Ref<HttpService> service = m_service;
-		if (service.isNull()) {
-			return;
-		}
-		if (m_flagClosed) {
-			return;
+		return type.startsWith("text/") || type.contains("json") || type.contains("javascript") || type.contains("xml");
+	}
+
+	// reuses the deflate states across the responses, instead of initializing them for each response
+	class _priv_HttpCompressPool : public Referable
+	{
+	public:
+		CList< Ref<ZlibCompress> > m_list;
+
+	public:
+		Ref<ZlibCompress> get()
+		{
+			Ref<ZlibCompress> ret;
+			if (m_list.popBack(&ret)) {
+				return ret;
+			}
+			return new ZlibCompress;
 		}
-		
-		const HttpServiceParam& param = service->getParam();
-		sl_uint64 maxRequestHeadersSize = param.maxRequestHeadersSize;
-		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
 
-		char* data = (char*)_data;
-		Ref<HttpServiceContext> _context = m_contextCurrent;
-		if (_context.isNull()) {
-			_context = HttpServiceContext::create(this);
-			if (_context.isNull()) {
-				sendResponse_ServerError();
-				return;
+		void put(const Ref<ZlibCompress>& compress)
+		{
+			if (compress->isStarted()) {
+				compress->abort();
+			}
+			if (m_list.getCount() < PRIV_HTTP_COMPRESS_POOL_SIZE) {
+				m_list.add(compress);
 			}
-			m_contextCurrent = _context;
-			_context->setProcessingByThread(param.flagProcessByThreads);
 		}
-		HttpServiceContext* context = _context.get();
-		if (context->m_requestHeader.isNull()) {
-			sl_size posBody;
-			if (context->m_requestHeaderReader.add(data, size, posBody)) {
-				context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
-				if (context->m_requestHeader.isNull()) {
-					sendResponse_ServerError();
-					return;
-				}
-				if (posBody > size) {
-					sendResponse_ServerError();
-					return;
-				}
-				context->m_requestHeaderReader.clear();
-				Memory header = context->getRawRequestHeader();
-				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
-				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
-					sendResponse_BadRequest();
-					return;
-				}
-				context->m_requestContentLength = context->getRequestContentLengthHeader();
-				if (context->m_requestContentLength > maxRequestBodySize) {
-					sendResponse_BadRequest();
-					return;
-				}
-				context->m_requestBody = Memory::create(data + posBody, size - (sl_uint32)posBody);
-				if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
-					sendResponse_ServerError();
-					return;
+
+		Ref<ZlibCompress> start(sl_bool flagGzip, sl_int32 level)
+		{
+			Ref<ZlibCompress> compress = get();
+			if (compress.isNotNull()) {
+				if (flagGzip ? compress->startGzip(level) : compress->start(level)) {
+					return compress;
 				}
-				context->applyQueryToParameters();
-				if (service->preprocessRequest(context)) {
+			}
+			return sl_null;
+		}
+
+	};
+
+	/*
+		Source stream of a compressed response in the chunked transfer coding.
+		The original content is written into the sink stream by `AsyncOutput`, and it is compressed while the
+		connection reads the chunks. The sink is paused while the compressed data is not consumed.
+	*/
+	class _priv_HttpCompressStream : public AsyncStream
+	{
+	public:
+		Ref<AsyncStream> m_io;
+		Ref<AsyncOutput> m_output;
+		Ref<ZlibCompress> m_compress;
+		WeakRef<_priv_HttpCompressPool> m_pool;
+		Memory m_bufCompress;
+
+		Mutex m_lock;
+		MemoryQueue m_queueCompressed;
+		Ref<AsyncStreamRequest> m_requestRead;
+		Ref<AsyncStreamRequest> m_requestWrite;
+		sl_bool m_flagFinished;
+		sl_bool m_flagError;
+		sl_bool m_flagClosed;
+
+	public:
+		_priv_HttpCompressStream()
+		{
+			m_flagFinished = sl_false;
+			m_flagError = sl_false;
+			m_flagClosed = sl_false;
+		}
+
+		~_priv_HttpCompressStream()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_priv_HttpCompressStream> create(AsyncStream* io, _priv_HttpCompressPool* pool, const Ref<ZlibCompress>& compress, AsyncOutputBuffer* content);
+
+		void close() override
+		{
+			Ref<AsyncOutput> output;
+			{
+				MutexLocker lock(&m_lock);
+				if (m_flagClosed) {
 					return;
 				}
+				m_flagClosed = sl_true;
+				output = m_output;
+				_releaseCompress();
+				m_requestRead.setNull();
+				m_requestWrite.setNull();
+			}
+			if (output.isNotNull()) {
+				output->close();
+			}
+		}
+
+		sl_bool isOpened() override
+		{
+			return !m_flagClosed;
+		}
+
+		sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject) override
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagClosed || m_requestRead.isNotNull()) {
+				return sl_false;
+			}
+			m_requestRead = AsyncStreamRequest::createRead(data, size, userObject, callback);
+			if (m_requestRead.isNull()) {
+				return sl_false;
+			}
+			_processRead();
+			return sl_true;
+		}
+
+		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject) override
+		{
+			return sl_false;
+		}
+
+		sl_bool addTask(const Function<void()>& callback) override
+		{
+			return m_io->addTask(callback);
+		}
+
+		sl_bool writeContent(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagClosed || m_flagError || m_flagFinished) {
+				return sl_false;
+			}
+			if (!(_compress(data, size, sl_false))) {
+				_processRead();
+				return sl_false;
+			}
+			Ref<AsyncStreamRequest> request = AsyncStreamRequest::createWrite(data, size, userObject, callback);
+			if (request.isNull()) {
+				return sl_false;
+			}
+			if (m_queueCompressed.getSize() < PRIV_HTTP_COMPRESS_PENDING_LIMIT) {
+				_dispatchCallback(request, size, sl_false);
 			} else {
-				if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
-					sendResponse_BadRequest();
-					return;
-				}
+				m_requestWrite = request;
 			}
-		} else {
-			if (!(context->m_requestBodyBuffer.add(Memory::create(data, size)))) {
-				sendResponse_ServerError();
+			_processRead();
+			return sl_true;
+		}
+
+		void finishContent()
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagClosed || m_flagError || m_flagFinished) {
 				return;
 			}
+			if (_compress(sl_null, 0, sl_true)) {
+				SLIB_STATIC_STRING(s, "0\r\n\r\n")
+				m_queueCompressed.addStatic(s.getData(), s.getLength());
+				m_flagFinished = sl_true;
+			}
+			_releaseCompress();
+			_processRead();
 		}
-		if (context->m_requestHeader.isNotNull()) {
-			if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
 
-				m_contextCurrent.setNull();
+		void setContentError()
+		{
+			MutexLocker lock(&m_lock);
+			m_flagError = sl_true;
+			_releaseCompress();
+			_processRead();
+		}
 
-				context->m_requestBody = context->m_requestBodyBuffer.merge();
-				if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
-					sendResponse_ServerError();
-					return;
+	protected:
+		// appends the compressed data as a chunk
+		sl_bool _compress(const void* _data, sl_uint32 size, sl_bool flagFinish)
+		{
+			if (m_compress.isNull()) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			const sl_uint8* data = (const sl_uint8*)_data;
+			sl_uint8* buf = (sl_uint8*)(m_bufCompress.getData());
+			sl_uint32 sizeBuf = (sl_uint32)(m_bufCompress.getSize());
+			MemoryQueue chunk;
+			for (;;) {
+				sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+				sl_int32 iRet = m_compress->compress(data, size, sizeInputPassed, buf, sizeBuf, sizeOutputUsed, flagFinish);
+				if (iRet < 0) {
+					m_flagError = sl_true;
+					return sl_false;
 				}
-				context->m_requestBodyBuffer.clear();
-
-				if (context->getMethod() == HttpMethod::POST) {
-					String reqContentType = context->getRequestContentTypeNoParams();
-					if (reqContentType == ContentTypes::WebForm) {
-						Memory body = context->getRequestBody();
-						context->applyPostParameters(body.getData(), body.getSize());
-					}
+				if (sizeOutputUsed > 0) {
+					chunk.add(Memory::create(buf, sizeOutputUsed));
 				}
-				
-				if (context->isProcessingByThread()) {
-					Ref<ThreadPool> threadPool = service->getThreadPool();
-					if (threadPool.isNotNull()) {
-						threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
-					} else {
-						sendResponse_ServerError();
-						return;
-					}
-				} else {
-					_processContext(context);
+				data += sizeInputPassed;
+				size -= sizeInputPassed;
+				if (iRet == 0) {
+					break;
+				}
+				if (size == 0 && sizeOutputUsed < sizeBuf && !flagFinish) {
+					break;
 				}
 			}
+			sl_size sizeChunk = chunk.getSize();
+			if (sizeChunk > 0) {
+				String header = String::fromUint64(sizeChunk, 16) + "\r\n";
+				m_queueCompressed.add(Memory::create(header.getData(), header.getLength()));
+				m_queueCompressed.link(chunk);
+				m_queueCompressed.addStatic("\r\n", 2);
+			}
+			return sl_true;
 		}
-		_read();
-	}
 
-	void HttpServiceConnection::_processContext(const Ref<HttpServiceContext>& context)
-	{
-		Ref<HttpService> service = getService();
-		if (service.isNull()) {
-			return;
-		}
-		if (context->getMethod() == HttpMethod::CONNECT) {
+		void _processRead()
+		{
+			Ref<AsyncStreamRequest> request = m_requestRead;
+			if (request.isNull()) {
+				return;
+			}
+			if (m_queueCompressed.getSize() > 0) {
+				m_requestRead.setNull();
+				sl_uint32 n = (sl_uint32)(m_queueCompressed.pop(request->data, request->size));
+				_dispatchCallback(request, n, sl_false);
+				if (m_requestWrite.isNotNull() && m_queueCompressed.getSize() < PRIV_HTTP_COMPRESS_PENDING_LIMIT) {
+					_dispatchCallback(m_requestWrite, m_requestWrite->size, sl_false);
+					m_requestWrite.setNull();
+				}
+			} else if (m_flagError) {
+				m_requestRead.setNull();
+				_dispatchCallback(request, 0, sl_true);
+			} else if (m_flagFinished) {
+				// the empty read completes the copy of unknown size
+				m_requestRead.setNull();
+				_dispatchCallback(request, 0, sl_false);
+			}
+		}
+
+		void _dispatchCallback(const Ref<AsyncStreamRequest>& request, sl_uint32 size, sl_bool flagError)
+		{
+			m_io->addTask(SLIB_BIND_REF(void(), _priv_HttpCompressStream, _runCallback, this, request, size, flagError));
+		}
+
+		void _runCallback(const Ref<AsyncStreamRequest>& request, sl_uint32 size, sl_bool flagError)
+		{
+			request->runCallback(this, size, flagError);
+		}
+
+		void _releaseCompress()
+		{
+			if (m_compress.isNotNull()) {
+				Ref<_priv_HttpCompressPool> pool = m_pool;
+				if (pool.isNotNull()) {
+					pool->put(m_compress);
+				}
+				m_compress.setNull();
+			}
+		}
+
+	};
+
+	// receives the original content from `AsyncOutput`
+	class _priv_HttpCompressStream_Sink : public AsyncStream, public IAsyncOutputListener
+	{
+	public:
+		WeakRef<_priv_HttpCompressStream> m_source;
+
+	public:
+		void close() override
+		{
+		}
+
+		sl_bool isOpened() override
+		{
+			Ref<_priv_HttpCompressStream> source = m_source;
+			if (source.isNotNull()) {
+				return source->isOpened();
+			}
+			return sl_false;
+		}
+
+		sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject) override
+		{
+			return sl_false;
+		}
+
+		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject) override
+		{
+			Ref<_priv_HttpCompressStream> source = m_source;
+			if (source.isNotNull()) {
+				return source->writeContent(data, size, callback, userObject);
+			}
+			return sl_false;
+		}
+
+		sl_bool addTask(const Function<void()>& callback) override
+		{
+			Ref<_priv_HttpCompressStream> source = m_source;
+			if (source.isNotNull()) {
+				return source->addTask(callback);
+			}
+			return sl_false;
+		}
+
+		void onAsyncOutputError(AsyncOutput* output) override
+		{
+			Ref<_priv_HttpCompressStream> source = m_source;
+			if (source.isNotNull()) {
+				source->setContentError();
+			}
+		}
+
+		void onAsyncOutputComplete(AsyncOutput* output) override
+		{
+			Ref<_priv_HttpCompressStream> source = m_source;
+			if (source.isNotNull()) {
+				source->finishContent();
+			}
+		}
+
+	};
+
+	Ref<_priv_HttpCompressStream> _priv_HttpCompressStream::create(AsyncStream* io, _priv_HttpCompressPool* pool, const Ref<ZlibCompress>& compress, AsyncOutputBuffer* content)
+	{
+		Memory buf = Memory::create(PRIV_HTTP_COMPRESS_BUFFER_SIZE);
+		if (buf.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_HttpCompressStream> ret = new _priv_HttpCompressStream;
+		Ref<_priv_HttpCompressStream_Sink> sink = new _priv_HttpCompressStream_Sink;
+		if (ret.isNotNull() && sink.isNotNull()) {
+			sink->m_source = ret;
+			AsyncOutputParam param;
+			param.stream = sink;
+			param.listener = sink;
+			Ref<AsyncOutput> output = AsyncOutput::create(param);
+			if (output.isNotNull()) {
+				ret->m_io = io;
+				ret->m_output = output;
+				ret->m_compress = compress;
+				ret->m_pool = pool;
+				ret->m_bufCompress = buf;
+				output->mergeBuffer(content);
+				content->clearOutput();
+				output->startWriting();
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+/******************************************************
+			HttpServiceConnection
+******************************************************/
+#define SIZE_READ_BUF 0x10000
+#define SIZE_COPY_BUF 0x10000
+#define MAX_PIPELINED_REQUESTS 64
+
+#define TIMEOUT_STATE_NONE 0
+#define TIMEOUT_STATE_IDLE 1
+#define TIMEOUT_STATE_HEADER 2
+#define TIMEOUT_STATE_BODY 3
+
+#define READ_BUFFER_POOL_SIZE 32
+
+	/*
+		Read buffers shared by the connections on the same I/O loop.
+		The data is received into the buffers only on the loop thread, so a buffer returned while the loop is still
+		parsing it can't be overwritten before the parsing ends.
+		On io_uring, the buffers are the slices of one region registered to the ring (fixed buffers). A registered buffer
+		is reused when only the pool references it: the connection and its pending read request have released it.
+	*/
+	class _priv_HttpBufferPool : public Referable
+	{
+	public:
+		CList<Memory> m_list;
+		
+		Memory m_buffersRegistered[READ_BUFFER_POOL_SIZE];
+		sl_uint32 m_nBuffersRegistered;
+		const sl_uint8* m_regionRegistered;
+		SpinLock m_lockRegistered;
+
+	public:
+		_priv_HttpBufferPool()
+		{
+			m_nBuffersRegistered = 0;
+			m_regionRegistered = sl_null;
+		}
+
+	public:
+		void registerBuffers(AsyncIoLoop* loop)
+		{
+			Memory region = Memory::create(SIZE_READ_BUF * READ_BUFFER_POOL_SIZE);
+			if (region.isNull()) {
+				return;
+			}
+			if (!(loop->registerBuffer(region))) {
+				return;
+			}
+			for (sl_uint32 i = 0; i < READ_BUFFER_POOL_SIZE; i++) {
+				m_buffersRegistered[i] = region.sub(i * SIZE_READ_BUF, SIZE_READ_BUF);
+			}
+			m_regionRegistered = (const sl_uint8*)(region.getData());
+			m_nBuffersRegistered = READ_BUFFER_POOL_SIZE;
+		}
+
+		Memory get()
+		{
+			if (m_nBuffersRegistered) {
+				SpinLocker lock(&m_lockRegistered);
+				for (sl_uint32 i = 0; i < m_nBuffersRegistered; i++) {
+					Memory& mem = m_buffersRegistered[i];
+					if (mem.ref->getReferenceCount() == 1) {
+						return mem;
+					}
+				}
+			}
+			Memory ret;
+			if (m_list.popBack(&ret)) {
+				return ret;
+			}
+			return Memory::create(SIZE_READ_BUF);
+		}
+
+		void put(const Memory& mem)
+		{
+			const sl_uint8* data = (const sl_uint8*)(mem.getData());
+			if (m_regionRegistered && data >= m_regionRegistered && data < m_regionRegistered + SIZE_READ_BUF * READ_BUFFER_POOL_SIZE) {
+				// free again when it is released
+				return;
+			}
+			if (m_list.getCount() < READ_BUFFER_POOL_SIZE) {
+				m_list.add(mem);
+			}
+		}
+
+	};
+
+	HttpServiceConnection::HttpServiceConnection()
+	{
+		m_flagClosed = sl_true;
+		m_flagLazyReadBuffer = sl_false;
+		m_flagReading = sl_false;
+		m_flagProcessingInput = sl_false;
+		m_flagReadRequested = sl_false;
+		m_flagPipelineFull = sl_false;
+		m_stateTimeout = TIMEOUT_STATE_NONE;
+		m_timeStateStarted = 0;
+		m_flagRequestServed = sl_false;
+	}
+
+	HttpServiceConnection::~HttpServiceConnection()
+	{
+		close();
+	}
+
+	Ref<HttpServiceConnection> HttpServiceConnection::create(HttpService* service, AsyncStream* io)
+	{
+		if (service && io) {
+			Ref<_priv_HttpBufferPool> pool = service->_getReadBufferPool(io);
+			if (pool.isNotNull()) {
+				Ref<HttpServiceConnection> ret = new HttpServiceConnection;
+				if (ret.isNotNull()) {
+					ret->m_arena = MemoryArena::create();
+					AsyncOutputParam op;
+					op.stream = io;
+					op.listener.setWeak(ret);
+					op.bufferSize = SIZE_COPY_BUF;
+					Ref<AsyncOutput> output = AsyncOutput::create(op);
+					if (output.isNotNull()) {
+						ret->m_service = service;
+						ret->m_io = io;
+						ret->m_output = output;
+						ret->m_poolRead = pool;
+						ret->m_flagLazyReadBuffer = IsInstanceOf<AsyncTcpSocket>(io);
+						ret->m_flagClosed = sl_false;
+						return ret;
+					}
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	void HttpServiceConnection::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		_cancelTimeout();
+		
+		Ref<HttpService> service = m_service;
+		if (service.isNotNull()) {
+			service->closeConnection(this);
+		}
+		m_io->close();
+		m_output->close();
+		Ref<WebSocket> webSocket = m_webSocket;
+		lock.unlock();
+		if (webSocket.isNotNull()) {
+			webSocket->close();
+		}
+	}
+
+	void HttpServiceConnection::start(const void* data, sl_uint32 size)
+	{
+		m_contextCurrent.setNull();
+		if (data && size > 0) {
+			_processInput(data, size);
+		} else {
+			_read();
+		}
+	}
+
+	Ref<AsyncStream> HttpServiceConnection::getIO()
+	{
+		return m_io;
+	}
+
+	Ref<HttpService> HttpServiceConnection::getService()
+	{
+		return m_service;
+	}
+
+	Ref<HttpServiceContext> HttpServiceConnection::getCurrentContext()
+	{
+		return m_contextCurrent;
+	}
+
+	void HttpServiceConnection::_read()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (m_webSocket.isNotNull()) {
+			// the input is read by the WebSocket
+			return;
+		}
+		_updateTimeout();
+		if (m_flagReading) {
+			return;
+		}
+		if (m_flagPipelineFull) {
+			if (m_queueContexts.getCount() >= MAX_PIPELINED_REQUESTS) {
+				// resumed by `_flushResponses`
+				return;
+			}
+			m_flagPipelineFull = sl_false;
+			// the requests kept by `_processInput` are parsed on the loop thread, and no data is read before them
+			m_flagProcessingInput = sl_true;
+			if (m_io->addTask(SLIB_FUNCTION_WEAKREF(HttpServiceConnection, _resumeInput, this))) {
+				return;
+			}
+			m_flagProcessingInput = sl_false;
+			lock.unlock();
+			close();
+			return;
+		}
+		if (m_flagProcessingInput) {
+			// the received data is still in the buffer, restarted by `onReadStream`
+			m_flagReadRequested = sl_true;
+			return;
+		}
+		if (m_queueContexts.getCount() >= MAX_PIPELINED_REQUESTS) {
+			// resumed by `_flushResponses`
+			return;
+		}
+		Ref<HttpServiceContext> context = m_contextCurrent;
+		if (context.isNotNull() && context->m_flagRequestBodySuspended) {
+			// resumed by `HttpServiceContext::resumeRequestBody`
+			return;
+		}
+		if (context.isNull() && m_flagLazyReadBuffer) {
+			// no partial request remains, so the next request is waited without holding the buffer (see `onReadable`)
+			_releaseReadBuffer();
+			m_flagReading = sl_true;
+			if (m_io->read(sl_null, 0, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadable, this))) {
+				return;
+			}
+		} else {
+			if (m_bufRead.isNull()) {
+				m_bufRead = m_poolRead->get();
+			}
+			m_flagReading = sl_true;
+			if (m_bufRead.isNotNull()) {
+				if (m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadStream, this))) {
+					return;
+				}
+			}
+		}
+		m_flagReading = sl_false;
+		close();
+	}
+
+	void HttpServiceConnection::_releaseReadBuffer()
+	{
+		if (m_flagReading) {
+			return;
+		}
+		if (m_bufRead.isNotNull()) {
+			m_poolRead->put(m_bufRead);
+			m_bufRead.setNull();
+		}
+	}
+
+	sl_uint32 HttpServiceConnection::_getTimeoutState()
+	{
+		if (m_webSocket.isNotNull() || m_queueContexts.isNotEmpty()) {
+			// the WebSocket has no timeout, and the client is waiting for the responses
+			return TIMEOUT_STATE_NONE;
+		}
+		Ref<HttpServiceContext> context = m_contextCurrent;
+		if (context.isNull()) {
+			if (!m_flagRequestServed) {
+				// the first request is timed from the connection
+				return TIMEOUT_STATE_HEADER;
+			}
+			if (m_output->isWriting()) {
+				return TIMEOUT_STATE_NONE;
+			}
+			return TIMEOUT_STATE_IDLE;
+		}
+		if (context->m_requestHeader.isNull()) {
+			return TIMEOUT_STATE_HEADER;
+		}
+		if (context->m_flagRequestBodySuspended) {
+			return TIMEOUT_STATE_NONE;
+		}
+		return TIMEOUT_STATE_BODY;
+	}
+
+	void HttpServiceConnection::_updateTimeout()
+	{
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return;
+		}
+		const HttpServiceParam& param = service->getParam();
+		sl_uint32 state = _getTimeoutState();
+		if (state != m_stateTimeout) {
+			m_stateTimeout = state;
+			m_timeStateStarted = System::getTickCount();
+			switch (state) {
+				case TIMEOUT_STATE_IDLE:
+					_setTimeout(param.keepAliveTimeout);
+					break;
+				case TIMEOUT_STATE_HEADER:
+					// not extended by the following reads, so that the header can't be sent slowly
+					_setTimeout(param.requestHeaderTimeout);
+					break;
+				case TIMEOUT_STATE_BODY:
+					_setTimeout(param.requestBodyTimeout);
+					break;
+				default:
+					_cancelTimeout();
+					break;
+			}
+			return;
+		}
+		if (state == TIMEOUT_STATE_BODY) {
+			// restarted by every read, but limited by the minimum rate since the body started
+			sl_uint32 timeout = param.requestBodyTimeout;
+			if (!timeout) {
+				return;
+			}
+			sl_uint32 minRate = param.requestBodyMinRate;
+			if (minRate) {
+				Ref<HttpServiceContext> context = m_contextCurrent;
+				sl_uint64 limit = (sl_uint64)timeout + context->m_sizeRequestBodyReceived * 1000 / minRate;
+				sl_uint64 elapsed = (sl_uint32)(System::getTickCount() - m_timeStateStarted);
+				if (limit <= elapsed) {
+					timeout = 1;
+				} else if (limit - elapsed < timeout) {
+					timeout = (sl_uint32)(limit - elapsed);
+				}
+			}
+			_setTimeout(timeout);
+		}
+	}
+
+	void HttpServiceConnection::_cancelTimeout()
+	{
+		m_timer.cancel();
+		m_timer.setNull();
+	}
+
+	void HttpServiceConnection::_setTimeout(sl_uint32 timeout)
+	{
+		if (!timeout) {
+			_cancelTimeout();
+			return;
+		}
+		// rescheduling on the timer wheel of the loop is O(1)
+		if (m_timer.reschedule(timeout)) {
+			return;
+		}
+		Ref<AsyncIoLoop> loop = m_io->getIoLoop();
+		if (loop.isNull()) {
+			Ref<HttpService> service = m_service;
+			if (service.isNull()) {
+				return;
+			}
+			loop = service->getAsyncIoLoop();
+			if (loop.isNull()) {
+				return;
+			}
+		}
+		m_timer = loop->addTimeout(SLIB_FUNCTION_WEAKREF(HttpServiceConnection, _onTimeout, this), timeout);
+	}
+
+	void HttpServiceConnection::_onTimeout()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (m_timer.isPending()) {
+			// rescheduled after expired
+			return;
+		}
+		if (_getTimeoutState() != m_stateTimeout) {
+			_updateTimeout();
+			return;
+		}
+		if (m_stateTimeout == TIMEOUT_STATE_NONE) {
+			return;
+		}
+		Ref<HttpService> service = m_service;
+		if (service.isNotNull() && service->getParam().flagLogDebug) {
+			Log(SERVICE_TAG, "[%s] Connection Timeout", String::fromPointerValue(this));
+		}
+		lock.unlock();
+		close();
+	}
+
+	void HttpServiceConnection::_processInput(const void* _data, sl_uint32 size)
+	{
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return;
+		}
+		if (m_flagClosed) {
+			return;
+		}
+		
+		const HttpServiceParam& param = service->getParam();
+		sl_uint64 maxRequestHeadersSize = param.maxRequestHeadersSize;
+		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
+
+		char* data = (char*)_data;
+		
+		// a single read may contain several pipelined requests
+		while (1) {
+			
+			Ref<HttpServiceContext> _context = m_contextCurrent;
+			if (_context.isNull()) {
+				if (size == 0) {
+					break;
+				}
+				{
+					ObjectLocker lock(this);
+					if (m_queueContexts.getCount() >= MAX_PIPELINED_REQUESTS) {
+						// the rest of the input is not parsed until the responses are flushed (resumed by `_read`)
+						m_bufPending = Memory::create(data, size);
+						m_flagPipelineFull = sl_true;
+						return;
+					}
+				}
+				_context = HttpServiceContext::create(this);
+				if (_context.isNull()) {
+					sendResponse_ServerError();
+					return;
+				}
+				m_contextCurrent = _context;
+				_context->setProcessingByThread(param.flagProcessByThreads);
+				if (m_arena.isNotNull()) {
+					// the chunk is rewound when the strings of the previous requests are released
+					m_arena->reset();
+					_context->m_requestHeaderReader.setMemoryArena(m_arena);
+					_context->setRequestArena(m_arena);
+				}
+			}
+			HttpServiceContext* context = _context.get();
+			
+			if (context->m_requestHeader.isNull()) {
+				if (size == 0) {
+					break;
+				}
+				sl_size posBody;
+				if (context->m_requestHeaderReader.add(data, size, posBody)) {
+					context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
+					if (context->m_requestHeader.isNull()) {
+						_sendErrorResponse(context, sl_null);
+						return;
+					}
+					if (posBody > size) {
+						_sendErrorResponse(context, sl_null);
+						return;
+					}
+					context->m_requestHeaderReader.clear();
+					Memory header = context->getRawRequestHeader();
+					sl_reg iRet = context->parseRequestPacket(header);
+					if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
+						SLIB_STATIC_STRING(s, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+						_sendErrorResponse(context, Memory::create(s.getData(), s.getLength()));
+						return;
+					}
+					context->m_requestContentLength = context->getRequestContentLengthHeader();
+					data += posBody;
+					size -= (sl_uint32)posBody;
+					context->applyQueryToParameters();
+					// the arena is not thread-safe, so the strings created later (on the processing threads) are not allocated in it
+					context->setRequestArena(sl_null);
+					context->m_requestHeaderReader.setMemoryArena(sl_null);
+					if (service->preprocessRequest(context)) {
+						// the service is processing the connection itself
+						ObjectLocker lock(this);
+						m_stateTimeout = TIMEOUT_STATE_NONE;
+						_cancelTimeout();
+						return;
+					}
+					if (_upgradeWebSocket(context, data, size)) {
+						return;
+					}
+					// streamed bodies are not buffered, so they are not limited by `maxRequestBodySize`
+					if (context->m_callbackRequestBody.isNull() && context->m_requestContentLength > maxRequestBodySize) {
+						SLIB_STATIC_STRING(s, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+						_sendErrorResponse(context, Memory::create(s.getData(), s.getLength()));
+						return;
+					}
+				} else {
+					if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
+						SLIB_STATIC_STRING(s, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+						_sendErrorResponse(context, Memory::create(s.getData(), s.getLength()));
+						return;
+					}
+					break;
+				}
+			}
+			
+			sl_uint32 sizeBody = size;
+			sl_uint64 sizeRemain = context->m_requestContentLength - context->m_sizeRequestBodyReceived;
+			if (sizeBody > sizeRemain) {
+				sizeBody = (sl_uint32)sizeRemain;
+			}
+			if (sizeBody > 0) {
+				context->m_sizeRequestBodyReceived += sizeBody;
+				if (context->m_callbackRequestBody.isNotNull()) {
+					context->m_callbackRequestBody(context, data, sizeBody);
+				} else {
+					if (!(context->m_requestBodyBuffer.add(Memory::create(data, sizeBody)))) {
+						_sendErrorResponse(context, sl_null);
+						return;
+					}
+				}
+				data += sizeBody;
+				size -= sizeBody;
+			}
+			
+			{
+				ObjectLocker lock(this);
+				if (context->m_flagRequestBodySuspended) {
+					// backpressure: the rest of the input is kept until `HttpServiceContext::resumeRequestBody`
+					if (size > 0) {
+						m_bufPending = Memory::create(data, size);
+					}
+					return;
+				}
+			}
+			
+			if (context->m_sizeRequestBodyReceived < context->m_requestContentLength) {
+				break;
+			}
+
+			{
+				ObjectLocker lock(this);
+				m_contextCurrent.setNull();
+				// the next request is timed from its first byte, after the responses are sent
+				m_flagRequestServed = sl_true;
+				m_stateTimeout = TIMEOUT_STATE_NONE;
+				_cancelTimeout();
+			}
+
+			if (context->m_callbackRequestBody.isNull()) {
+				context->m_requestBody = context->m_requestBodyBuffer.merge();
+				if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
+					_sendErrorResponse(context, sl_null);
+					return;
+				}
+				context->m_requestBodyBuffer.clear();
+			}
+
+			if (context->getMethod() == HttpMethod::POST) {
+				String reqContentType = context->getRequestContentTypeNoParams();
+				if (reqContentType == ContentTypes::WebForm) {
+					Memory body = context->getRequestBody();
+					context->setRequestArena(m_arena);
+					context->applyPostParameters(body.getData(), body.getSize());
+					context->setRequestArena(sl_null);
+				}
+			}
+			
+			_dispatchContext(context);
+			
+			if (m_flagClosed) {
+				return;
+			}
+		}
+		_read();
+	}
+
+	void HttpServiceConnection::_resumeInput()
+	{
+		Memory pending;
+		{
+			ObjectLocker lock(this);
+			pending = m_bufPending;
+			m_bufPending.setNull();
+			m_flagProcessingInput = sl_true;
+		}
+		_processInput(pending.getData(), (sl_uint32)(pending.getSize()));
+		sl_bool flagRead;
+		{
+			ObjectLocker lock(this);
+			m_flagProcessingInput = sl_false;
+			flagRead = m_flagReadRequested;
+			m_flagReadRequested = sl_false;
+		}
+		if (flagRead) {
+			_read();
+		}
+	}
+
+	void HttpServiceConnection::_resumeRequestBody(const Ref<HttpServiceContext>& context)
+	{
+		{
+			ObjectLocker lock(this);
+			if (!(context->m_flagRequestBodySuspended)) {
+				return;
+			}
+			context->m_flagRequestBodySuspended = sl_false;
+			m_flagProcessingInput = sl_true;
+		}
+		_resumeInput();
+	}
+
+	void HttpServiceConnection::_dispatchContext(HttpServiceContext* context)
+	{
+		m_queueContexts.push(context);
+		if (context->isProcessingByThread()) {
+			Ref<HttpService> service = m_service;
+			if (service.isNotNull()) {
+				Ref<ThreadPool> threadPool = service->getThreadPool();
+				if (threadPool.isNotNull()) {
+					if (threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, Ref<HttpServiceContext>(context)))) {
+						return;
+					}
+				}
+			}
+			_sendErrorResponse(context, sl_null);
+		} else {
+			_processContext(context);
+		}
+	}
+
+	void HttpServiceConnection::_processContext(const Ref<HttpServiceContext>& context)
+	{
+		Ref<HttpService> service = getService();
+		if (service.isNull()) {
+			return;
+		}
+		if (context->getMethod() == HttpMethod::CONNECT) {
 			sendConnectResponse_Failed();
 			return;
 		}
-		service->processRequest(context.get());
-		if (!(context->isAsynchronousResponse())) {
-			context->completeResponse();
+		service->processRequest(context.get());
+		if (!(context->isAsynchronousResponse())) {
+			context->completeResponse();
+		}
+	}
+
+	void HttpServiceConnection::_completeResponse(HttpServiceContext* context)
+	{
+		String oldResponseContentType = context->getResponseContentType();
+		if (oldResponseContentType.isEmpty()) {
+			context->setResponseContentType(ContentTypes::TextHtml_Utf8);
+		}
+		_compressResponse(context);
+		if (!(context->isChunkedResponse())) {
+			context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
+		}
+		Memory header = context->makeResponsePacket();
+		if (header.isNull()) {
+			close();
+			return;
+		}
+		{
+			ObjectLocker lock(this);
+			if (m_contextCurrent == context) {
+				// taken over by `HttpService::preprocessRequest`
+				m_contextCurrent.setNull();
+				m_queueContexts.push(context);
+			}
+			context->m_responseHeader = header;
+			context->m_flagResponseCompleted = sl_true;
+		}
+		_flushResponses();
+	}
+
+	void HttpServiceConnection::_compressResponse(HttpServiceContext* context)
+	{
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return;
+		}
+		Ref<_priv_HttpCompressPool> pool = service->m_compressPool;
+		if (pool.isNull()) {
+			return;
+		}
+		const HttpServiceParam& param = service->getParam();
+		if (context->getMethod() == HttpMethod::HEAD) {
+			return;
+		}
+		HttpStatus status = context->getResponseCode();
+		if ((sl_uint32)status < 200 || status == HttpStatus::NoContent || status == HttpStatus::PartialContent || status == HttpStatus::NotModified) {
+			return;
+		}
+		if (context->getResponseContentEncoding().isNotEmpty()) {
+			return;
+		}
+		if (!(_priv_HttpService_isCompressibleContentType(context->getResponseContentType()))) {
+			return;
+		}
+		if (context->getResponseContentLength() < param.compressionMinSize) {
+			return;
+		}
+		SLIB_STATIC_STRING(gzip, "gzip")
+		SLIB_STATIC_STRING(deflate, "deflate")
+		_priv_HttpContentCoding coding = _priv_HttpService_getAcceptedCoding(context->getRequestHeader(HttpHeaders::AcceptEncoding), sl_true);
+		if (coding == _priv_HttpContentCoding::Identity) {
+			return;
+		}
+		sl_bool flagGzip = coding == _priv_HttpContentCoding::Gzip;
+		String vary = context->getResponseHeader(HttpHeaders::Vary);
+		if (vary.isEmpty()) {
+			context->setResponseHeader(HttpHeaders::Vary, HttpHeaders::AcceptEncoding);
+		} else if (!(vary.toLower().contains("accept-encoding"))) {
+			context->setResponseHeader(HttpHeaders::Vary, vary + ", " + HttpHeaders::AcceptEncoding);
+		}
+		Memory content;
+		if (context->m_bufferOutput.getMemoryOutput(content)) {
+			Ref<ZlibCompress> compress = pool->start(flagGzip, param.compressionLevel);
+			if (compress.isNull()) {
+				return;
+			}
+			Memory output = compress->compress(content.getData(), content.getSize(), sl_true);
+			pool->put(compress);
+			if (output.isNotNull() && output.getSize() < content.getSize()) {
+				context->clearOutput();
+				context->write(output);
+				context->setResponseContentEncoding(flagGzip ? gzip : deflate);
+			}
+			return;
+		}
+		// the chunked transfer coding is not available for HTTP/1.0 clients
+		if (context->getRequestVersion().equalsIgnoreCase("HTTP/1.0")) {
+			return;
+		}
+		Ref<ZlibCompress> compress = pool->start(flagGzip, param.compressionLevel);
+		if (compress.isNull()) {
+			return;
+		}
+		Ref<_priv_HttpCompressStream> stream = _priv_HttpCompressStream::create(m_io.get(), pool.get(), compress, &(context->m_bufferOutput));
+		if (stream.isNull()) {
+			pool->put(compress);
+			return;
+		}
+		context->copyFrom(stream.get(), SLIB_UINT64_MAX);
+		context->setResponseContentEncoding(flagGzip ? gzip : deflate);
+		context->setResponseTransferEncoding("chunked");
+	}
+
+	sl_bool HttpServiceConnection::_upgradeWebSocket(HttpServiceContext* context, const void* data, sl_uint32 size)
+	{
+		if (context->getMethod() != HttpMethod::GET) {
+			return sl_false;
+		}
+		if (!(context->getRequestHeader(HttpHeaders::Upgrade).equalsIgnoreCase("websocket"))) {
+			return sl_false;
+		}
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return sl_false;
+		}
+		String key = context->getRequestHeader(HttpHeaders::SecWebSocketKey);
+		if (key.isEmpty() || m_queueContexts.isNotEmpty()) {
+			// not a handshake of this version, or pipelined after other requests
+			return sl_false;
+		}
+		if (context->getRequestHeader(HttpHeaders::SecWebSocketVersion) != "13") {
+			SLIB_STATIC_STRING(s, "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nContent-Length: 0\r\n\r\n");
+			_sendErrorResponse(context, Memory::create(s.getData(), s.getLength()));
+			return sl_true;
+		}
+		WebSocketParam param;
+		if (!(service->acceptWebSocket(context, param))) {
+			return sl_false;
+		}
+		Ref<WebSocket> webSocket = WebSocket::create(m_io, param, data, size);
+		if (webSocket.isNull()) {
+			_sendErrorResponse(context, sl_null);
+			return sl_true;
+		}
+		webSocket->m_connection = this;
+		String response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + WebSocket::getAcceptKey(key) + "\r\n";
+		if (param.protocol.isNotEmpty()) {
+			response += "Sec-WebSocket-Protocol: " + param.protocol + "\r\n";
+		}
+		response += "\r\n";
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed) {
+				return sl_true;
+			}
+			m_contextCurrent.setNull();
+			m_webSocket = webSocket;
+			// the input is copied by the WebSocket
+			_releaseReadBuffer();
+			_updateTimeout();
+		}
+		if (!(m_io->writeFromMemory(Memory::create(response.getData(), response.getLength()), sl_null))) {
+			close();
+			return sl_true;
+		}
+		webSocket->start();
+		return sl_true;
+	}
+
+	void HttpServiceConnection::_sendErrorResponse(HttpServiceContext* context, const Memory& response)
+	{
+		Memory mem = response;
+		if (mem.isNull()) {
+			SLIB_STATIC_STRING(s, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n");
+			mem = Memory::create(s.getData(), s.getLength());
+		}
+		{
+			ObjectLocker lock(this);
+			if (m_contextCurrent == context) {
+				// the rest of the input can't be parsed any more, restart with the next read
+				m_contextCurrent.setNull();
+				m_queueContexts.push(context);
+			}
+			context->m_bufferOutput.clearOutput();
+			context->m_responseHeader = mem;
+			context->m_flagResponseCompleted = sl_true;
+		}
+		_flushResponses();
+	}
+
+	void HttpServiceConnection::_flushResponses()
+	{
+		sl_bool flagWrite = sl_false;
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed) {
+				return;
+			}
+			// the responses are written in the order of the requests, and the completed ones are written together
+			Link< Ref<HttpServiceContext> >* link;
+			while ((link = m_queueContexts.getFront()) && link->value->m_flagResponseCompleted) {
+				Ref<HttpServiceContext> context;
+				m_queueContexts.pop(&context);
+				if (!(m_output->write(context->m_responseHeader))) {
+					lock.unlock();
+					close();
+					return;
+				}
+				context->m_responseHeader.setNull();
+				m_output->mergeBuffer(&(context->m_bufferOutput));
+				flagWrite = sl_true;
+			}
+		}
+		if (flagWrite) {
+			m_output->startWriting();
 		}
+		_read();
 	}
 
-	void HttpServiceConnection::_completeResponse(HttpServiceContext* context)
+	void HttpServiceConnection::onReadStream(AsyncStreamResult* result)
 	{
-		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
-		String oldResponseContentType = context->getResponseContentType();
-		if (oldResponseContentType.isEmpty()) {
-			context->setResponseContentType(ContentTypes::TextHtml_Utf8);
-		}
-		Memory header = context->makeResponsePacket();
-		if (header.isNull()) {
+		if (result->flagError) {
+			m_flagReading = sl_false;
 			close();
 			return;
 		}
-		if (!(m_output->write(header))) {
-			close();
-			return;
+		{
+			ObjectLocker lock(this);
+			m_flagReading = sl_false;
+			m_flagProcessingInput = sl_true;
+			m_flagReadRequested = sl_false;
+		}
+		_processInput(result->data, result->size);
+		sl_bool flagRead;
+		{
+			ObjectLocker lock(this);
+			m_flagProcessingInput = sl_false;
+			flagRead = m_flagReadRequested;
+			m_flagReadRequested = sl_false;
+		}
+		if (flagRead) {
+			_read();
 		}
-		m_output->mergeBuffer(&(context->m_bufferOutput));
-		m_output->startWriting();
-		start();
 	}
 
-	void HttpServiceConnection::onReadStream(AsyncStreamResult* result)
+	void HttpServiceConnection::onReadable(AsyncStreamResult* result)
 	{
-		m_flagReading = sl_false;
 		if (result->flagError) {
+			m_flagReading = sl_false;
 			close();
-		} else {
-			_processInput(result->data, result->size);
+			return;
+		}
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		// the data arrived: borrows the buffer and receives it, while still reading
+		if (m_bufRead.isNull()) {
+			m_bufRead = m_poolRead->get();
+		}
+		if (m_bufRead.isNotNull()) {
+			if (m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadStream, this))) {
+				return;
+			}
 		}
+		m_flagReading = sl_false;
+		lock.unlock();
+		close();
 	}
 
 	void HttpServiceConnection::onAsyncOutputComplete(AsyncOutput* output)
 	{
+		// starts the keep-alive timeout
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		_updateTimeout();
 	}
 
 	void HttpServiceConnection::onAsyncOutputError(AsyncOutput* output)
@@ -527,15 +1750,36 @@ namespace slib
 		m_service = service;
 	}
 
+	void HttpServiceConnectionProvider::pauseAccepting()
+	{
+	}
+
+	void HttpServiceConnectionProvider::resumeAccepting()
+	{
+	}
+
+#if defined(SLIB_PLATFORM_IS_LINUX) && defined(SLIB_PLATFORM_IS_DESKTOP)
+	// SO_REUSEPORT balances incoming connections among the listening sockets
+#	define PRIV_SUPPORT_REUSE_PORT_SHARDING
+#endif
+
+#define ACCEPT_ERROR_BACKOFF 100
+
 	class _priv_DefaultHttpServiceConnectionProvider : public HttpServiceConnectionProvider, public IAsyncTcpServerListener
 	{
 	public:
-		Ref<AsyncTcpServer> m_server;
-		Ref<AsyncIoLoop> m_loop;
+		List< Ref<AsyncTcpServer> > m_servers;
+		List< Ref<AsyncIoLoop> > m_loops;
+		sl_bool m_flagSharding;
+		sl_uint32 m_indexLoop;
+		sl_bool m_flagPaused;
 
 	public:
 		_priv_DefaultHttpServiceConnectionProvider()
 		{
+			m_flagSharding = sl_false;
+			m_indexLoop = 0;
+			m_flagPaused = sl_false;
 		}
 
 		~_priv_DefaultHttpServiceConnectionProvider()
@@ -546,22 +1790,53 @@ namespace slib
 	public:
 		static Ref<HttpServiceConnectionProvider> create(HttpService* service, const SocketAddress& addressListen)
 		{
-			Ref<AsyncIoLoop> loop = service->getAsyncIoLoop();
-			if (loop.isNotNull()) {
-				Ref<_priv_DefaultHttpServiceConnectionProvider> ret = new _priv_DefaultHttpServiceConnectionProvider;
-				if (ret.isNotNull()) {
-					ret->m_loop = loop;
-					ret->setService(service);
-					AsyncTcpServerParam sp;
-					sp.bindAddress = addressListen;
-					sp.listener.setWeak(ret);
-					sp.ioLoop = loop;
+			List< Ref<AsyncIoLoop> > loops = service->getAsyncIoLoops();
+			if (loops.isEmpty()) {
+				return sl_null;
+			}
+			Ref<_priv_DefaultHttpServiceConnectionProvider> ret = new _priv_DefaultHttpServiceConnectionProvider;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->m_loops = loops;
+			ret->setService(service);
+			AsyncTcpServerParam sp;
+			sp.bindAddress = addressListen;
+			sp.listener.setWeak(ret);
+#if defined(PRIV_SUPPORT_REUSE_PORT_SHARDING)
+			ListElements< Ref<AsyncIoLoop> > listLoops(loops);
+			if (listLoops.count > 1) {
+				// one listening socket per loop, so that each connection lives on the loop which accepted it
+				List< Ref<AsyncTcpServer> > servers;
+				sp.flagReusingPort = sl_true;
+				sp.flagLogError = sl_false;
+				for (sl_size i = 0; i < listLoops.count; i++) {
+					sp.ioLoop = listLoops[i];
 					Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
-					if (server.isNotNull()) {
-						ret->m_server = server;
-						return ret;
+					if (server.isNull()) {
+						break;
 					}
+					servers.add_NoLock(server);
+				}
+				if (servers.getCount() == listLoops.count) {
+					ret->m_servers = servers;
+					ret->m_flagSharding = sl_true;
+					return ret;
 				}
+				ListElements< Ref<AsyncTcpServer> > listServers(servers);
+				for (sl_size i = 0; i < listServers.count; i++) {
+					listServers[i]->close();
+				}
+				sp.flagReusingPort = sl_false;
+				sp.flagLogError = sl_true;
+			}
+#endif
+			// single listening socket, the accepted connections are distributed to the loops in round-robin
+			sp.ioLoop = loops.getValueAt(0);
+			Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+			if (server.isNotNull()) {
+				ret->m_servers = List< Ref<AsyncTcpServer> >::createFromElement(server);
+				return ret;
 			}
 			return sl_null;
 		}
@@ -569,16 +1844,52 @@ namespace slib
 		void release()
 		{
 			ObjectLocker lock(this);
-			if (m_server.isNotNull()) {
-				m_server->close();
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->close();
+			}
+		}
+
+		void pauseAccepting() override
+		{
+			ObjectLocker lock(this);
+			m_flagPaused = sl_true;
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->stop();
+			}
+		}
+
+		void resumeAccepting() override
+		{
+			ObjectLocker lock(this);
+			m_flagPaused = sl_false;
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->start();
+			}
+		}
+
+		Ref<AsyncIoLoop> selectLoop(AsyncTcpServer* socketListen)
+		{
+			if (m_flagSharding) {
+				return socketListen->getIoLoop();
+			}
+			ListElements< Ref<AsyncIoLoop> > loops(m_loops);
+			if (loops.count == 0) {
+				return sl_null;
 			}
+			// `onAccept` is always called on the loop of the single listening socket
+			sl_uint32 index = m_indexLoop;
+			m_indexLoop = (sl_uint32)((index + 1) % loops.count);
+			return loops[index % loops.count];
 		}
 
 		void onAccept(AsyncTcpServer* socketListen, const Ref<Socket>& socketAccept, const SocketAddress& address)
 		{
 			Ref<HttpService> service = getService();
 			if (service.isNotNull()) {
-				Ref<AsyncIoLoop> loop = m_loop;
+				Ref<AsyncIoLoop> loop = selectLoop(socketListen);
 				if (loop.isNull()) {
 					return;
 				}
@@ -597,9 +1908,204 @@ namespace slib
 		void onError(AsyncTcpServer* socketListen)
 		{
 			LogError(SERVICE_TAG, "Accept Error");
+			// backs off instead of retrying immediately (ex: out of file descriptors), the pending connections are accepted after the delay
+			if (socketListen->isRunning()) {
+				Ref<AsyncIoLoop> loop = socketListen->getIoLoop();
+				if (loop.isNotNull()) {
+					socketListen->stop();
+					loop->addTimeout(SLIB_BIND_WEAKREF(void(), _priv_DefaultHttpServiceConnectionProvider, resumeServer, this, Ref<AsyncTcpServer>(socketListen)), ACCEPT_ERROR_BACKOFF);
+				}
+			}
+		}
+
+		void resumeServer(const Ref<AsyncTcpServer>& server)
+		{
+			ObjectLocker lock(this);
+			if (!m_flagPaused) {
+				server->start();
+			}
+		}
+	};
+
+/******************************************************
+				HttpService Static Cache
+******************************************************/
+
+	class _priv_HttpStaticCacheEntry : public Referable
+	{
+	public:
+		String path;
+		Memory content;
+		Memory contentGzip;
+		ContentType contentType;
+		String etag;
+		String etagGzip; // `etag` suffixed by `-gz`, for `contentGzip`
+		String lastModified;
+		Time timeModified;
+		sl_uint64 size;
+		sl_uint32 tickChecked; // protected by the lock of the cache
+		Link< Ref<_priv_HttpStaticCacheEntry> >* link;
+
+	public:
+		sl_uint64 getCost()
+		{
+			return content.getSize() + contentGzip.getSize();
+		}
+
+	};
+
+	class _priv_HttpStaticCache : public Referable
+	{
+	public:
+		Mutex m_lock;
+		CHashMap< String, Ref<_priv_HttpStaticCacheEntry> > m_map;
+		// front: most recently used
+		CLinkedList< Ref<_priv_HttpStaticCacheEntry> > m_lru;
+		sl_uint64 m_sizeTotal;
+
+		sl_uint64 m_sizeLimit;
+		sl_uint64 m_sizeFileLimit;
+		sl_uint32 m_intervalCheck;
+		sl_bool m_flagGzip;
+
+	public:
+		_priv_HttpStaticCache(const HttpServiceParam& param)
+		{
+			m_sizeTotal = 0;
+			m_sizeLimit = param.staticCacheSize;
+			m_sizeFileLimit = param.staticCacheMaxFileSize;
+			m_intervalCheck = param.staticCacheCheckInterval;
+			m_flagGzip = param.flagStaticCacheGzip;
+		}
+
+	public:
+		Ref<_priv_HttpStaticCacheEntry> get(const String& path)
+		{
+			sl_uint32 tickNow = System::getTickCount();
+			Ref<_priv_HttpStaticCacheEntry> entry;
+			{
+				MutexLocker lock(&m_lock);
+				if (m_map.get_NoLock(path, &entry)) {
+					_touch(entry.get());
+					if ((sl_uint32)(tickNow - entry->tickChecked) < m_intervalCheck) {
+						return entry;
+					}
+				}
+			}
+			Time timeModified = File::getModifiedTime(path);
+			sl_uint64 size = File::getSize(path);
+			if (entry.isNotNull()) {
+				if (timeModified.isNotZero() && timeModified == entry->timeModified && size == entry->size) {
+					MutexLocker lock(&m_lock);
+					entry->tickChecked = tickNow;
+					return entry;
+				}
+				_remove(entry.get());
+				entry.setNull();
+			}
+			if (timeModified.isZero() || size > m_sizeFileLimit || size > m_sizeLimit || File::isDirectory(path)) {
+				return sl_null;
+			}
+			Memory content = File::readAllBytes(path, (sl_size)(m_sizeFileLimit));
+			if (content.getSize() != size) {
+				return sl_null;
+			}
+			entry = new _priv_HttpStaticCacheEntry;
+			if (entry.isNull()) {
+				return sl_null;
+			}
+			entry->path = path;
+			entry->content = content;
+			entry->size = size;
+			entry->timeModified = timeModified;
+			entry->tickChecked = tickNow;
+			entry->link = sl_null;
+			entry->contentType = ContentTypes::getFromFileExtension(File::getFileExtension(path));
+			if (entry->contentType == ContentType::Unknown) {
+				entry->contentType = ContentType::OctetStream;
+			}
+			entry->etag = String::format("\"%s-%s\"", String::fromUint64(timeModified.toInt(), 16), String::fromUint64(size, 16));
+			entry->lastModified = timeModified.toHttpDate();
+			if (m_flagGzip && size >= PRIV_HTTP_STATIC_CACHE_GZIP_MIN_SIZE && _isCompressible(entry->contentType)) {
+				Memory gzip = Zlib::compressGzip(content.getData(), content.getSize());
+				if (gzip.getSize() < size) {
+					entry->contentGzip = gzip;
+					entry->etagGzip = String::format("\"%s-%s-gz\"", String::fromUint64(timeModified.toInt(), 16), String::fromUint64(size, 16));
+				}
+			}
+			_add(entry.get());
+			return entry;
+		}
+
+	private:
+		void _touch(_priv_HttpStaticCacheEntry* entry)
+		{
+			if (entry->link) {
+				m_lru.removeAt(entry->link);
+			}
+			entry->link = m_lru.pushFront_NoLock(entry);
 		}
+
+		void _add(_priv_HttpStaticCacheEntry* entry)
+		{
+			MutexLocker lock(&m_lock);
+			Ref<_priv_HttpStaticCacheEntry> old;
+			if (m_map.get_NoLock(entry->path, &old)) {
+				_remove_NoLock(old.get());
+			}
+			sl_uint64 cost = entry->getCost();
+			while (m_sizeTotal + cost > m_sizeLimit) {
+				Link< Ref<_priv_HttpStaticCacheEntry> >* link = m_lru.getBack();
+				if (!link) {
+					break;
+				}
+				Ref<_priv_HttpStaticCacheEntry> victim = link->value;
+				_remove_NoLock(victim.get());
+			}
+			m_map.put_NoLock(entry->path, entry);
+			entry->link = m_lru.pushFront_NoLock(entry);
+			m_sizeTotal += cost;
+		}
+
+		void _remove(_priv_HttpStaticCacheEntry* entry)
+		{
+			MutexLocker lock(&m_lock);
+			_remove_NoLock(entry);
+		}
+
+		void _remove_NoLock(_priv_HttpStaticCacheEntry* entry)
+		{
+			if (!(entry->link)) {
+				return;
+			}
+			m_lru.removeAt(entry->link);
+			entry->link = sl_null;
+			m_map.remove_NoLock(entry->path);
+			m_sizeTotal -= entry->getCost();
+		}
+
+		static sl_bool _isCompressible(ContentType type)
+		{
+			return _priv_HttpService_isCompressibleContentType(ContentTypes::toString(type));
+		}
+
 	};
 
+	static sl_bool _priv_HttpService_isMatchingETag(const String& header, const String& etag)
+	{
+		ListElements<String> tags(header.split(","));
+		for (sl_size i = 0; i < tags.count; i++) {
+			String tag = tags[i].trim();
+			if (tag.startsWith("W/")) {
+				tag = tag.substring(2);
+			}
+			if (tag == "*" || tag == etag) {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 /******************************************************
 					HttpService
 ******************************************************/
@@ -616,14 +2122,32 @@ namespace slib
 	{
 		port = 80;
 		
+		ioLoopCount = System::getProcessorsCount();
+		
 		maxThreadsCount = 32;
 		flagProcessByThreads = sl_true;
 		
 		flagUseAsset = sl_false;
 		
+		flagUseStaticCache = sl_false;
+		staticCacheSize = 0x4000000; // 64MB
+		staticCacheMaxFileSize = 0x100000; // 1MB
+		staticCacheCheckInterval = 1000;
+		flagStaticCacheGzip = sl_true;
+		
+		flagCompressResponse = sl_false;
+		compressionMinSize = 1024;
+		compressionLevel = 6;
+		
 		maxRequestHeadersSize = 0x10000; // 64KB
 		maxRequestBodySize = 0x2000000; // 32MB
 		
+		maxConnections = 0;
+		requestHeaderTimeout = 30000;
+		keepAliveTimeout = 60000;
+		requestBodyTimeout = 30000;
+		requestBodyMinRate = 0;
+		
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
@@ -642,6 +2166,7 @@ namespace slib
 	HttpService::HttpService()
 	{
 		m_flagRunning = sl_true;
+		m_flagAcceptingPaused = sl_false;
 	}
 
 	HttpService::~HttpService()
@@ -651,30 +2176,60 @@ namespace slib
 
 	sl_bool HttpService::_init(const HttpServiceParam& param)
 	{
-		Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
-		if (ioLoop.isNotNull()) {
-			Ref<ThreadPool> threadPool = ThreadPool::create();
-			if (threadPool.isNotNull()) {
-				threadPool->setMaximumThreadsCount(param.maxThreadsCount);
-				
-				m_ioLoop = ioLoop;
-				m_threadPool = threadPool;
-				m_param = param;
-				if (param.port) {
-					if (! (addHttpService(param.addressBind, param.port))) {
-						return sl_false;
-					}
-				}
-				if (param.processor.isNotNull()) {
-					addProcessor(param.processor);
+		sl_uint32 nLoops = param.ioLoopCount;
+		if (nLoops < 1) {
+			nLoops = 1;
+		}
+		for (sl_uint32 i = 0; i < nLoops; i++) {
+			Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
+			if (ioLoop.isNull()) {
+				return sl_false;
+			}
+			m_ioLoops.add(ioLoop);
+		}
+		
+		Ref<ThreadPool> threadPool = ThreadPool::create();
+		if (threadPool.isNull()) {
+			return sl_false;
+		}
+		threadPool->setMaximumThreadsCount(param.maxThreadsCount);
+		
+		{
+			ListLocker< Ref<AsyncIoLoop> > loops(m_ioLoops);
+			for (sl_size i = 0; i < loops.count; i++) {
+				Ref<_priv_HttpBufferPool> pool = new _priv_HttpBufferPool;
+				if (pool.isNull()) {
+					return sl_false;
 				}
-				
-				ioLoop->start();
-
-				return sl_true;
+				pool->registerBuffers(loops[i].get());
+				m_readBufferPools.put_NoLock(loops[i].get(), pool);
 			}
 		}
-		return sl_false;
+		
+		m_ioLoop = m_ioLoops.getValueAt(0);
+		m_threadPool = threadPool;
+		m_param = param;
+		if (param.flagUseStaticCache) {
+			m_staticCache = new _priv_HttpStaticCache(param);
+		}
+		if (param.flagCompressResponse) {
+			m_compressPool = new _priv_HttpCompressPool;
+		}
+		if (param.port) {
+			if (! (addHttpService(param.addressBind, param.port))) {
+				return sl_false;
+			}
+		}
+		if (param.processor.isNotNull()) {
+			addProcessor(param.processor);
+		}
+		
+		ListLocker< Ref<AsyncIoLoop> > loops(m_ioLoops);
+		for (sl_size i = 0; i < loops.count; i++) {
+			loops[i]->start();
+		}
+		
+		return sl_true;
 	}
 
 	Ref<HttpService> HttpService::create(const HttpServiceParam& param)
@@ -706,18 +2261,27 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
-		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
-		if (ioLoop.isNotNull()) {
-			ioLoop->release();
+		{
+			ListElements< Ref<AsyncIoLoop> > loops(getAsyncIoLoops());
+			m_ioLoops.removeAll();
 			m_ioLoop.setNull();
+			for (sl_size i = 0; i < loops.count; i++) {
+				loops[i]->release();
+			}
 		}
+		
 		Ref<ThreadPool> threadPool = m_threadPool;
 		if (threadPool.isNotNull()) {
 			threadPool->release();
 			m_threadPool.setNull();
 		}
 		
-		m_connections.removeAll();
+		// the connections are released out of the lock
+		FlatHashMap< HttpServiceConnection*, Ref<HttpServiceConnection> > connections;
+		{
+			MutexLocker lock(&m_lockConnections);
+			connections = Move(m_connections);
+		}
 	}
 
 	sl_bool HttpService::isRunning()
@@ -730,6 +2294,11 @@ namespace slib
 		return m_ioLoop;
 	}
 
+	List< Ref<AsyncIoLoop> > HttpService::getAsyncIoLoops()
+	{
+		return m_ioLoops.duplicate();
+	}
+
 	Ref<ThreadPool> HttpService::getThreadPool()
 	{
 		return m_threadPool;
@@ -742,6 +2311,17 @@ namespace slib
 
 	sl_bool HttpService::preprocessRequest(const Ref<HttpServiceContext>& context)
 	{
+		if (m_param.onPreprocessRequest.isNotNull()) {
+			return m_param.onPreprocessRequest(this, context.get());
+		}
+		return sl_false;
+	}
+
+	sl_bool HttpService::acceptWebSocket(const Ref<HttpServiceContext>& context, WebSocketParam& param)
+	{
+		if (m_param.onWebSocket.isNotNull()) {
+			return m_param.onWebSocket(this, context.get(), param);
+		}
 		return sl_false;
 	}
 
@@ -840,6 +2420,13 @@ namespace slib
 
 	sl_bool HttpService::processFile(const Ref<HttpServiceContext>& context, const String& path)
 	{
+		Ref<_priv_HttpStaticCache> cache = m_staticCache;
+		if (cache.isNotNull()) {
+			Ref<_priv_HttpStaticCacheEntry> entry = cache->get(path);
+			if (entry.isNotNull()) {
+				return _processCachedFile(context, entry.get());
+			}
+		}
 		if (File::exists(path) && !(File::isDirectory(path))) {
 
 			sl_uint64 totalSize = File::getSize(path);
@@ -859,6 +2446,13 @@ namespace slib
 
 			String rangeHeader = context->getRequestRange();
 			
+			// zero-copy path: file regions are sent by `sendfile` on the connection's socket
+			sl_bool flagSendFile = sl_false;
+			Ref<AsyncStream> io = context->getIO();
+			if (io.isNotNull()) {
+				flagSendFile = io->isSendFileSupported();
+			}
+			
 			if (rangeHeader.isNotEmpty()) {
 				
 				sl_uint64 start;
@@ -866,6 +2460,11 @@ namespace slib
 				
 				if (processRangeRequest(context, totalSize, rangeHeader, start, len)) {
 
+					if (flagSendFile) {
+						if (context->copyFromFileRegion(path, start, len)) {
+							return sl_true;
+						}
+					}
 					Ref<AsyncFile> file = AsyncFile::openForRead(path, m_threadPool);
 					if (file.isNotNull()) {
 						file->seek(start);
@@ -879,6 +2478,11 @@ namespace slib
 				
 			} else {
 				if (totalSize > 100000) {
+					if (flagSendFile) {
+						if (context->copyFromFileRegion(path, 0, totalSize)) {
+							return sl_true;
+						}
+					}
 					context->copyFromFile(path, m_threadPool);
 					return sl_true;
 				} else {
@@ -896,6 +2500,63 @@ namespace slib
 		
 	}
 
+	sl_bool HttpService::_processCachedFile(const Ref<HttpServiceContext>& context, _priv_HttpStaticCacheEntry* entry)
+	{
+		if (context->getResponseContentType().isEmpty()) {
+			context->setResponseContentType(entry->contentType);
+		}
+		context->setResponseAcceptRanges(sl_true);
+		
+		String rangeHeader = context->getRequestRange();
+		// the ranges are served from the identity content
+		sl_bool flagGzip = sl_false;
+		if (entry->contentGzip.isNotNull()) {
+			context->setResponseHeader(HttpHeaders::Vary, HttpHeaders::AcceptEncoding);
+			if (rangeHeader.isEmpty()) {
+				flagGzip = _priv_HttpService_getAcceptedCoding(context->getRequestHeader(HttpHeaders::AcceptEncoding), sl_false) == _priv_HttpContentCoding::Gzip;
+			}
+		}
+		// the representations of the different codings are distinguished by the strong validator
+		const String& etag = flagGzip ? entry->etagGzip : entry->etag;
+		context->setResponseHeader(HttpHeaders::ETag, etag);
+		context->setResponseHeader(HttpHeaders::LastModified, entry->lastModified);
+		
+		String ifNoneMatch = context->getRequestHeader(HttpHeaders::IfNoneMatch);
+		if (ifNoneMatch.isNotEmpty()) {
+			if (_priv_HttpService_isMatchingETag(ifNoneMatch, etag)) {
+				context->setResponseCode(HttpStatus::NotModified);
+				return sl_true;
+			}
+		} else {
+			String ifModifiedSince = context->getRequestHeader(HttpHeaders::IfModifiedSince);
+			if (ifModifiedSince.isNotEmpty()) {
+				Time time;
+				// `Last-Modified` has the precision of seconds
+				if (Time::parseHttpDate(ifModifiedSince, &time) && entry->timeModified.getSecondsCount() <= time.getSecondsCount()) {
+					context->setResponseCode(HttpStatus::NotModified);
+					return sl_true;
+				}
+			}
+		}
+		
+		if (rangeHeader.isNotEmpty()) {
+			sl_uint64 start;
+			sl_uint64 len;
+			if (processRangeRequest(context, entry->size, rangeHeader, start, len)) {
+				context->write(entry->content.sub((sl_size)start, (sl_size)len));
+			}
+			return sl_true;
+		}
+		
+		if (flagGzip) {
+			context->setResponseContentEncoding("gzip");
+			context->write(entry->contentGzip);
+		} else {
+			context->write(entry->content);
+		}
+		return sl_true;
+	}
+
 	sl_bool HttpService::processRangeRequest(const Ref<HttpServiceContext>& context, sl_uint64 totalLength, const String& range, sl_uint64& outStart, sl_uint64& outLength)
 	{
 		if (range.getLength() < 2 || !(range.startsWith("bytes="))) {
@@ -923,7 +2584,8 @@ namespace slib
 				return sl_false;
 			}
 		}
-		if (indexSplit == 0) {
+		if (s1.isEmpty()) {
+			// suffix range: last `n2` bytes
 			if (n2 == 0) {
 				context->setResponseCode(HttpStatus::NoContent);
 				return sl_false;
@@ -934,7 +2596,7 @@ namespace slib
 				return sl_false;
 			}
 			outStart = totalLength - n2;
-			outLength = totalLength - 1;
+			outLength = n2;
 		} else {
 			if (n1 >= totalLength) {
 				context->setResponseCode(HttpStatus::RequestRangeNotSatisfiable);
@@ -975,6 +2637,13 @@ namespace slib
 
 	Ref<HttpServiceConnection> HttpService::addConnection(const Ref<AsyncStream>& stream, const SocketAddress& remoteAddress, const SocketAddress& localAddress)
 	{
+		sl_uint32 maxConnections = m_param.maxConnections;
+		if (maxConnections && _getConnectionsCount() >= maxConnections) {
+			// accepted before the listening sockets are paused
+			stream->close();
+			_updateAccepting();
+			return sl_null;
+		}
 		Ref<HttpServiceConnection> connection = HttpServiceConnection::create(this, stream.get());
 		if (connection.isNotNull()) {
 			if (m_param.flagLogDebug) {
@@ -984,7 +2653,11 @@ namespace slib
 			}
 			connection->setRemoteAddress(remoteAddress);
 			connection->setLocalAddress(localAddress);
-			m_connections.put(connection.get(), connection);
+			{
+				MutexLocker lock(&m_lockConnections);
+				m_connections.put(connection.get(), connection);
+			}
+			_updateAccepting();
 			connection->start();
 		}
 		return connection;
@@ -995,7 +2668,53 @@ namespace slib
 		if (m_param.flagLogDebug) {
 			Log(SERVICE_TAG, "[%s] Connection Closed", String::fromPointerValue(connection));
 		}
-		m_connections.remove(connection);
+		Ref<HttpServiceConnection> ref;
+		{
+			MutexLocker lock(&m_lockConnections);
+			m_connections.remove(connection, &ref);
+		}
+		_updateAccepting();
+	}
+
+	sl_size HttpService::_getConnectionsCount()
+	{
+		MutexLocker lock(&m_lockConnections);
+		return m_connections.getCount();
+	}
+
+	Ref<_priv_HttpBufferPool> HttpService::_getReadBufferPool(AsyncStream* io)
+	{
+		Ref<AsyncIoLoop> loop = io->getIoLoop();
+		if (loop.isNotNull()) {
+			Ref<_priv_HttpBufferPool> pool;
+			if (m_readBufferPools.get(loop.get(), &pool)) {
+				return pool;
+			}
+		}
+		// not shared with the connections receiving on the other threads
+		return new _priv_HttpBufferPool;
+	}
+
+	void HttpService::_updateAccepting()
+	{
+		sl_uint32 maxConnections = m_param.maxConnections;
+		if (!maxConnections) {
+			return;
+		}
+		MutexLocker lock(&m_lockAccepting);
+		sl_bool flagPause = _getConnectionsCount() >= maxConnections;
+		if (flagPause == m_flagAcceptingPaused) {
+			return;
+		}
+		m_flagAcceptingPaused = flagPause;
+		ListLocker< Ref<HttpServiceConnectionProvider> > providers(m_connectionProviders);
+		for (sl_size i = 0; i < providers.count; i++) {
+			if (flagPause) {
+				providers[i]->pauseAccepting();
+			} else {
+				providers[i]->resumeAccepting();
+			}
+		}
 	}
 
 	void HttpService::addProcessor(const Ptr<IHttpServiceProcessor>& processor)
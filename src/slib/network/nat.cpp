@@ -159,7 +159,9 @@ namespace slib
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
 						IcmpEchoElement element;
+						ObjectLocker lock(this);
 						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
+							lock.unlock();
 							ipHeader->setDestinationAddress(element.addressSource.ip);
 							icmp->setEchoIdentifier(element.addressSource.identifier);
 							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
@@ -208,6 +210,7 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		ObjectLocker lock(this);
 		IcmpEchoElement element;
 		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
 			return element.sequenceNumberTarget;
@@ -252,7 +255,7 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 
-		m_mapPorts.removeAll_NoLock();
+		m_mapPorts.removeAll();
 
 		if (m_ports) {
 			NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
@@ -282,13 +285,13 @@ namespace slib
 		}
 
 		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
+		if (m_mapPorts.get(address, &port)) {
 			if (port >= m_portBegin && port <= m_portEnd) {
 				m_ports[port - m_portBegin].timeLastAccess = Time::now();
 				_port = port;
 				return sl_true;
 			} else {
-				m_mapPorts.remove_NoLock(address);
+				m_mapPorts.remove(address);
 			}
 		}
 
@@ -302,7 +305,7 @@ namespace slib
 				m_ports[pos].flagActive = sl_true;
 				m_ports[pos].addressSource = address;
 				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
+				m_mapPorts.put(address, port);
 				_port = port;
 				m_pos = (pos + 1) % m_nPorts;
 				return sl_true;
@@ -322,7 +325,7 @@ namespace slib
 					if (m_ports[k].flagActive) {
 						if (m_ports[k].timeLastAccess.toInt() <= mid) {
 							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
+							m_mapPorts.remove(m_ports[k].addressSource);
 						}
 					}
 				}
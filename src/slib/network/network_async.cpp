@@ -152,9 +152,16 @@ namespace slib
 					return sl_null;
 				}
 			}
+			AsyncIoMode mode = AsyncIoMode::InOut;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			if (loop->isIoUring()) {
+				// the reads and writes are completed by the ring, instead of waiting for the readiness
+				mode = AsyncIoMode::None;
+			}
+#endif
 			Ref<AsyncTcpSocket> ret = new AsyncTcpSocket;
 			if (ret.isNotNull()) {
-				if (ret->_initialize(instance.get(), AsyncIoMode::InOut, loop)) {
+				if (ret->_initialize(instance.get(), mode, loop)) {
 					ret->m_listener = param.listener;
 					ret->m_onConnect = param.onConnect;
 					ret->m_onError = param.onError;
@@ -313,6 +320,11 @@ namespace slib
 		requestOrder();
 	}
 
+	void AsyncTcpServerInstance::stop()
+	{
+		m_flagRunning = sl_false;
+	}
+
 	sl_bool AsyncTcpServerInstance::isRunning()
 	{
 		return m_flagRunning;
@@ -358,6 +370,7 @@ namespace slib
 		
 		flagAutoStart = sl_true;
 		flagLogError = sl_true;
+		flagReusingPort = sl_false;
 	}
 
 	AsyncTcpServerParam::~AsyncTcpServerParam()
@@ -403,6 +416,14 @@ namespace slib
 			 */
 			socket->setOption_ReuseAddress(sl_true);
 #endif
+			if (param.flagReusingPort) {
+				if (!(socket->setOption_ReusePort(sl_true))) {
+					if (param.flagLogError) {
+						LogError(TAG, "AsyncTcpServer reuse-port error: %s, %s", param.bindAddress.toString(), socket->getLastErrorMessage());
+					}
+					return sl_null;
+				}
+			}
 
 			if (!(socket->bind(param.bindAddress))) {
 				if (param.flagLogError) {
@@ -465,6 +486,14 @@ namespace slib
 		}
 	}
 
+	void AsyncTcpServer::stop()
+	{
+		Ref<AsyncTcpServerInstance> instance = _getIoInstance();
+		if (instance.isNotNull()) {
+			instance->stop();
+		}
+	}
+
 	sl_bool AsyncTcpServer::isRunning()
 	{
 		Ref<AsyncTcpServerInstance> instance = _getIoInstance();
@@ -77,6 +77,8 @@ namespace slib
 		
 		void start();
 		
+		void stop();
+		
 		sl_bool isRunning();
 		
 		Ref<Socket> getSocket();
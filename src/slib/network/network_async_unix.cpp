@@ -26,6 +26,8 @@
 
 #include "network_async.h"
 
+#include <errno.h>
+
 namespace slib
 {
 
@@ -38,11 +40,26 @@ namespace slib
 		
 		sl_bool m_flagConnecting;
 		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// io_uring: at most one read and one write entry of the socket are in the ring
+		sl_bool m_flagReadSubmitted;
+		sl_bool m_flagWriteSubmitted;
+		// the entry (to be) submitted is the poll waiting for the readiness, instead of the receiving/sending
+		sl_bool m_flagReadPolling;
+		sl_bool m_flagWritePolling;
+#endif
+		
 	public:
 		_priv_Unix_AsyncTcpSocketInstance()
 		{
 			m_sizeWritten = 0;
 			m_flagConnecting = sl_false;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			m_flagReadSubmitted = sl_false;
+			m_flagWriteSubmitted = sl_false;
+			m_flagReadPolling = sl_false;
+			m_flagWritePolling = sl_false;
+#endif
 		}
 		
 		~_priv_Unix_AsyncTcpSocketInstance()
@@ -76,6 +93,15 @@ namespace slib
 			m_socket.setNull();
 		}
 		
+		sl_bool isSendFileSupported() override
+		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			return sl_true;
+#else
+			return sl_false;
+#endif
+		}
+		
 		void processRead(sl_bool flagError)
 		{
 			Ref<Socket> socket = m_socket;
@@ -112,6 +138,19 @@ namespace slib
 						}
 						return;
 					}
+				} else if (!(request->size)) {
+					// waiting for the data
+					char c;
+					sl_int32 n = socket->peek(&c, 1);
+					if (n > 0) {
+						_onReceive(request.get(), 0, sl_false);
+					} else if (n == 0 && !flagError) {
+						m_requestReading = request;
+						return;
+					} else {
+						_onReceive(request.get(), 0, sl_true);
+						return;
+					}
 				} else {
 					_onReceive(request.get(), request->size, sl_false);
 				}
@@ -127,30 +166,34 @@ namespace slib
 			}
 			Ref<AsyncStreamRequest> request = m_requestWriting;
 			m_requestWriting.setNull();
-			sl_size nQueue = getWriteRequestsCount();
-			if (Thread::isNotStoppingCurrent()) {
+			// writes the queued requests until the socket would block, because the orders requested by several `write` calls can be coalesced into one
+			while (Thread::isNotStoppingCurrent()) {
 				if (request.isNull()) {
-					if (nQueue > 0) {
-						nQueue--;
-						popWriteRequest(request);
-						if (request.isNull()) {
-							return;
-						} else {
-							m_sizeWritten = 0;
-						}
-					} else {
+					popWriteRequest(request);
+					if (request.isNull()) {
 						return;
+					} else {
+						m_sizeWritten = 0;
 					}
 				}
-				if (request->data && request->size) {
+				if ((request->data || request->file.isNotNull()) && request->size) {
 					sl_uint32 size = request->size - m_sizeWritten;
-					sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
+					sl_int32 n;
+					if (request->data) {
+						n = socket->send((char*)(request->data) + m_sizeWritten, size);
+					} else {
+						n = socket->sendFile(request->file->getHandle(), request->offsetFile + m_sizeWritten, size);
+					}
 					if (n > 0) {
 						m_sizeWritten += n;
 						if (m_sizeWritten >= request->size) {
 							_onSend(request.get(), request->size, flagError);
+							if (flagError) {
+								return;
+							}
 						} else {
 							m_requestWriting = request;
+							return;
 						}
 					} else if (n < 0) {
 						_onSend(request.get(), m_sizeWritten, sl_true);
@@ -176,13 +219,27 @@ namespace slib
 			if (socket.isNull()) {
 				return;
 			}
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			if (_isIoUring()) {
+				_orderIoUring(socket.get());
+				return;
+			}
+#endif
 			if (m_flagConnecting) {
 				return;
 			}
 			if (m_flagRequestConnect) {
 				m_flagRequestConnect = sl_false;
 				if (socket->connect(m_addressRequestConnect)) {
-					m_flagConnecting = sl_true;
+					SocketAddress address;
+					if (socket->getRemoteAddress(address)) {
+						// connected immediately (loopback), the readiness may not be reported again
+						_onConnect(sl_false);
+						processRead(sl_false);
+						processWrite(sl_false);
+					} else {
+						m_flagConnecting = sl_true;
+					}
 				} else {
 					_onConnect(sl_true);
 				}
@@ -194,6 +251,38 @@ namespace slib
 		
 		void onEvent(EventDesc* pev)
 		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			if (_isIoUring()) {
+				_onCompleteIoUring(pev);
+				return;
+			}
+#endif
+			if (m_flagConnecting && (pev->flagOut || pev->flagError)) {
+				// io_uring polls may deliver the readiness of the socket armed before `connect` (OUT|HUP of an unconnected socket),
+				// so the result of connecting is checked on the socket
+				Ref<Socket> socket = m_socket;
+				if (socket.isNotNull()) {
+					sl_bool flagError = socket->getOption_Error() != 0;
+					if (!flagError) {
+						SocketAddress address;
+						if (!(socket->getRemoteAddress(address))) {
+							if (pev->flagError) {
+								// still connecting
+								requestOrder();
+								return;
+							}
+							flagError = sl_true;
+						}
+					}
+					m_flagConnecting = sl_false;
+					_onConnect(flagError);
+					if (flagError) {
+						return;
+					}
+					pev->flagOut = sl_false;
+					pev->flagError = sl_false;
+				}
+			}
 			sl_bool flagProcessed = sl_false;
 			if (pev->flagIn) {
 				processRead(pev->flagError);
@@ -225,6 +314,241 @@ namespace slib
 			}
 			requestOrder();
 		}
+		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		sl_bool _isIoUring()
+		{
+			// attached without the readiness polling of the loop (see `AsyncTcpSocket::create`)
+			return getMode() == AsyncIoMode::None;
+		}
+		
+		void _orderIoUring(Socket* socket)
+		{
+			if (m_flagConnecting) {
+				return;
+			}
+			if (m_flagRequestConnect) {
+				m_flagRequestConnect = sl_false;
+				if (socket->connect(m_addressRequestConnect)) {
+					SocketAddress address;
+					if (socket->getRemoteAddress(address)) {
+						_onConnect(sl_false);
+					} else {
+						m_flagConnecting = sl_true;
+						m_flagWritePolling = sl_true;
+						_submitWriteIoUring(socket);
+						return;
+					}
+				} else {
+					_onConnect(sl_true);
+					return;
+				}
+			}
+			_submitReadIoUring(socket);
+			_submitWriteIoUring(socket);
+		}
+		
+		void _submitReadIoUring(Socket* socket)
+		{
+			if (m_flagReadSubmitted || isClosing()) {
+				return;
+			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNull()) {
+				return;
+			}
+			while (Thread::isNotStoppingCurrent()) {
+				Ref<AsyncStreamRequest> request = m_requestReading;
+				if (request.isNull()) {
+					popReadRequest(request);
+					if (request.isNull()) {
+						return;
+					}
+					m_requestReading = request;
+				}
+				sl_bool flagSubmitted;
+				if (request->data && request->size) {
+					if (m_flagReadPolling) {
+						flagSubmitted = loop->_submitIoUringPoll(this, sl_false);
+					} else {
+						flagSubmitted = loop->_submitIoUringReceive(this, request->data, request->size);
+					}
+				} else if (!(request->size)) {
+					// waiting for the data
+					m_flagReadPolling = sl_true;
+					flagSubmitted = loop->_submitIoUringPoll(this, sl_false);
+				} else {
+					m_requestReading.setNull();
+					_onReceive(request.get(), request->size, sl_false);
+					continue;
+				}
+				if (flagSubmitted) {
+					m_flagReadSubmitted = sl_true;
+				} else {
+					m_requestReading.setNull();
+					m_flagReadPolling = sl_false;
+					_onReceive(request.get(), 0, sl_true);
+				}
+				return;
+			}
+		}
+		
+		void _submitWriteIoUring(Socket* socket)
+		{
+			if (m_flagWriteSubmitted || isClosing()) {
+				return;
+			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNull()) {
+				return;
+			}
+			if (m_flagConnecting) {
+				if (loop->_submitIoUringPoll(this, sl_true)) {
+					m_flagWriteSubmitted = sl_true;
+				} else {
+					m_flagConnecting = sl_false;
+					m_flagWritePolling = sl_false;
+					_onConnect(sl_true);
+				}
+				return;
+			}
+			while (Thread::isNotStoppingCurrent() && !(isClosing())) {
+				Ref<AsyncStreamRequest> request = m_requestWriting;
+				if (request.isNull()) {
+					popWriteRequest(request);
+					if (request.isNull()) {
+						return;
+					}
+					m_requestWriting = request;
+					m_sizeWritten = 0;
+				}
+				if ((request->data || request->file.isNotNull()) && request->size) {
+					if (m_flagWritePolling) {
+						if (loop->_submitIoUringPoll(this, sl_true)) {
+							m_flagWriteSubmitted = sl_true;
+							return;
+						}
+					} else if (request->data) {
+						if (loop->_submitIoUringSend(this, (char*)(request->data) + m_sizeWritten, request->size - m_sizeWritten)) {
+							m_flagWriteSubmitted = sl_true;
+							return;
+						}
+					} else {
+						// the file region is sent by `sendfile` on the loop thread, and the poll waits for the room of the socket
+						sl_int32 n = socket->sendFile(request->file->getHandle(), request->offsetFile + m_sizeWritten, request->size - m_sizeWritten);
+						if (n > 0) {
+							m_sizeWritten += n;
+							if (m_sizeWritten >= request->size) {
+								m_requestWriting.setNull();
+								_onSend(request.get(), request->size, sl_false);
+							}
+							continue;
+						} else if (!n) {
+							m_flagWritePolling = sl_true;
+							continue;
+						}
+					}
+					m_requestWriting.setNull();
+					m_flagWritePolling = sl_false;
+					_onSend(request.get(), m_sizeWritten, sl_true);
+					return;
+				} else {
+					m_requestWriting.setNull();
+					_onSend(request.get(), request->size, sl_false);
+				}
+			}
+		}
+		
+		void _onCompleteIoUring(EventDesc* pev)
+		{
+			Ref<Socket> socket = m_socket;
+			if (socket.isNull()) {
+				return;
+			}
+			sl_int32 result = pev->completionResult;
+			if (pev->flagIn) {
+				m_flagReadSubmitted = sl_false;
+				Ref<AsyncStreamRequest> request = m_requestReading;
+				if (request.isNotNull()) {
+					if (m_flagReadPolling) {
+						m_flagReadPolling = sl_false;
+						if (result < 0) {
+							m_requestReading.setNull();
+							_onReceive(request.get(), 0, sl_true);
+						} else if (!(request->size)) {
+							char c;
+							sl_int32 n = socket->peek(&c, 1);
+							if (n > 0) {
+								m_requestReading.setNull();
+								_onReceive(request.get(), 0, sl_false);
+							} else if (n < 0) {
+								m_requestReading.setNull();
+								_onReceive(request.get(), 0, sl_true);
+							}
+						}
+						// otherwise, the request is submitted again
+					} else {
+						if (result > 0) {
+							m_requestReading.setNull();
+							_onReceive(request.get(), (sl_uint32)result, sl_false);
+						} else if (result == -EAGAIN || result == -EINTR) {
+							m_flagReadPolling = sl_true;
+						} else {
+							// zero: closed by the peer
+							m_requestReading.setNull();
+							_onReceive(request.get(), 0, sl_true);
+						}
+					}
+				}
+			}
+			if (pev->flagOut) {
+				m_flagWriteSubmitted = sl_false;
+				if (m_flagWritePolling) {
+					m_flagWritePolling = sl_false;
+					if (m_flagConnecting) {
+						m_flagConnecting = sl_false;
+						sl_bool flagError = result < 0 || socket->getOption_Error() != 0;
+						if (!flagError) {
+							SocketAddress address;
+							if (!(socket->getRemoteAddress(address))) {
+								flagError = sl_true;
+							}
+						}
+						_onConnect(flagError);
+						if (flagError) {
+							return;
+						}
+					} else if (result < 0) {
+						Ref<AsyncStreamRequest> request = m_requestWriting;
+						if (request.isNotNull()) {
+							m_requestWriting.setNull();
+							_onSend(request.get(), m_sizeWritten, sl_true);
+						}
+					}
+				} else {
+					Ref<AsyncStreamRequest> request = m_requestWriting;
+					if (request.isNotNull()) {
+						if (result > 0) {
+							m_sizeWritten += (sl_uint32)result;
+							if (m_sizeWritten >= request->size) {
+								m_requestWriting.setNull();
+								_onSend(request.get(), request->size, sl_false);
+							}
+						} else if (result == -EAGAIN || result == -EINTR) {
+							m_flagWritePolling = sl_true;
+						} else {
+							m_requestWriting.setNull();
+							_onSend(request.get(), m_sizeWritten, sl_true);
+						}
+					}
+				}
+			}
+			// the requests queued by the callbacks are submitted together with the others of this loop step
+			_submitReadIoUring(socket.get());
+			_submitWriteIoUring(socket.get());
+		}
+#endif
+		
 	};
 
 	Ref<AsyncTcpSocketInstance> AsyncTcpSocket::_createInstance(const Ref<Socket>& socket)
@@ -281,10 +605,10 @@ namespace slib
 			if (socket.isNull()) {
 				return;
 			}
-			while (Thread::isNotStoppingCurrent()) {
+			while (m_flagRunning && Thread::isNotStoppingCurrent()) {
 				Ref<Socket> socketAccept;
 				SocketAddress addr;
-				if (socket->accept(socketAccept, addr)) {
+				if (socket->acceptNonBlocking(socketAccept, addr)) {
 					_onAccept(socketAccept, addr);
 				} else {
 					SocketError err = socket->getLastError();
@@ -120,7 +120,8 @@ namespace slib
 				Ref<AsyncStreamRequest> req;
 				if (popReadRequest(req)) {
 					if (req.isNotNull()) {
-						if (req->data && req->size) {
+						// the zero-byte receive is completed when the data arrives
+						if (req->data || !(req->size)) {
 							Base::zeroMemory(&m_overlappedRead, sizeof(m_overlappedRead));
 							m_bufRead.buf = (CHAR*)(req->data);
 							m_bufRead.len = req->size;
@@ -359,6 +360,9 @@ namespace slib
 			if (m_flagAccepting) {
 				return;
 			}
+			if (!m_flagRunning) {
+				return;
+			}
 			sl_file handle = getHandle();
 			if (handle == SLIB_FILE_INVALID_HANDLE) {
 				return;
@@ -39,6 +39,7 @@
 #		include <linux/if.h>
 #		include <linux/if_packet.h>
 #		include <sys/ioctl.h>
+#		include <sys/sendfile.h>
 #	else
 #		include <netinet/tcp.h>
 #	endif
@@ -47,6 +48,9 @@
 #	include <errno.h>
 typedef int SOCKET;
 #	define SOCKET_ERROR -1
+#	if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+#		define PRIV_SUPPORT_ACCEPT4
+#	endif
 #endif
 
 namespace slib
@@ -125,6 +129,7 @@ namespace slib
 		m_socket = SLIB_SOCKET_INVALID_HANDLE;
 		m_type = SocketType::None;
 		m_lastError = SocketError::None;
+		m_flagNonBlocking = sl_false;
 	}
 
 	Socket::~Socket()
@@ -271,6 +276,7 @@ namespace slib
 		}
 		m_type = SocketType::None;
 		m_lastError = SocketError::None;
+		m_flagNonBlocking = sl_false;
 	}
 
 	sl_bool Socket::isOpened() const
@@ -478,6 +484,18 @@ namespace slib
 	}
 
 	sl_bool Socket::accept(Ref<Socket>& socketClient, SocketAddress& address)
+	{
+		return _accept(socketClient, address, sl_false);
+	}
+
+	sl_bool Socket::acceptNonBlocking(Ref<Socket>& socketClient, SocketAddress& address)
+	{
+		return _accept(socketClient, address, sl_true);
+	}
+
+	sl_bool _priv_Socket_setNonBlocking(SOCKET fd, sl_bool flagEnable);
+
+	sl_bool Socket::_accept(Ref<Socket>& socketClient, SocketAddress& address, sl_bool flagNonBlocking)
 	{
 		if (isOpened()) {
 			if (!(isStream())) {
@@ -489,15 +507,27 @@ namespace slib
 			int len = sizeof(addr);
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
 			sl_socket client = (sl_socket)(::accept((SOCKET)(m_socket), (sockaddr*)&addr, &len));
+#elif defined(PRIV_SUPPORT_ACCEPT4)
+			sl_socket client = (sl_socket)(::accept4((SOCKET)(m_socket), (sockaddr*)&addr, (socklen_t*)&len, flagNonBlocking ? (SOCK_NONBLOCK | SOCK_CLOEXEC) : 0));
 #else
 			sl_socket client = (sl_socket)(::accept((SOCKET)(m_socket), (sockaddr*)&addr, (socklen_t*)&len));
 #endif
 			if (client != SLIB_SOCKET_INVALID_HANDLE) {
 				address.setSystemSocketAddress(&addr);
+#if !defined(PRIV_SUPPORT_ACCEPT4)
+				if (flagNonBlocking) {
+					if (!(_priv_Socket_setNonBlocking((SOCKET)client, sl_true))) {
+						_checkError();
+						_priv_Socket_close(client);
+						return sl_false;
+					}
+				}
+#endif
 				Ref<Socket> socket = new Socket();
 				if (socket.isNotNull()) {
 					socket->m_type = m_type;
 					socket->m_socket = client;
+					socket->m_flagNonBlocking = flagNonBlocking;
 					socketClient = socket;
 				} else {
 					_priv_Socket_close(client);
@@ -577,6 +607,41 @@ namespace slib
 		}
 	}
 
+	sl_int32 Socket::sendFile(sl_file file, sl_uint64 offset, sl_uint32 size)
+	{
+		if (isOpened()) {
+			if (size == 0) {
+				return 0;
+			}
+			if (!(isStream())) {
+				_setError(SocketError::SendIsNotSupported);
+				return -1;
+			}
+#if	defined(SLIB_PLATFORM_IS_LINUX)
+			off_t off = (off_t)offset;
+			sl_int32 ret = (sl_int32)(::sendfile((SOCKET)(m_socket), (int)file, &off, size));
+			if (ret >= 0) {
+				if (ret == 0) {
+					ret = -1;
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+#else
+			_setError(SocketError::SendFileIsNotSupported);
+			return -1;
+#endif
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::receive(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -606,6 +671,35 @@ namespace slib
 		}
 	}
 
+	sl_int32 Socket::peek(void* buf, sl_uint32 size)
+	{
+		if (isOpened()) {
+			if (size == 0) {
+				return 0;
+			}
+			if (!(isStream())) {
+				_setError(SocketError::ReceiveIsNotSupported);
+				return -1;
+			}
+			sl_int32 ret = (sl_int32)(::recv((SOCKET)(m_socket), (char*)buf, size, MSG_PEEK));
+			if (ret >= 0) {
+				if (ret == 0) {
+					return -1;
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::sendTo(const SocketAddress& address, const void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -784,7 +878,11 @@ namespace slib
 	sl_bool Socket::setNonBlockingMode(sl_bool flagEnable)
 	{
 		if (isOpened()) {
+			if (flagEnable && m_flagNonBlocking) {
+				return sl_true;
+			}
 			if (_priv_Socket_setNonBlocking((SOCKET)(m_socket), flagEnable)) {
+				m_flagNonBlocking = flagEnable;
 				return sl_true;
 			}
 		}
@@ -1358,6 +1456,8 @@ namespace slib
 				return "SendPacket is not supported";
 			case SocketError::SendPacketInvalidAddress:
 				return "SendPacket to invalid address";
+			case SocketError::SendFileIsNotSupported:
+				return "SendFile is not supported";
 			case SocketError::ReceivePacketIsNotSupported:
 				return "ReceivePacket is not supported";
 			default:
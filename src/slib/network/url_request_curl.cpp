@@ -24,11 +24,19 @@
 
 #include "slib/core/file.h"
 #include "slib/core/system.h"
+#include "slib/core/safe_static.h"
 
 #include "curl/curl.h"
 
 #include <stdlib.h>
 
+#if defined(SLIB_PLATFORM_IS_UNIX)
+#	define PRIV_CURL_USE_MULTI
+#	include "slib/core/async.h"
+#	include <unistd.h>
+#	include <poll.h>
+#endif
+
 #if defined(SLIB_PLATFORM_IS_TIZEN)
 #	include <net_connection.h>
 #endif
@@ -37,28 +45,103 @@
 #	undef DELETE
 #endif
 
+// connections opened to a host at the same time on the multi handle, further requests wait for a connection to be released
+#define PRIV_CURL_MAX_HOST_CONNECTIONS 64
+
 namespace slib
 {
 
+	/*
+		DNS and TLS session caches shared by all the easy handles.
+		Connections are not shared here: the handles running on the multi handle already share its connection cache,
+		and the sockets watched by the I/O loop must not be closed by the handles performing on other threads.
+	*/
+	class _priv_CurlShare
+	{
+	public:
+		CURLSH* share;
+		Mutex locks[CURL_LOCK_DATA_LAST];
+
+	public:
+		_priv_CurlShare()
+		{
+			::curl_global_init(CURL_GLOBAL_ALL);
+			share = ::curl_share_init();
+			if (share) {
+				::curl_share_setopt(share, CURLSHOPT_LOCKFUNC, _priv_CurlShare::callbackLock);
+				::curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, _priv_CurlShare::callbackUnlock);
+				::curl_share_setopt(share, CURLSHOPT_USERDATA, (void*)this);
+				::curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+				::curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+			}
+		}
+
+		~_priv_CurlShare()
+		{
+			if (share) {
+				::curl_share_cleanup(share);
+			}
+		}
+
+	public:
+		static void callbackLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+		{
+			_priv_CurlShare* p = (_priv_CurlShare*)userptr;
+			if ((sl_uint32)data < CURL_LOCK_DATA_LAST) {
+				p->locks[data].lock();
+			}
+		}
+
+		static void callbackUnlock(CURL* handle, curl_lock_data data, void* userptr)
+		{
+			_priv_CurlShare* p = (_priv_CurlShare*)userptr;
+			if ((sl_uint32)data < CURL_LOCK_DATA_LAST) {
+				p->locks[data].unlock();
+			}
+		}
+
+	};
+
+	SLIB_SAFE_STATIC_GETTER(_priv_CurlShare, _priv_getCurlShare)
+
+#if defined(PRIV_CURL_USE_MULTI)
+	class _priv_CurlMulti;
+#endif
+
 	class CurlRequest_Impl : public UrlRequest
 	{
 		friend class CurlRequest;
-		
+#if defined(PRIV_CURL_USE_MULTI)
+		friend class _priv_CurlMulti;
+#endif
+
 	public:
 		CURL* m_curl;
+		curl_slist* m_headerChunk;
 		sl_bool m_flagClosed;
 		sl_bool m_flagProcessResponse;
+#if defined(PRIV_CURL_USE_MULTI)
+		sl_bool m_flagAddedToMulti;
+#endif
+#if defined(SLIB_PLATFORM_IS_TIZEN)
+		connection_h m_connection;
+#endif
 
 	public:
 		CurlRequest_Impl()
 		{
 			m_curl = sl_null;
+			m_headerChunk = sl_null;
 			m_flagClosed = sl_false;
 			m_flagProcessResponse = sl_false;
+#if defined(PRIV_CURL_USE_MULTI)
+			m_flagAddedToMulti = sl_false;
+#endif
 		}
 
 		~CurlRequest_Impl()
 		{
+			_cleanup();
 		}
 
 	public:
@@ -71,18 +154,28 @@ namespace slib
 			return sl_null;
 		}
 
-		void _cancel() override
+		void _cancel() override;
+
+		void _sendSync() override;
+
+		void _sendAsync() override;
+
+		void _perform()
 		{
-			m_flagClosed = sl_true;
+			if (!(_prepare())) {
+				onError();
+				return;
+			}
+			CURLcode err = ::curl_easy_perform(m_curl);
+			_finish(err);
 		}
 
-		void _sendSync() override
+		sl_bool _prepare()
 		{
 #if defined(SLIB_PLATFORM_IS_TIZEN)
 			connection_h connection;
 			if (::connection_create(&connection) != CONNECTION_ERROR_NONE) {
-				onError();
-				return;
+				return sl_false;
 			}
 #endif
 
@@ -91,13 +184,13 @@ namespace slib
 #if defined(SLIB_PLATFORM_IS_TIZEN)
 				::connection_destroy(connection);
 #endif
-				onError();
-				return;
+				return sl_false;
 			}
 
 			m_curl = curl;
 
 #if defined(SLIB_PLATFORM_IS_TIZEN)
+			m_connection = connection;
 			char* proxy_address;
 			sl_bool flagSetProxy = sl_false;
 			int conn_err = ::connection_get_proxy(connection, CONNECTION_ADDRESS_FAMILY_IPV4, &proxy_address);
@@ -117,7 +210,7 @@ namespace slib
 					::free(proxy_address);
 				}
 			}
-			::connection_set_proxy_address_changed_cb(connection, UrlRequest_Impl::callbackProxyChanged, (void*)this);
+			::connection_set_proxy_address_changed_cb(connection, CurlRequest_Impl::callbackProxyChanged, (void*)this);
 #endif
 
 			String url = m_url;
@@ -125,10 +218,16 @@ namespace slib
 
 			::curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 			::curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
-			
+
 			::curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, m_timeout);
 			::curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, m_timeout);
-			
+			::curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+			_priv_CurlShare* share = _priv_getCurlShare();
+			if (share && share->share) {
+				::curl_easy_setopt(curl, CURLOPT_SHARE, share->share);
+			}
+
 			if (m_flagAllowInsecureConnection) {
 				::curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
 				::curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
@@ -184,6 +283,7 @@ namespace slib
 			if (headerChunk) {
 				::curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerChunk);
 			}
+			m_headerChunk = headerChunk;
 
 			// post data
 			Memory requestBody = m_requestBody;
@@ -205,9 +305,11 @@ namespace slib
 			::curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlRequest_Impl::callbackWrite);
 			::curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)this);
 
-			/* getting data */
-			CURLcode err = ::curl_easy_perform(curl);
+			return sl_true;
+		}
 
+		void _finish(CURLcode err)
+		{
 			processResponse();
 
 			if (err == CURLE_OK) {
@@ -218,15 +320,22 @@ namespace slib
 				onError();
 			}
 
-			if (headerChunk) {
-				::curl_slist_free_all(headerChunk);
-			}
+			_cleanup();
+		}
 
-			::curl_easy_cleanup(curl);
+		void _cleanup()
+		{
+			if (m_headerChunk) {
+				::curl_slist_free_all(m_headerChunk);
+				m_headerChunk = sl_null;
+			}
+			if (m_curl) {
+				::curl_easy_cleanup(m_curl);
+				m_curl = sl_null;
 #if defined(SLIB_PLATFORM_IS_TIZEN)
-			::connection_destroy(connection);
+				::connection_destroy(m_connection);
 #endif
-
+			}
 		}
 
 		void processResponse()
@@ -386,6 +495,361 @@ namespace slib
 
 	};
 
+#if defined(PRIV_CURL_USE_MULTI)
+	class _priv_CurlSocket : public AsyncIoInstance
+	{
+	public:
+		WeakRef<_priv_CurlMulti> m_multi;
+		curl_socket_t m_socket;
+		int m_action;
+
+	public:
+		_priv_CurlSocket()
+		{
+			m_socket = CURL_SOCKET_BAD;
+			m_action = CURL_POLL_NONE;
+		}
+
+		~_priv_CurlSocket()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_priv_CurlSocket> create(_priv_CurlMulti* multi, curl_socket_t socket);
+
+		void close() override
+		{
+			sl_file handle = getHandle();
+			if (handle != SLIB_FILE_INVALID_HANDLE) {
+				::close((int)handle);
+				setHandle(SLIB_FILE_INVALID_HANDLE);
+			}
+		}
+
+		sl_bool checkReady(sl_bool& flagIn, sl_bool& flagOut, sl_bool& flagError)
+		{
+			pollfd pfd;
+			pfd.fd = (int)(getHandle());
+			pfd.events = 0;
+			pfd.revents = 0;
+			if (m_action & CURL_POLL_IN) {
+				pfd.events |= POLLIN;
+			}
+			if (m_action & CURL_POLL_OUT) {
+				pfd.events |= POLLOUT;
+			}
+			if (!(pfd.events)) {
+				return sl_false;
+			}
+			if (::poll(&pfd, 1, 0) > 0) {
+				flagIn = (pfd.revents & POLLIN) != 0;
+				flagOut = (pfd.revents & POLLOUT) != 0;
+				flagError = (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+				return flagIn || flagOut || flagError;
+			}
+			return sl_false;
+		}
+
+	protected:
+		void onOrder() override;
+
+		void onEvent(EventDesc* pev) override;
+
+	};
+
+	/*
+		Runs the requests on one multi handle driven by a dedicated I/O loop.
+		All the calls on the multi handle are made on the loop thread, and the completion callbacks are also invoked there.
+	*/
+	class _priv_CurlMulti : public Referable
+	{
+	public:
+		Ref<AsyncIoLoop> m_loop;
+		CURLM* m_multi;
+		TimerHandle m_timer;
+		CHashMap< curl_socket_t, Ref<_priv_CurlSocket> > m_sockets;
+
+	public:
+		_priv_CurlMulti()
+		{
+			m_multi = sl_null;
+		}
+
+		~_priv_CurlMulti()
+		{
+			m_loop->release();
+			::curl_multi_cleanup(m_multi);
+		}
+
+	public:
+		static Ref<_priv_CurlMulti> create()
+		{
+			if (!(_priv_getCurlShare())) {
+				return sl_null;
+			}
+			Ref<AsyncIoLoop> loop = AsyncIoLoop::create();
+			if (loop.isNull()) {
+				return sl_null;
+			}
+			CURLM* multi = ::curl_multi_init();
+			if (multi) {
+				Ref<_priv_CurlMulti> ret = new _priv_CurlMulti;
+				if (ret.isNotNull()) {
+					ret->m_loop = loop;
+					ret->m_multi = multi;
+					::curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, _priv_CurlMulti::callbackSocket);
+					::curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, (void*)(ret.get()));
+					::curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, _priv_CurlMulti::callbackTimer);
+					::curl_multi_setopt(multi, CURLMOPT_TIMERDATA, (void*)(ret.get()));
+					::curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)PRIV_CURL_MAX_HOST_CONNECTIONS);
+					return ret;
+				}
+				::curl_multi_cleanup(multi);
+			}
+			loop->release();
+			return sl_null;
+		}
+
+		static Ref<_priv_CurlMulti> get()
+		{
+			SLIB_SAFE_STATIC(Ref<_priv_CurlMulti>, ret, create())
+			if (SLIB_SAFE_STATIC_CHECK_FREED(ret)) {
+				return sl_null;
+			}
+			return ret;
+		}
+
+		sl_bool isLoopThread()
+		{
+			return m_loop->isCurrentThread();
+		}
+
+		sl_bool addRequest(CurlRequest_Impl* request)
+		{
+			return m_loop->addTask(SLIB_BIND_REF(void(), _priv_CurlMulti, _addRequest, this, Ref<CurlRequest_Impl>(request)));
+		}
+
+		void cancelRequest(CurlRequest_Impl* request)
+		{
+			m_loop->addTask(SLIB_BIND_REF(void(), _priv_CurlMulti, _cancelRequest, this, Ref<CurlRequest_Impl>(request)));
+		}
+
+		void onSocketEvent(_priv_CurlSocket* socket, sl_bool flagIn, sl_bool flagOut, sl_bool flagError)
+		{
+			int mask = 0;
+			if (flagIn) {
+				mask |= CURL_CSELECT_IN;
+			}
+			if (flagOut) {
+				mask |= CURL_CSELECT_OUT;
+			}
+			if (flagError) {
+				mask |= CURL_CSELECT_ERR;
+			}
+			int nRunning = 0;
+			::curl_multi_socket_action(m_multi, socket->m_socket, mask, &nRunning);
+			_processCompleted();
+			// the loop reports edge-triggered events, so the socket is checked again while it stays ready for the action requested by curl
+			if (socket->m_action != CURL_POLL_NONE && socket->isOpened()) {
+				sl_bool flagReadyIn, flagReadyOut, flagReadyError;
+				if (socket->checkReady(flagReadyIn, flagReadyOut, flagReadyError)) {
+					socket->requestOrder();
+				}
+			}
+		}
+
+	protected:
+		void _addRequest(const Ref<CurlRequest_Impl>& request)
+		{
+			if (request->isClosed()) {
+				return;
+			}
+			if (!(request->_prepare())) {
+				request->onError();
+				return;
+			}
+			CURL* curl = request->m_curl;
+			::curl_easy_setopt(curl, CURLOPT_PRIVATE, (void*)(request.get()));
+			if (::curl_multi_add_handle(m_multi, curl) != CURLM_OK) {
+				request->_finish(CURLE_FAILED_INIT);
+				return;
+			}
+			request->m_flagAddedToMulti = sl_true;
+			request->increaseReference();
+		}
+
+		void _cancelRequest(const Ref<CurlRequest_Impl>& request)
+		{
+			if (request->m_flagAddedToMulti) {
+				request->m_flagAddedToMulti = sl_false;
+				::curl_multi_remove_handle(m_multi, request->m_curl);
+				request->_cleanup();
+				request->decreaseReference();
+			}
+		}
+
+		void _processCompleted()
+		{
+			int nMessages = 0;
+			CURLMsg* msg;
+			while ((msg = ::curl_multi_info_read(m_multi, &nMessages))) {
+				if (msg->msg == CURLMSG_DONE) {
+					CURL* curl = msg->easy_handle;
+					CURLcode err = msg->data.result;
+					char* priv = sl_null;
+					::curl_easy_getinfo(curl, CURLINFO_PRIVATE, &priv);
+					::curl_multi_remove_handle(m_multi, curl);
+					CurlRequest_Impl* request = (CurlRequest_Impl*)priv;
+					if (request && request->m_flagAddedToMulti) {
+						request->m_flagAddedToMulti = sl_false;
+						request->_finish(err);
+						request->decreaseReference();
+					}
+				}
+			}
+		}
+
+		void _onSocketAction(curl_socket_t s, int action)
+		{
+			Ref<_priv_CurlSocket> socket;
+			m_sockets.get_NoLock(s, &socket);
+			if (action == CURL_POLL_REMOVE) {
+				if (socket.isNotNull()) {
+					socket->m_action = CURL_POLL_NONE;
+					m_sockets.remove_NoLock(s);
+					m_loop->closeInstance(socket.get());
+				}
+				return;
+			}
+			if (socket.isNull()) {
+				socket = _priv_CurlSocket::create(this, s);
+				if (socket.isNull()) {
+					return;
+				}
+				if (!(m_loop->attachInstance(socket.get(), AsyncIoMode::InOut))) {
+					return;
+				}
+				m_sockets.put_NoLock(s, socket);
+			}
+			socket->m_action = action;
+			// the readiness may have been reported before the action is changed
+			socket->requestOrder();
+		}
+
+		static int callbackSocket(CURL* easy, curl_socket_t s, int action, void* userp, void* socketp)
+		{
+			_priv_CurlMulti* multi = (_priv_CurlMulti*)userp;
+			multi->_onSocketAction(s, action);
+			return 0;
+		}
+
+		void _onTimeout()
+		{
+			int nRunning = 0;
+			::curl_multi_socket_action(m_multi, CURL_SOCKET_TIMEOUT, 0, &nRunning);
+			_processCompleted();
+		}
+
+		void _setTimer(long timeout_ms)
+		{
+			m_timer.cancel();
+			if (timeout_ms >= 0) {
+				m_timer = m_loop->addTimeout(SLIB_FUNCTION_WEAKREF(_priv_CurlMulti, _onTimeout, this), timeout_ms);
+			} else {
+				m_timer.setNull();
+			}
+		}
+
+		static int callbackTimer(CURLM* multi, long timeout_ms, void* userp)
+		{
+			_priv_CurlMulti* p = (_priv_CurlMulti*)userp;
+			p->_setTimer(timeout_ms);
+			return 0;
+		}
+
+	};
+
+	Ref<_priv_CurlSocket> _priv_CurlSocket::create(_priv_CurlMulti* multi, curl_socket_t socket)
+	{
+		// watches a duplicated descriptor, so that the registration on the loop is not confused with a new socket reusing the number after curl closes the socket
+		int fd = ::dup((int)socket);
+		if (fd < 0) {
+			return sl_null;
+		}
+		Ref<_priv_CurlSocket> ret = new _priv_CurlSocket;
+		if (ret.isNotNull()) {
+			ret->m_multi = multi;
+			ret->m_socket = socket;
+			ret->setHandle((sl_file)fd);
+			return ret;
+		}
+		::close(fd);
+		return sl_null;
+	}
+
+	void _priv_CurlSocket::onOrder()
+	{
+		sl_bool flagIn, flagOut, flagError;
+		if (checkReady(flagIn, flagOut, flagError)) {
+			Ref<_priv_CurlMulti> multi = m_multi;
+			if (multi.isNotNull()) {
+				multi->onSocketEvent(this, flagIn, flagOut, flagError);
+			}
+		}
+	}
+
+	void _priv_CurlSocket::onEvent(EventDesc* pev)
+	{
+		if (m_action == CURL_POLL_NONE) {
+			return;
+		}
+		Ref<_priv_CurlMulti> multi = m_multi;
+		if (multi.isNotNull()) {
+			multi->onSocketEvent(this, pev->flagIn, pev->flagOut, pev->flagError);
+		}
+	}
+#endif
+
+	void CurlRequest_Impl::_cancel()
+	{
+		m_flagClosed = sl_true;
+#if defined(PRIV_CURL_USE_MULTI)
+		Ref<_priv_CurlMulti> multi = _priv_CurlMulti::get();
+		if (multi.isNotNull()) {
+			multi->cancelRequest(this);
+		}
+#endif
+	}
+
+	void CurlRequest_Impl::_sendSync()
+	{
+#if defined(PRIV_CURL_USE_MULTI)
+		Ref<_priv_CurlMulti> multi = _priv_CurlMulti::get();
+		if (multi.isNotNull() && !(multi->isLoopThread())) {
+			// waits for the completion on the multi handle
+			UrlRequest::_sendSync();
+			return;
+		}
+#endif
+		_perform();
+	}
+
+	void CurlRequest_Impl::_sendAsync()
+	{
+#if defined(PRIV_CURL_USE_MULTI)
+		Ref<_priv_CurlMulti> multi = _priv_CurlMulti::get();
+		if (multi.isNotNull()) {
+			if (!(multi->addRequest(this))) {
+				onError();
+			}
+			return;
+		}
+#endif
+		// performs on the thread pool
+		UrlRequest::_sendAsync();
+	}
+
 #define URL_REQUEST CurlRequest
 #include "url_request_common.inc"
 	
@@ -0,0 +1,769 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include "slib/network/websocket.h"
+
+#include "slib/network/http_service.h"
+#include "slib/crypto/sha1.h"
+#include "slib/core/base64.h"
+
+#define PRIV_WEBSOCKET_READ_BUFFER_SIZE 0x4000
+#define PRIV_WEBSOCKET_MAX_FRAME_HEADER_SIZE 14
+// frames with the larger payloads are sent as separate header and payload, without copying the payload
+#define PRIV_WEBSOCKET_COPY_PAYLOAD_LIMIT 0x1000
+
+namespace slib
+{
+
+	WebSocketMessage::WebSocketMessage()
+	{
+		opcode = WebSocketOpcode::Binary;
+		data = sl_null;
+		size = 0;
+	}
+
+	WebSocketMessage::~WebSocketMessage()
+	{
+	}
+
+	sl_bool WebSocketMessage::isText() const
+	{
+		return opcode == WebSocketOpcode::Text;
+	}
+
+	String WebSocketMessage::getText() const
+	{
+		return String::fromUtf8(data, size);
+	}
+
+	Memory WebSocketMessage::getData() const
+	{
+		return Memory::create(data, size);
+	}
+
+
+	WebSocketParam::WebSocketParam()
+	{
+		maxMessageSize = 0x1000000; // 16MB
+		maxPendingWriteSize = 0x1000000; // 16MB
+	}
+
+	WebSocketParam::WebSocketParam(const WebSocketParam& other) = default;
+
+	WebSocketParam::~WebSocketParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(WebSocket, Object)
+
+	WebSocket::WebSocket()
+	{
+		m_flagOpened = sl_false;
+		m_flagReading = sl_false;
+		m_flagCloseSent = sl_false;
+		m_sizeRead = 0;
+		m_opcodeFragments = WebSocketOpcode::Binary;
+		m_flagFragmented = sl_false;
+		m_sizePendingWrite = 0;
+	}
+
+	WebSocket::~WebSocket()
+	{
+		if (m_flagOpened) {
+			m_io->close();
+		}
+	}
+
+	Ref<WebSocket> WebSocket::create(const Ref<AsyncStream>& io, const WebSocketParam& param, const void* input, sl_size sizeInput)
+	{
+		if (io.isNull()) {
+			return sl_null;
+		}
+		sl_size sizeBuf = PRIV_WEBSOCKET_READ_BUFFER_SIZE;
+		if (sizeInput > sizeBuf) {
+			sizeBuf = sizeInput;
+		}
+		Memory bufRead = Memory::create(sizeBuf);
+		if (bufRead.isNull()) {
+			return sl_null;
+		}
+		Ref<WebSocket> ret = new WebSocket;
+		if (ret.isNotNull()) {
+			ret->m_io = io;
+			ret->m_param = param;
+			ret->m_bufRead = bufRead;
+			if (input && sizeInput) {
+				Base::copyMemory(bufRead.getData(), input, sizeInput);
+				ret->m_sizeRead = sizeInput;
+			}
+			ret->m_flagOpened = sl_true;
+			return ret;
+		}
+		return sl_null;
+	}
+
+	void WebSocket::start()
+	{
+		m_param.onOpen(this);
+		if (m_sizeRead > 0) {
+			_processInput();
+		}
+		_read();
+	}
+
+	void WebSocket::close()
+	{
+		_onClosed(WebSocketCloseCode::Abnormal, sl_null);
+		_closeIO();
+	}
+
+	void WebSocket::close(sl_uint16 code, const String& reason)
+	{
+		if (!m_flagOpened) {
+			return;
+		}
+		sl_uint8 payload[125];
+		const sl_uint8* dataReason = (const sl_uint8*)(reason.getData());
+		sl_size sizeReason = reason.getLength();
+		if (sizeReason > 123) {
+			// truncated on a boundary of the characters
+			sizeReason = 123;
+			while (sizeReason && (dataReason[sizeReason] & 0xC0) == 0x80) {
+				sizeReason--;
+			}
+		}
+		if (!(isValidUtf8(dataReason, sizeReason))) {
+			sizeReason = 0;
+		}
+		payload[0] = (sl_uint8)(code >> 8);
+		payload[1] = (sl_uint8)code;
+		Base::copyMemory(payload + 2, dataReason, sizeReason);
+		_onClosed(code, sizeReason == reason.getLength() ? reason : String((const sl_char8*)dataReason, sizeReason));
+		if (!(_write(buildFrame(WebSocketOpcode::Close, payload, 2 + sizeReason), sl_null, sl_true))) {
+			_closeIO();
+		}
+	}
+
+	sl_bool WebSocket::isOpened()
+	{
+		return m_flagOpened;
+	}
+
+	Ref<AsyncStream> WebSocket::getIO()
+	{
+		return m_io;
+	}
+
+	const WebSocketParam& WebSocket::getParam()
+	{
+		return m_param;
+	}
+
+	sl_bool WebSocket::sendText(const String& text)
+	{
+		return _send(WebSocketOpcode::Text, text.getData(), text.getLength(), sl_null);
+	}
+
+	sl_bool WebSocket::sendBinary(const void* data, sl_size size)
+	{
+		return _send(WebSocketOpcode::Binary, data, size, sl_null);
+	}
+
+	sl_bool WebSocket::sendBinary(const Memory& data)
+	{
+		return _send(WebSocketOpcode::Binary, data.getData(), data.getSize(), data);
+	}
+
+	sl_bool WebSocket::ping(const void* data, sl_size size)
+	{
+		if (size > 125) {
+			return sl_false;
+		}
+		return _send(WebSocketOpcode::Ping, data, size, sl_null);
+	}
+
+	sl_bool WebSocket::sendFrame(const Memory& frame)
+	{
+		if (!m_flagOpened) {
+			return sl_false;
+		}
+		return _write(frame, sl_null, sl_false);
+	}
+
+	sl_uint64 WebSocket::getPendingWriteSize()
+	{
+		return m_sizePendingWrite;
+	}
+
+	Memory WebSocket::buildFrame(WebSocketOpcode opcode, const void* data, sl_size size, sl_bool flagFin)
+	{
+		sl_uint8 header[PRIV_WEBSOCKET_MAX_FRAME_HEADER_SIZE];
+		sl_uint32 sizeHeader = buildFrameHeader(header, opcode, size, flagFin);
+		Memory ret = Memory::create(sizeHeader + size);
+		if (ret.isNotNull()) {
+			sl_uint8* p = (sl_uint8*)(ret.getData());
+			Base::copyMemory(p, header, sizeHeader);
+			if (size) {
+				Base::copyMemory(p + sizeHeader, data, size);
+			}
+		}
+		return ret;
+	}
+
+	sl_uint32 WebSocket::buildFrameHeader(void* _header, WebSocketOpcode opcode, sl_uint64 sizePayload, sl_bool flagFin, const sl_uint8* mask)
+	{
+		sl_uint8* header = (sl_uint8*)_header;
+		header[0] = (sl_uint8)((flagFin ? 0x80 : 0) | ((sl_uint32)opcode & 15));
+		sl_uint8 bitMask = mask ? 0x80 : 0;
+		sl_uint32 n;
+		if (sizePayload < 126) {
+			header[1] = (sl_uint8)(bitMask | sizePayload);
+			n = 2;
+		} else if (sizePayload < 0x10000) {
+			header[1] = bitMask | 126;
+			header[2] = (sl_uint8)(sizePayload >> 8);
+			header[3] = (sl_uint8)sizePayload;
+			n = 4;
+		} else {
+			header[1] = bitMask | 127;
+			for (sl_uint32 i = 0; i < 8; i++) {
+				header[2 + i] = (sl_uint8)(sizePayload >> ((7 - i) << 3));
+			}
+			n = 10;
+		}
+		if (mask) {
+			Base::copyMemory(header + n, mask, 4);
+			n += 4;
+		}
+		return n;
+	}
+
+	void WebSocket::applyMask(void* _data, sl_size size, const sl_uint8* mask, sl_size offset)
+	{
+		sl_uint8* data = (sl_uint8*)_data;
+		// leading bytes up to the 8-byte boundary
+		while (size && ((sl_size)data & 7)) {
+			*data ^= mask[offset & 3];
+			data++;
+			offset++;
+			size--;
+		}
+		if (size >= 8) {
+			sl_uint8 key8[8];
+			for (sl_uint32 i = 0; i < 8; i++) {
+				key8[i] = mask[(offset + i) & 3];
+			}
+			sl_uint64 key;
+			Base::copyMemory(&key, key8, 8);
+			sl_uint64* p = (sl_uint64*)data;
+			sl_size n = size >> 3;
+			// 16 bytes per step
+			for (sl_size i = n >> 1; i > 0; i--) {
+				p[0] ^= key;
+				p[1] ^= key;
+				p += 2;
+			}
+			if (n & 1) {
+				*p ^= key;
+				p++;
+			}
+			// the phase of the key is not changed by the multiples of 8 bytes
+			data = (sl_uint8*)p;
+			size &= 7;
+		}
+		while (size) {
+			*data ^= mask[offset & 3];
+			data++;
+			offset++;
+			size--;
+		}
+	}
+
+	String WebSocket::getAcceptKey(const String& key)
+	{
+		SLIB_STATIC_STRING(guid, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11")
+		sl_uint8 hash[SHA1::HashSize];
+		SHA1::hash(key + guid, hash);
+		return Base64::encode(hash, SHA1::HashSize);
+	}
+
+	// 1004 is reserved, and 1005, 1006 and 1015 are for the local use only, never sent in a Close frame
+	static sl_bool _priv_WebSocket_isValidCloseCode(sl_uint16 code)
+	{
+		if (code >= 1000 && code <= 1014) {
+			return code != 1004 && code != WebSocketCloseCode::NoStatus && code != WebSocketCloseCode::Abnormal;
+		}
+		return code >= 3000 && code <= 4999;
+	}
+
+	sl_bool WebSocket::isValidUtf8(const void* _data, sl_size size)
+	{
+		const sl_uint8* p = (const sl_uint8*)_data;
+		const sl_uint8* end = p + size;
+		while (p < end) {
+			sl_uint8 ch = *p;
+			if (ch < 0x80) {
+				p++;
+				continue;
+			}
+			sl_size n;
+			sl_uint8 minNext = 0x80;
+			sl_uint8 maxNext = 0xBF;
+			if (ch >= 0xC2 && ch <= 0xDF) {
+				n = 1;
+			} else if (ch >= 0xE0 && ch <= 0xEF) {
+				n = 2;
+				if (ch == 0xE0) {
+					// overlong
+					minNext = 0xA0;
+				} else if (ch == 0xED) {
+					// surrogates
+					maxNext = 0x9F;
+				}
+			} else if (ch >= 0xF0 && ch <= 0xF4) {
+				n = 3;
+				if (ch == 0xF0) {
+					// overlong
+					minNext = 0x90;
+				} else if (ch == 0xF4) {
+					// above U+10FFFF
+					maxNext = 0x8F;
+				}
+			} else {
+				return sl_false;
+			}
+			if ((sl_size)(end - p) <= n) {
+				return sl_false;
+			}
+			if (p[1] < minNext || p[1] > maxNext) {
+				return sl_false;
+			}
+			for (sl_size i = 2; i <= n; i++) {
+				if ((p[i] & 0xC0) != 0x80) {
+					return sl_false;
+				}
+			}
+			p += n + 1;
+		}
+		return sl_true;
+	}
+
+	sl_bool WebSocket::_send(WebSocketOpcode opcode, const void* data, sl_size size, const Memory& payload)
+	{
+		if (!m_flagOpened) {
+			return sl_false;
+		}
+		if (payload.isNotNull() && size > PRIV_WEBSOCKET_COPY_PAYLOAD_LIMIT) {
+			sl_uint8 header[PRIV_WEBSOCKET_MAX_FRAME_HEADER_SIZE];
+			sl_uint32 sizeHeader = buildFrameHeader(header, opcode, size);
+			return _write(Memory::create(header, sizeHeader), payload, sl_false);
+		}
+		Memory frame = buildFrame(opcode, data, size);
+		if (frame.isNull()) {
+			return sl_false;
+		}
+		return _write(frame, sl_null, sl_false);
+	}
+
+	sl_bool WebSocket::_write(const Memory& frame, const Memory& payload, sl_bool flagClose)
+	{
+		if (frame.isNull()) {
+			return sl_false;
+		}
+		MutexLocker lock(&m_lockWrite);
+		if (m_flagCloseSent) {
+			return sl_false;
+		}
+		sl_size size = frame.getSize() + payload.getSize();
+		if (m_sizePendingWrite + size > m_param.maxPendingWriteSize) {
+			// the peer is not reading
+			lock.unlock();
+			close();
+			return sl_false;
+		}
+		if (flagClose) {
+			m_flagCloseSent = sl_true;
+		}
+		m_sizePendingWrite += size;
+		// the header and the payload are written adjacently while locking
+		if (payload.isNotNull()) {
+			if (!(m_io->writeFromMemory(frame, SLIB_FUNCTION_WEAKREF(WebSocket, onWriteStream, this)))) {
+				m_sizePendingWrite -= size;
+				return sl_false;
+			}
+			if (m_io->writeFromMemory(payload, SLIB_FUNCTION_WEAKREF(WebSocket, onWriteStream, this))) {
+				return sl_true;
+			}
+			m_sizePendingWrite -= payload.getSize();
+		} else {
+			if (m_io->writeFromMemory(frame, flagClose ? SLIB_FUNCTION_WEAKREF(WebSocket, onWriteStreamAndClose, this) : SLIB_FUNCTION_WEAKREF(WebSocket, onWriteStream, this))) {
+				return sl_true;
+			}
+			m_sizePendingWrite -= size;
+		}
+		return sl_false;
+	}
+
+	void WebSocket::_read()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagOpened) {
+			return;
+		}
+		if (m_flagReading) {
+			return;
+		}
+		sl_size sizeBuf = m_bufRead.getSize();
+		if (m_sizeRead >= sizeBuf) {
+			return;
+		}
+		sl_size size = sizeBuf - m_sizeRead;
+		if (size > 0x40000000) {
+			size = 0x40000000;
+		}
+		m_flagReading = sl_true;
+		if (!(m_io->read((sl_uint8*)(m_bufRead.getData()) + m_sizeRead, (sl_uint32)size, SLIB_FUNCTION_WEAKREF(WebSocket, onReadStream, this), m_bufRead.ref.get()))) {
+			m_flagReading = sl_false;
+			lock.unlock();
+			close();
+		}
+	}
+
+	void WebSocket::_processInput()
+	{
+		sl_uint8* buf = (sl_uint8*)(m_bufRead.getData());
+		sl_size sizeInput = m_sizeRead;
+		sl_size pos = 0;
+		while (m_flagOpened) {
+			sl_size remain = sizeInput - pos;
+			if (remain < 2) {
+				break;
+			}
+			sl_uint8* p = buf + pos;
+			sl_bool flagFin = (p[0] & 0x80) != 0;
+			if (p[0] & 0x70) {
+				// no extension is negotiated
+				_closeWithError(WebSocketCloseCode::ProtocolError);
+				return;
+			}
+			WebSocketOpcode opcode = (WebSocketOpcode)(p[0] & 15);
+			if (!(p[1] & 0x80)) {
+				// the client frames must be masked
+				_closeWithError(WebSocketCloseCode::ProtocolError);
+				return;
+			}
+			sl_uint64 sizePayload = p[1] & 127;
+			sl_size sizeHeader;
+			if (sizePayload == 126) {
+				if (remain < 4) {
+					break;
+				}
+				sizePayload = ((sl_uint32)(p[2]) << 8) | p[3];
+				sizeHeader = 8;
+			} else if (sizePayload == 127) {
+				if (remain < 10) {
+					break;
+				}
+				sizePayload = 0;
+				for (sl_uint32 i = 0; i < 8; i++) {
+					sizePayload = (sizePayload << 8) | p[2 + i];
+				}
+				sizeHeader = 14;
+			} else {
+				sizeHeader = 6;
+			}
+			if ((sl_uint32)opcode >= 8 && (!flagFin || sizePayload > 125)) {
+				_closeWithError(WebSocketCloseCode::ProtocolError);
+				return;
+			}
+			if (sizePayload > m_param.maxMessageSize) {
+				_closeWithError(WebSocketCloseCode::MessageTooBig);
+				return;
+			}
+			sl_size sizeFrame = sizeHeader + (sl_size)sizePayload;
+			if (remain < sizeFrame) {
+				if (sizeFrame > m_bufRead.getSize()) {
+					// grows the buffer to contain the whole frame
+					Memory bufNew = Memory::create(sizeFrame);
+					if (bufNew.isNull()) {
+						_closeWithError(WebSocketCloseCode::InternalError);
+						return;
+					}
+					Base::copyMemory(bufNew.getData(), p, remain);
+					m_bufRead = bufNew;
+					m_sizeRead = remain;
+					return;
+				}
+				break;
+			}
+			sl_uint8* payload = p + sizeHeader;
+			applyMask(payload, (sl_size)sizePayload, payload - 4);
+			pos += sizeFrame;
+			if (!(_processFrame(opcode, flagFin, payload, (sl_size)sizePayload))) {
+				return;
+			}
+		}
+		if (pos > 0) {
+			sl_size remain = sizeInput - pos;
+			if (m_bufRead.getSize() > PRIV_WEBSOCKET_READ_BUFFER_SIZE && remain <= PRIV_WEBSOCKET_READ_BUFFER_SIZE) {
+				// releases the grown buffer
+				Memory bufNew = Memory::create(PRIV_WEBSOCKET_READ_BUFFER_SIZE);
+				if (bufNew.isNotNull()) {
+					Base::copyMemory(bufNew.getData(), buf + pos, remain);
+					m_bufRead = bufNew;
+					m_sizeRead = remain;
+					return;
+				}
+			}
+			if (remain > 0) {
+				Base::moveMemory(buf, buf + pos, remain);
+			}
+			m_sizeRead = remain;
+		}
+	}
+
+	sl_bool WebSocket::_processFrame(WebSocketOpcode opcode, sl_bool flagFin, sl_uint8* payload, sl_size size)
+	{
+		switch (opcode) {
+			case WebSocketOpcode::Text:
+			case WebSocketOpcode::Binary:
+				if (m_flagFragmented) {
+					_closeWithError(WebSocketCloseCode::ProtocolError);
+					return sl_false;
+				}
+				if (flagFin) {
+					if (opcode == WebSocketOpcode::Text && !(isValidUtf8(payload, size))) {
+						_closeWithError(WebSocketCloseCode::InvalidData);
+						return sl_false;
+					}
+					WebSocketMessage message;
+					message.opcode = opcode;
+					message.data = payload;
+					message.size = size;
+					m_param.onMessage(this, &message);
+				} else {
+					m_flagFragmented = sl_true;
+					m_opcodeFragments = opcode;
+					if (size) {
+						m_fragments.add(Memory::create(payload, size));
+					}
+				}
+				return sl_true;
+			case WebSocketOpcode::Continuation:
+				if (!m_flagFragmented) {
+					_closeWithError(WebSocketCloseCode::ProtocolError);
+					return sl_false;
+				}
+				if (m_fragments.getSize() + size > m_param.maxMessageSize) {
+					_closeWithError(WebSocketCloseCode::MessageTooBig);
+					return sl_false;
+				}
+				if (size) {
+					m_fragments.add(Memory::create(payload, size));
+				}
+				if (flagFin) {
+					Memory content = m_fragments.merge();
+					m_fragments.clear();
+					m_flagFragmented = sl_false;
+					// validated as a whole, a character can be split between the fragments
+					if (m_opcodeFragments == WebSocketOpcode::Text && !(isValidUtf8(content.getData(), content.getSize()))) {
+						_closeWithError(WebSocketCloseCode::InvalidData);
+						return sl_false;
+					}
+					WebSocketMessage message;
+					message.opcode = m_opcodeFragments;
+					message.data = content.getData();
+					message.size = content.getSize();
+					m_param.onMessage(this, &message);
+				}
+				return sl_true;
+			case WebSocketOpcode::Ping:
+				_send(WebSocketOpcode::Pong, payload, size, sl_null);
+				return sl_true;
+			case WebSocketOpcode::Pong:
+				m_param.onPong(this, payload, size);
+				return sl_true;
+			case WebSocketOpcode::Close:
+				{
+					sl_uint16 code = WebSocketCloseCode::NoStatus;
+					String reason;
+					if (size == 1) {
+						_closeWithError(WebSocketCloseCode::ProtocolError);
+						return sl_false;
+					}
+					if (size >= 2) {
+						code = (sl_uint16)(((sl_uint32)(payload[0]) << 8) | payload[1]);
+						if (!(_priv_WebSocket_isValidCloseCode(code))) {
+							_closeWithError(WebSocketCloseCode::ProtocolError);
+							return sl_false;
+						}
+						if (!(isValidUtf8(payload + 2, size - 2))) {
+							_closeWithError(WebSocketCloseCode::InvalidData);
+							return sl_false;
+						}
+						reason = String::fromUtf8(payload + 2, size - 2);
+					}
+					_onClosed(code, reason);
+					// echoes the status code, and closes after it is sent
+					if (!(_write(buildFrame(WebSocketOpcode::Close, payload, size < 2 ? 0 : 2), sl_null, sl_true))) {
+						_closeIO();
+					}
+				}
+				return sl_false;
+			default:
+				break;
+		}
+		_closeWithError(WebSocketCloseCode::ProtocolError);
+		return sl_false;
+	}
+
+	void WebSocket::_closeWithError(sl_uint16 code)
+	{
+		close(code);
+	}
+
+	void WebSocket::_onClosed(sl_uint16 code, const String& reason)
+	{
+		{
+			ObjectLocker lock(this);
+			if (!m_flagOpened) {
+				return;
+			}
+			m_flagOpened = sl_false;
+			m_fragments.clear();
+		}
+		m_param.onClose(this, code, reason);
+	}
+
+	void WebSocket::onReadStream(AsyncStreamResult* result)
+	{
+		{
+			ObjectLocker lock(this);
+			m_flagReading = sl_false;
+		}
+		if (result->flagError) {
+			close();
+			return;
+		}
+		m_sizeRead += result->size;
+		_processInput();
+		_read();
+	}
+
+	void WebSocket::onWriteStream(AsyncStreamResult* result)
+	{
+		{
+			MutexLocker lock(&m_lockWrite);
+			m_sizePendingWrite -= result->requestSize;
+		}
+		if (result->flagError) {
+			close();
+		}
+	}
+
+	void WebSocket::onWriteStreamAndClose(AsyncStreamResult* result)
+	{
+		{
+			MutexLocker lock(&m_lockWrite);
+			m_sizePendingWrite -= result->requestSize;
+		}
+		_closeIO();
+	}
+
+	void WebSocket::_closeIO()
+	{
+		m_io->close();
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNotNull()) {
+			connection->close();
+		}
+	}
+
+
+	SLIB_DEFINE_OBJECT(WebSocketGroup, Object)
+
+	WebSocketGroup::WebSocketGroup()
+	{
+	}
+
+	WebSocketGroup::~WebSocketGroup()
+	{
+	}
+
+	void WebSocketGroup::add(const Ref<WebSocket>& socket)
+	{
+		if (socket.isNotNull()) {
+			m_sockets.put(socket.get(), socket);
+		}
+	}
+
+	void WebSocketGroup::remove(WebSocket* socket)
+	{
+		m_sockets.remove(socket);
+	}
+
+	sl_size WebSocketGroup::getCount()
+	{
+		return m_sockets.getCount();
+	}
+
+	List< Ref<WebSocket> > WebSocketGroup::getSockets()
+	{
+		return m_sockets.getAllValues();
+	}
+
+	sl_size WebSocketGroup::broadcastFrame(const Memory& frame)
+	{
+		if (frame.isNull()) {
+			return 0;
+		}
+		sl_size n = 0;
+		List< Ref<WebSocket> > closed;
+		ListElements< Ref<WebSocket> > sockets(getSockets());
+		for (sl_size i = 0; i < sockets.count; i++) {
+			WebSocket* socket = sockets[i].get();
+			// all the connections share the memory of the frame
+			if (socket->sendFrame(frame)) {
+				n++;
+			} else if (!(socket->isOpened())) {
+				closed.add_NoLock(sockets[i]);
+			}
+		}
+		ListElements< Ref<WebSocket> > listClosed(closed);
+		for (sl_size i = 0; i < listClosed.count; i++) {
+			m_sockets.remove(listClosed[i].get());
+		}
+		return n;
+	}
+
+	sl_size WebSocketGroup::broadcastText(const String& text)
+	{
+		return broadcastFrame(WebSocket::buildFrame(WebSocketOpcode::Text, text.getData(), text.getLength()));
+	}
+
+	sl_size WebSocketGroup::broadcastBinary(const void* data, sl_size size)
+	{
+		return broadcastFrame(WebSocket::buildFrame(WebSocketOpcode::Binary, data, size));
+	}
+
+}
@@ -28,6 +28,210 @@
 namespace slib
 {
 
+	class _priv_WebRouteNode : public Referable
+	{
+	public:
+		String prefix; // static text (empty for `:` and `*` nodes)
+		List< Ref<_priv_WebRouteNode> > children;
+		Ref<_priv_WebRouteNode> param;
+		Ref<_priv_WebRouteNode> wildcard;
+		WebHandler handler;
+		// names of the parameters captured by the route ending at this node. `:` and `*` nodes are shared by the patterns
+		// having a parameter at the same position, so the names are kept per route instead of per node
+		List<String> paramNames;
+		
+	public:
+		_priv_WebRouteNode* addStatic(const sl_char8* s, sl_size len)
+		{
+			_priv_WebRouteNode* node = this;
+			while (len) {
+				sl_size n = node->children.getCount();
+				Ref<_priv_WebRouteNode>* list = node->children.getData();
+				sl_size index = 0;
+				for (; index < n; index++) {
+					if (list[index]->prefix.getData()[0] == s[0]) {
+						break;
+					}
+				}
+				if (index == n) {
+					Ref<_priv_WebRouteNode> child = new _priv_WebRouteNode;
+					if (child.isNull()) {
+						return sl_null;
+					}
+					child->prefix = String(s, len);
+					node->children.add_NoLock(child);
+					return child.get();
+				}
+				_priv_WebRouteNode* child = list[index].get();
+				const sl_char8* prefix = child->prefix.getData();
+				sl_size lenPrefix = child->prefix.getLength();
+				sl_size l = 0;
+				while (l < lenPrefix && l < len && prefix[l] == s[l]) {
+					l++;
+				}
+				if (l < lenPrefix) {
+					// split the edge
+					Ref<_priv_WebRouteNode> middle = new _priv_WebRouteNode;
+					if (middle.isNull()) {
+						return sl_null;
+					}
+					middle->prefix = String(prefix, l);
+					middle->children.add_NoLock(list[index]);
+					child->prefix = String(prefix + l, lenPrefix - l);
+					node->children.setAt_NoLock(index, middle);
+					child = middle.get();
+				}
+				node = child;
+				s += l;
+				len -= l;
+			}
+			return node;
+		}
+		
+		const _priv_WebRouteNode* match(const sl_char8* path, sl_size pos, sl_size len, HttpPathParameter* params, sl_uint32& nParams) const
+		{
+			if (pos == len) {
+				if (handler.isNotNull()) {
+					return this;
+				}
+			} else {
+				sl_size n = children.getCount();
+				Ref<_priv_WebRouteNode>* list = children.getData();
+				for (sl_size i = 0; i < n; i++) {
+					_priv_WebRouteNode* child = list[i].get();
+					const sl_char8* prefix = child->prefix.getData();
+					if (prefix[0] == path[pos]) {
+						sl_size lenPrefix = child->prefix.getLength();
+						if (lenPrefix <= len - pos && Base::equalsMemory(prefix, path + pos, lenPrefix)) {
+							const _priv_WebRouteNode* ret = child->match(path, pos + lenPrefix, len, params, nParams);
+							if (ret) {
+								return ret;
+							}
+						}
+						break;
+					}
+				}
+				if (param.isNotNull() && nParams < SLIB_HTTP_MAX_PATH_PARAMETERS) {
+					sl_size end = pos;
+					while (end < len && path[end] != '/') {
+						end++;
+					}
+					if (end > pos) {
+						HttpPathParameter& p = params[nParams];
+						p.pos = (sl_uint32)pos;
+						p.length = (sl_uint32)(end - pos);
+						nParams++;
+						const _priv_WebRouteNode* ret = param->match(path, end, len, params, nParams);
+						if (ret) {
+							return ret;
+						}
+						nParams--;
+					}
+				}
+			}
+			if (wildcard.isNotNull() && nParams < SLIB_HTTP_MAX_PATH_PARAMETERS) {
+				HttpPathParameter& p = params[nParams];
+				p.pos = (sl_uint32)pos;
+				p.length = (sl_uint32)(len - pos);
+				nParams++;
+				return wildcard.get();
+			}
+			return sl_null;
+		}
+		
+	};
+	
+	WebRouter::WebRouter()
+	{
+	}
+	
+	WebRouter::~WebRouter()
+	{
+	}
+	
+	void WebRouter::add(HttpMethod method, const String& pattern, const WebHandler& handler)
+	{
+		sl_uint32 m = (sl_uint32)method;
+		if (m >= CountOfArray(m_roots)) {
+			return;
+		}
+		WriteLocker lock(&m_lock);
+		Ref<_priv_WebRouteNode>& root = m_roots[m];
+		if (root.isNull()) {
+			root = new _priv_WebRouteNode;
+			if (root.isNull()) {
+				return;
+			}
+		}
+		_priv_WebRouteNode* node = root.get();
+		List<String> names;
+		const sl_char8* s = pattern.getData();
+		sl_size len = pattern.getLength();
+		sl_size pos = 0;
+		while (node && pos < len) {
+			sl_char8 ch = s[pos];
+			if ((ch == ':' || ch == '*') && (pos == 0 || s[pos - 1] == '/')) {
+				sl_size end = pos + 1;
+				if (ch == ':') {
+					while (end < len && s[end] != '/') {
+						end++;
+					}
+				} else {
+					end = len;
+				}
+				Ref<_priv_WebRouteNode>& child = ch == ':' ? node->param : node->wildcard;
+				if (child.isNull()) {
+					child = new _priv_WebRouteNode;
+					if (child.isNull()) {
+						return;
+					}
+				}
+				names.add_NoLock(String(s + pos + 1, end - pos - 1));
+				node = child.get();
+				pos = end;
+			} else {
+				sl_size end = pos + 1;
+				while (end < len && !((s[end] == ':' || s[end] == '*') && s[end - 1] == '/')) {
+					end++;
+				}
+				node = node->addStatic(s + pos, end - pos);
+				pos = end;
+			}
+		}
+		if (node) {
+			node->handler = handler;
+			node->paramNames = names;
+		}
+	}
+	
+	WebHandler WebRouter::match(HttpMethod method, const String& path, HttpPathParameter* params, sl_uint32* pCountParams) const
+	{
+		sl_uint32 nParams = 0;
+		WebHandler ret;
+		sl_uint32 m = (sl_uint32)method;
+		if (m < CountOfArray(m_roots)) {
+			ReadLocker lock(&m_lock);
+			_priv_WebRouteNode* root = m_roots[m].get();
+			if (root) {
+				const _priv_WebRouteNode* node = root->match(path.getData(), 0, path.getLength(), params, nParams);
+				if (node) {
+					ret = node->handler;
+					ListElements<String> names(node->paramNames);
+					for (sl_uint32 i = 0; i < nParams; i++) {
+						params[i].name = i < names.count ? names[i] : String::null();
+					}
+				} else {
+					nParams = 0;
+				}
+			}
+		}
+		if (pCountParams) {
+			*pCountParams = nParams;
+		}
+		return ret;
+	}
+	
+
 	SLIB_DEFINE_OBJECT(WebController, Object)
 
 	WebController::WebController()
@@ -42,18 +246,24 @@ namespace slib
 	void WebController::registerHandler(HttpMethod method, const String& path, const WebHandler& handler)
 	{
 		if (handler.isNotNull()) {
-			String sig = _getHandlerSignature(method, path);
-			m_handlers.put(sig, handler);
+			m_router.add(method, path, handler);
 		}
 	}
+	
+	WebRouter& WebController::getRouter()
+	{
+		return m_router;
+	}
 
 	sl_bool WebController::onHttpRequest(const Ref<HttpServiceContext>& context)
 	{
 		HttpMethod method = context->getMethod();
 		String path = context->getPath();
-		String sig = _getHandlerSignature(method, path);
-		WebHandler handler;
-		if (m_handlers.get(sig, &handler)) {
+		HttpPathParameter params[SLIB_HTTP_MAX_PATH_PARAMETERS];
+		sl_uint32 nParams = 0;
+		WebHandler handler = m_router.match(method, path, params, &nParams);
+		if (handler.isNotNull()) {
+			context->setPathParameters(params, nParams);
 			Variant ret(handler(context, method, path));
 			if (ret.isNotNull()) {
 				if (ret.isObject()) {
@@ -64,7 +274,7 @@ namespace slib
 						} else if (CMemory* mem = CastInstance<CMemory>(obj.get())) {
 							context->write(mem);
 						} else {
-							context->write(ret.toJsonString());
+							context->writeJson(ret);
 						}
 					}
 				} else {
@@ -76,12 +286,6 @@ namespace slib
 		return sl_false;
 	}
 
-	String WebController::_getHandlerSignature(HttpMethod method, const String& path)
-	{
-		return HttpMethods::toString(method) + " " + path;
-	}
-
-
 	WebModule::WebModule(const String& path)
 	: m_path(path)
 	{
@@ -0,0 +1,188 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static void TestBasic()
+{
+	FlatHashMap<sl_int32, String> map;
+	TEST_CHECK(map.isEmpty());
+	sl_bool flagInsertion = sl_false;
+	map.put(1, "one", &flagInsertion);
+	TEST_CHECK(flagInsertion);
+	map.put(2, "two");
+	map.put(1, "uno", &flagInsertion);
+	TEST_CHECK(!flagInsertion);
+	TEST_CHECK(map.getCount() == 2);
+	TEST_CHECK(map.getValue(1) == "uno");
+	TEST_CHECK(map.getValue(3, "none") == "none");
+	TEST_CHECK(map.find(3) == sl_null);
+	TEST_CHECK(map.replace(3, String("three")) == sl_null);
+	TEST_CHECK(map.replace(2, String("dos")) != sl_null);
+	TEST_CHECK(map.getValue(2) == "dos");
+	String value;
+	TEST_CHECK(map.remove(1, &value));
+	TEST_CHECK(value == "uno");
+	TEST_CHECK(!(map.remove(1)));
+	TEST_CHECK(map.getCount() == 1);
+}
+
+static void TestDuplicatedKeys()
+{
+	FlatHashMap<sl_int32, sl_int32> map;
+	map.add(7, 1);
+	map.add(7, 2);
+	map.add(7, 3);
+	map.add(8, 4);
+	TEST_CHECK(map.getCount() == 4);
+	TEST_CHECK(map.getValues(7).getCount() == 3);
+	TEST_CHECK(map.removeKeyAndValue(7, 2));
+	TEST_CHECK(!(map.removeKeyAndValue(7, 2)));
+	TEST_CHECK(map.removeItems(7) == 2);
+	TEST_CHECK(map.getCount() == 1);
+	TEST_CHECK(map.getValue(8) == 4);
+}
+
+static void TestGrowAndTombstones()
+{
+	FlatHashMap<sl_int32, sl_int32> map;
+	const sl_int32 n = 10000;
+	sl_int32 i;
+	for (i = 0; i < n; i++) {
+		map.put(i, i * 2);
+	}
+	TEST_CHECK(map.getCount() == (sl_size)n);
+	TEST_CHECK(map.getCapacity() >= (sl_size)n);
+	sl_bool flagFound = sl_true;
+	for (i = 0; i < n; i++) {
+		if (map.getValue(i, -1) != i * 2) {
+			flagFound = sl_false;
+		}
+	}
+	TEST_CHECK(flagFound);
+	// removing and inserting again must reuse the deleted slots
+	sl_size capacity = map.getCapacity();
+	for (sl_int32 k = 0; k < 10; k++) {
+		for (i = 0; i < n; i += 2) {
+			map.remove(i);
+		}
+		for (i = 0; i < n; i += 2) {
+			map.put(i, i * 2);
+		}
+	}
+	TEST_CHECK(map.getCount() == (sl_size)n);
+	TEST_CHECK(map.getCapacity() <= capacity * 2);
+	sl_size count = 0;
+	sl_int64 sum = 0;
+	for (auto& node : map) {
+		count++;
+		sum += node.value - node.key * 2;
+	}
+	TEST_CHECK(count == (sl_size)n);
+	TEST_CHECK(sum == 0);
+}
+
+static void TestReserveAndShrink()
+{
+	FlatHashMap<sl_int32, sl_int32> map;
+	TEST_CHECK(map.reserve(1000));
+	sl_size capacity = map.getCapacity();
+	TEST_CHECK(capacity >= 1000);
+	sl_int32 i;
+	for (i = 0; i < 1000; i++) {
+		map.put(i, i);
+	}
+	// no rehash was needed
+	TEST_CHECK(map.getCapacity() == capacity);
+	TEST_CHECK(map.removeAll() == 1000);
+	TEST_CHECK(map.isEmpty());
+	TEST_CHECK(map.getCapacity() == capacity);
+	map.put(1, 1);
+	map.shrink();
+	TEST_CHECK(map.getCapacity() < capacity);
+	TEST_CHECK(map.getValue(1) == 1);
+}
+
+static void TestMoveAndCopy()
+{
+	FlatHashMap<String, sl_int32> map;
+	map.put("alpha", 1);
+	map.put("beta", 2);
+	FlatHashMap<String, sl_int32> moved(Move(map));
+	TEST_CHECK(map.isEmpty());
+	TEST_CHECK(moved.getCount() == 2);
+	TEST_CHECK(moved.getValue("beta") == 2);
+	FlatHashMap<String, sl_int32> copied;
+	copied.put("gamma", 3);
+	TEST_CHECK(copied.copyFrom(moved));
+	TEST_CHECK(copied.getCount() == 2);
+	TEST_CHECK(copied.getValue("alpha") == 1);
+	TEST_CHECK(copied.find("gamma") == sl_null);
+	map = Move(copied);
+	TEST_CHECK(map.getValue("alpha") == 1);
+	TEST_CHECK(copied.isEmpty());
+	// the moved-from map must stay usable
+	copied.put("delta", 4);
+	TEST_CHECK(copied.getValue("delta") == 4);
+}
+
+static void TestRandomOperations()
+{
+	FlatHashMap<sl_uint32, sl_uint32> map;
+	HashMap<sl_uint32, sl_uint32> reference;
+	sl_uint32 seed = 12345;
+	sl_bool flagSame = sl_true;
+	for (sl_uint32 i = 0; i < 100000; i++) {
+		seed = seed * 1103515245 + 12345;
+		sl_uint32 key = (seed >> 8) % 2000;
+		if ((seed >> 4) & 1) {
+			map.put(key, i);
+			reference.put(key, i);
+		} else {
+			if (map.remove(key) != reference.remove(key)) {
+				flagSame = sl_false;
+			}
+		}
+	}
+	TEST_CHECK(flagSame);
+	TEST_CHECK(map.getCount() == reference.getCount());
+	for (auto& item : reference) {
+		if (map.getValue(item.key, (sl_uint32)-1) != item.value) {
+			flagSame = sl_false;
+		}
+	}
+	TEST_CHECK(flagSame);
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestBasic);
+	TEST_RUN(TestDuplicatedKeys);
+	TEST_RUN(TestGrowAndTombstones);
+	TEST_RUN(TestReserveAndShrink);
+	TEST_RUN(TestMoveAndCopy);
+	TEST_RUN(TestRandomOperations);
+	return TEST_RESULT;
+}
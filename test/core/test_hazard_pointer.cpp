@@ -0,0 +1,171 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static sl_int32 g_countLiveObjects = 0;
+
+class TestObject : public Referable
+{
+public:
+	sl_uint32 magic;
+	AtomicRef<TestObject> child;
+	
+public:
+	TestObject(): magic(0x12345678)
+	{
+		Base::interlockedIncrement32(&g_countLiveObjects);
+	}
+	
+	~TestObject()
+	{
+		magic = 0;
+		// replaces another pointer while the replaced pointers are released
+		child.setNull();
+		Base::interlockedDecrement32(&g_countLiveObjects);
+	}
+	
+};
+
+static sl_int32 GetLiveObjects()
+{
+	return Base::interlockedAdd32(&g_countLiveObjects, 0);
+}
+
+static void TestDelayedRelease()
+{
+	AtomicRef<TestObject> a = new TestObject;
+	TEST_CHECK(GetLiveObjects() == 1);
+	a = new TestObject;
+	// retired, and released by the explicit reclamation
+	TEST_CHECK(GetLiveObjects() == 2);
+	HazardPointer::reclaimAll();
+	TEST_CHECK(GetLiveObjects() == 1);
+	// the slots are scanned when the retire list reaches the threshold (8)
+	for (sl_uint32 i = 0; i < 7; i++) {
+		a = new TestObject;
+	}
+	TEST_CHECK(GetLiveObjects() == 8);
+	a = new TestObject;
+	TEST_CHECK(GetLiveObjects() == 1);
+	// the child is replaced by the destructor while the retired pointers are released
+	Ref<TestObject> parent = new TestObject;
+	parent->child = new TestObject;
+	a = parent;
+	parent.setNull();
+	HazardPointer::reclaimAll();
+	TEST_CHECK(GetLiveObjects() == 2);
+	a.setNull();
+	HazardPointer::reclaimAll();
+	TEST_CHECK(GetLiveObjects() == 0);
+}
+
+static void TestWriterDoesNotWait()
+{
+	TestObject* object = new TestObject;
+	object->increaseReference();
+	TestObject* volatile shared = object;
+	sl_int32 step = 0;
+	Ref<Thread> reader = Thread::start([&shared, &step, object]() {
+		void* ptr = HazardPointer::protect((void* const volatile*)&shared);
+		TEST_CHECK(ptr == object);
+		Base::interlockedIncrement32(&step);
+		while (Base::interlockedAdd32(&step, 0) < 2) {
+			System::sleep(1);
+		}
+		HazardPointer::clear();
+		Base::interlockedIncrement32(&step);
+	});
+	while (Base::interlockedAdd32(&step, 0) < 1) {
+		System::sleep(1);
+	}
+	// the reader still announces the object: it is retired instead of waiting for the reader
+	HazardPointer::replace(shared, (TestObject*)sl_null);
+	TEST_CHECK(shared == sl_null);
+	TEST_CHECK(GetLiveObjects() == 1);
+	Base::interlockedIncrement32(&step);
+	reader->join();
+	while (Base::interlockedAdd32(&step, 0) < 3) {
+		System::sleep(1);
+	}
+	// not announced any more
+	HazardPointer::reclaimAll();
+	TEST_CHECK(GetLiveObjects() == 0);
+}
+
+static void TestConcurrentAccess()
+{
+	{
+		AtomicRef<TestObject> object = new TestObject;
+		AtomicString str = "v0";
+		sl_int32 flagStop = 0;
+		sl_int32 countErrors = 0;
+		List< Ref<Thread> > threads;
+		for (sl_uint32 i = 0; i < 8; i++) {
+			threads.add(Thread::start([&object, &str, &flagStop, &countErrors, i]() {
+				sl_uint32 n = 0;
+				while (!(Base::interlockedAdd32(&flagStop, 0))) {
+					if (i < 2) {
+						Ref<TestObject> o = new TestObject;
+						if (n & 1) {
+							o->child = new TestObject;
+						}
+						object = o;
+						str = String::format("v%d", n);
+					} else {
+						Ref<TestObject> o = object;
+						if (o.isNull() || o->magic != 0x12345678) {
+							Base::interlockedIncrement32(&countErrors);
+						}
+						String s = str;
+						if (!(s.startsWith('v'))) {
+							Base::interlockedIncrement32(&countErrors);
+						}
+					}
+					n++;
+				}
+			}));
+		}
+		System::sleep(500);
+		Base::interlockedIncrement32(&flagStop);
+		for (sl_size i = 0; i < threads.getCount(); i++) {
+			threads.getValueAt(i)->join();
+		}
+		TEST_CHECK(countErrors == 0);
+	}
+	// the retire lists of the exited threads are released in the thread-local destructors
+	for (sl_uint32 i = 0; i < 100 && GetLiveObjects(); i++) {
+		System::sleep(10);
+	}
+	TEST_CHECK(GetLiveObjects() == 0);
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestDelayedRelease);
+	TEST_RUN(TestWriterDoesNotWait);
+	TEST_RUN(TestConcurrentAccess);
+	return TEST_RESULT;
+}
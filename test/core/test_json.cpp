@@ -0,0 +1,169 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static Memory ToMemory(const char* sz)
+{
+	return Memory::create(sz, Base::getStringLength(sz));
+}
+
+static Ref<JsonDocument> ParseDocument(const char* sz)
+{
+	JsonParseParam param;
+	param.flagLogError = sl_false;
+	return JsonDocument::parse(ToMemory(sz), param);
+}
+
+static sl_bool EqualsBytes(const String& str, const char* bytes)
+{
+	return str.getLength() == Base::getStringLength(bytes) && Base::equalsMemory(str.getData(), bytes, str.getLength());
+}
+
+static void TestDocumentValues()
+{
+	Ref<JsonDocument> doc = ParseDocument("{\"b\": [1, -2, 3.5, true, false, null], \"a\": \"text\", \"c\": {\"x\": 18446744073709551615}}");
+	TEST_CHECK(doc.isNotNull());
+	if (doc.isNull()) {
+		return;
+	}
+	JsonValue root = doc->getRoot();
+	TEST_CHECK(root.isMap());
+	TEST_CHECK(root.getItemsCount() == 3);
+	TEST_CHECK(root.getItemKey(0) == "a");
+	TEST_CHECK(root.getItemKey(2) == "c");
+	TEST_CHECK(root["a"].getString() == "text");
+	JsonValue list = root["b"];
+	TEST_CHECK(list.isList());
+	TEST_CHECK(list.getElementsCount() == 6);
+	TEST_CHECK(list[0].getInt32() == 1);
+	TEST_CHECK(list[1].getInt64() == -2);
+	TEST_CHECK(list[2].getDouble() == 3.5);
+	TEST_CHECK(list[3].isBoolean() && list[3].getBoolean());
+	TEST_CHECK(list[4].isBoolean() && !(list[4].getBoolean(sl_true)));
+	TEST_CHECK(list[5].isNull());
+	TEST_CHECK(list[6].isNull());
+	TEST_CHECK(root["c"]["x"].getUint64() == SLIB_UINT64(0xFFFFFFFFFFFFFFFF));
+	TEST_CHECK(root["missing"].isNull());
+	
+	// the strings without escapes point into the source
+	sl_size len = 0;
+	const sl_char8* data = root["a"].getStringData(&len);
+	const sl_char8* source = (const sl_char8*)(doc->getSource().getData());
+	TEST_CHECK(len == 4);
+	TEST_CHECK(data > source && data < source + doc->getSource().getSize());
+	
+	Json json = root.toJson();
+	TEST_CHECK(json["a"].getString() == "text");
+	TEST_CHECK(json["b"][2].getDouble() == 3.5);
+}
+
+static void TestDocumentArena()
+{
+	// many nodes and escaped strings spread over the chunks of the arena
+	StringBuffer sb;
+	sb.add("[[], {}, ");
+	for (sl_uint32 i = 0; i < 5000; i++) {
+		sb.add(String::format("{\"k%d\": [%d, \"v\\n%d\"]}, ", i, i, i));
+	}
+	sb.add("\"end\"]");
+	String str = sb.merge();
+	Ref<JsonDocument> doc = JsonDocument::parse(Memory::create(str.getData(), str.getLength()));
+	TEST_CHECK(doc.isNotNull());
+	if (doc.isNull()) {
+		return;
+	}
+	JsonValue root = doc->getRoot();
+	TEST_CHECK(root.getElementsCount() == 5003);
+	TEST_CHECK(root[0].isList() && !(root[0].getElementsCount()));
+	TEST_CHECK(root[1].isMap() && !(root[1].getItemsCount()));
+	for (sl_uint32 i = 0; i < 5000; i += 999) {
+		JsonValue item = root[i + 2][String::format("k%d", i)];
+		TEST_CHECK(item[0].getUint32() == i);
+		TEST_CHECK(item[1].getString() == String::format("v\n%d", i));
+	}
+	TEST_CHECK(root[5002].getString() == "end");
+}
+
+static void TestDocumentErrors()
+{
+	TEST_CHECK(ParseDocument("{\"a\": 1").isNull());
+	TEST_CHECK(ParseDocument("[1, 2").isNull());
+	TEST_CHECK(ParseDocument("\"abc").isNull());
+	TEST_CHECK(ParseDocument("\"\\q\"").isNull());
+	TEST_CHECK(ParseDocument("\"\\u12G4\"").isNull());
+	TEST_CHECK(ParseDocument("\"\\u12\"").isNull());
+	TEST_CHECK(ParseDocument("\"\\xg\"").isNull());
+	TEST_CHECK(ParseDocument("\"\\U0011FFFF\"").isNull());
+	TEST_CHECK(ParseDocument("\"\\U0001F60\"").isNull());
+}
+
+static void TestEscapes(const char* literal, const char* decoded)
+{
+	Ref<JsonDocument> doc = ParseDocument(literal);
+	TEST_CHECK(doc.isNotNull());
+	if (doc.isNotNull()) {
+		TEST_CHECK(EqualsBytes(doc->getRoot().getString(), decoded));
+	}
+	Json json = Json::parseJsonUtf8(ToMemory(literal));
+	TEST_CHECK(EqualsBytes(json.getString(), decoded));
+}
+
+static void TestStringEscapes()
+{
+	TestEscapes("\"a\\/b\"", "a/b");
+	TestEscapes("\"\\\"\\\\\\b\\f\\n\\r\\t\"", "\"\\\b\f\n\r\t");
+	TestEscapes("'it\\'s'", "it's");
+	TestEscapes("\"\\u0041\\u00e9\\u20AC\"", "A\xC3\xA9\xE2\x82\xAC");
+	// surrogate pair: U+1F600
+	TestEscapes("\"\\uD83D\\uDE00!\"", "\xF0\x9F\x98\x80!");
+	// unpaired surrogates are replaced with U+FFFD
+	TestEscapes("\"\\uD83Dx\"", "\xEF\xBF\xBDx");
+	TestEscapes("\"\\uDE00\"", "\xEF\xBF\xBD");
+	TestEscapes("\"\\uD83D\\u0041\"", "\xEF\xBF\xBD" "A");
+	// escapes at the boundaries of the SIMD scan
+	TestEscapes("\"0123456789abcdef\\n0123456789abcde\\/\"", "0123456789abcdef\n0123456789abcde/");
+	// lenient escapes, same as `ParseUtil::parseBackslashEscapes`
+	TestEscapes("\"\\a\\v\"", "\a\v");
+	TestEscapes("\"\\101\\60\\1234\"", "A0S4");
+	TestEscapes("\"\\x41\\x7g\\xe9\"", "A\x07g\xE9");
+	TestEscapes("\"\\U0001F600\\U00000041\"", "\xF0\x9F\x98\x80" "A");
+	
+	Ref<JsonDocument> doc = ParseDocument("{\"k\\u00e9y\": \"v\\u00e9\"}");
+	TEST_CHECK(doc.isNotNull());
+	if (doc.isNotNull()) {
+		TEST_CHECK(EqualsBytes(doc->getRoot().getItemKey(0), "k\xC3\xA9y"));
+		TEST_CHECK(EqualsBytes(doc->getRoot().getItem("k\xC3\xA9y").getString(), "v\xC3\xA9"));
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestDocumentValues);
+	TEST_RUN(TestDocumentArena);
+	TEST_RUN(TestDocumentErrors);
+	TEST_RUN(TestStringEscapes);
+	return TEST_RESULT;
+}
@@ -0,0 +1,148 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static String WriteToString(const Variant& value, sl_bool flagPretty = sl_false)
+{
+	MemoryWriter output;
+	JsonWriter writer(&output, flagPretty);
+	if (!(writer.write(value) && writer.flush())) {
+		return sl_null;
+	}
+	Memory mem = output.getData();
+	return String((const sl_char8*)(mem.getData()), mem.getSize());
+}
+
+static void TestWriterScalars()
+{
+	TEST_CHECK(WriteToString(Variant()) == "null");
+	TEST_CHECK(WriteToString(sl_true) == "true");
+	TEST_CHECK(WriteToString(sl_false) == "false");
+	TEST_CHECK(WriteToString((sl_int64)0) == "0");
+	TEST_CHECK(WriteToString(SLIB_INT64(-9223372036854775807) - 1) == "-9223372036854775808");
+	TEST_CHECK(WriteToString(SLIB_UINT64(18446744073709551615)) == "18446744073709551615");
+	TEST_CHECK(WriteToString(1.0) == "1.0");
+	TEST_CHECK(WriteToString(-2.0) == "-2.0");
+	TEST_CHECK(WriteToString(0.1) == "0.1");
+	double zero = 0;
+	TEST_CHECK(WriteToString(zero / zero) == "null");
+	TEST_CHECK(WriteToString(1 / zero) == "null");
+	double values[] = {1.0 / 3.0, 1e300, -2.5e-10, 123456.789};
+	for (sl_size i = 0; i < CountOfArray(values); i++) {
+		String s = WriteToString(values[i]);
+		double d = 0;
+		TEST_CHECK(String::parseDouble(&d, s.getData(), 0, s.getLength()) == (sl_reg)(s.getLength()));
+		TEST_CHECK(d == values[i]);
+	}
+}
+
+static void TestWriterStrings()
+{
+	TEST_CHECK(WriteToString("") == "\"\"");
+	TEST_CHECK(WriteToString("a\"b\\c/d") == "\"a\\\"b\\\\c/d\"");
+	TEST_CHECK(WriteToString("\n\r\t\b\f") == "\"\\n\\r\\t\\b\\f\"");
+	TEST_CHECK(WriteToString(String("\x01\x1f", 2)) == "\"\\u0001\\u001f\"");
+	// UTF-8 is written as is
+	TEST_CHECK(WriteToString("caf\xC3\xA9") == "\"caf\xC3\xA9\"");
+}
+
+static void TestWriterStructures()
+{
+	Json map = Json::createMap();
+	map.putItem("x", 1);
+	Json list = Json::createList();
+	list.addElement(1.5);
+	list.addElement(sl_true);
+	list.addElement(Json());
+	list.addElement("s");
+	map.putItem("l", list);
+	map.putItem("m", Json::createMap());
+	String s = WriteToString(map);
+	Json parsed = Json::parseJson(s);
+	TEST_CHECK(parsed.isJsonMap());
+	TEST_CHECK(parsed["x"].getInt32() == 1);
+	TEST_CHECK(parsed["l"].getElementsCount() == 4);
+	TEST_CHECK(parsed["l"][0].getDouble() == 1.5);
+	TEST_CHECK(parsed["l"][1].getBoolean());
+	TEST_CHECK(parsed["l"][2].isNull());
+	TEST_CHECK(parsed["l"][3].getString() == "s");
+	TEST_CHECK(parsed["m"].isJsonMap());
+	
+	MemoryWriter output;
+	JsonWriter writer(&output, sl_true);
+	writer.beginMap();
+	writer.writeKey("a");
+	writer.beginList();
+	writer.writeInt64(1);
+	writer.writeInt64(2);
+	writer.endList();
+	writer.writeKey("b");
+	writer.beginMap();
+	writer.endMap();
+	writer.writeKey("c");
+	writer.beginList();
+	writer.endList();
+	writer.endMap();
+	TEST_CHECK(writer.flush());
+	TEST_CHECK(!(writer.isError()));
+	Memory mem = output.getData();
+	const char* expected = "{\n\t\"a\": [\n\t\t1,\n\t\t2\n\t],\n\t\"b\": {},\n\t\"c\": []\n}";
+	TEST_CHECK(writer.getWrittenSize() == Base::getStringLength(expected));
+	TEST_CHECK(String((const sl_char8*)(mem.getData()), mem.getSize()) == expected);
+}
+
+static void TestWriterLargeOutput()
+{
+	// longer than the chunk, so the text is passed to the output in several writes
+	StringBuffer sb;
+	for (sl_uint32 i = 0; i < 3 * SLIB_JSON_WRITER_CHUNK_SIZE / 10; i++) {
+		sb.add(String::format("%05d\"\\ ", i));
+	}
+	String str = sb.merge();
+	Json list = Json::createList();
+	for (sl_uint32 i = 0; i < 3; i++) {
+		list.addElement(str);
+	}
+	String s = WriteToString(list);
+	TEST_CHECK(s.getLength() > 3 * SLIB_JSON_WRITER_CHUNK_SIZE);
+	Json parsed = Json::parseJson(s);
+	TEST_CHECK(parsed.getElementsCount() == 3);
+	TEST_CHECK(parsed[2].getString() == str);
+	Ref<JsonDocument> doc = JsonDocument::parse(Memory::create(s.getData(), s.getLength()));
+	TEST_CHECK(doc.isNotNull());
+	if (doc.isNotNull()) {
+		TEST_CHECK(doc->getRoot()[1].getString() == str);
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestWriterScalars);
+	TEST_RUN(TestWriterStrings);
+	TEST_RUN(TestWriterStructures);
+	TEST_RUN(TestWriterLargeOutput);
+	return TEST_RESULT;
+}
@@ -0,0 +1,185 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	Each case uses its own size classes, so that the free lists of the heaps are not shared by the cases.
+*/
+
+static sl_uint32 GetSizeClass(sl_size size)
+{
+	for (sl_uint32 i = 0; i < SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT; i++) {
+		SlabAllocatorStatistics stats;
+		SlabAllocator::getStatistics(i, stats);
+		if (size <= stats.blockSize) {
+			return i;
+		}
+	}
+	return SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT;
+}
+
+static SlabAllocatorStatistics GetStatistics(sl_size size)
+{
+	SlabAllocatorStatistics stats;
+	SlabAllocator::getStatistics(GetSizeClass(size), stats);
+	return stats;
+}
+
+static void TestSizeClasses()
+{
+	sl_size sizes[] = {0, 1, 16, 17, 128, 129, 256, 257, 512};
+	sl_size blockSizes[] = {16, 16, 16, 32, 128, 160, 256, 320, 512};
+	for (sl_size i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		void* ptr = SlabAllocator::allocate(sizes[i]);
+		TEST_CHECK(ptr != sl_null);
+		if (ptr) {
+			TEST_CHECK(SlabAllocator::contains(ptr));
+			TEST_CHECK(SlabAllocator::getBlockSize(ptr) == blockSizes[i]);
+			// the whole block is usable
+			Base::resetMemory(ptr, 0xAB, blockSizes[i]);
+			SlabAllocator::free(ptr);
+		}
+	}
+	// larger than the maximum block size
+	TEST_CHECK(SlabAllocator::allocate(513) == sl_null);
+	SlabAllocatorStatistics stats;
+	TEST_CHECK(!(SlabAllocator::getStatistics(SLIB_SLAB_ALLOCATOR_SIZE_CLASSES_COUNT, stats)));
+}
+
+static void TestContains()
+{
+	void* ptr = ::malloc(64);
+	TEST_CHECK(!(SlabAllocator::contains(ptr)));
+	::free(ptr);
+	TEST_CHECK(!(SlabAllocator::contains(sl_null)));
+	// small blocks of `Base::createMemory` are served by the slabs, and freed by `Base::freeMemory`
+	ptr = Base::createMemory(100);
+	TEST_CHECK(SlabAllocator::contains(ptr));
+	TEST_CHECK(SlabAllocator::getBlockSize(ptr) == 112);
+	ptr = Base::reallocMemory(ptr, 1000);
+	TEST_CHECK(ptr != sl_null && !(SlabAllocator::contains(ptr)));
+	Base::freeMemory(ptr);
+	ptr = Base::createMemory(1000);
+	TEST_CHECK(!(SlabAllocator::contains(ptr)));
+	Base::freeMemory(ptr);
+}
+
+static void TestStatistics()
+{
+	const sl_size size = 300;
+	SlabAllocatorStatistics before = GetStatistics(size);
+	TEST_CHECK(before.blockSize == 320);
+	void* blocks[1000];
+	for (sl_uint32 i = 0; i < 1000; i++) {
+		blocks[i] = SlabAllocator::allocate(size);
+	}
+	SlabAllocatorStatistics stats = GetStatistics(size);
+	TEST_CHECK(stats.allocatedCount == before.allocatedCount + 1000);
+	TEST_CHECK(stats.freedCount == before.freedCount);
+	TEST_CHECK(stats.liveBytes == before.liveBytes + 1000 * 320);
+	// 1000 blocks of 320 bytes don't fit in a 64KB span
+	TEST_CHECK(stats.spansCount >= before.spansCount + 4);
+	for (sl_uint32 i = 0; i < 1000; i++) {
+		SlabAllocator::free(blocks[i]);
+	}
+	SlabAllocatorStatistics after = GetStatistics(size);
+	TEST_CHECK(after.freedCount == before.freedCount + 1000);
+	TEST_CHECK(after.liveBytes == before.liveBytes);
+	// the spans are kept
+	TEST_CHECK(after.spansCount == stats.spansCount);
+	// reused from the free list
+	void* ptr = SlabAllocator::allocate(size);
+	TEST_CHECK(GetStatistics(size).spansCount == stats.spansCount);
+	SlabAllocator::free(ptr);
+}
+
+static void TestRemoteFree()
+{
+	const sl_size size = 448;
+	void* ptr = SlabAllocator::allocate(size);
+	TEST_CHECK(ptr != sl_null);
+	SlabAllocatorStatistics before = GetStatistics(size);
+	Ref<Thread> thread = Thread::start([ptr]() {
+		SlabAllocator::free(ptr);
+	});
+	thread->join();
+	// waiting in the remote queue of this thread, counted as live
+	SlabAllocatorStatistics stats = GetStatistics(size);
+	TEST_CHECK(stats.freedCount == before.freedCount);
+	TEST_CHECK(stats.liveBytes == before.liveBytes);
+	// collected when the free list runs empty
+	void* ptr2 = SlabAllocator::allocate(size);
+	TEST_CHECK(ptr2 == ptr);
+	stats = GetStatistics(size);
+	TEST_CHECK(stats.allocatedCount == before.allocatedCount + 1);
+	TEST_CHECK(stats.freedCount == before.freedCount + 1);
+	TEST_CHECK(stats.liveBytes == before.liveBytes);
+	SlabAllocator::free(ptr2);
+}
+
+static void TestAbandonedHeap()
+{
+	const sl_size size = 500;
+	void* ptr = sl_null;
+	Ref<Thread> thread = Thread::start([&ptr, size]() {
+		ptr = SlabAllocator::allocate(size);
+	});
+	thread->join();
+	TEST_CHECK(ptr != sl_null);
+	if (!ptr) {
+		return;
+	}
+	// the heap of the thread is abandoned by its thread-local destructor, after the thread function returns
+	System::sleep(100);
+	SlabAllocatorStatistics before = GetStatistics(size);
+	// freed after the owner exits: pushed to the remote queue of the abandoned heap
+	SlabAllocator::free(ptr);
+	SlabAllocatorStatistics stats = GetStatistics(size);
+	TEST_CHECK(stats.freedCount == before.freedCount);
+	// the new thread reuses the abandoned heap, and collects the block
+	void* ptr2 = sl_null;
+	thread = Thread::start([&ptr2, size]() {
+		ptr2 = SlabAllocator::allocate(size);
+		SlabAllocator::free(ptr2);
+	});
+	thread->join();
+	TEST_CHECK(ptr2 == ptr);
+	stats = GetStatistics(size);
+	TEST_CHECK(stats.freedCount == before.freedCount + 2);
+	TEST_CHECK(stats.liveBytes + 512 == before.liveBytes);
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_CHECK(SlabAllocator::setEnabled(sl_true));
+	TEST_CHECK(SlabAllocator::isEnabled());
+	TEST_RUN(TestSizeClasses);
+	TEST_RUN(TestContains);
+	TEST_RUN(TestStatistics);
+	TEST_RUN(TestRemoteFree);
+	TEST_RUN(TestAbandonedHeap);
+	return TEST_RESULT;
+}
@@ -0,0 +1,218 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static sl_int32 g_countLiveCaptures = 0;
+
+// counts the live copies, to check that the callables are destroyed
+class TestCapture
+{
+public:
+	sl_int32* value;
+	
+public:
+	TestCapture(sl_int32* _value): value(_value)
+	{
+		Base::interlockedIncrement32(&g_countLiveCaptures);
+	}
+	
+	TestCapture(const TestCapture& other): value(other.value)
+	{
+		Base::interlockedIncrement32(&g_countLiveCaptures);
+	}
+	
+	~TestCapture()
+	{
+		Base::interlockedDecrement32(&g_countLiveCaptures);
+	}
+	
+};
+
+static sl_int32 GetLiveCaptures()
+{
+	return Base::interlockedAdd32(&g_countLiveCaptures, 0);
+}
+
+static void TestUniqueFunction()
+{
+	sl_int32 value = 0;
+	{
+		TestCapture capture(&value);
+		UniqueFunction<void(sl_int32)> small = [capture](sl_int32 n) {
+			*(capture.value) += n;
+		};
+		char large[SLIB_UNIQUE_FUNCTION_INLINE_SIZE * 2] = {1};
+		UniqueFunction<void(sl_int32)> big = [capture, large](sl_int32 n) {
+			*(capture.value) += n * large[0];
+		};
+		TEST_CHECK(GetLiveCaptures() == 3);
+		small(1);
+		big(10);
+		TEST_CHECK(value == 11);
+		
+		UniqueFunction<void(sl_int32)> moved = Move(small);
+		TEST_CHECK(small.isNull());
+		TEST_CHECK(moved.isNotNull());
+		moved(100);
+		TEST_CHECK(value == 111);
+		TEST_CHECK(GetLiveCaptures() == 3);
+		
+		// assigning releases the previous callable
+		moved = Move(big);
+		TEST_CHECK(GetLiveCaptures() == 2);
+		moved(1000);
+		TEST_CHECK(value == 1111);
+		moved.setNull();
+		TEST_CHECK(GetLiveCaptures() == 1);
+		
+		UniqueFunction<sl_int32(sl_int32, sl_int32)> add = [](sl_int32 a, sl_int32 b) {
+			return a + b;
+		};
+		Function<sl_int32(sl_int32, sl_int32)> f = add.release();
+		TEST_CHECK(add.isNull());
+		TEST_CHECK(f(2, 3) == 5);
+		
+		UniqueFunction<sl_int32(sl_int32, sl_int32)> fromFunction = f;
+		TEST_CHECK(fromFunction(4, 5) == 9);
+	}
+	TEST_CHECK(GetLiveCaptures() == 0);
+}
+
+static void TestQueueOrder()
+{
+	TaskQueue queue;
+	sl_int32 last = -1;
+	sl_bool flagOrdered = sl_true;
+	sl_int32 next = 0;
+	UniqueFunction<void()> task;
+	// interleaves push and pop across many blocks
+	for (sl_int32 round = 0; round < 50; round++) {
+		for (sl_int32 i = 0; i < 37; i++) {
+			sl_int32 n = next++;
+			TEST_CHECK(queue.push([n, &last, &flagOrdered]() {
+				if (n != last + 1) {
+					flagOrdered = sl_false;
+				}
+				last = n;
+			}));
+		}
+		for (sl_int32 i = 0; i < 20; i++) {
+			TEST_CHECK(queue.pop(&task));
+			task();
+		}
+	}
+	TEST_CHECK(queue.getCount() == (sl_size)(next - last - 1));
+	while (queue.pop(&task)) {
+		task();
+	}
+	TEST_CHECK(flagOrdered);
+	TEST_CHECK(last == next - 1);
+	TEST_CHECK(queue.isEmpty());
+	TEST_CHECK(!(queue.pop(&task)));
+	TEST_CHECK(!(queue.push(UniqueFunction<void()>())));
+}
+
+static void TestQueueSwapAndRemove()
+{
+	sl_int32 value = 0;
+	{
+		TaskQueue queue;
+		TestCapture capture(&value);
+		for (sl_int32 i = 0; i < 100; i++) {
+			queue.push([capture]() {
+				(*(capture.value))++;
+			});
+		}
+		TEST_CHECK(GetLiveCaptures() == 101);
+		TaskQueue local;
+		queue.swap(local);
+		TEST_CHECK(queue.isEmpty());
+		TEST_CHECK(local.getCount() == 100);
+		UniqueFunction<void()> task;
+		for (sl_int32 i = 0; i < 40; i++) {
+			TEST_CHECK(local.pop_NoLock(&task));
+			task();
+		}
+		task.setNull();
+		TEST_CHECK(value == 40);
+		TEST_CHECK(GetLiveCaptures() == 61);
+		local.removeAll();
+		TEST_CHECK(local.isEmpty());
+		TEST_CHECK(GetLiveCaptures() == 1);
+		for (sl_int32 i = 0; i < 10; i++) {
+			queue.push([capture]() {
+				(*(capture.value))++;
+			});
+		}
+	}
+	// the destructor removes the remaining tasks
+	TEST_CHECK(GetLiveCaptures() == 0);
+	TEST_CHECK(value == 40);
+}
+
+static void TestQueueConcurrentPush()
+{
+	TaskQueue queue;
+	sl_int32 count = 0;
+	const sl_int32 nProducers = 4;
+	const sl_uint32 nTasks = 20000;
+	sl_int32 countProducers = nProducers;
+	List< Ref<Thread> > threads;
+	for (sl_int32 i = 0; i < nProducers; i++) {
+		threads.add(Thread::start([&queue, &count, &countProducers, nTasks]() {
+			for (sl_uint32 k = 0; k < nTasks; k++) {
+				queue.push([&count]() {
+					count++;
+				});
+			}
+			Base::interlockedDecrement32(&countProducers);
+		}));
+	}
+	UniqueFunction<void()> task;
+	for (;;) {
+		sl_bool flagDone = !(Base::interlockedAdd32(&countProducers, 0));
+		if (queue.pop(&task)) {
+			task();
+		} else if (!flagDone) {
+			System::yield();
+		} else {
+			break;
+		}
+	}
+	for (sl_size i = 0; i < threads.getCount(); i++) {
+		threads.getValueAt(i)->join();
+	}
+	TEST_CHECK(count == (sl_int32)(nProducers * nTasks));
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestUniqueFunction);
+	TEST_RUN(TestQueueOrder);
+	TEST_RUN(TestQueueSwapAndRemove);
+	TEST_RUN(TestQueueConcurrentPush);
+	return TEST_RESULT;
+}
@@ -0,0 +1,125 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static sl_bool WaitForCount(sl_int32* count, sl_int32 expected, sl_uint32 timeout_ms = 5000)
+{
+	TimeCounter t;
+	while (Base::interlockedAdd32(count, 0) < expected) {
+		if (t.getElapsedMilliseconds() > timeout_ms) {
+			return sl_false;
+		}
+		System::sleep(1);
+	}
+	return sl_true;
+}
+
+static void TestTasks(const Ref<ThreadPool>& pool)
+{
+	TEST_CHECK(pool.isNotNull());
+	if (pool.isNull()) {
+		return;
+	}
+	sl_int32 count = 0;
+	for (sl_uint32 i = 0; i < 1000; i++) {
+		pool->addTask([&count]() {
+			Base::interlockedIncrement32(&count);
+		});
+	}
+	TEST_CHECK(WaitForCount(&count, 1000));
+	TEST_CHECK(count == 1000);
+	pool->release();
+}
+
+static void TestTasks()
+{
+	TestTasks(ThreadPool::create(2, 8));
+}
+
+static void TestTasksWorkStealing()
+{
+	Ref<ThreadPool> pool = ThreadPool::createWorkStealing(4);
+	TEST_CHECK(pool.isNotNull() && pool->isWorkStealing());
+	if (pool.isNull()) {
+		return;
+	}
+	// tasks added from the workers go to their own deques
+	sl_int32 count = 0;
+	for (sl_uint32 i = 0; i < 100; i++) {
+		pool->addTask([pool, &count]() {
+			for (sl_uint32 k = 0; k < 10; k++) {
+				pool->addTask([&count]() {
+					Base::interlockedIncrement32(&count);
+				});
+			}
+		});
+	}
+	TEST_CHECK(WaitForCount(&count, 1000));
+	TestTasks(pool);
+}
+
+static void TestDelayedDispatch()
+{
+	Ref<ThreadPool> pool = ThreadPool::create();
+	sl_int32 count = 0;
+	TimeCounter t;
+	TEST_CHECK(pool->dispatch([&count]() {
+		Base::interlockedIncrement32(&count);
+	}, 50));
+	TEST_CHECK(WaitForCount(&count, 1));
+	TEST_CHECK(t.getElapsedMilliseconds() >= 45);
+	pool->release();
+}
+
+static void TestCancelTimeout()
+{
+	Ref<ThreadPool> pool = ThreadPool::create();
+	sl_int32 countCanceled = 0;
+	sl_int32 count = 0;
+	TimerHandle handle = pool->addTimeout([&countCanceled]() {
+		Base::interlockedIncrement32(&countCanceled);
+	}, 30);
+	TEST_CHECK(handle.isPending());
+	TEST_CHECK(handle.cancel());
+	TEST_CHECK(!(handle.isPending()));
+	TEST_CHECK(!(handle.cancel()));
+	TimerHandle handleExpired = pool->addTimeout([&count]() {
+		Base::interlockedIncrement32(&count);
+	}, 60);
+	TEST_CHECK(WaitForCount(&count, 1));
+	TEST_CHECK(!(handleExpired.cancel()));
+	TEST_CHECK(countCanceled == 0);
+	pool->release();
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestTasks);
+	TEST_RUN(TestTasksWorkStealing);
+	TEST_RUN(TestDelayedDispatch);
+	TEST_RUN(TestCancelTimeout);
+	return TEST_RESULT;
+}
@@ -0,0 +1,86 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+
+#include "test.h"
+
+using namespace slib;
+
+// Sun, 06 Nov 1994 08:49:37 GMT
+#define TEST_SECONDS 784111777
+
+static void TestFormatHttpDate()
+{
+	Time time;
+	time.setSecondsCount(TEST_SECONDS);
+	TEST_CHECK(time.toHttpDate() == "Sun, 06 Nov 1994 08:49:37 GMT");
+	time.setSecondsCount(0);
+	TEST_CHECK(time.toHttpDate() == "Thu, 01 Jan 1970 00:00:00 GMT");
+	// leap day
+	time.setSecondsCount(951782400);
+	TEST_CHECK(time.toHttpDate() == "Tue, 29 Feb 2000 00:00:00 GMT");
+	time.setSecondsCount(-1);
+	TEST_CHECK(time.toHttpDate() == "Wed, 31 Dec 1969 23:59:59 GMT");
+}
+
+static void TestParseHttpDate()
+{
+	Time time;
+	// IMF-fixdate
+	TEST_CHECK(Time::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", &time));
+	TEST_CHECK(time.getSecondsCount() == TEST_SECONDS);
+	// RFC 850
+	time.setZero();
+	TEST_CHECK(Time::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", &time));
+	TEST_CHECK(time.getSecondsCount() == TEST_SECONDS);
+	// asctime
+	time.setZero();
+	TEST_CHECK(Time::parseHttpDate("Sun Nov  6 08:49:37 1994", &time));
+	TEST_CHECK(time.getSecondsCount() == TEST_SECONDS);
+	
+	// month names are case-insensitive, and the two-digit years before 70 are in 2000s
+	TEST_CHECK(Time::parseHttpDate("Tuesday, 29-FEB-00 00:00:00 GMT", &time));
+	TEST_CHECK(time.getSecondsCount() == 951782400);
+	
+	// round trip
+	Time now = Time::now();
+	now.setSecondsCount(now.getSecondsCount());
+	TEST_CHECK(Time::parseHttpDate(now.toHttpDate(), &time));
+	TEST_CHECK(time.getSecondsCount() == now.getSecondsCount());
+	
+	TEST_CHECK(!(Time::parseHttpDate("", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Nov 1994 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Xyz 1994 08:49:37 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Nov 1994 24:00:00 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Nov 1994 8:49:37 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 32 Nov 1994 08:49:37 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Nov 1994 1995 08:49:37 GMT", &time)));
+	TEST_CHECK(!(Time::parseHttpDate("Sun, 06 Nov 1994 08:49:37 08:49:37 GMT", &time)));
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestFormatHttpDate);
+	TEST_RUN(TestParseHttpDate);
+	return TEST_RESULT;
+}
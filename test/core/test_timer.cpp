@@ -0,0 +1,214 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static sl_uint32 RunExpired(TimerWheel& wheel)
+{
+	LinkedQueue< Function<void()> > tasks;
+	wheel.pollExpired(tasks);
+	sl_uint32 n = 0;
+	Function<void()> task;
+	while (tasks.pop_NoLock(&task)) {
+		task();
+		n++;
+	}
+	return n;
+}
+
+static void TestWheelExpire()
+{
+	TimerWheel wheel;
+	sl_int32 flags = 0;
+	wheel.add([&flags]() { flags |= 1; }, 5);
+	wheel.add([&flags]() { flags |= 2; }, 20);
+	Ref<TimerWheelEntry> entryFar = wheel.add([&flags]() { flags |= 4; }, 100000);
+	TEST_CHECK(wheel.getCount() == 3);
+	System::sleep(40);
+	TEST_CHECK(RunExpired(wheel) == 2);
+	TEST_CHECK(flags == 3);
+	TEST_CHECK(wheel.getCount() == 1);
+	TEST_CHECK(entryFar->isPending());
+	LinkedQueue< Function<void()> > tasks;
+	sl_int32 timeout = wheel.pollExpired(tasks);
+	TEST_CHECK(timeout > 0 && timeout <= 100000);
+	TEST_CHECK(entryFar->cancel());
+	TEST_CHECK(wheel.pollExpired(tasks) < 0);
+	TEST_CHECK(tasks.isEmpty());
+}
+
+static void TestWheelCancelAndReschedule()
+{
+	TimerWheel wheel;
+	sl_int32 count = 0;
+	Ref<TimerWheelEntry> entry = wheel.add([&count]() { count++; }, 10);
+	TEST_CHECK(entry.isNotNull() && entry->isPending());
+	TEST_CHECK(entry->cancel());
+	TEST_CHECK(!(entry->isPending()));
+	TEST_CHECK(!(entry->cancel()));
+	TEST_CHECK(!(entry->reschedule(10)));
+	System::sleep(20);
+	TEST_CHECK(RunExpired(wheel) == 0);
+	TEST_CHECK(count == 0);
+
+	entry = wheel.add([&count]() { count++; }, 10);
+	TEST_CHECK(entry->reschedule(300));
+	System::sleep(30);
+	TEST_CHECK(RunExpired(wheel) == 0);
+	TEST_CHECK(entry->reschedule(0));
+	System::sleep(5);
+	TEST_CHECK(RunExpired(wheel) == 1);
+	TEST_CHECK(count == 1);
+	TEST_CHECK(!(entry->isPending()));
+	TEST_CHECK(wheel.getCount() == 0);
+}
+
+static void TestWheelCascade()
+{
+	// the timeouts over 256ms are placed in the upper levels, and cascaded down to the root slots
+	TimerWheel wheel;
+	sl_int32 count = 0;
+	TimeCounter t;
+	wheel.add([&count]() { count++; }, 300);
+	wheel.add([&count]() { count++; }, 600);
+	while (count < 2 && t.getElapsedMilliseconds() < 2000) {
+		RunExpired(wheel);
+		System::sleep(5);
+	}
+	TEST_CHECK(count == 2);
+	TEST_CHECK(t.getElapsedMilliseconds() >= 600);
+}
+
+static void TestWheelWakeCallback()
+{
+	TimerWheel wheel;
+	sl_int32 nWake = 0;
+	wheel.setWakeCallback([&nWake]() { nWake++; });
+	wheel.add([]() {}, 1000);
+	TEST_CHECK(nWake == 1);
+	// later than the next polling time
+	wheel.add([]() {}, 2000);
+	TEST_CHECK(nWake == 1);
+	wheel.add([]() {}, 10);
+	TEST_CHECK(nWake == 2);
+	wheel.cancelAll();
+	TEST_CHECK(wheel.getCount() == 0);
+}
+
+static void TestLoopTimerStopInCallback()
+{
+	Ref<DispatchLoop> loop = DispatchLoop::create();
+	TEST_CHECK(loop.isNotNull());
+	if (loop.isNull()) {
+		return;
+	}
+	sl_int32 countStop = 0;
+	Ref<Timer> timerStop = Timer::startWithLoop(loop, [&countStop](Timer* timer) {
+		Base::interlockedIncrement32(&countStop);
+		timer->stop();
+	}, 10);
+	sl_int32 countRemove = 0;
+	Ref<Timer> timerRemove;
+	timerRemove = Timer::startWithLoop(loop, [&countRemove, loop](Timer* timer) {
+		Base::interlockedIncrement32(&countRemove);
+		loop->removeTimer(timer);
+	}, 10);
+	sl_int32 countPeriodic = 0;
+	Ref<Timer> timerPeriodic = Timer::startWithLoop(loop, [&countPeriodic](Timer* timer) {
+		Base::interlockedIncrement32(&countPeriodic);
+	}, 10);
+	System::sleep(200);
+	TEST_CHECK(Base::interlockedAdd32(&countStop, 0) == 1);
+	TEST_CHECK(Base::interlockedAdd32(&countRemove, 0) == 1);
+	TEST_CHECK(Base::interlockedAdd32(&countPeriodic, 0) > 3);
+	timerPeriodic->stop();
+	System::sleep(30);
+	sl_int32 n = Base::interlockedAdd32(&countPeriodic, 0);
+	System::sleep(50);
+	TEST_CHECK(Base::interlockedAdd32(&countPeriodic, 0) == n);
+	loop->release();
+}
+
+static void TestLoopTimerStopFromOtherThread()
+{
+	Ref<DispatchLoop> loop = DispatchLoop::create();
+	if (loop.isNull()) {
+		return;
+	}
+	for (sl_uint32 i = 0; i < 50; i++) {
+		sl_int32 count = 0;
+		Ref<Timer> timer = Timer::startWithLoop(loop, [&count](Timer* timer) {
+			Base::interlockedIncrement32(&count);
+		}, 1);
+		System::sleep(i % 3);
+		timer->stopAndWait();
+		System::sleep(5);
+		sl_int32 n = Base::interlockedAdd32(&count, 0);
+		System::sleep(10);
+		TEST_CHECK(Base::interlockedAdd32(&count, 0) == n);
+	}
+	loop->release();
+}
+
+static void TestDispatchLoopTimeout()
+{
+	Ref<DispatchLoop> loop = DispatchLoop::create();
+	if (loop.isNull()) {
+		return;
+	}
+	sl_int32 count = 0;
+	TimerHandle handleCanceled = loop->addTimeout([&count]() {
+		Base::interlockedAdd32(&count, 100);
+	}, 20);
+	loop->addTimeout([&count]() {
+		Base::interlockedIncrement32(&count);
+	}, 20);
+	TEST_CHECK(handleCanceled.cancel());
+	// `Dispatch::setTimeout` keeps returning the boolean result
+	if (Dispatch::setTimeout(loop, [&count]() {
+		Base::interlockedAdd32(&count, 10);
+	}, 20)) {
+		TEST_CHECK(Dispatch::addTimeout(loop, [&count]() {
+			Base::interlockedAdd32(&count, 1000);
+		}, 20).cancel());
+	} else {
+		TEST_CHECK(sl_false);
+	}
+	System::sleep(100);
+	TEST_CHECK(Base::interlockedAdd32(&count, 0) == 11);
+	loop->release();
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestWheelExpire);
+	TEST_RUN(TestWheelCancelAndReschedule);
+	TEST_RUN(TestWheelCascade);
+	TEST_RUN(TestWheelWakeCallback);
+	TEST_RUN(TestLoopTimerStopInCallback);
+	TEST_RUN(TestLoopTimerStopFromOtherThread);
+	TEST_RUN(TestDispatchLoopTimeout);
+	return TEST_RESULT;
+}
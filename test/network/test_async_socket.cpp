@@ -0,0 +1,272 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	The socket is completed by the ring when the loop runs on io_uring, otherwise by the readiness of epoll/kqueue.
+	The peer is a blocking socket on the test thread.
+*/
+struct AsyncSocketPair
+{
+	Ref<AsyncIoLoop> loop;
+	Ref<Socket> listener;
+	Ref<AsyncTcpSocket> socket;
+	Ref<Socket> peer;
+	
+	sl_bool open()
+	{
+		loop = AsyncIoLoop::create();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		listener = Socket::openTcp();
+		if (listener.isNull()) {
+			return sl_false;
+		}
+		if (!(listener->bind(SocketAddress(IPv4Address(127, 0, 0, 1), 0)))) {
+			return sl_false;
+		}
+		SocketAddress address;
+		if (!(listener->getLocalAddress(address)) || !(listener->listen())) {
+			return sl_false;
+		}
+		Ref<Event> eventConnect = Event::create();
+		sl_bool flagConnectError = sl_true;
+		AsyncTcpSocketParam param;
+		param.ioLoop = loop;
+		param.connectAddress = address;
+		param.onConnect = [eventConnect, &flagConnectError](AsyncTcpSocket*, const SocketAddress&, sl_bool flagError) {
+			flagConnectError = flagError;
+			eventConnect->set();
+		};
+		socket = AsyncTcpSocket::create(param);
+		if (socket.isNull()) {
+			return sl_false;
+		}
+		if (!(eventConnect->wait(3000)) || flagConnectError) {
+			return sl_false;
+		}
+		SocketAddress addressPeer;
+		return listener->accept(peer, addressPeer);
+	}
+	
+	~AsyncSocketPair()
+	{
+		if (socket.isNotNull()) {
+			socket->close();
+		}
+		if (loop.isNotNull()) {
+			loop->release();
+		}
+	}
+	
+	sl_bool receivePeer(void* buf, sl_uint32 size)
+	{
+		sl_uint8* p = (sl_uint8*)buf;
+		while (size) {
+			sl_int32 n = peer->receive(p, size);
+			if (n <= 0) {
+				return sl_false;
+			}
+			p += n;
+			size -= n;
+		}
+		return sl_true;
+	}
+	
+};
+
+struct AsyncReadResult
+{
+	Ref<Event> event;
+	sl_uint32 size;
+	sl_bool flagError;
+	
+	AsyncReadResult(): event(Event::create()), size(0), flagError(sl_false) {}
+	
+	Function<void(AsyncStreamResult*)> getCallback()
+	{
+		AsyncReadResult* self = this;
+		return [self](AsyncStreamResult* result) {
+			self->size = result->size;
+			self->flagError = result->flagError;
+			self->event->set();
+		};
+	}
+	
+};
+
+static Memory CreatePattern(sl_uint32 size, sl_uint32 seed)
+{
+	Memory mem = Memory::create(size);
+	if (mem.isNotNull()) {
+		sl_uint8* p = (sl_uint8*)(mem.getData());
+		for (sl_uint32 i = 0; i < size; i++) {
+			p[i] = (sl_uint8)((i * 31 + seed) >> 3);
+		}
+	}
+	return mem;
+}
+
+static void TestSendInOrder()
+{
+	AsyncSocketPair pair;
+	TEST_CHECK(pair.open());
+	if (pair.peer.isNull()) {
+		return;
+	}
+	// larger than the socket buffer: the sending is partial, or waits for the room of the socket
+	const sl_uint32 nChunks = 8;
+	const sl_uint32 sizeChunk = 0x40000;
+	Memory data = CreatePattern(nChunks * sizeChunk, 7);
+	sl_uint32 nSent = 0;
+	sl_uint32 nErrors = 0;
+	sl_uint32 sizeSent = 0;
+	for (sl_uint32 i = 0; i < nChunks; i++) {
+		TEST_CHECK(pair.socket->write((sl_uint8*)(data.getData()) + i * sizeChunk, sizeChunk, [&nSent, &nErrors, &sizeSent](AsyncStreamResult* result) {
+			if (result->flagError) {
+				nErrors++;
+			}
+			sizeSent += result->size;
+			nSent++;
+		}));
+	}
+	Memory received = Memory::create(nChunks * sizeChunk);
+	TEST_CHECK(pair.receivePeer(received.getData(), (sl_uint32)(received.getSize())));
+	TEST_CHECK(Base::equalsMemory(received.getData(), data.getData(), data.getSize()));
+	for (int i = 0; i < 300 && nSent < nChunks; i++) {
+		Thread::sleep(10);
+	}
+	TEST_CHECK(nSent == nChunks);
+	TEST_CHECK(!nErrors);
+	TEST_CHECK(sizeSent == nChunks * sizeChunk);
+}
+
+static void TestReceive()
+{
+	AsyncSocketPair pair;
+	TEST_CHECK(pair.open());
+	if (pair.peer.isNull()) {
+		return;
+	}
+	Memory data = CreatePattern(1000, 3);
+	
+	// heap buffer
+	{
+		char buf[2000];
+		AsyncReadResult result;
+		TEST_CHECK(pair.socket->read(buf, sizeof(buf), result.getCallback()));
+		TEST_CHECK(pair.peer->send(data.getData(), 1000) == 1000);
+		TEST_CHECK(result.event->wait(3000));
+		TEST_CHECK(!(result.flagError));
+		TEST_CHECK(result.size == 1000);
+		TEST_CHECK(Base::equalsMemory(buf, data.getData(), 1000));
+	}
+	
+	// the fixed buffer of the loop
+	{
+		Memory region = Memory::create(0x10000);
+		sl_bool flagRegistered = pair.loop->registerBuffer(region);
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		if (pair.loop->isIoUring()) {
+			TEST_CHECK(flagRegistered);
+		}
+#endif
+		TEST_CHECK(!(pair.loop->registerBuffer(Memory::create(100))));
+		Memory slice = region.sub(0x8000, 0x1000);
+		AsyncReadResult result;
+		TEST_CHECK(pair.socket->readToMemory(slice, result.getCallback()));
+		TEST_CHECK(pair.peer->send(data.getData(), 1000) == 1000);
+		TEST_CHECK(result.event->wait(3000));
+		TEST_CHECK(!(result.flagError));
+		TEST_CHECK(result.size == 1000);
+		TEST_CHECK(Base::equalsMemory(slice.getData(), data.getData(), 1000));
+		SLIB_UNUSED(flagRegistered);
+	}
+	
+	// waiting for the data without a buffer
+	{
+		AsyncReadResult result;
+		TEST_CHECK(pair.socket->read(sl_null, 0, result.getCallback()));
+		TEST_CHECK(!(result.event->wait(100)));
+		TEST_CHECK(pair.peer->send("x", 1) == 1);
+		TEST_CHECK(result.event->wait(3000));
+		TEST_CHECK(!(result.flagError));
+		char c = 0;
+		AsyncReadResult result2;
+		TEST_CHECK(pair.socket->read(&c, 1, result2.getCallback()));
+		TEST_CHECK(result2.event->wait(3000));
+		TEST_CHECK(result2.size == 1 && c == 'x');
+	}
+	
+	// closed by the peer
+	{
+		char buf[16];
+		AsyncReadResult result;
+		TEST_CHECK(pair.socket->read(buf, sizeof(buf), result.getCallback()));
+		pair.peer->close();
+		TEST_CHECK(result.event->wait(3000));
+		TEST_CHECK(result.flagError);
+	}
+}
+
+static void TestSendFile()
+{
+	AsyncSocketPair pair;
+	TEST_CHECK(pair.open());
+	if (pair.peer.isNull()) {
+		return;
+	}
+	String path = System::getTempDirectory() + "/slib_test_async_socket.bin";
+	const sl_uint32 sizeFile = 0x200000;
+	Memory data = CreatePattern(sizeFile, 11);
+	TEST_CHECK(File::writeAllBytes(path, data) == sizeFile);
+	Ref<File> file = File::openForRead(path);
+	TEST_CHECK(file.isNotNull());
+	if (file.isNull()) {
+		return;
+	}
+	const sl_uint32 offset = 100;
+	AsyncReadResult result;
+	TEST_CHECK(pair.socket->sendFile(file, offset, sizeFile - offset, result.getCallback()));
+	Memory received = Memory::create(sizeFile - offset);
+	TEST_CHECK(pair.receivePeer(received.getData(), sizeFile - offset));
+	TEST_CHECK(Base::equalsMemory(received.getData(), (sl_uint8*)(data.getData()) + offset, sizeFile - offset));
+	TEST_CHECK(result.event->wait(3000));
+	TEST_CHECK(!(result.flagError));
+	TEST_CHECK(result.size == sizeFile - offset);
+	file->close();
+	File::deleteFile(path);
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestSendInOrder);
+	TEST_RUN(TestReceive);
+	TEST_RUN(TestSendFile);
+	return TEST_RESULT;
+}
@@ -0,0 +1,290 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	The client runs against `HttpService` on the loopback interface,
+	except the stale connection test, where the peer is a blocking socket closing the connection on the second request.
+*/
+#define REUSE_PORT 18641
+#define IDLE_TIMEOUT_PORT 18642
+#define REQUEST_TIMEOUT_PORT 18643
+#define PIPELINING_PORT 18644
+#define STALE_PORT 18645
+
+struct LoopbackService
+{
+	Ref<HttpService> service;
+	Mutex lock;
+	List<sl_uint16> ports; // remote ports of the requests, in the order of the requests
+	
+	sl_bool open(sl_uint16 port)
+	{
+		HttpServiceParam param;
+		param.port = port;
+		param.ioLoopCount = 1;
+		param.onRequest = [this](HttpService*, HttpServiceContext* context) {
+			{
+				MutexLocker locker(&lock);
+				ports.add_NoLock(context->getRemoteAddress().port);
+			}
+			String path = context->getPath();
+			if (path == "/slow") {
+				Thread::sleep(1500);
+			} else {
+				sl_uint32 n = path.substring(1).parseUint32();
+				Thread::sleep((n * 7) % 13);
+			}
+			context->write(String::format("path=%s", path));
+			return sl_true;
+		};
+		service = HttpService::create(param);
+		return service.isNotNull();
+	}
+	
+	sl_size getConnectionsCount()
+	{
+		MutexLocker locker(&lock);
+		List<sl_uint16> list;
+		for (auto& port : ports) {
+			if (!(list.contains_NoLock(port))) {
+				list.add_NoLock(port);
+			}
+		}
+		return list.getCount();
+	}
+	
+	~LoopbackService()
+	{
+		if (service.isNotNull()) {
+			service->release();
+		}
+	}
+	
+};
+
+static String GetUrl(sl_uint16 port, const String& path)
+{
+	return String::format("http://127.0.0.1:%d%s", port, path);
+}
+
+static Ref<UrlRequest> SendSynchronous(const Ref<HttpClient>& client, const String& url, sl_uint32 timeout = 0)
+{
+	UrlRequestParam param;
+	param.url = url;
+	param.flagSynchronous = sl_true;
+	param.timeout = timeout;
+	return client->send(param);
+}
+
+static void TestReuse()
+{
+	LoopbackService service;
+	TEST_CHECK(service.open(REUSE_PORT));
+	Ref<HttpClient> client = HttpClient::create();
+	TEST_CHECK(client.isNotNull());
+	if (client.isNull()) {
+		return;
+	}
+	for (sl_uint32 i = 0; i < 5; i++) {
+		Ref<UrlRequest> request = SendSynchronous(client, GetUrl(REUSE_PORT, String::format("/%d", i)));
+		TEST_CHECK(request.isNotNull() && !(request->isError()));
+		if (request.isNotNull()) {
+			TEST_CHECK(request->getResponseStatus() == HttpStatus::OK);
+			TEST_CHECK(request->getResponseContentAsString() == String::format("path=/%d", i));
+		}
+	}
+	// sequential requests are sent on one keep-alive connection
+	TEST_CHECK(service.getConnectionsCount() == 1);
+	TEST_CHECK(client->getConnectionsCount() == 1);
+	client->release();
+}
+
+static void TestIdleTimeout()
+{
+	LoopbackService service;
+	TEST_CHECK(service.open(IDLE_TIMEOUT_PORT));
+	HttpClientParam param;
+	param.keepAliveTimeout = 300;
+	Ref<HttpClient> client = HttpClient::create(param);
+	TEST_CHECK(client.isNotNull());
+	if (client.isNull()) {
+		return;
+	}
+	Ref<UrlRequest> request = SendSynchronous(client, GetUrl(IDLE_TIMEOUT_PORT, "/1"));
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	TEST_CHECK(client->getConnectionsCount() == 1);
+	Thread::sleep(1000);
+	TEST_CHECK(client->getConnectionsCount() == 0);
+	// the host is created again for the next request
+	request = SendSynchronous(client, GetUrl(IDLE_TIMEOUT_PORT, "/2"));
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	TEST_CHECK(service.getConnectionsCount() == 2);
+	client->release();
+}
+
+static void TestRequestTimeout()
+{
+	LoopbackService service;
+	TEST_CHECK(service.open(REQUEST_TIMEOUT_PORT));
+	Ref<HttpClient> client = HttpClient::create();
+	TEST_CHECK(client.isNotNull());
+	if (client.isNull()) {
+		return;
+	}
+	sl_uint32 tickStart = System::getTickCount();
+	Ref<UrlRequest> request = SendSynchronous(client, GetUrl(REQUEST_TIMEOUT_PORT, "/slow"), 300);
+	sl_uint32 elapsed = System::getTickCount() - tickStart;
+	TEST_CHECK(request.isNotNull() && request->isError());
+	TEST_CHECK(elapsed < 1200);
+	// the timed-out connection is not reused
+	TEST_CHECK(client->getConnectionsCount() == 0);
+	request = SendSynchronous(client, GetUrl(REQUEST_TIMEOUT_PORT, "/1"));
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	client->release();
+}
+
+static void TestPipelining()
+{
+	LoopbackService service;
+	TEST_CHECK(service.open(PIPELINING_PORT));
+	HttpClientParam param;
+	param.maxConnectionsPerHost = 1;
+	param.maxPipelinedRequests = 8;
+	Ref<HttpClient> client = HttpClient::create(param);
+	TEST_CHECK(client.isNotNull());
+	if (client.isNull()) {
+		return;
+	}
+	// pipelining starts after the first persistent response
+	Ref<UrlRequest> request = SendSynchronous(client, GetUrl(PIPELINING_PORT, "/0"));
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	
+	const sl_uint32 count = 30;
+	Mutex lock;
+	List<String> responses;
+	Ref<Event> event = Event::create();
+	for (sl_uint32 i = 0; i < count; i++) {
+		UrlRequestParam rp;
+		rp.url = GetUrl(PIPELINING_PORT, String::format("/%d", i));
+		rp.onComplete = [&lock, &responses, event, count](UrlRequest* request) {
+			MutexLocker locker(&lock);
+			responses.add_NoLock(request->isError() ? String("error") : request->getResponseContentAsString());
+			if (responses.getCount() == count) {
+				event->set();
+			}
+		};
+		client->send(rp);
+	}
+	TEST_CHECK(event->wait(10000));
+	MutexLocker locker(&lock);
+	TEST_CHECK(responses.getCount() == count);
+	for (sl_uint32 i = 0; i < count && i < responses.getCount(); i++) {
+		TEST_CHECK(responses.getValueAt_NoLock(i) == String::format("path=/%d", i));
+	}
+	TEST_CHECK(service.getConnectionsCount() == 1);
+	locker.unlock();
+	client->release();
+}
+
+static sl_bool ReceiveRequestHeader(const Ref<Socket>& socket)
+{
+	String header;
+	char buf[1024];
+	while (!(header.contains("\r\n\r\n"))) {
+		sl_int32 n = socket->receive(buf, sizeof(buf));
+		if (n <= 0) {
+			return sl_false;
+		}
+		header += String(buf, n);
+	}
+	return sl_true;
+}
+
+static void SendResponse(const Ref<Socket>& socket, const char* content)
+{
+	String response = String::format("HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%s", Base::getStringLength(content), content);
+	socket->send(response.getData(), (sl_uint32)(response.getLength()));
+}
+
+static void TestRetryOnStaleConnection()
+{
+	Ref<Socket> listener = Socket::openTcp();
+	TEST_CHECK(listener.isNotNull());
+	if (listener.isNull()) {
+		return;
+	}
+	listener->setOption_ReuseAddress(sl_true);
+	TEST_CHECK(listener->bind(SocketAddress(IPv4Address(127, 0, 0, 1), STALE_PORT)) && listener->listen());
+	Ref<Thread> thread = Thread::start([listener]() {
+		Ref<Socket> socket;
+		SocketAddress address;
+		if (!(listener->accept(socket, address))) {
+			return;
+		}
+		if (ReceiveRequestHeader(socket)) {
+			SendResponse(socket, "first");
+		}
+		// the keep-alive connection is closed when the next request arrives, without a response
+		ReceiveRequestHeader(socket);
+		socket->close();
+		if (!(listener->accept(socket, address))) {
+			return;
+		}
+		if (ReceiveRequestHeader(socket)) {
+			SendResponse(socket, "retried");
+		}
+		Thread::sleep(500);
+	});
+	Ref<HttpClient> client = HttpClient::create();
+	TEST_CHECK(client.isNotNull());
+	if (client.isNull()) {
+		return;
+	}
+	Ref<UrlRequest> request = SendSynchronous(client, GetUrl(STALE_PORT, "/a"), 5000);
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	if (request.isNotNull()) {
+		TEST_CHECK(request->getResponseContentAsString() == "first");
+	}
+	request = SendSynchronous(client, GetUrl(STALE_PORT, "/b"), 5000);
+	TEST_CHECK(request.isNotNull() && !(request->isError()));
+	if (request.isNotNull()) {
+		TEST_CHECK(request->getResponseContentAsString() == "retried");
+	}
+	client->release();
+	listener->close();
+	thread->join(3000);
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestReuse);
+	TEST_RUN(TestIdleTimeout);
+	TEST_RUN(TestRequestTimeout);
+	TEST_RUN(TestPipelining);
+	TEST_RUN(TestRetryOnStaleConnection);
+	return TEST_RESULT;
+}
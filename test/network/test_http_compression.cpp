@@ -0,0 +1,331 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	Each request is sent on a new connection by a blocking socket.
+*/
+#define CODING_PORT 18651
+#define MIN_SIZE_PORT 18652
+#define HTTP10_PORT 18653
+#define REUSE_PORT 18654
+#define STATIC_PORT 18655
+
+static String GetTestFilePath()
+{
+	return System::getTempDirectory() + "/slib_test_http_compression.txt";
+}
+
+static String MakeText(sl_uint32 size)
+{
+	String ret = String::allocate(size);
+	sl_char8* data = ret.getData();
+	for (sl_uint32 i = 0; i < size; i++) {
+		data[i] = (sl_char8)('a' + (i * 7 + i / 26) % 26);
+	}
+	return ret;
+}
+
+static Ref<HttpService> CreateService(sl_uint16 port, sl_uint32 compressionMinSize = 1024)
+{
+	HttpServiceParam param;
+	param.port = port;
+	param.ioLoopCount = 1;
+	param.flagCompressResponse = sl_true;
+	param.compressionMinSize = compressionMinSize;
+	param.flagUseStaticCache = sl_true;
+	param.onRequest = [](HttpService* service, HttpServiceContext* context) {
+		String path = context->getPath();
+		if (path == "/file") {
+			context->setResponseContentType(ContentType::TextPlain);
+			context->copyFromFile(GetTestFilePath());
+			return sl_true;
+		}
+		if (path == "/static") {
+			return service->processFile(context, GetTestFilePath());
+		}
+		context->setResponseContentType(ContentType::TextPlain);
+		context->write(MakeText(path.substring(1).parseUint32()));
+		return sl_true;
+	};
+	return HttpService::create(param);
+}
+
+static Memory DecodeChunked(const Memory& mem)
+{
+	MemoryBuffer buf;
+	const char* p = (const char*)(mem.getData());
+	const char* end = p + mem.getSize();
+	for (;;) {
+		const char* line = p;
+		while (p + 1 < end && !(p[0] == '\r' && p[1] == '\n')) {
+			p++;
+		}
+		if (p + 1 >= end) {
+			return sl_null;
+		}
+		sl_uint32 size = 0;
+		if (!(String(line, p - line).parseUint32(16, &size))) {
+			return sl_null;
+		}
+		p += 2;
+		if (!size) {
+			return buf.merge();
+		}
+		if (p + size + 2 > end) {
+			return sl_null;
+		}
+		buf.add(Memory::create(p, size));
+		p += size + 2;
+	}
+}
+
+struct Response
+{
+	HttpResponse header;
+	Memory content; // decoded by the transfer coding and the content coding
+	String contentEncoding;
+};
+
+static sl_bool SendRequest(sl_uint16 port, const String& path, const String& headers, Response& response, const char* version = "HTTP/1.1")
+{
+	response.header.clearResponseHeaders();
+	response.content.setNull();
+	Ref<Socket> socket = Socket::openTcp();
+	if (socket.isNull() || !(socket->connectAndWait(SocketAddress(IPv4Address(127, 0, 0, 1), port), 3000))) {
+		return sl_false;
+	}
+	socket->setNonBlockingMode(sl_false);
+	String request = String::format("GET %s %s\r\nHost: localhost\r\n%s\r\n", path, version, headers);
+	if (socket->send(request.getData(), (sl_uint32)(request.getLength())) != (sl_int32)(request.getLength())) {
+		return sl_false;
+	}
+	// the service keeps the connection, so the response is read by its length
+	MemoryBuffer buf;
+	char chunk[4096];
+	sl_reg sizeHeader = 0;
+	Memory data;
+	for (;;) {
+		sl_int32 n = socket->receive(chunk, sizeof(chunk));
+		if (n <= 0) {
+			return sl_false;
+		}
+		buf.add(Memory::create(chunk, n));
+		data = buf.merge();
+		const char* p = (const char*)(data.getData());
+		sl_size size = data.getSize();
+		if (!sizeHeader) {
+			for (sl_size i = 0; i + 4 <= size; i++) {
+				if (Base::equalsMemory(p + i, "\r\n\r\n", 4)) {
+					sizeHeader = i + 4;
+					break;
+				}
+			}
+			if (sizeHeader && response.header.parseResponsePacket(p, sizeHeader) != sizeHeader) {
+				return sl_false;
+			}
+		}
+		if (sizeHeader) {
+			if (response.header.isChunkedResponse()) {
+				if (size >= (sl_size)sizeHeader + 7 && Base::equalsMemory(p + size - 7, "\r\n0\r\n\r\n", 7)) {
+					break;
+				}
+			} else if (size >= sizeHeader + response.header.getResponseContentLengthHeader()) {
+				break;
+			}
+		}
+	}
+	Memory content = data.sub(sizeHeader);
+	if (response.header.isChunkedResponse()) {
+		content = DecodeChunked(content);
+		if (content.isNull()) {
+			return sl_false;
+		}
+	}
+	response.contentEncoding = response.header.getResponseContentEncoding();
+	if (response.contentEncoding.isNotEmpty() && content.isNotNull()) {
+		content = Zlib::decompress(content.getData(), content.getSize());
+	}
+	response.content = content;
+	return sl_true;
+}
+
+static sl_bool EqualsContent(const Memory& content, const String& text)
+{
+	return content.getSize() == text.getLength() && Base::equalsMemory(content.getData(), text.getData(), text.getLength());
+}
+
+static void CheckCoding(const char* acceptEncoding, const char* expected)
+{
+	Response response;
+	TEST_CHECK(SendRequest(CODING_PORT, "/4000", String::format("Accept-Encoding: %s\r\n", acceptEncoding), response));
+	if (!(response.contentEncoding == expected)) {
+		printf("Accept-Encoding: %s -> '%s' (expected '%s')\n", acceptEncoding, response.contentEncoding.getData(), expected);
+		TEST_CHECK(sl_false);
+	}
+	TEST_CHECK(EqualsContent(response.content, MakeText(4000)));
+}
+
+static void TestQualityValues()
+{
+	Ref<HttpService> service = CreateService(CODING_PORT);
+	TEST_CHECK(service.isNotNull());
+	CheckCoding("gzip", "gzip");
+	CheckCoding("deflate", "deflate");
+	CheckCoding("gzip, deflate", "gzip");
+	CheckCoding("deflate, gzip", "gzip");
+	CheckCoding("GZip;Q=1.0", "gzip");
+	// q=0 is a refusal
+	CheckCoding("gzip;q=0, deflate", "deflate");
+	CheckCoding("gzip;q=0.000", "");
+	CheckCoding("gzip;q=0.2, deflate;q=0.8", "deflate");
+	CheckCoding("deflate;q=0.5, gzip;q=0.501", "gzip");
+	// the explicit codings override `*`, wherever they are in the list
+	CheckCoding("*", "gzip");
+	CheckCoding("*;q=0", "");
+	CheckCoding("*;q=0.5, gzip;q=0", "deflate");
+	CheckCoding("gzip;q=0, *", "deflate");
+	CheckCoding("deflate;q=0, *;q=0.1", "gzip");
+	CheckCoding("identity", "");
+	CheckCoding("br", "");
+	Response response;
+	TEST_CHECK(SendRequest(CODING_PORT, "/4000", sl_null, response));
+	TEST_CHECK(response.contentEncoding.isEmpty());
+	TEST_CHECK(response.header.getResponseHeader(HttpHeaders::Vary).isEmpty());
+}
+
+static void TestMinSize()
+{
+	Ref<HttpService> service = CreateService(MIN_SIZE_PORT, 2000);
+	TEST_CHECK(service.isNotNull());
+	Response response;
+	TEST_CHECK(SendRequest(MIN_SIZE_PORT, "/1999", "Accept-Encoding: gzip\r\n", response));
+	TEST_CHECK(response.contentEncoding.isEmpty());
+	TEST_CHECK(EqualsContent(response.content, MakeText(1999)));
+	TEST_CHECK(SendRequest(MIN_SIZE_PORT, "/2000", "Accept-Encoding: gzip\r\n", response));
+	TEST_CHECK(response.contentEncoding == "gzip");
+	TEST_CHECK(response.header.getResponseHeader(HttpHeaders::Vary) == "Accept-Encoding");
+	TEST_CHECK(EqualsContent(response.content, MakeText(2000)));
+}
+
+static void TestHttp10()
+{
+	String text = MakeText(50000);
+	TEST_CHECK(File::writeAllBytes(GetTestFilePath(), text.getData(), text.getLength()) == text.getLength());
+	Ref<HttpService> service = CreateService(HTTP10_PORT);
+	TEST_CHECK(service.isNotNull());
+	Response response;
+	// the file is compressed in the chunked transfer coding
+	TEST_CHECK(SendRequest(HTTP10_PORT, "/file", "Accept-Encoding: gzip\r\n", response));
+	TEST_CHECK(response.header.isChunkedResponse());
+	TEST_CHECK(response.contentEncoding == "gzip");
+	TEST_CHECK(EqualsContent(response.content, text));
+	// which is not available for HTTP/1.0
+	TEST_CHECK(SendRequest(HTTP10_PORT, "/file", "Accept-Encoding: gzip\r\n", response, "HTTP/1.0"));
+	TEST_CHECK(!(response.header.isChunkedResponse()));
+	TEST_CHECK(response.contentEncoding.isEmpty());
+	TEST_CHECK(EqualsContent(response.content, text));
+	// the content in memory is compressed with its length
+	TEST_CHECK(SendRequest(HTTP10_PORT, "/4000", "Accept-Encoding: gzip\r\n", response, "HTTP/1.0"));
+	TEST_CHECK(response.contentEncoding == "gzip");
+	TEST_CHECK(EqualsContent(response.content, MakeText(4000)));
+	File::deleteFile(GetTestFilePath());
+}
+
+static void TestCompressorReuse()
+{
+	// the deflate state is reset by the next start, with another level or wrapper
+	Ref<ZlibCompress> compress = new ZlibCompress;
+	String text = MakeText(20000);
+	const sl_int32 levels[] = { 6, 6, 1, 9 };
+	for (sl_uint32 i = 0; i < 8; i++) {
+		sl_bool flagGzip = !(i & 4);
+		sl_int32 level = levels[i & 3];
+		TEST_CHECK(flagGzip ? compress->startGzip(level) : compress->start(level));
+		Memory output = compress->compress(text.getData(), text.getLength(), sl_true);
+		TEST_CHECK(!(compress->isStarted()));
+		TEST_CHECK(EqualsContent(Zlib::decompress(output.getData(), output.getSize()), text));
+	}
+	// started again after an unfinished stream
+	TEST_CHECK(compress->startGzip());
+	compress->compress(text.getData(), 100, sl_false);
+	TEST_CHECK(compress->startGzip());
+	Memory output = compress->compress(text.getData(), text.getLength(), sl_true);
+	TEST_CHECK(EqualsContent(Zlib::decompress(output.getData(), output.getSize()), text));
+	
+	// the pooled compressors of the service across the responses
+	Ref<HttpService> service = CreateService(REUSE_PORT);
+	TEST_CHECK(service.isNotNull());
+	for (sl_uint32 i = 0; i < 20; i++) {
+		sl_uint32 size = 1024 + i * 997;
+		Response response;
+		TEST_CHECK(SendRequest(REUSE_PORT, String::format("/%d", size), (i & 1) ? "Accept-Encoding: deflate\r\n" : "Accept-Encoding: gzip\r\n", response));
+		TEST_CHECK(response.contentEncoding == ((i & 1) ? "deflate" : "gzip"));
+		TEST_CHECK(EqualsContent(response.content, MakeText(size)));
+	}
+}
+
+static void TestStaticETag()
+{
+	String text = MakeText(8000);
+	TEST_CHECK(File::writeAllBytes(GetTestFilePath(), text.getData(), text.getLength()) == text.getLength());
+	Ref<HttpService> service = CreateService(STATIC_PORT);
+	TEST_CHECK(service.isNotNull());
+	Response response;
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", sl_null, response));
+	TEST_CHECK(response.contentEncoding.isEmpty());
+	TEST_CHECK(EqualsContent(response.content, text));
+	String etag = response.header.getResponseHeader(HttpHeaders::ETag);
+	TEST_CHECK(etag.isNotEmpty() && !(etag.endsWith("-gz\"")));
+	
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", "Accept-Encoding: gzip\r\n", response));
+	TEST_CHECK(response.contentEncoding == "gzip");
+	TEST_CHECK(EqualsContent(response.content, text));
+	String etagGzip = response.header.getResponseHeader(HttpHeaders::ETag);
+	TEST_CHECK(etagGzip.endsWith("-gz\"") && etagGzip != etag);
+	
+	// each validator matches its own representation only
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", "Accept-Encoding: gzip\r\nIf-None-Match: " + etagGzip + "\r\n", response));
+	TEST_CHECK(response.header.getResponseCode() == HttpStatus::NotModified);
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", "If-None-Match: " + etagGzip + "\r\n", response));
+	TEST_CHECK(response.header.getResponseCode() == HttpStatus::OK);
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", "Accept-Encoding: gzip\r\nIf-None-Match: " + etag + "\r\n", response));
+	TEST_CHECK(response.header.getResponseCode() == HttpStatus::OK);
+	TEST_CHECK(response.contentEncoding == "gzip");
+	TEST_CHECK(SendRequest(STATIC_PORT, "/static", "If-None-Match: " + etag + "\r\n", response));
+	TEST_CHECK(response.header.getResponseCode() == HttpStatus::NotModified);
+	File::deleteFile(GetTestFilePath());
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestQualityValues);
+	TEST_RUN(TestMinSize);
+	TEST_RUN(TestHttp10);
+	TEST_RUN(TestCompressorReuse);
+	TEST_RUN(TestStaticETag);
+	return TEST_RESULT;
+}
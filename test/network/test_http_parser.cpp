@@ -0,0 +1,209 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+static sl_reg ParseRequest(HttpRequest& request, const char* sz)
+{
+	return request.parseRequestPacket(Memory::create(sz, Base::getStringLength(sz)));
+}
+
+static void TestRequestLine()
+{
+	HttpRequest request;
+	const char* packet = "GET /index.html?a=1&b=2 HTTP/1.1\r\nHost: localhost\r\n\r\nBODY";
+	sl_reg n = ParseRequest(request, packet);
+	TEST_CHECK(n == (sl_reg)(Base::getStringLength(packet) - 4));
+	TEST_CHECK(request.getMethod() == HttpMethod::GET);
+	TEST_CHECK(request.getPath() == "/index.html");
+	TEST_CHECK(request.getQuery() == "a=1&b=2");
+	TEST_CHECK(request.getRequestVersion() == "HTTP/1.1");
+	
+	TEST_CHECK(ParseRequest(request, "PATCH /x HTTP/1.0\r\n\r\n") > 0);
+	TEST_CHECK(request.getMethodText() == "PATCH");
+	TEST_CHECK(request.getPath() == "/x");
+	TEST_CHECK(request.getQuery().isEmpty());
+	TEST_CHECK(request.getRequestVersion() == "HTTP/1.0");
+}
+
+static void TestIncompleteAndInvalid()
+{
+	HttpRequest request;
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1") == 0);
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nHost: a\r\n") == 0);
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nHost: a\r\n\r") == 0);
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\rX\r\n\r\n") < 0);
+	TEST_CHECK(ParseRequest(request, "GET\r\n\r\n") < 0);
+	TEST_CHECK(ParseRequest(request, "GET /\r\n\r\n") < 0);
+}
+
+static void TestHeaderSlices()
+{
+	HttpRequest request;
+	TEST_CHECK(ParseRequest(request, "POST /upload HTTP/1.1\r\nHost: example.com\r\ncontent-length:  12 \r\nAccept: a\r\nACCEPT: b\r\n\r\n") > 0);
+	TEST_CHECK(request.getMethod() == HttpMethod::POST);
+	TEST_CHECK(request.getRequestHeader("host") == "example.com");
+	TEST_CHECK(request.getRequestHeader("Content-Length") == "12");
+	TEST_CHECK(request.getRequestContentLengthHeader() == 12);
+	TEST_CHECK(request.containsRequestHeader("HOST"));
+	TEST_CHECK(!(request.containsRequestHeader("Cookie")));
+	TEST_CHECK(request.getRequestHeader("Cookie").isNull());
+	List<String> values = request.getRequestHeaderValues("accept");
+	TEST_CHECK(values.getCount() == 2);
+	TEST_CHECK(values.getValueAt(0) == "a");
+	TEST_CHECK(values.getValueAt(1) == "b");
+	
+	// modifying the headers moves them into the map
+	request.setRequestHeader("Host", "other.com");
+	TEST_CHECK(request.getRequestHeader("host") == "other.com");
+	TEST_CHECK(request.getRequestHeader("content-length") == "12");
+	request.removeRequestHeader("Accept");
+	TEST_CHECK(!(request.containsRequestHeader("accept")));
+	TEST_CHECK(request.getRequestHeaders().getCount() == 2);
+	
+	// parsing again drops the previous headers
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nX-Test: 1\r\n\r\n") > 0);
+	TEST_CHECK(!(request.containsRequestHeader("Host")));
+	TEST_CHECK(request.getRequestHeader("x-test") == "1");
+}
+
+static void TestReparse()
+{
+	HttpRequest request;
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nHost: a\r\nX-Old: 1\r\n\r\n") > 0);
+	TEST_CHECK(request.getRequestHeader("X-Old") == "1");
+	// the slices of the previous request must not survive a parse stopping early
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1") == 0);
+	TEST_CHECK(request.getRequestHeader("X-Old").isNull());
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nHost: b\r\n") == 0);
+	TEST_CHECK(request.getRequestHeader("X-Old").isNull());
+	TEST_CHECK(ParseRequest(request, "GET /\r\n\r\n") < 0);
+	TEST_CHECK(request.getRequestHeader("X-Old").isNull());
+	
+	TEST_CHECK(ParseRequest(request, "GET / HTTP/1.1\r\nHost: a\r\nX-Old: 1\r\n\r\n") > 0);
+	const char* packet = "GET / HTTP/1.1\r\nHost: c\r\n\r\n";
+	TEST_CHECK(request.parseRequestPacket(packet, Base::getStringLength(packet)) > 0);
+	TEST_CHECK(request.getRequestHeader("X-Old").isNull());
+	TEST_CHECK(request.getRequestHeader("Host") == "c");
+}
+
+static void TestManyHeaders()
+{
+	StringBuffer sb;
+	sb.addStatic("GET / HTTP/1.1\r\n", 16);
+	sl_uint32 n = SLIB_HTTP_MAX_HEADER_SLICES + 8;
+	for (sl_uint32 i = 0; i < n; i++) {
+		sb.add(String::format("X-Header-%d: %d\r\n", i, i));
+	}
+	sb.addStatic("\r\n", 2);
+	String packet = sb.merge();
+	HttpRequest request;
+	TEST_CHECK(request.parseRequestPacket(Memory::create(packet.getData(), packet.getLength())) == (sl_reg)(packet.getLength()));
+	TEST_CHECK(request.getRequestHeaders().getCount() == n);
+	TEST_CHECK(request.getRequestHeader("x-header-0") == "0");
+	TEST_CHECK(request.getRequestHeader(String::format("X-HEADER-%d", n - 1)) == String::fromUint32(n - 1));
+}
+
+static void TestHeaderReader()
+{
+	const char* packet = "GET / HTTP/1.1\r\nHost: a\r\nAccept: */*\r\n\r\nBODY";
+	sl_size len = Base::getStringLength(packet);
+	// feed the packet in every split position
+	for (sl_size split = 1; split < len; split++) {
+		HttpHeaderReader reader;
+		sl_size posBody = 0;
+		sl_bool flagDone = reader.add(packet, split, posBody);
+		if (!flagDone) {
+			flagDone = reader.add(packet + split, len - split, posBody);
+			posBody += split;
+		}
+		TEST_CHECK(flagDone);
+		TEST_CHECK(posBody == len - 4);
+		TEST_CHECK(reader.getHeaderSize() == len - 4);
+		Memory header = reader.mergeHeader();
+		TEST_CHECK(header.getSize() == len - 4);
+		HttpRequest request;
+		TEST_CHECK(request.parseRequestPacket(header) == (sl_reg)(len - 4));
+		TEST_CHECK(request.getRequestHeader("accept") == "*/*");
+	}
+	HttpHeaderReader reader;
+	sl_size posBody = 0;
+	TEST_CHECK(!(reader.add("GET / HTTP/1.1\r\n", 16, posBody)));
+	TEST_CHECK(!(reader.add("Host: a\r\n", 9, posBody)));
+	TEST_CHECK(reader.add("\r\n", 2, posBody));
+	TEST_CHECK(posBody == 2);
+}
+
+static sl_bool EqualsParameters(const HashMap<String, String>& map1, const HashMap<String, String>& map2)
+{
+	if (map1.getCount() != map2.getCount()) {
+		return sl_false;
+	}
+	for (auto& item : map1) {
+		String value;
+		if (!(map2.get(item.key, &value))) {
+			return sl_false;
+		}
+		if (value != item.value || value.isNull() != item.value.isNull()) {
+			return sl_false;
+		}
+	}
+	return sl_true;
+}
+
+static void TestParameters()
+{
+	const char* query = "a=1&&b=&=x&c&d=%41%42&e=f=g";
+	HashMap<String, String> expected = HttpRequest::parseParameters(query, Base::getStringLength(query));
+	TEST_CHECK(expected.getCount() == 7);
+	TEST_CHECK(expected.find(""));
+	TEST_CHECK(expected.getValue("d") == "AB");
+	for (sl_uint32 i = 0; i < 2; i++) {
+		HttpRequest request;
+		if (i) {
+			request.setRequestArena(MemoryArena::create());
+		}
+		request.setQuery(query);
+		request.applyQueryToParameters();
+		TEST_CHECK(EqualsParameters(request.getQueryParameters(), expected));
+		request.applyPostParameters("p=%20&q=");
+		TEST_CHECK(request.getPostParameter("p") == " ");
+		TEST_CHECK(request.containsPostParameter("q"));
+		TEST_CHECK(request.getPostParameter("q").isNull());
+		TEST_CHECK(request.getParameters().getCount() == 9);
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestRequestLine);
+	TEST_RUN(TestIncompleteAndInvalid);
+	TEST_RUN(TestHeaderSlices);
+	TEST_RUN(TestReparse);
+	TEST_RUN(TestManyHeaders);
+	TEST_RUN(TestHeaderReader);
+	TEST_RUN(TestParameters);
+	return TEST_RESULT;
+}
@@ -0,0 +1,206 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	The connections are opened by non-blocking sockets,
+	so `receive()` returns 0 when nothing arrives and -1 when the service closes the connection.
+*/
+#define KEEP_ALIVE_PORT 18661
+#define HEADER_TIMEOUT_PORT 18662
+#define MAX_CONNECTIONS_PORT 18663
+
+static Ref<HttpService> CreateService(HttpServiceParam& param)
+{
+	param.ioLoopCount = 1;
+	param.onRequest = [](HttpService* service, HttpServiceContext* context) {
+		context->setResponseContentType(ContentType::TextPlain);
+		context->write("ok");
+		return sl_true;
+	};
+	return HttpService::create(param);
+}
+
+static Ref<Socket> Connect(sl_uint16 port)
+{
+	Ref<Socket> socket = Socket::openTcp();
+	if (socket.isNull() || !(socket->connectAndWait(SocketAddress(IPv4Address(127, 0, 0, 1), port), 3000))) {
+		return sl_null;
+	}
+	socket->setNonBlockingMode(sl_true);
+	return socket;
+}
+
+static sl_bool SendString(Socket* socket, const String& str)
+{
+	return socket->send(str.getData(), (sl_uint32)(str.getLength())) == (sl_int32)(str.getLength());
+}
+
+// waits for the response of `CreateService()`, which ends with its content
+static sl_bool ReceiveResponse(Socket* socket, sl_uint32 timeout)
+{
+	String data;
+	char buf[1024];
+	TimeCounter t;
+	while (t.getElapsedMilliseconds() < timeout) {
+		sl_int32 n = socket->receive(buf, sizeof(buf));
+		if (n < 0) {
+			return sl_false;
+		}
+		if (!n) {
+			System::sleep(1);
+			continue;
+		}
+		data += String(buf, n);
+		if (data.startsWith("HTTP/1.1 200 ") && data.endsWith("\r\n\r\nok")) {
+			return sl_true;
+		}
+	}
+	return sl_false;
+}
+
+// returns the milliseconds until the connection is closed by the service, or -1 on timeout
+static sl_int64 WaitForClose(Socket* socket, sl_uint32 timeout)
+{
+	char buf[1024];
+	TimeCounter t;
+	while (t.getElapsedMilliseconds() < timeout) {
+		if (socket->receive(buf, sizeof(buf)) < 0) {
+			return (sl_int64)(t.getElapsedMilliseconds());
+		}
+		System::sleep(1);
+	}
+	return -1;
+}
+
+static void TestKeepAliveTimeout()
+{
+	HttpServiceParam param;
+	param.port = KEEP_ALIVE_PORT;
+	param.keepAliveTimeout = 500;
+	Ref<HttpService> service = CreateService(param);
+	TEST_CHECK(service.isNotNull());
+	if (service.isNull()) {
+		return;
+	}
+	Ref<Socket> socket = Connect(KEEP_ALIVE_PORT);
+	TEST_CHECK(socket.isNotNull());
+	if (socket.isNotNull()) {
+		TEST_CHECK(SendString(socket.get(), "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+		TEST_CHECK(ReceiveResponse(socket.get(), 3000));
+		// kept alive until the idle timeout
+		sl_int64 elapsed = WaitForClose(socket.get(), 5000);
+		TEST_CHECK(elapsed >= 400 && elapsed < 3000);
+	}
+	service->release();
+}
+
+static void TestHeaderTimeout()
+{
+	HttpServiceParam param;
+	param.port = HEADER_TIMEOUT_PORT;
+	param.requestHeaderTimeout = 500;
+	Ref<HttpService> service = CreateService(param);
+	TEST_CHECK(service.isNotNull());
+	if (service.isNull()) {
+		return;
+	}
+	Ref<Socket> socket = Connect(HEADER_TIMEOUT_PORT);
+	TEST_CHECK(socket.isNotNull());
+	if (socket.isNotNull()) {
+		// the header line sent every 100ms doesn't extend the deadline
+		TEST_CHECK(SendString(socket.get(), "GET / HTTP/1.1\r\nHost: localhost\r\n"));
+		TimeCounter t;
+		sl_bool flagClosed = sl_false;
+		char buf[1024];
+		while (t.getElapsedMilliseconds() < 5000) {
+			SendString(socket.get(), "X-Slow: 1\r\n");
+			sl_int32 n = socket->receive(buf, sizeof(buf));
+			if (n < 0) {
+				flagClosed = sl_true;
+				break;
+			}
+			// no response for the incomplete header
+			TEST_CHECK(!n);
+			System::sleep(100);
+		}
+		TEST_CHECK(flagClosed);
+		sl_uint64 elapsed = t.getElapsedMilliseconds();
+		TEST_CHECK(elapsed >= 400 && elapsed < 3000);
+	}
+	service->release();
+}
+
+static void TestMaxConnections()
+{
+	HttpServiceParam param;
+	param.port = MAX_CONNECTIONS_PORT;
+	param.maxConnections = 2;
+	Ref<HttpService> service = CreateService(param);
+	TEST_CHECK(service.isNotNull());
+	if (service.isNull()) {
+		return;
+	}
+	Ref<Socket> sockets[3];
+	for (sl_uint32 i = 0; i < 2; i++) {
+		sockets[i] = Connect(MAX_CONNECTIONS_PORT);
+		TEST_CHECK(sockets[i].isNotNull());
+		if (sockets[i].isNull()) {
+			service->release();
+			return;
+		}
+		TEST_CHECK(SendString(sockets[i].get(), "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+		TEST_CHECK(ReceiveResponse(sockets[i].get(), 3000));
+	}
+	// connected in the kernel backlog, but not accepted while the limit is reached
+	sockets[2] = Connect(MAX_CONNECTIONS_PORT);
+	TEST_CHECK(sockets[2].isNotNull());
+	if (sockets[2].isNotNull()) {
+		TEST_CHECK(SendString(sockets[2].get(), "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+		TEST_CHECK(!(ReceiveResponse(sockets[2].get(), 500)));
+		// accepted again after a connection is closed
+		sockets[0]->close();
+		TEST_CHECK(ReceiveResponse(sockets[2].get(), 3000));
+		// the limit is reached again
+		Ref<Socket> socket = Connect(MAX_CONNECTIONS_PORT);
+		TEST_CHECK(socket.isNotNull());
+		if (socket.isNotNull()) {
+			TEST_CHECK(SendString(socket.get(), "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+			TEST_CHECK(!(ReceiveResponse(socket.get(), 500)));
+			sockets[1]->close();
+			TEST_CHECK(ReceiveResponse(socket.get(), 3000));
+		}
+	}
+	service->release();
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestKeepAliveTimeout);
+	TEST_RUN(TestHeaderTimeout);
+	TEST_RUN(TestMaxConnections);
+	return TEST_RESULT;
+}
@@ -0,0 +1,392 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "test.h"
+
+using namespace slib;
+
+#define TEST_PORT 18190
+
+class WebSocketClient
+{
+public:
+	Ref<Socket> socket;
+	Memory buf;
+	sl_size sizeBuf;
+	
+public:
+	WebSocketClient(): sizeBuf(0)
+	{
+		buf = Memory::create(65536);
+	}
+	
+	sl_bool connect(sl_uint16 port = TEST_PORT)
+	{
+		socket = Socket::openTcp();
+		if (socket.isNull()) {
+			return sl_false;
+		}
+		if (!(socket->connectAndWait(SocketAddress(IPv4Address(127, 0, 0, 1), port), 3000))) {
+			return sl_false;
+		}
+		socket->setNonBlockingMode(sl_true);
+		String request = "GET /ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+		if (!(sendAll(request.getData(), request.getLength()))) {
+			return sl_false;
+		}
+		// reads the response header
+		TimeCounter t;
+		while (t.getElapsedMilliseconds() < 3000) {
+			sl_char8* data = (sl_char8*)(buf.getData());
+			for (sl_size i = 0; i + 4 <= sizeBuf; i++) {
+				if (Base::equalsMemory(data + i, "\r\n\r\n", 4)) {
+					String header(data, i);
+					sl_size n = i + 4;
+					Base::moveMemory(data, data + n, sizeBuf - n);
+					sizeBuf -= n;
+					return header.startsWith("HTTP/1.1 101 ") && header.contains("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+				}
+			}
+			if (!(receive())) {
+				return sl_false;
+			}
+		}
+		return sl_false;
+	}
+	
+	sl_bool sendAll(const void* data, sl_size size)
+	{
+		const sl_uint8* p = (const sl_uint8*)data;
+		TimeCounter t;
+		while (size > 0 && t.getElapsedMilliseconds() < 3000) {
+			sl_int32 n = socket->send(p, (sl_uint32)size);
+			if (n < 0) {
+				return sl_false;
+			}
+			if (!n) {
+				System::sleep(1);
+			}
+			p += n;
+			size -= n;
+		}
+		return !size;
+	}
+	
+	sl_bool sendFrame(WebSocketOpcode opcode, const void* data, sl_size size, sl_bool flagFin = sl_true, sl_bool flagMask = sl_true)
+	{
+		sl_uint8 mask[4] = {0x12, 0x34, 0x56, 0x78};
+		Memory frame = Memory::create(14 + size);
+		sl_uint8* p = (sl_uint8*)(frame.getData());
+		sl_uint32 sizeHeader = WebSocket::buildFrameHeader(p, opcode, size, flagFin, flagMask ? mask : sl_null);
+		Base::copyMemory(p + sizeHeader, data, size);
+		if (flagMask) {
+			WebSocket::applyMask(p + sizeHeader, size, mask);
+		}
+		return sendAll(p, sizeHeader + size);
+	}
+	
+	sl_bool sendText(const char* text, sl_bool flagFin = sl_true)
+	{
+		return sendFrame(WebSocketOpcode::Text, text, Base::getStringLength(text), flagFin);
+	}
+	
+	sl_bool receive()
+	{
+		sl_int32 n = socket->receive((sl_uint8*)(buf.getData()) + sizeBuf, (sl_uint32)(buf.getSize() - sizeBuf));
+		if (n < 0) {
+			return sl_false;
+		}
+		if (!n) {
+			System::sleep(1);
+		}
+		sizeBuf += n;
+		return sl_true;
+	}
+	
+	// reads an unmasked server frame
+	sl_bool readFrame(WebSocketOpcode& opcode, String& payload)
+	{
+		TimeCounter t;
+		while (t.getElapsedMilliseconds() < 3000) {
+			sl_uint8* p = (sl_uint8*)(buf.getData());
+			if (sizeBuf >= 2) {
+				sl_size sizePayload = p[1] & 127;
+				sl_size sizeHeader = 2;
+				if (sizePayload == 126) {
+					sizeHeader = 4;
+					if (sizeBuf >= 4) {
+						sizePayload = ((sl_size)(p[2]) << 8) | p[3];
+					}
+				}
+				if (sizeBuf >= sizeHeader && sizeBuf >= sizeHeader + sizePayload) {
+					opcode = (WebSocketOpcode)(p[0] & 15);
+					payload = String((sl_char8*)(p + sizeHeader), sizePayload);
+					sl_size n = sizeHeader + sizePayload;
+					Base::moveMemory(p, p + n, sizeBuf - n);
+					sizeBuf -= n;
+					return sl_true;
+				}
+			}
+			if (!(receive())) {
+				return sl_false;
+			}
+		}
+		return sl_false;
+	}
+	
+	sl_bool expectText(const char* text)
+	{
+		WebSocketOpcode opcode;
+		String payload;
+		return readFrame(opcode, payload) && opcode == WebSocketOpcode::Text && payload == text;
+	}
+	
+	sl_bool expectClose(sl_uint16 code)
+	{
+		WebSocketOpcode opcode;
+		String payload;
+		if (!(readFrame(opcode, payload))) {
+			return sl_false;
+		}
+		if (opcode != WebSocketOpcode::Close || payload.getLength() < 2) {
+			return sl_false;
+		}
+		const sl_uint8* p = (const sl_uint8*)(payload.getData());
+		return (((sl_uint16)(p[0]) << 8) | p[1]) == code;
+	}
+	
+};
+
+static void TestFrameHeader()
+{
+	sl_uint8 header[14];
+	TEST_CHECK(WebSocket::buildFrameHeader(header, WebSocketOpcode::Text, 125) == 2);
+	TEST_CHECK(header[0] == 0x81 && header[1] == 125);
+	TEST_CHECK(WebSocket::buildFrameHeader(header, WebSocketOpcode::Binary, 126, sl_false) == 4);
+	TEST_CHECK(header[0] == 0x02 && header[1] == 126 && header[2] == 0 && header[3] == 126);
+	TEST_CHECK(WebSocket::buildFrameHeader(header, WebSocketOpcode::Binary, 65536) == 10);
+	TEST_CHECK(header[1] == 127 && header[7] == 1 && header[8] == 0 && header[9] == 0);
+	sl_uint8 mask[4] = {1, 2, 3, 4};
+	TEST_CHECK(WebSocket::buildFrameHeader(header, WebSocketOpcode::Ping, 5, sl_true, mask) == 6);
+	TEST_CHECK(header[1] == 0x85 && Base::equalsMemory(header + 2, mask, 4));
+	
+	Memory frame = WebSocket::buildFrame(WebSocketOpcode::Text, "abc", 3);
+	TEST_CHECK(frame.getSize() == 5);
+	TEST_CHECK(Base::equalsMemory((sl_uint8*)(frame.getData()) + 2, "abc", 3));
+}
+
+static void TestMask()
+{
+	sl_uint8 mask[4] = {0xA1, 0xB2, 0xC3, 0xD4};
+	sl_uint8 data[100];
+	sl_uint8 masked[100];
+	for (sl_uint32 i = 0; i < 100; i++) {
+		data[i] = (sl_uint8)(i * 7);
+	}
+	Base::copyMemory(masked, data, 100);
+	WebSocket::applyMask(masked, 100, mask);
+	for (sl_uint32 i = 0; i < 100; i++) {
+		TEST_CHECK(masked[i] == (data[i] ^ mask[i & 3]));
+	}
+	// masking in pieces with the offsets gives the same result
+	sl_uint8 pieces[100];
+	Base::copyMemory(pieces, data, 100);
+	WebSocket::applyMask(pieces, 3, mask, 0);
+	WebSocket::applyMask(pieces + 3, 50, mask, 3);
+	WebSocket::applyMask(pieces + 53, 47, mask, 53);
+	TEST_CHECK(Base::equalsMemory(pieces, masked, 100));
+}
+
+static void TestUtf8Validation()
+{
+	TEST_CHECK(WebSocket::isValidUtf8("", 0));
+	TEST_CHECK(WebSocket::isValidUtf8("hello", 5));
+	TEST_CHECK(WebSocket::isValidUtf8("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xF4\x8F\xBF\xBF", 13));
+	TEST_CHECK(WebSocket::isValidUtf8("\xED\x9F\xBF", 3));
+	// overlong
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xC0\x80", 2)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xE0\x80\xAF", 3)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xF0\x8F\xBF\xBF", 4)));
+	// surrogate
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xED\xA0\x80", 3)));
+	// above U+10FFFF
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xF4\x90\x80\x80", 4)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xF5\x80\x80\x80", 4)));
+	// truncated, and invalid continuation
+	TEST_CHECK(!(WebSocket::isValidUtf8("a\xE2\x82", 3)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xE2\x28\xA1", 3)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\x80", 1)));
+	TEST_CHECK(!(WebSocket::isValidUtf8("\xFF", 1)));
+}
+
+static void TestServerFrames()
+{
+	HttpServiceParam param;
+	param.port = TEST_PORT;
+	param.ioLoopCount = 1;
+	param.onWebSocket = [](HttpService*, HttpServiceContext* context, WebSocketParam& p) {
+		p.onMessage = [](WebSocket* socket, WebSocketMessage* message) {
+			if (message->isText()) {
+				socket->sendText("echo:" + message->getText());
+			} else {
+				socket->sendBinary(message->data, message->size);
+			}
+		};
+		return sl_true;
+	};
+	Ref<HttpService> service = HttpService::create(param);
+	TEST_CHECK(service.isNotNull());
+	if (service.isNull()) {
+		return;
+	}
+	{
+		WebSocketClient client;
+		TEST_CHECK(client.connect());
+		TEST_CHECK(client.sendText("hello"));
+		TEST_CHECK(client.expectText("echo:hello"));
+		// fragmented, with a control frame between the fragments
+		TEST_CHECK(client.sendText("frag", sl_false));
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Ping, "p", 1));
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Continuation, "ment", 4));
+		WebSocketOpcode opcode;
+		String payload;
+		TEST_CHECK(client.readFrame(opcode, payload) && opcode == WebSocketOpcode::Pong && payload == "p");
+		TEST_CHECK(client.expectText("echo:fragment"));
+		// a character split between the fragments
+		TEST_CHECK(client.sendText("caf\xC3", sl_false));
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Continuation, "\xA9", 1));
+		TEST_CHECK(client.expectText("echo:caf\xC3\xA9"));
+		// larger than 125 bytes
+		String big('x', 300);
+		TEST_CHECK(client.sendText(big.getData()));
+		TEST_CHECK(client.expectText(("echo:" + big).getData()));
+		// invalid UTF-8
+		TEST_CHECK(client.sendText("bad\xC0\x80"));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::InvalidData));
+	}
+	{
+		WebSocketClient client;
+		TEST_CHECK(client.connect());
+		TEST_CHECK(client.sendText("bad\xE2\x82", sl_false));
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Continuation, "", 0));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::InvalidData));
+	}
+	{
+		WebSocketClient client;
+		TEST_CHECK(client.connect());
+		// the client frames must be masked
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Text, "abc", 3, sl_true, sl_false));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::ProtocolError));
+	}
+	{
+		WebSocketClient client;
+		TEST_CHECK(client.connect());
+		// continuation without the first fragment
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Continuation, "abc", 3));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::ProtocolError));
+	}
+	service->release();
+}
+
+static void TestCloseFrames()
+{
+	HttpServiceParam param;
+	param.port = TEST_PORT + 1;
+	param.ioLoopCount = 1;
+	param.onWebSocket = [](HttpService*, HttpServiceContext* context, WebSocketParam& p) {
+		p.onMessage = [](WebSocket* socket, WebSocketMessage* message) {
+			// 1 + 41 * 3 bytes: cut at 123 bytes, then backed off to 121
+			String reason = "a";
+			for (sl_uint32 i = 0; i < 41; i++) {
+				reason += "\xE2\x82\xAC";
+			}
+			reason += message->getText();
+			socket->close(WebSocketCloseCode::Normal, reason);
+		};
+		return sl_true;
+	};
+	Ref<HttpService> service = HttpService::create(param);
+	TEST_CHECK(service.isNotNull());
+	if (service.isNull()) {
+		return;
+	}
+	auto sendClose = [](WebSocketClient& client, sl_uint16 code, const char* reason) {
+		sl_uint8 payload[125];
+		payload[0] = (sl_uint8)(code >> 8);
+		payload[1] = (sl_uint8)code;
+		sl_size sizeReason = Base::getStringLength(reason);
+		Base::copyMemory(payload + 2, reason, sizeReason);
+		return client.sendFrame(WebSocketOpcode::Close, payload, 2 + sizeReason);
+	};
+	// the valid codes are echoed
+	sl_uint16 validCodes[] = {1000, 1001, 1011, 3000, 4999};
+	for (sl_uint16 code : validCodes) {
+		WebSocketClient client;
+		TEST_CHECK(client.connect(TEST_PORT + 1));
+		TEST_CHECK(sendClose(client, code, "bye"));
+		TEST_CHECK(client.expectClose(code));
+	}
+	// the codes never sent in a Close frame
+	sl_uint16 invalidCodes[] = {0, 999, 1004, 1005, 1006, 1015, 1016, 2999, 5000};
+	for (sl_uint16 code : invalidCodes) {
+		WebSocketClient client;
+		TEST_CHECK(client.connect(TEST_PORT + 1));
+		TEST_CHECK(sendClose(client, code, ""));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::ProtocolError));
+	}
+	{
+		// the status code can't be split
+		WebSocketClient client;
+		TEST_CHECK(client.connect(TEST_PORT + 1));
+		TEST_CHECK(client.sendFrame(WebSocketOpcode::Close, "\x03", 1));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::ProtocolError));
+	}
+	{
+		WebSocketClient client;
+		TEST_CHECK(client.connect(TEST_PORT + 1));
+		TEST_CHECK(sendClose(client, 1000, "bad\xC0\x80"));
+		TEST_CHECK(client.expectClose(WebSocketCloseCode::InvalidData));
+	}
+	{
+		// the reason sent by close() is truncated on a boundary of the characters
+		WebSocketClient client;
+		TEST_CHECK(client.connect(TEST_PORT + 1));
+		TEST_CHECK(client.sendText("tail"));
+		WebSocketOpcode opcode;
+		String payload;
+		TEST_CHECK(client.readFrame(opcode, payload) && opcode == WebSocketOpcode::Close);
+		TEST_CHECK(payload.getLength() == 123);
+		TEST_CHECK(WebSocket::isValidUtf8(payload.getData() + 2, payload.getLength() - 2));
+	}
+	service->release();
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestFrameHeader);
+	TEST_RUN(TestMask);
+	TEST_RUN(TestUtf8Validation);
+	TEST_RUN(TestServerFrames);
+	TEST_RUN(TestCloseFrames);
+	return TEST_RESULT;
+}
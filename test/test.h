@@ -0,0 +1,61 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_TEST
+#define CHECKHEADER_SLIB_TEST
+
+#include <slib.h>
+
+/*
+	Assertions of the test programs.
+	Each program runs its cases from `main` by `TEST_RUN`, and returns `TEST_RESULT` (non-zero when any check failed), so that `ctest` reports the failures.
+*/
+
+namespace slib
+{
+
+	SLIB_INLINE static sl_uint32& _priv_Test_getFailuresCount()
+	{
+		static sl_uint32 n = 0;
+		return n;
+	}
+
+}
+
+#define TEST_CHECK(EXPR) \
+	do { \
+		if (!(EXPR)) { \
+			slib::Console::println("%s:%d: Check failed: %s", __FILE__, __LINE__, #EXPR); \
+			slib::_priv_Test_getFailuresCount()++; \
+		} \
+	} while (0)
+
+#define TEST_RUN(FUNC) \
+	do { \
+		slib::Console::println("Running %s", #FUNC); \
+		FUNC(); \
+	} while (0)
+
+#define TEST_RESULT (slib::_priv_Test_getFailuresCount() ? 1 : 0)
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+
+#include "test.h"
+
+#include <slib/web.h>
+
+using namespace slib;
+
+static WebHandler MakeHandler(sl_int32 id)
+{
+	return [id](SWEB_HANDLER_PARAMS_LIST) -> Variant {
+		return id;
+	};
+}
+
+struct RouteResult
+{
+	sl_int32 id;
+	HttpPathParameter params[SLIB_HTTP_MAX_PATH_PARAMETERS];
+	sl_uint32 nParams;
+	String path;
+	
+	String getName(sl_uint32 index)
+	{
+		return index < nParams ? params[index].name : String::null();
+	}
+	
+	String getValue(sl_uint32 index)
+	{
+		if (index < nParams) {
+			return path.substring(params[index].pos, params[index].pos + params[index].length);
+		}
+		return String::null();
+	}
+	
+};
+
+static RouteResult Match(WebRouter& router, HttpMethod method, const String& path)
+{
+	RouteResult ret;
+	ret.path = path;
+	ret.nParams = 0;
+	WebHandler handler = router.match(method, path, ret.params, &(ret.nParams));
+	if (handler.isNotNull()) {
+		ret.id = handler(sl_null, method, path).getInt32();
+	} else {
+		ret.id = 0;
+	}
+	return ret;
+}
+
+static void TestPrecedence()
+{
+	WebRouter router;
+	router.add(HttpMethod::GET, "/users/*rest", MakeHandler(3));
+	router.add(HttpMethod::GET, "/users/:id", MakeHandler(2));
+	router.add(HttpMethod::GET, "/users/list", MakeHandler(1));
+	
+	RouteResult r = Match(router, HttpMethod::GET, "/users/list");
+	TEST_CHECK(r.id == 1 && r.nParams == 0);
+	
+	r = Match(router, HttpMethod::GET, "/users/42");
+	TEST_CHECK(r.id == 2 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "id" && r.getValue(0) == "42");
+	
+	// a prefix of the static segment is a parameter
+	r = Match(router, HttpMethod::GET, "/users/lis");
+	TEST_CHECK(r.id == 2 && r.getValue(0) == "lis");
+	
+	r = Match(router, HttpMethod::GET, "/users/42/orders");
+	TEST_CHECK(r.id == 3 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "rest" && r.getValue(0) == "42/orders");
+	
+	r = Match(router, HttpMethod::GET, "/other");
+	TEST_CHECK(r.id == 0 && r.nParams == 0);
+}
+
+static void TestBacktracking()
+{
+	WebRouter router;
+	router.add(HttpMethod::GET, "/a/:x/c", MakeHandler(1));
+	router.add(HttpMethod::GET, "/a/b/d", MakeHandler(2));
+	router.add(HttpMethod::GET, "/p/:x/y", MakeHandler(3));
+	router.add(HttpMethod::GET, "/p/*rest", MakeHandler(4));
+	
+	// the static branch `b/` fails at `c`
+	RouteResult r = Match(router, HttpMethod::GET, "/a/b/c");
+	TEST_CHECK(r.id == 1 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "x" && r.getValue(0) == "b");
+	
+	r = Match(router, HttpMethod::GET, "/a/b/d");
+	TEST_CHECK(r.id == 2 && r.nParams == 0);
+	
+	// the parameter branch fails at `z`, and its capture is dropped
+	r = Match(router, HttpMethod::GET, "/p/q/z");
+	TEST_CHECK(r.id == 4 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "rest" && r.getValue(0) == "q/z");
+	
+	r = Match(router, HttpMethod::GET, "/p/q/y");
+	TEST_CHECK(r.id == 3 && r.getName(0) == "x" && r.getValue(0) == "q");
+	
+	r = Match(router, HttpMethod::GET, "/a/b");
+	TEST_CHECK(r.id == 0 && r.nParams == 0);
+}
+
+static void TestTrailingWildcard()
+{
+	WebRouter router;
+	router.add(HttpMethod::GET, "/files/*path", MakeHandler(1));
+	router.add(HttpMethod::GET, "/files", MakeHandler(2));
+	
+	RouteResult r = Match(router, HttpMethod::GET, "/files/");
+	TEST_CHECK(r.id == 1 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "path" && r.getValue(0).isEmpty());
+	
+	r = Match(router, HttpMethod::GET, "/files/a/b/c.txt");
+	TEST_CHECK(r.id == 1 && r.getValue(0) == "a/b/c.txt");
+	
+	r = Match(router, HttpMethod::GET, "/files");
+	TEST_CHECK(r.id == 2 && r.nParams == 0);
+	
+	r = Match(router, HttpMethod::GET, "/filesx");
+	TEST_CHECK(r.id == 0);
+}
+
+static void TestMethods()
+{
+	WebRouter router;
+	router.add(HttpMethod::GET, "/item/:id", MakeHandler(1));
+	router.add(HttpMethod::POST, "/item/:id", MakeHandler(2));
+	router.add(HttpMethod::DELETE, "/item", MakeHandler(3));
+	
+	TEST_CHECK(Match(router, HttpMethod::GET, "/item/1").id == 1);
+	TEST_CHECK(Match(router, HttpMethod::POST, "/item/1").id == 2);
+	TEST_CHECK(Match(router, HttpMethod::PUT, "/item/1").id == 0);
+	TEST_CHECK(Match(router, HttpMethod::DELETE, "/item").id == 3);
+	TEST_CHECK(Match(router, HttpMethod::GET, "/item").id == 0);
+	
+	// registering again replaces the handler
+	router.add(HttpMethod::GET, "/item/:id", MakeHandler(4));
+	TEST_CHECK(Match(router, HttpMethod::GET, "/item/1").id == 4);
+}
+
+static void TestParameterNames()
+{
+	WebRouter router;
+	router.add(HttpMethod::GET, "/users/:id", MakeHandler(1));
+	router.add(HttpMethod::GET, "/users/:name/orders/:order", MakeHandler(2));
+	router.add(HttpMethod::GET, "/users/:user/*rest", MakeHandler(3));
+	
+	RouteResult r = Match(router, HttpMethod::GET, "/users/7");
+	TEST_CHECK(r.id == 1 && r.nParams == 1);
+	TEST_CHECK(r.getName(0) == "id" && r.getValue(0) == "7");
+	
+	r = Match(router, HttpMethod::GET, "/users/bob/orders/12");
+	TEST_CHECK(r.id == 2 && r.nParams == 2);
+	TEST_CHECK(r.getName(0) == "name" && r.getValue(0) == "bob");
+	TEST_CHECK(r.getName(1) == "order" && r.getValue(1) == "12");
+	
+	r = Match(router, HttpMethod::GET, "/users/bob/photos/1");
+	TEST_CHECK(r.id == 3 && r.nParams == 2);
+	TEST_CHECK(r.getName(0) == "user" && r.getValue(0) == "bob");
+	TEST_CHECK(r.getName(1) == "rest" && r.getValue(1) == "photos/1");
+}
+
+int main(int argc, const char * argv[])
+{
+	TEST_RUN(TestPrecedence);
+	TEST_RUN(TestBacktracking);
+	TEST_RUN(TestTrailingWildcard);
+	TEST_RUN(TestMethods);
+	TEST_RUN(TestParameterNames);
+	return TEST_RESULT;
+}